@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: summing a large array of floats with bulk_reduce(), serially on
+// a single_thread_context and in parallel on a static_thread_pool, plus a
+// sum of squares with bulk_transform_reduce().
+//
+// The default size is small enough to run as part of the test suite; pass a
+// larger element count on the command line, e.g. 1000000000, and build with
+// NDEBUG (which also disables async stacks) for meaningful numbers.
+
+#include <unifex/bulk_reduce.hpp>
+#include <unifex/bulk_schedule.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+constexpr std::size_t default_element_count = std::size_t(1) << 18;
+constexpr int repetitions = 2;
+
+template <typename Scheduler, typename Factory>
+void run(
+    const char* name,
+    Scheduler sched,
+    std::size_t elementCount,
+    Factory makeReduction) {
+  double result = 0;
+  auto start = bench_clock::now();
+  for (int i = 0; i < repetitions; ++i) {
+    result = sync_wait(makeReduction(
+                           bulk_schedule(sched, elementCount)))
+                 .value();
+  }
+  auto elapsed = bench_clock::now() - start;
+
+  std::printf(
+      "%-28s %9.3f ms   %8.2f Melem/s   (result %.0f)\n",
+      name,
+      std::chrono::duration<double, std::milli>(elapsed).count() /
+          repetitions,
+      double(elementCount) * repetitions /
+          std::chrono::duration<double, std::micro>(elapsed).count(),
+      result);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t elementCount = argc > 1
+      ? std::size_t(std::strtoull(argv[1], nullptr, 10))
+      : default_element_count;
+  std::vector<float> data(elementCount, 1.0f);
+  const float* values = data.data();
+
+  auto sum = [values](auto indices) {
+    return std::move(indices) |
+        bulk_transform_reduce(
+               0.0, std::plus<>{}, [values](std::size_t i) {
+                 return double(values[i]);
+               });
+  };
+  auto sumOfSquares = [values](auto indices) {
+    return std::move(indices) |
+        bulk_transform_reduce(
+               0.0, std::plus<>{}, [values](std::size_t i) {
+                 return double(values[i]) * values[i];
+               });
+  };
+  auto sumOfIndices = [](auto indices) {
+    return std::move(indices) | bulk_reduce(0.0, std::plus<>{});
+  };
+
+  single_thread_context serial;
+  static_thread_pool pool;
+
+  auto serialSched = serial.get_scheduler();
+  auto poolSched = pool.get_scheduler();
+
+  run("serial sum", serialSched, elementCount, sum);
+  run("thread pool sum", poolSched, elementCount, sum);
+  run("serial sum of squares", serialSched, elementCount, sumOfSquares);
+  run("thread pool sum of squares", poolSched, elementCount, sumOfSquares);
+  run("thread pool sum of indices", poolSched, elementCount, sumOfIndices);
+  return 0;
+}
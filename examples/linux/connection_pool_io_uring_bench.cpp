@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: async_connect() and connection_pool on io_uring over loopback.
+//
+// Connect rate:
+//   Opens and closes connections to a loopback listener that accepts and
+//   immediately closes them, reporting connections per second.
+//
+// Request latency:
+//   Sends a small request to a loopback echo server and waits for the
+//   reply, either over a connection leased from a connection_pool or over
+//   a connection opened for the request, reporting p50/p99 latency.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+#  include <unifex/connection_pool.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/let_value.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+#  include <unifex/linux/socket_address.hpp>
+#  include <unifex/scope_guard.hpp>
+#  include <unifex/socket_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+
+#  include <algorithm>
+#  include <array>
+#  include <atomic>
+#  include <chrono>
+#  include <cstdio>
+#  include <thread>
+#  include <vector>
+
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+constexpr int connect_iterations = 2000;
+constexpr int request_iterations = 2000;
+constexpr std::size_t request_size = 64;
+
+// A blocking loopback server running on its own threads.
+class loopback_server {
+public:
+  explicit loopback_server(bool echo) : echo_(echo) {
+    fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t size = sizeof(addr);
+    if (::bind(fd_, (const sockaddr*)&addr, size) < 0 ||
+        ::listen(fd_, 1024) < 0 ||
+        ::getsockname(fd_, (sockaddr*)&addr, &size) < 0) {
+      throw std::system_error{errno, std::system_category(), "listen"};
+    }
+    port_ = ntohs(addr.sin_port);
+    acceptThread_ = std::thread{[this] {
+      accept_loop();
+    }};
+  }
+
+  ~loopback_server() {
+    ::shutdown(fd_, SHUT_RDWR);
+    acceptThread_.join();
+    for (auto& t : connectionThreads_) {
+      t.join();
+    }
+    ::close(fd_);
+  }
+
+  socket_address address() const {
+    return socket_address::ipv4_loopback(port_);
+  }
+
+private:
+  void accept_loop() {
+    while (true) {
+      int fd = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0) {
+        return;
+      }
+      if (!echo_) {
+        ::close(fd);
+        continue;
+      }
+      connectionThreads_.emplace_back([fd] {
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::array<char, request_size> buffer;
+        ssize_t n;
+        while ((n = ::read(fd, buffer.data(), buffer.size())) > 0) {
+          if (::write(fd, buffer.data(), n) != n) {
+            break;
+          }
+        }
+        ::close(fd);
+      });
+    }
+  }
+
+  bool echo_;
+  int fd_;
+  port_t port_;
+  std::thread acceptThread_;
+  std::vector<std::thread> connectionThreads_;
+};
+
+template <typename Connection>
+auto round_trip(
+    Connection& connection, std::array<char, request_size>& buffer) {
+  return let_value(
+      async_write_some_at(connection, 0, as_bytes(span{buffer})),
+      [&connection, &buffer](ssize_t) {
+        return async_read_some_at(
+            connection, 0, as_writable_bytes(span{buffer}));
+      });
+}
+
+void report_latency(
+    const char* name, std::vector<bench_clock::duration>& samples) {
+  std::sort(samples.begin(), samples.end());
+  auto us = [](bench_clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+  };
+  std::printf(
+      "%-28s p50 %8.1f us   p99 %8.1f us\n",
+      name,
+      us(samples[samples.size() / 2]),
+      us(samples[samples.size() * 99 / 100]));
+}
+}  // namespace
+
+int main() {
+  io_uring_context ctx;
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+  };
+  auto scheduler = ctx.get_scheduler();
+
+  {
+    loopback_server server{false};
+    auto address = server.address();
+    auto start = bench_clock::now();
+    for (int i = 0; i < connect_iterations; ++i) {
+      // The socket is closed as soon as the returned optional is destroyed.
+      (void)sync_wait(async_connect(scheduler, address));
+    }
+    auto elapsed = std::chrono::duration<double>(bench_clock::now() - start);
+    std::printf(
+        "%-28s %8.0f connections/s\n",
+        "async_connect",
+        connect_iterations / elapsed.count());
+  }
+
+  {
+    loopback_server server{true};
+    auto address = server.address();
+    std::array<char, request_size> buffer{};
+    std::vector<bench_clock::duration> samples;
+    samples.reserve(request_iterations);
+
+    for (int i = 0; i < request_iterations; ++i) {
+      auto start = bench_clock::now();
+      sync_wait(let_value(
+          async_connect(scheduler, address), [&](auto& connection) {
+            return round_trip(connection, buffer);
+          }));
+      samples.push_back(bench_clock::now() - start);
+    }
+    report_latency("connect-per-request", samples);
+
+    samples.clear();
+    connection_pool pool{scheduler, address, {4}};
+    for (int i = 0; i < request_iterations; ++i) {
+      auto start = bench_clock::now();
+      sync_wait(let_value(pool.acquire(), [&](auto& lease) {
+        return round_trip(*lease, buffer);
+      }));
+      samples.push_back(bench_clock::now() - start);
+    }
+    report_latency("pooled", samples);
+  }
+  return 0;
+}
+
+#else  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+#  include <cstdio>
+int main() {
+  std::printf("liburing support not found\n");
+}
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
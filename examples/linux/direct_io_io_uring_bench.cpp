@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: fio-style 4 KiB random reads through io_uring_context.
+//
+// Runs the same random-read workload at a fixed queue depth in three modes
+// and reports IOPS and p50/p99 completion latency for each:
+//
+//   buffered - file opened normally, reads served through the page cache.
+//   direct   - file opened with direct_io, interrupt-driven completions.
+//   polled   - file opened with direct_io on a context created with
+//              polledIo, completions reaped by polling the device.
+//
+// The test file is created in the directory named by the first argument,
+// or /var/tmp by default. Modes that the filesystem or device don't support
+// (eg. O_DIRECT on tmpfs, or polling on a device without poll queues) are
+// reported as skipped.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+#  include <unifex/async_scope.hpp>
+#  include <unifex/defer.hpp>
+#  include <unifex/file_concepts.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/io_concepts.hpp>
+#  include <unifex/linux/aligned_buffer_pool.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+#  include <unifex/repeat_effect_until.hpp>
+#  include <unifex/scope_guard.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+#  include <unifex/upon_error.hpp>
+
+#  include <algorithm>
+#  include <chrono>
+#  include <cstdio>
+#  include <optional>
+#  include <random>
+#  include <string>
+#  include <system_error>
+#  include <thread>
+#  include <vector>
+
+#  include <unistd.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+constexpr std::size_t block_size = 4096;
+constexpr std::size_t file_size = 32 * 1024 * 1024;
+constexpr std::size_t queue_depth = 16;
+constexpr std::size_t total_reads = 20000;
+
+enum class mode { buffered, direct, polled };
+
+const char* mode_name(mode m) {
+  switch (m) {
+    case mode::buffered: return "buffered";
+    case mode::direct: return "direct";
+    default: return "polled";
+  }
+}
+
+struct result {
+  std::vector<bench_clock::duration> latencies;
+  bench_clock::duration elapsed{};
+  int errorCode = 0;
+};
+
+// Keeps 'queue_depth' reads in flight until 'total_reads' have been issued.
+template <typename File>
+result run_workload(
+    io_uring_context::scheduler scheduler,
+    File& file,
+    aligned_buffer_pool& pool) {
+  result r;
+  r.latencies.reserve(total_reads);
+  std::size_t issued = 0;
+  std::mt19937_64 rng{42};
+  std::uniform_int_distribution<std::size_t> block{
+      0, file_size / block_size - 1};
+
+  std::vector<aligned_buffer_pool::buffer> buffers;
+  for (std::size_t i = 0; i < queue_depth; ++i) {
+    buffers.push_back(pool.try_acquire());
+  }
+
+  async_scope scope;
+  auto start = bench_clock::now();
+  for (auto& buffer : buffers) {
+    // All workers run on the I/O thread so the shared state needs no
+    // synchronisation.
+    scope.detached_spawn_on(
+        scheduler,
+        repeat_effect_until(
+            defer([&, span = buffer.data()] {
+              ++issued;
+              auto offset = std::int64_t(block(rng) * block_size);
+              return async_read_some_at(file, offset, span) |
+                  then([&, t0 = bench_clock::now()](ssize_t) {
+                       r.latencies.push_back(bench_clock::now() - t0);
+                     });
+            }),
+            [&] { return issued >= total_reads || r.errorCode != 0; }) |
+            upon_error([&](auto&& error) noexcept {
+              if constexpr (std::is_same_v<
+                                remove_cvref_t<decltype(error)>,
+                                std::error_code>) {
+                r.errorCode = error.value();
+              } else {
+                r.errorCode = EIO;
+              }
+            }));
+  }
+  sync_wait(scope.complete());
+  r.elapsed = bench_clock::now() - start;
+  return r;
+}
+
+void report(mode m, result& r) {
+  if (r.errorCode != 0) {
+    std::printf(
+        "%-10s skipped: %s\n",
+        mode_name(m),
+        std::system_category().message(r.errorCode).c_str());
+    return;
+  }
+  std::sort(r.latencies.begin(), r.latencies.end());
+  auto us = [](bench_clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+  };
+  std::printf(
+      "%-10s %9.0f IOPS   p50 %8.1f us   p99 %8.1f us\n",
+      mode_name(m),
+      r.latencies.size() / std::chrono::duration<double>(r.elapsed).count(),
+      us(r.latencies[r.latencies.size() / 2]),
+      us(r.latencies[r.latencies.size() * 99 / 100]));
+}
+
+void run_mode(mode m, const std::string& path) {
+  std::optional<io_uring_context> ctx;
+  try {
+    io_uring_context::options options;
+    options.polledIo = m == mode::polled;
+    ctx.emplace(options);
+  } catch (const std::system_error& e) {
+    std::printf("%-10s skipped: %s\n", mode_name(m), e.what());
+    return;
+  }
+
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx->run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+  };
+  auto scheduler = ctx->get_scheduler();
+  aligned_buffer_pool pool{block_size, queue_depth};
+
+  if (m == mode::buffered) {
+    auto file = open_file_read_only(scheduler, path);
+    auto r = run_workload(scheduler, file, pool);
+    report(m, r);
+    return;
+  }
+
+  std::optional<io_uring_context::async_read_only_file> file;
+  try {
+    file.emplace(open_file_read_only(scheduler, path, direct_io));
+  } catch (const std::system_error& e) {
+    std::printf("%-10s skipped: %s\n", mode_name(m), e.what());
+    return;
+  }
+  auto r = run_workload(scheduler, *file, pool);
+  report(m, r);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string path = argc > 1 ? argv[1] : "/var/tmp";
+  path += "/unifex_direct_io_bench_XXXXXX";
+  int fd = ::mkstemp(path.data());
+  if (fd < 0) {
+    std::perror("mkstemp");
+    return 1;
+  }
+  scope_guard removeFile = [&]() noexcept {
+    ::close(fd);
+    ::unlink(path.c_str());
+  };
+
+  std::vector<char> chunk(1024 * 1024, 'x');
+  for (std::size_t written = 0; written < file_size;
+       written += chunk.size()) {
+    if (::write(fd, chunk.data(), chunk.size()) != ssize_t(chunk.size())) {
+      std::perror("write");
+      return 1;
+    }
+  }
+  ::fsync(fd);
+
+  std::printf(
+      "4 KiB random reads, queue depth %zu, %zu reads\n",
+      queue_depth,
+      total_reads);
+  for (mode m : {mode::buffered, mode::direct, mode::polled}) {
+    run_mode(m, path);
+  }
+  return 0;
+}
+
+#else  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+#  include <cstdio>
+int main() {
+  std::printf("liburing support not found\n");
+}
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: cross-context ping-pong between two io_uring_contexts.
+//
+// A task bounces between the I/O threads of two contexts, rescheduling
+// itself onto the other context each hop. Each hop wakes the other
+// context's idle I/O thread either with an IORING_OP_MSG_RING submitted
+// from the current ring or by writing to the other context's eventfd,
+// depending on io_uring_context::options::msgRingWakeups.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/let_value.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+#  include <unifex/on.hpp>
+#  include <unifex/repeat_effect_until.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+
+#  include <chrono>
+#  include <cstdio>
+#  include <thread>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+constexpr int round_trips = 20000;
+
+struct running_context {
+  explicit running_context(const io_uring_context::options& options)
+    : context_(options) {}
+
+  ~running_context() {
+    stopSource_.request_stop();
+    thread_.join();
+  }
+
+  io_uring_context context_;
+  inplace_stop_source stopSource_;
+  std::thread thread_{[this] {
+    context_.run(stopSource_.get_token());
+  }};
+};
+
+void run(const char* name, bool msgRingWakeups) {
+  io_uring_context::options options;
+  options.msgRingWakeups = msgRingWakeups;
+  running_context ping{options};
+  running_context pong{options};
+  auto a = ping.context_.get_scheduler();
+  auto b = pong.context_.get_scheduler();
+
+  int count = 0;
+  auto start = bench_clock::now();
+  sync_wait(on(
+      a,
+      repeat_effect_until(
+          let_value(schedule(b), [a] { return schedule(a); }) |
+              then([&] { ++count; }),
+          [&] { return count == round_trips; })));
+  auto elapsed = std::chrono::duration<double>(bench_clock::now() - start);
+
+  std::printf(
+      "%-10s %9.0f round trips/s   %6.2f us/round trip\n",
+      name,
+      round_trips / elapsed.count(),
+      elapsed.count() * 1e6 / round_trips);
+}
+}  // namespace
+
+int main() {
+  run("eventfd", false);
+  run("msg_ring", true);
+  return 0;
+}
+
+#else  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+#  include <cstdio>
+int main() {
+  std::printf("liburing support not found\n");
+}
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: a sharded key-value echo server on loopback.
+//
+// Each connection is handed to a shard of a sharded_runtime, round robin.
+// Every request is a fixed-size (key, value) pair: a zero value reads the
+// key and any other value stores it. The connection's shard hops to the
+// shard that owns the key, which looks it up in a map allocated from its
+// shard-local memory resource, then hops back to write the key's value as
+// the reply. Blocking client threads check the replies and the request
+// rate is reported.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS && \
+    !UNIFEX_NO_MEMORY_RESOURCE
+#  include <unifex/async_scope.hpp>
+#  include <unifex/defer.hpp>
+#  include <unifex/io_concepts.hpp>
+#  include <unifex/just.hpp>
+#  include <unifex/just_from.hpp>
+#  include <unifex/let_value.hpp>
+#  include <unifex/let_value_with.hpp>
+#  include <unifex/linux/sharded_runtime.hpp>
+#  include <unifex/memory_resource.hpp>
+#  include <unifex/on.hpp>
+#  include <unifex/repeat_effect_until.hpp>
+#  include <unifex/span.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+#  include <unifex/upon_error.hpp>
+#  include <unifex/variant_sender.hpp>
+#  include <unifex/via.hpp>
+
+#  include <atomic>
+#  include <chrono>
+#  include <cstdint>
+#  include <cstdio>
+#  include <optional>
+#  include <random>
+#  include <system_error>
+#  include <thread>
+#  include <unordered_map>
+#  include <vector>
+
+#  include <csignal>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+constexpr std::size_t shard_count = 4;
+constexpr int client_count = 4;
+constexpr int requests_per_client = 5000;
+
+struct request {
+  std::uint64_t key;
+  std::uint64_t value;
+};
+
+class kv_server {
+public:
+  explicit kv_server(sharded_runtime& runtime)
+    : runtime_(runtime)
+    , stores_(runtime.shard_count()) {
+    // Each shard creates, and later destroys, its own map so that the map
+    // only ever allocates from that shard's memory resource.
+    for_each_shard([this](std::size_t shard) {
+      stores_[shard].emplace(&sharded_runtime::this_shard_memory_resource());
+    });
+  }
+
+  ~kv_server() {
+    for_each_shard([this](std::size_t shard) { stores_[shard].reset(); });
+  }
+
+  sharded_runtime& runtime() noexcept { return runtime_; }
+
+  // Runs on the key's shard.
+  std::uint64_t apply(const request& r) {
+    auto& store = *stores_[owner(r.key)];
+    if (r.value != 0) {
+      store[r.key] = r.value;
+      return r.value;
+    }
+    auto it = store.find(r.key);
+    return it == store.end() ? 0 : it->second;
+  }
+
+  std::size_t owner(std::uint64_t key) const noexcept {
+    return key % runtime_.shard_count();
+  }
+
+private:
+  template <typename Func>
+  void for_each_shard(Func func) {
+    for (std::size_t i = 0; i < runtime_.shard_count(); ++i) {
+      sync_wait(on(runtime_.shard_scheduler(i), just_from([&, i] {
+                     func(i);
+                   })));
+    }
+  }
+
+  using store =
+      std::pmr::unordered_map<std::uint64_t, std::uint64_t>;
+
+  sharded_runtime& runtime_;
+  std::vector<std::optional<store>> stores_;
+};
+
+struct connection {
+  connection(kv_server& server, std::size_t shard, int fd)
+    : server_(server)
+    , shard_(shard)
+    , file_(server.runtime().shard_context(shard), fd) {}
+
+  kv_server& server_;
+  std::size_t shard_;
+  io_uring_context::async_read_write_file file_;
+  request request_{};
+  std::uint64_t reply_ = 0;
+  std::size_t transferred_ = 0;
+  bool closed_ = false;
+};
+
+// Repeats a partial read or write until `size` bytes have been transferred
+// or the peer has closed the connection.
+template <typename TransferSome>
+auto transfer_all(connection& c, std::size_t size, TransferSome transferSome) {
+  return defer([&c, size, transferSome] {
+    c.transferred_ = 0;
+    return repeat_effect_until(
+        defer([&c, transferSome] {
+          return then(transferSome(c.transferred_), [&c](ssize_t n) {
+            c.closed_ = n == 0;
+            c.transferred_ += n;
+          });
+        }),
+        [&c, size] { return c.closed_ || c.transferred_ == size; });
+  });
+}
+
+auto read_request(connection& c) {
+  return transfer_all(c, sizeof(request), [&c](std::size_t done) {
+    auto bytes = as_writable_bytes(span{&c.request_, 1});
+    return async_read_some_at(
+        c.file_, 0, span{bytes.data() + done, bytes.size() - done});
+  });
+}
+
+auto write_reply(connection& c) {
+  return transfer_all(c, sizeof(c.reply_), [&c](std::size_t done) {
+    auto bytes = as_bytes(span{&c.reply_, 1});
+    return async_write_some_at(
+        c.file_, 0, span{bytes.data() + done, bytes.size() - done});
+  });
+}
+
+auto handle_request(connection& c) {
+  auto& runtime = c.server_.runtime();
+  auto owner = runtime.shard_scheduler(c.server_.owner(c.request_.key));
+  auto home = runtime.shard_scheduler(c.shard_);
+  return let_value(
+      via(on(owner,
+             just_from([&c] { c.reply_ = c.server_.apply(c.request_); })),
+          home),
+      [&c] { return write_reply(c); });
+}
+
+auto serve(kv_server& server, std::size_t shard, int fd) {
+  return let_value_with(
+      [&server, shard, fd] { return connection{server, shard, fd}; },
+      [](connection& c) {
+        return repeat_effect_until(
+            defer([&c] {
+              return let_value(
+                  read_request(c),
+                  [&c]() -> variant_sender<
+                             decltype(just()),
+                             decltype(handle_request(c))> {
+                    if (c.closed_) {
+                      return just();
+                    }
+                    return handle_request(c);
+                  });
+            }),
+            [&c] { return c.closed_; });
+      });
+}
+
+int listen_on_loopback(port_t& port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t size = sizeof(addr);
+  if (fd < 0 || ::bind(fd, (const sockaddr*)&addr, size) < 0 ||
+      ::listen(fd, 128) < 0 ||
+      ::getsockname(fd, (sockaddr*)&addr, &size) < 0) {
+    throw std::system_error{errno, std::system_category(), "listen"};
+  }
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+bool send_all(int fd, const void* data, std::size_t size) {
+  auto* p = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t n = ::write(fd, p, size);
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool receive_all(int fd, void* data, std::size_t size) {
+  auto* p = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t n = ::read(fd, p, size);
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+// Alternately stores a random value in one of the client's own keys and
+// reads back one of them, returning the number of wrong replies.
+int run_client(int id, port_t port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if (::connect(fd, (const sockaddr*)&addr, sizeof(addr)) < 0) {
+    ::close(fd);
+    return requests_per_client;
+  }
+  int one = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  std::mt19937_64 rng(id);
+  std::unordered_map<std::uint64_t, std::uint64_t> expected;
+  int errors = 0;
+  for (int i = 0; i < requests_per_client; ++i) {
+    request r{std::uint64_t(id) << 32 | (rng() % 1024), 0};
+    if (i % 2 == 0) {
+      r.value = rng() | 1;
+      expected[r.key] = r.value;
+    }
+    std::uint64_t reply;
+    if (!send_all(fd, &r, sizeof(r)) || !receive_all(fd, &reply, 8)) {
+      errors += requests_per_client - i;
+      break;
+    }
+    auto it = expected.find(r.key);
+    if (reply != (it == expected.end() ? 0 : it->second)) {
+      ++errors;
+    }
+  }
+  ::close(fd);
+  return errors;
+}
+}  // namespace
+
+int main() {
+  std::signal(SIGPIPE, SIG_IGN);
+
+  sharded_runtime::options options;
+  options.shardCount = shard_count;
+  sharded_runtime runtime{options};
+  kv_server server{runtime};
+
+  port_t port;
+  int listenFd = listen_on_loopback(port);
+
+  // Connections are accepted on a plain thread and handed to the shards
+  // round robin.
+  async_scope scope;
+  std::thread acceptor{[&] {
+    for (std::size_t next = 0;; ++next) {
+      int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0) {
+        return;
+      }
+      int one = 1;
+      ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      std::size_t shard = next % runtime.shard_count();
+      scope.detached_spawn_on(
+          runtime.shard_scheduler(shard),
+          serve(server, shard, fd) | upon_error([](auto&&) noexcept {}));
+    }
+  }};
+
+  std::atomic<int> errors{0};
+  auto start = bench_clock::now();
+  std::vector<std::thread> clients;
+  for (int i = 0; i < client_count; ++i) {
+    clients.emplace_back([&, i] { errors += run_client(i, port); });
+  }
+  for (auto& t : clients) {
+    t.join();
+  }
+  auto elapsed = std::chrono::duration<double>(bench_clock::now() - start);
+
+  ::shutdown(listenFd, SHUT_RDWR);
+  acceptor.join();
+  ::close(listenFd);
+  sync_wait(scope.complete());
+
+  const int total = client_count * requests_per_client;
+  std::printf(
+      "%zu shards, %d clients: %8.0f requests/s, %d wrong replies\n",
+      runtime.shard_count(),
+      client_count,
+      total / elapsed.count(),
+      errors.load());
+  return errors.load() == 0 ? 0 : 1;
+}
+
+#else  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS && ...
+#  include <cstdio>
+int main() {
+  std::printf("liburing support not found\n");
+}
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS && ...
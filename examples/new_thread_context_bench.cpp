@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: new_thread_context with and without thread caching.
+//
+//   sequential: schedule() one operation at a time, waiting for each.
+//   fan-out:    schedule() a batch of operations at once with when_all,
+//               so each needs its own thread at the same time.
+//
+// "uncached" passes maxCachedThreads = 0, which starts (and joins) a new
+// thread for every operation, as new_thread_context always used to.
+
+#include <unifex/new_thread_context.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/when_all.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+constexpr int sequential_ops = 2000;
+constexpr int fan_out_rounds = 250;
+constexpr int fan_out_width = 8;
+
+template <typename F>
+double us_per_op(int ops, F f) {
+  auto start = bench_clock::now();
+  f();
+  auto elapsed = bench_clock::now() - start;
+  return std::chrono::duration<double, std::micro>(elapsed).count() / ops;
+}
+
+void run(const char* name, std::size_t maxCachedThreads) {
+  new_thread_context ctx{maxCachedThreads};
+  auto s = ctx.get_scheduler();
+
+  double sequential = us_per_op(sequential_ops, [&] {
+    for (int i = 0; i < sequential_ops; ++i) {
+      sync_wait(schedule(s));
+    }
+  });
+
+  double fanOut = us_per_op(fan_out_rounds * fan_out_width, [&] {
+    for (int i = 0; i < fan_out_rounds; ++i) {
+      sync_wait(when_all(
+          schedule(s),
+          schedule(s),
+          schedule(s),
+          schedule(s),
+          schedule(s),
+          schedule(s),
+          schedule(s),
+          schedule(s)));
+    }
+  });
+
+  std::printf(
+      "%-10s sequential %8.2f us/op   fan-out %8.2f us/op\n",
+      name,
+      sequential,
+      fanOut);
+}
+}  // namespace
+
+int main() {
+  run("uncached", 0);
+  run("cached", new_thread_context::default_max_cached_threads);
+  return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: static_thread_pool priority lanes under a mixed workload.
+//
+// A fixed number of bulk loops keep the pool saturated with short CPU-bound
+// tasks while the main thread repeatedly schedules a latency-sensitive task
+// and measures how long it waits to start:
+//
+//   single lane:    bulk and latency-sensitive work share the normal lane.
+//   weighted lanes: bulk work in the low lane, latency-sensitive work in the
+//                   high lane, default lane weights.
+//   aging lanes:    as above, with strict priority and 5ms aging.
+
+#include <unifex/async_scope.hpp>
+#include <unifex/defer.hpp>
+#include <unifex/get_priority.hpp>
+#include <unifex/repeat_effect_until.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+constexpr int bulk_loops = 32;
+constexpr auto bulk_task_duration = std::chrono::microseconds(20);
+constexpr int samples = 400;
+
+void spin_for(bench_clock::duration d) {
+  auto end = bench_clock::now() + d;
+  while (bench_clock::now() < end) {
+  }
+}
+
+void run(
+    const char* name,
+    const static_thread_pool::options& options,
+    priority bulkPriority,
+    priority urgentPriority) {
+  static_thread_pool pool{options};
+  auto bulk = pool.get_scheduler(bulkPriority);
+  auto urgent = pool.get_scheduler(urgentPriority);
+
+  std::atomic<bool> stop{false};
+  async_scope scope;
+  for (int i = 0; i < bulk_loops; ++i) {
+    scope.detached_spawn(repeat_effect_until(
+        defer([&] {
+          return then(schedule(bulk), [] { spin_for(bulk_task_duration); });
+        }),
+        [&] { return stop.load(std::memory_order_relaxed); }));
+  }
+
+  std::vector<bench_clock::duration> waits;
+  waits.reserve(samples);
+  for (int i = 0; i < samples; ++i) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    auto start = bench_clock::now();
+    auto started = sync_wait(then(schedule(urgent), [] {
+      return bench_clock::now();
+    }));
+    waits.push_back(*started - start);
+  }
+
+  stop = true;
+  sync_wait(scope.complete());
+
+  std::sort(waits.begin(), waits.end());
+  auto us = [](bench_clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+  };
+  std::printf(
+      "%-16s p50 %8.1f us   p99 %8.1f us\n",
+      name,
+      us(waits[waits.size() / 2]),
+      us(waits[waits.size() * 99 / 100]));
+}
+}  // namespace
+
+int main() {
+  static_thread_pool::options options;
+  // A single worker, so that waits reflect queueing in the pool rather
+  // than the OS scheduling more workers than there are CPUs.
+  options.threadCount = 1;
+  run("single lane", options, priority::normal, priority::normal);
+  run("weighted lanes", options, priority::low, priority::high);
+
+  options.lanePolicy = static_thread_pool::options::lane_policy::aging;
+  options.agingThreshold = std::chrono::milliseconds(5);
+  run("aging lanes", options, priority::low, priority::high);
+  return 0;
+}
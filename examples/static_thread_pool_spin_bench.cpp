@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: static_thread_pool workers parking straight away vs spinning
+// before they park.
+//
+// The main thread schedules bursts of short tasks, waits for each burst to
+// finish and then pauses long enough for the workers to park. For several
+// burst sizes this reports context switches per task, which is what each
+// futex wait or wake of a worker turns into, and the wall time per task.
+// Context switches are counted with getrusage(), so this is Linux-only.
+
+#include <unifex/async_scope.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#if defined(__linux__)
+#  include <sys/resource.h>
+#endif
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+constexpr int tasks_per_run = 2048;
+constexpr auto task_duration = std::chrono::microseconds(2);
+constexpr auto pause_between_bursts = std::chrono::microseconds(200);
+
+long context_switches() {
+#if defined(__linux__)
+  rusage usage{};
+  ::getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_nvcsw + usage.ru_nivcsw;
+#else
+  return 0;
+#endif
+}
+
+void spin_for(bench_clock::duration d) {
+  auto end = bench_clock::now() + d;
+  while (bench_clock::now() < end) {
+  }
+}
+
+void run(const char* name, std::uint32_t spinCount, int burstSize) {
+  static_thread_pool::options options;
+  options.threadCount = 4;
+  options.spinCount = spinCount;
+  static_thread_pool pool{options};
+  auto tp = pool.get_scheduler();
+
+  bench_clock::duration busy{};
+  const long switchesBefore = context_switches();
+  for (int done = 0; done < tasks_per_run; done += burstSize) {
+    auto start = bench_clock::now();
+    async_scope scope;
+    for (int i = 0; i < burstSize; ++i) {
+      scope.detached_spawn(
+          then(schedule(tp), [] { spin_for(task_duration); }));
+    }
+    sync_wait(scope.complete());
+    busy += bench_clock::now() - start;
+    std::this_thread::sleep_for(pause_between_bursts);
+  }
+  const long switches = context_switches() - switchesBefore;
+
+  std::printf(
+      "%-8s burst %4d   %6.2f switches/task   %7.2f us/task\n",
+      name,
+      burstSize,
+      double(switches) / tasks_per_run,
+      std::chrono::duration<double, std::micro>(busy).count() /
+          tasks_per_run);
+}
+}  // namespace
+
+int main() {
+  for (int burstSize : {1, 8, 64, 512}) {
+    run("park", 0, burstSize);
+    run("spin", static_thread_pool::options{}.spinCount, burstSize);
+  }
+  return 0;
+}
@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/await_transform.hpp>
+#include <unifex/coroutine.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_traits.hpp>
+#include <unifex/unhandled_done.hpp>
+
+#if UNIFEX_NO_COROUTINES
+#  error "Coroutine support is required to use this header"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _async_gen {
+
+// Allocates coroutine frames with an allocator passed to the coroutine as
+// std::allocator_arg, alloc. The allocator and a pointer to the function
+// that frees the frame are stored after the frame, so operator delete
+// doesn't need to know which allocator was used.
+struct _frame_allocator {
+  using deallocate_fn = void(void*, std::size_t) noexcept;
+
+  struct alignas(alignof(std::max_align_t)) block {
+    unsigned char data[alignof(std::max_align_t)];
+  };
+
+  template <typename Alloc>
+  using block_allocator =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<block>;
+
+  static constexpr std::size_t
+  round_up(std::size_t n, std::size_t alignment) noexcept {
+    return (n + alignment - 1) & ~(alignment - 1);
+  }
+
+  static constexpr std::size_t fn_offset(std::size_t size) noexcept {
+    return round_up(size, alignof(deallocate_fn*));
+  }
+
+  template <typename Alloc>
+  static constexpr std::size_t alloc_offset(std::size_t size) noexcept {
+    return round_up(
+        fn_offset(size) + sizeof(deallocate_fn*),
+        alignof(block_allocator<Alloc>));
+  }
+
+  template <typename Alloc>
+  static constexpr std::size_t block_count(std::size_t size) noexcept {
+    return round_up(
+               alloc_offset<Alloc>(size) + sizeof(block_allocator<Alloc>),
+               sizeof(block)) /
+        sizeof(block);
+  }
+
+  template <typename Alloc>
+  static void* allocate(std::size_t size, const Alloc& alloc) {
+    block_allocator<Alloc> blockAlloc{alloc};
+    auto* p = reinterpret_cast<unsigned char*>(
+        std::allocator_traits<block_allocator<Alloc>>::allocate(
+            blockAlloc, block_count<Alloc>(size)));
+    ::new (static_cast<void*>(p + fn_offset(size)))
+        deallocate_fn*(&deallocate<Alloc>);
+    ::new (static_cast<void*>(p + alloc_offset<Alloc>(size)))
+        block_allocator<Alloc>(std::move(blockAlloc));
+    return p;
+  }
+
+  template <typename Alloc>
+  static void deallocate(void* frame, std::size_t size) noexcept {
+    auto* p = static_cast<unsigned char*>(frame);
+    auto& stored = *std::launder(reinterpret_cast<block_allocator<Alloc>*>(
+        p + alloc_offset<Alloc>(size)));
+    block_allocator<Alloc> blockAlloc{std::move(stored)};
+    stored.~block_allocator<Alloc>();
+    std::allocator_traits<block_allocator<Alloc>>::deallocate(
+        blockAlloc, reinterpret_cast<block*>(p), block_count<Alloc>(size));
+  }
+
+  static void free(void* frame, std::size_t size) noexcept {
+    auto* p = static_cast<unsigned char*>(frame);
+    (*std::launder(reinterpret_cast<deallocate_fn**>(p + fn_offset(size))))(
+        frame, size);
+  }
+};
+
+// The pending next() that the generator delivers its next element, error
+// or end to.
+struct _consumer {
+  void (*deliver_)(_consumer*) noexcept;
+};
+
+enum class _handoff { idle, in_start, ready };
+
+template <typename T>
+struct _promise {
+  class type;
+};
+
+template <typename T>
+struct _gen {
+  class type;
+};
+
+template <typename T>
+class _promise<T>::type {
+public:
+  using value_type = remove_cvref_t<T>;
+  enum class result_kind { value, error, done };
+
+  static void* operator new(std::size_t size) {
+    return _frame_allocator::allocate(size, std::allocator<std::byte>{});
+  }
+
+  template <typename Alloc, typename... Args>
+  static void* operator new(
+      std::size_t size, std::allocator_arg_t, const Alloc& alloc, Args&...) {
+    return _frame_allocator::allocate(size, alloc);
+  }
+
+  // For member functions, whose first argument is the object.
+  template <typename Class, typename Alloc, typename... Args>
+  static void* operator new(
+      std::size_t size,
+      Class&,
+      std::allocator_arg_t,
+      const Alloc& alloc,
+      Args&...) {
+    return _frame_allocator::allocate(size, alloc);
+  }
+
+  // Coroutine frames are always freed with the usual operator delete, so
+  // there are no placement forms to match the overloads above.
+  static void operator delete(void* frame, std::size_t size) noexcept {
+    _frame_allocator::free(frame, size);
+  }
+
+  type()
+    : doneCoro_(unifex::unhandled_done([this]() noexcept {
+      result_ = result_kind::done;
+      finish();
+    })) {}
+
+  typename _gen<T>::type get_return_object() noexcept {
+    return typename _gen<T>::type{
+        coro::coroutine_handle<type>::from_promise(*this)};
+  }
+
+  coro::suspend_always initial_suspend() noexcept { return {}; }
+
+  auto final_suspend() noexcept {
+    struct awaiter {
+      bool await_ready() noexcept { return false; }
+      void await_suspend(coro::coroutine_handle<type> h) noexcept {
+        auto& p = h.promise();
+        if (p.result_ != result_kind::error) {
+          p.result_ = result_kind::done;
+        }
+        p.finish();
+      }
+      void await_resume() noexcept {}
+    };
+    return awaiter{};
+  }
+
+  void unhandled_exception() noexcept {
+    error_ = std::current_exception();
+    result_ = result_kind::error;
+  }
+
+  void return_void() noexcept {}
+
+  // A co_await'ed sender completed with done, which ends the stream.
+  coro::coroutine_handle<> unhandled_done() noexcept {
+    return doneCoro_.handle();
+  }
+
+  auto yield_value(value_type&& value) noexcept {
+    value_ = std::addressof(value);
+    return yield_awaiter{};
+  }
+
+  auto yield_value(const value_type& value) noexcept(
+      std::is_nothrow_copy_constructible_v<value_type>) {
+    copy_.emplace(value);
+    value_ = std::addressof(*copy_);
+    return yield_awaiter{};
+  }
+
+  template <typename Value>
+  decltype(auto) await_transform(Value&& value) {
+    return unifex::await_transform(*this, (Value &&) value);
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& p) noexcept {
+    return p.stopSource_.get_token();
+  }
+
+private:
+  friend typename _gen<T>::type;
+  template <typename, typename>
+  friend struct _next_op;
+
+  struct yield_awaiter {
+    bool await_ready() noexcept { return false; }
+    void await_suspend(coro::coroutine_handle<type> h) noexcept {
+      auto& p = h.promise();
+      p.result_ = result_kind::value;
+      p.hand_off();
+    }
+    void await_resume() noexcept {}
+  };
+
+  void finish() noexcept {
+    finished_ = true;
+    hand_off();
+  }
+
+  // Hands the result to the pending next(). If the coroutine was resumed
+  // from next()'s start() and hasn't returned to it yet, start() delivers
+  // the result once resume() returns, which keeps synchronous generators
+  // from growing the stack by one frame per element.
+  void hand_off() noexcept {
+    if (handoff_.exchange(_handoff::ready, std::memory_order_acq_rel) ==
+        _handoff::idle) {
+      handoff_.store(_handoff::idle, std::memory_order_relaxed);
+      consumer_->deliver_(consumer_);
+    }
+  }
+
+  // Resumes the coroutine on behalf of next() and delivers its result if
+  // it produced one before suspending.
+  void resume_from(coro::coroutine_handle<type> h, _consumer* c) noexcept {
+    consumer_ = c;
+    handoff_.store(_handoff::in_start, std::memory_order_relaxed);
+    h.resume();
+    if (handoff_.exchange(_handoff::idle, std::memory_order_acq_rel) ==
+        _handoff::ready) {
+      c->deliver_(c);
+    }
+  }
+
+  value_type* value_ = nullptr;
+  std::optional<value_type> copy_;
+  std::exception_ptr error_;
+  result_kind result_ = result_kind::done;
+  bool finished_ = false;
+  _consumer* consumer_ = nullptr;
+  std::atomic<_handoff> handoff_{_handoff::idle};
+  mutable inplace_stop_source stopSource_;
+  done_coro doneCoro_;
+};
+
+template <typename T, typename Receiver>
+struct _next_op {
+  class type;
+};
+
+template <typename T, typename Receiver>
+using next_operation =
+    typename _next_op<T, remove_cvref_t<Receiver>>::type;
+
+template <typename T, typename Receiver>
+class _next_op<T, Receiver>::type : private _consumer {
+  using promise_t = typename _promise<T>::type;
+  using result_kind = typename promise_t::result_kind;
+
+  struct cancel_callback {
+    promise_t* promise_;
+    void operator()() noexcept { promise_->stopSource_.request_stop(); }
+  };
+
+public:
+  template <typename Receiver2>
+  explicit type(
+      coro::coroutine_handle<promise_t> coro,
+      Receiver2&& receiver) noexcept(std::
+                                         is_nothrow_constructible_v<
+                                             Receiver,
+                                             Receiver2>)
+    : _consumer{&deliver}
+    , coro_(coro)
+    , receiver_((Receiver2 &&) receiver) {}
+
+  type(type&&) = delete;
+
+  void start() & noexcept {
+    if (!coro_ || coro_.promise().finished_) {
+      unifex::set_done(std::move(receiver_));
+      return;
+    }
+    auto& p = coro_.promise();
+    stopCallback_.construct(get_stop_token(receiver_), cancel_callback{&p});
+    p.resume_from(coro_, this);
+  }
+
+private:
+  static void deliver(_consumer* c) noexcept {
+    auto& self = *static_cast<type*>(c);
+    auto& p = self.coro_.promise();
+    self.stopCallback_.destruct();
+    switch (p.result_) {
+      case result_kind::value:
+        if constexpr (is_nothrow_receiver_of_v<
+                          Receiver,
+                          typename promise_t::value_type>) {
+          unifex::set_value(std::move(self.receiver_), std::move(*p.value_));
+        } else {
+          UNIFEX_TRY {
+            unifex::set_value(
+                std::move(self.receiver_), std::move(*p.value_));
+          }
+          UNIFEX_CATCH(...) {
+            unifex::set_error(
+                std::move(self.receiver_), std::current_exception());
+          }
+        }
+        break;
+      case result_kind::error:
+        // Later calls to next() complete with done.
+        p.result_ = result_kind::done;
+        unifex::set_error(std::move(self.receiver_), std::move(p.error_));
+        break;
+      default:
+        unifex::set_done(std::move(self.receiver_));
+        break;
+    }
+  }
+
+  coro::coroutine_handle<promise_t> coro_;
+  Receiver receiver_;
+  manual_lifetime<typename stop_token_type_t<
+      Receiver&>::template callback_type<cancel_callback>>
+      stopCallback_;
+};
+
+template <typename T>
+struct _next_sender {
+  class type;
+};
+
+template <typename T>
+class _next_sender<T>::type {
+  using promise_t = typename _promise<T>::type;
+
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<typename promise_t::value_type>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit type(coro::coroutine_handle<promise_t> coro) noexcept
+    : coro_(coro) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      next_operation<T, Receiver> connect(Receiver&& r) const noexcept(
+          std::is_nothrow_constructible_v<remove_cvref_t<Receiver>, Receiver>) {
+    return next_operation<T, Receiver>{coro_, (Receiver &&) r};
+  }
+
+private:
+  coro::coroutine_handle<promise_t> coro_;
+};
+
+template <typename T>
+struct _cleanup_sender {
+  class type;
+};
+
+template <typename T>
+class _cleanup_sender<T>::type {
+  using gen_t = typename _gen<T>::type;
+
+  template <typename Receiver>
+  struct operation {
+    gen_t* gen_;
+    Receiver receiver_;
+
+    // Destroys the coroutine frame, running the destructors of its locals,
+    // and completes with done like other streams' cleanup().
+    void start() & noexcept {
+      gen_->destroy();
+      unifex::set_done(std::move(receiver_));
+    }
+  };
+
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<>;
+
+  static constexpr bool sends_done = true;
+
+  explicit type(gen_t* gen) noexcept : gen_(gen) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      operation<remove_cvref_t<Receiver>> connect(Receiver&& r) const
+      noexcept(
+          std::is_nothrow_constructible_v<remove_cvref_t<Receiver>, Receiver>) {
+    return operation<remove_cvref_t<Receiver>>{gen_, (Receiver &&) r};
+  }
+
+private:
+  gen_t* gen_;
+};
+
+template <typename T>
+class _gen<T>::type {
+public:
+  using promise_type = typename _promise<T>::type;
+
+  explicit type(coro::coroutine_handle<promise_type> coro) noexcept
+    : coro_(coro) {}
+
+  type(type&& other) noexcept : coro_(std::exchange(other.coro_, {})) {}
+
+  type& operator=(type other) noexcept {
+    std::swap(coro_, other.coro_);
+    return *this;
+  }
+
+  ~type() { destroy(); }
+
+  friend typename _next_sender<T>::type
+  tag_invoke(tag_t<next>, type& g) noexcept {
+    return typename _next_sender<T>::type{g.coro_};
+  }
+
+  friend typename _cleanup_sender<T>::type
+  tag_invoke(tag_t<cleanup>, type& g) noexcept {
+    return typename _cleanup_sender<T>::type{&g};
+  }
+
+private:
+  friend typename _cleanup_sender<T>::type;
+
+  void destroy() noexcept {
+    if (coro_) {
+      std::exchange(coro_, {}).destroy();
+    }
+  }
+
+  coro::coroutine_handle<promise_type> coro_;
+};
+}  // namespace _async_gen
+
+// A coroutine that produces a stream: each co_yield produces one element,
+// and co_await works on senders and awaitables as it does in a task<>.
+//
+// The coroutine starts when next() is first called and runs until its next
+// co_yield, co_return or unhandled exception. A sender that completes with
+// done in a co_await ends the stream, and a stop request on a pending
+// next() is forwarded to whatever the coroutine is awaiting. cleanup()
+// destroys the coroutine frame. Unlike task<>, the coroutine isn't resumed
+// on a particular scheduler after a co_await.
+//
+// The frame is allocated with the allocator passed as
+// (std::allocator_arg, alloc) at the start of the coroutine's parameters,
+// or after the object parameter of a member function. GCC 12 reports the
+// frame's deallocation as -Wmismatched-new-delete in that case, as it does
+// for any template operator new in a promise type (GCC bug 109224).
+template <typename T>
+using async_generator = typename _async_gen::_gen<T>::type;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/bind_back.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <unifex/detail/stream_pump.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _batch_stream {
+
+template <typename Stream, typename Scheduler, typename Duration>
+struct _state {
+  class type;
+};
+template <typename Stream, typename Scheduler, typename Duration>
+using state = typename _state<Stream, Scheduler, Duration>::type;
+
+template <typename State>
+struct _timer_receiver {
+  class type;
+};
+template <typename State>
+using timer_receiver = typename _timer_receiver<State>::type;
+
+template <typename State>
+class _timer_receiver<State>::type {
+public:
+  explicit type(State* state) noexcept : state_(state) {}
+
+  void set_value() noexcept { state_->on_timer(true); }
+
+  template <typename Error>
+  void set_error(Error&& error) noexcept {
+    state_->on_timer_error((Error &&) error);
+  }
+
+  void set_done() noexcept { state_->on_timer(false); }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.get_stop_token();
+  }
+
+private:
+  inplace_stop_token get_stop_token() const noexcept {
+    return state_->timerStopSource_.get().get_token();
+  }
+
+  State* state_;
+};
+
+template <typename Stream, typename Scheduler, typename Duration>
+struct _traits {
+  using value_t = _stream_pump::value_t<Stream>;
+  using batch_t = std::vector<value_t>;
+
+  using timer_sender_t = decltype(schedule_after(
+      UNIFEX_DECLVAL(Scheduler&), UNIFEX_DECLVAL(const Duration&)));
+
+  using errors = concat_type_lists_unique_t<
+      _stream_pump::next_errors_t<Stream>,
+      sender_error_types_t<timer_sender_t, type_list>>;
+};
+
+template <typename Stream, typename Scheduler, typename Duration>
+using state_base = _stream_pump::state_base<
+    state<Stream, Scheduler, Duration>,
+    type_list<typename _traits<Stream, Scheduler, Duration>::batch_t>,
+    typename _traits<Stream, Scheduler, Duration>::errors,
+    _stream_pump::cleanup_errors_t<Stream>>;
+
+// The shared state of a batch_stream(). The pumping thread, see
+// _stream_pump::state_base, pulls the next element and starts or cancels
+// the flush timer.
+//
+// Elements are only pulled while a next() is pending. The flush timer for
+// a batch starts when its first element arrives, so a batch is emitted at
+// most maxDelay after its first element, or as soon as it's full.
+template <typename Stream, typename Scheduler, typename Duration>
+class _state<Stream, Scheduler, Duration>::type
+  : public state_base<Stream, Scheduler, Duration> {
+  using base = state_base<Stream, Scheduler, Duration>;
+  using traits = _traits<Stream, Scheduler, Duration>;
+  using source_t = _stream_pump::source<type, Stream>;
+
+public:
+  using batch_t = typename traits::batch_t;
+  using outcome_t = typename base::outcome_t;
+
+  template <typename Stream2, typename Scheduler2, typename Duration2>
+  explicit type(
+      Stream2&& stream,
+      std::size_t maxCount,
+      Duration2&& maxDelay,
+      Scheduler2&& scheduler)
+    : source_(_stream_pump::source_init<type, Stream2>{
+          this, 0, (Stream2 &&) stream})
+    , scheduler_((Scheduler2 &&) scheduler)
+    , maxDelay_((Duration2 &&) maxDelay)
+    , maxCount_(std::max<std::size_t>(maxCount, 1)) {
+    batch_.reserve(maxCount_);
+  }
+
+  ~type() {
+    if (timerConstructed_) {
+      timerOp_.destruct();
+      timerStopSource_.destruct();
+    }
+  }
+
+private:
+  friend base;
+  friend source_t;
+  friend _stream_pump::next_receiver<source_t>;
+  friend timer_receiver<type>;
+
+  using timer_op_t =
+      connect_result_t<typename traits::timer_sender_t, timer_receiver<type>>;
+
+  bool step(std::unique_lock<std::mutex>& lk) noexcept {
+    // Cancel a timer whose batch has already been emitted, or any timer
+    // once we're stopping.
+    if (timerActive_ && !timerCancelled_ &&
+        (this->stopping_ || timerBatch_ != batchIndex_)) {
+      timerCancelled_ = true;
+      lk.unlock();
+      timerStopSource_.get().request_stop();
+      lk.lock();
+      return true;
+    }
+
+    if (!timerActive_ && !this->stopping_ && !batch_.empty() &&
+        timerBatch_ != batchIndex_) {
+      timerActive_ = true;
+      timerCancelled_ = false;
+      timerBatch_ = batchIndex_;
+      lk.unlock();
+      start_timer();
+      lk.lock();
+      return true;
+    }
+
+    if (this->waiter_pending() && !source_.active_ && !source_.ended_ &&
+        !this->stopping_ && !this->error_ && batch_.size() < maxCount_) {
+      source_.active_ = true;
+      lk.unlock();
+      source_.start_next();
+      lk.lock();
+      return true;
+    }
+    return false;
+  }
+
+  bool idle() const noexcept { return !source_.active_ && !timerActive_; }
+
+  template <typename F>
+  void for_each_source(F&& f) {
+    f(source_);
+  }
+
+  static constexpr std::size_t source_count() noexcept { return 1; }
+
+  // The result for a pending next(), if there is one yet. A batch that
+  // isn't full yet is emitted once its timer expires or ahead of the end
+  // of the source or an error.
+  std::optional<outcome_t> take_outcome() noexcept {
+    if (this->finished_ || this->stopping_) {
+      this->finished_ = true;
+      return outcome_t{std::in_place_index<0>};
+    }
+    if (!batch_.empty() &&
+        (batch_.size() >= maxCount_ || expired_ || source_.ended_ ||
+         this->error_)) {
+      expired_ = false;
+      ++batchIndex_;
+      UNIFEX_TRY {
+        batch_t next;
+        next.reserve(maxCount_);
+        return outcome_t{
+            std::in_place_index<1>, std::exchange(batch_, std::move(next))};
+      }
+      UNIFEX_CATCH(...) {
+        this->finished_ = true;
+        return outcome_t{
+            std::in_place_index<2>,
+            std::in_place_type<std::exception_ptr>,
+            std::current_exception()};
+      }
+    }
+    if (this->error_) {
+      this->finished_ = true;
+      outcome_t outcome{std::in_place_index<2>, std::move(*this->error_)};
+      this->error_.reset();
+      return outcome;
+    }
+    if (source_.ended_) {
+      this->finished_ = true;
+      return outcome_t{std::in_place_index<0>};
+    }
+    return std::nullopt;
+  }
+
+  // Only called by the pumping thread.
+  void start_timer() noexcept {
+    if (timerConstructed_) {
+      timerConstructed_ = false;
+      timerOp_.destruct();
+      timerStopSource_.destruct();
+    }
+    timerStopSource_.construct();
+    UNIFEX_TRY {
+      timerOp_.construct_with([&] {
+        return unifex::connect(
+            schedule_after(scheduler_, std::as_const(maxDelay_)),
+            timer_receiver<type>{this});
+      });
+      timerConstructed_ = true;
+    }
+    UNIFEX_CATCH(...) {
+      timerStopSource_.destruct();
+      on_timer_error(std::current_exception());
+      return;
+    }
+    unifex::start(timerOp_.get());
+  }
+
+  template <typename... Values>
+  void on_value(source_t& s, Values&&... values) noexcept {
+    std::unique_lock lk{this->mutex_};
+    s.active_ = false;
+    UNIFEX_TRY {
+      // Doesn't allocate, as the batch has room for maxCount_ elements.
+      batch_.emplace_back((Values &&) values...);
+    }
+    UNIFEX_CATCH(...) {
+      s.ended_ = true;
+      this->record_error(std::current_exception());
+    }
+    this->pump_if_idle(lk);
+  }
+
+  template <typename Error>
+  void on_error(source_t& s, Error&& error) noexcept {
+    std::unique_lock lk{this->mutex_};
+    s.active_ = false;
+    s.ended_ = true;
+    this->record_error((Error &&) error);
+    this->pump_if_idle(lk);
+  }
+
+  void on_end(source_t& s) noexcept {
+    std::unique_lock lk{this->mutex_};
+    s.active_ = false;
+    s.ended_ = true;
+    this->pump_if_idle(lk);
+  }
+
+  void on_timer(bool expired) noexcept {
+    std::unique_lock lk{this->mutex_};
+    timerActive_ = false;
+    if (expired && !timerCancelled_ && timerBatch_ == batchIndex_) {
+      expired_ = true;
+    }
+    this->pump_if_idle(lk);
+  }
+
+  template <typename Error>
+  void on_timer_error(Error&& error) noexcept {
+    std::unique_lock lk{this->mutex_};
+    timerActive_ = false;
+    this->record_error((Error &&) error);
+    this->pump_if_idle(lk);
+  }
+
+  source_t source_;
+  Scheduler scheduler_;
+  Duration maxDelay_;
+  const std::size_t maxCount_;
+
+  // The timer is only started, cancelled and destroyed by the pumping
+  // thread. timerBatch_ is the index of the batch it was started for.
+  bool timerActive_ = false;
+  bool timerCancelled_ = false;
+  bool timerConstructed_ = false;
+  bool expired_ = false;
+  std::size_t timerBatch_ = static_cast<std::size_t>(-1);
+  manual_lifetime<timer_op_t> timerOp_;
+  manual_lifetime<inplace_stop_source> timerStopSource_;
+
+  batch_t batch_;
+  std::size_t batchIndex_ = 0;
+};
+
+template <typename Stream, typename Scheduler, typename Duration>
+using stream = _stream_pump::stream<state<
+    remove_cvref_t<Stream>,
+    remove_cvref_t<Scheduler>,
+    remove_cvref_t<Duration>>>;
+
+inline const struct _fn {
+  template(typename Stream, typename Duration, typename Scheduler)  //
+      (requires unifex::sender<next_sender_t<remove_cvref_t<Stream>>> AND
+           scheduler<remove_cvref_t<Scheduler>>)                   //
+      stream<Stream, Scheduler, Duration>
+      operator()(
+          Stream&& s,
+          std::size_t maxCount,
+          Duration&& maxDelay,
+          Scheduler&& scheduler) const {
+    using state_t = state<
+        remove_cvref_t<Stream>,
+        remove_cvref_t<Scheduler>,
+        remove_cvref_t<Duration>>;
+    return stream<Stream, Scheduler, Duration>{std::make_unique<state_t>(
+        (Stream &&) s,
+        maxCount,
+        (Duration &&) maxDelay,
+        (Scheduler &&) scheduler)};
+  }
+
+  template(typename Duration, typename Scheduler)    //
+      (requires scheduler<remove_cvref_t<Scheduler>>)  //
+      constexpr auto
+      operator()(
+          std::size_t maxCount,
+          Duration&& maxDelay,
+          Scheduler&& scheduler) const
+      noexcept(std::is_nothrow_invocable_v<
+               tag_t<bind_back>,
+               _fn,
+               std::size_t,
+               Duration,
+               Scheduler>)
+          -> bind_back_result_t<_fn, std::size_t, Duration, Scheduler> {
+    return bind_back(
+        *this, maxCount, (Duration &&) maxDelay, (Scheduler &&) scheduler);
+  }
+} batch_stream{};
+}  // namespace _batch_stream
+
+// Groups the elements of a stream into std::vector batches of up to
+// maxCount elements.
+//
+// A batch is emitted once it's full or, if the consumer is waiting for it,
+// maxDelay after its first element arrived, measured with the given time
+// scheduler's schedule_after(). Each batch reserves room for maxCount
+// elements up front, so adding an element to it never allocates.
+using _batch_stream::batch_stream;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
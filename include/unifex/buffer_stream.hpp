@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/bind_back.hpp>
+#include <unifex/just.hpp>
+#include <unifex/transform_stream_async.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <cstddef>
+#include <type_traits>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _buffer_stream {
+struct _forward_fn {
+  template <typename Value>
+  auto operator()(Value&& value) const {
+    if constexpr (std::is_same_v<remove_cvref_t<Value>, unit>) {
+      return just();
+    } else {
+      return just((Value &&) value);
+    }
+  }
+};
+
+struct _fn {
+  template <typename Stream>
+  auto operator()(Stream&& stream, std::size_t count) const {
+    return transform_stream_async(
+        (Stream &&) stream, _forward_fn{}, count, transform_order::input);
+  }
+
+  constexpr auto operator()(std::size_t count) const
+      noexcept(std::is_nothrow_invocable_v<tag_t<bind_back>, _fn, std::size_t>)
+          -> bind_back_result_t<_fn, std::size_t> {
+    return bind_back(*this, count);
+  }
+};
+}  // namespace _buffer_stream
+
+// Reads up to count elements of the stream ahead of the consumer.
+//
+// Once next() has been called, elements are pulled from the stream one
+// after another into a buffer of up to count elements, whether or not the
+// consumer is ready for them.
+inline constexpr _buffer_stream::_fn buffer_stream{};
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/bind_back.hpp>
+#include <unifex/bulk_transform.hpp>
+#include <unifex/execution_policy.hpp>
+#include <unifex/get_execution_policy.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/type_list.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+
+namespace _bulk_reduce {
+
+// The partial accumulator that the calling thread last claimed, and the
+// operation it was claimed from.
+struct partial_cache {
+  std::uint64_t opId = 0;
+  void* partial = nullptr;
+};
+
+inline partial_cache& current_partial_cache() noexcept {
+  static thread_local partial_cache cache;
+  return cache;
+}
+
+inline std::uint64_t next_operation_id() noexcept {
+  static std::atomic<std::uint64_t> nextId{1};
+  return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Threads beyond this many share a single accumulator under a mutex.
+inline std::size_t max_partials() noexcept {
+  static const std::size_t maxPartials = std::max<std::size_t>(
+      64, 2 * std::size_t(std::thread::hardware_concurrency()));
+  return maxPartials;
+}
+
+template <typename Source, typename T, typename Op, typename Receiver>
+struct _op {
+  class type;
+};
+template <typename Source, typename T, typename Op, typename Receiver>
+using operation =
+    typename _op<Source, T, Op, remove_cvref_t<Receiver>>::type;
+
+template <typename Source, typename T, typename Op, typename Receiver>
+struct _reduce_receiver {
+  class type;
+};
+template <typename Source, typename T, typename Op, typename Receiver>
+using reduce_receiver =
+    typename _reduce_receiver<Source, T, Op, Receiver>::type;
+
+template <typename Source, typename T, typename Op, typename Receiver>
+class _reduce_receiver<Source, T, Op, Receiver>::type {
+  using op_t = operation<Source, T, Op, Receiver>;
+
+public:
+  explicit type(op_t* op) noexcept : op_(op) {}
+
+  template <typename Value>
+  void set_next(Value&& value) & noexcept(
+      std::is_nothrow_invocable_v<Op&, T, Value> &&
+      std::is_nothrow_constructible_v<T, Value> &&
+      std::is_nothrow_move_assignable_v<T>) {
+    op_->accumulate((Value &&) value);
+  }
+
+  void set_value() noexcept { op_->complete(); }
+
+  template(typename Error)                  //
+      (requires receiver<Receiver, Error>)  //
+      void set_error(Error&& error) noexcept {
+    unifex::set_error(std::move(op_->receiver_), (Error &&) error);
+  }
+
+  void set_done() noexcept { unifex::set_done(std::move(op_->receiver_)); }
+
+  // Each thread accumulates into its own partial, so set_next() can be
+  // called concurrently from several threads but not interleaved on one.
+  friend constexpr parallel_policy
+  tag_invoke(tag_t<get_execution_policy>, const type&) noexcept {
+    return {};
+  }
+
+  template(typename CPO, typename Self)  //
+      (requires is_receiver_query_cpo_v<CPO> AND same_as<
+          Self,
+          type>)  //
+      friend auto tag_invoke(CPO cpo, const Self& self) noexcept(
+          std::is_nothrow_invocable_v<CPO, const Receiver&>)
+          -> std::invoke_result_t<CPO, const Receiver&> {
+    return cpo(self.get_receiver());
+  }
+
+private:
+  const Receiver& get_receiver() const noexcept { return op_->receiver_; }
+
+  op_t* op_;
+};
+
+template <typename Source, typename T, typename Op, typename Receiver>
+class _op<Source, T, Op, Receiver>::type {
+  using receiver_t = reduce_receiver<Source, T, Op, Receiver>;
+  friend receiver_t;
+
+  // Padded to a cache line so that threads don't falsely share their
+  // accumulators.
+  struct alignas(64) partial {
+    std::optional<T> value_;
+  };
+
+public:
+  template <typename Source2, typename Op2, typename Receiver2>
+  explicit type(Source2&& source, T init, Op2&& op, Receiver2&& receiver)
+    : init_(std::move(init))
+    , op_((Op2 &&) op)
+    , receiver_((Receiver2 &&) receiver)
+    , partials_(std::make_unique<partial[]>(partialCount_))
+    , sourceOp_(
+          unifex::connect((Source2 &&) source, receiver_t{this})) {}
+
+  type(type&&) = delete;
+
+  void start() & noexcept { unifex::start(sourceOp_); }
+
+private:
+  template <typename Value>
+  void accumulate(Value&& value) {
+    if (partial* p = local_partial()) {
+      add(p->value_, (Value &&) value);
+    } else {
+      std::lock_guard lk{overflowMutex_};
+      add(overflow_, (Value &&) value);
+    }
+  }
+
+  template <typename Value>
+  void add(std::optional<T>& acc, Value&& value) {
+    if (acc) {
+      *acc = std::invoke(op_, std::move(*acc), (Value &&) value);
+    } else {
+      acc.emplace((Value &&) value);
+    }
+  }
+
+  // Claims a partial for the calling thread the first time it calls
+  // set_next(), and returns it from a thread-local cache after that.
+  // Returns null if every partial has been claimed.
+  partial* local_partial() noexcept {
+    partial_cache& cache = current_partial_cache();
+    if (cache.opId != id_) {
+      const std::size_t index =
+          claimedCount_.fetch_add(1, std::memory_order_relaxed);
+      cache.opId = id_;
+      cache.partial = index < partialCount_ ? &partials_[index] : nullptr;
+    }
+    return static_cast<partial*>(cache.partial);
+  }
+
+  // Combines the partials into the result. The source calls set_value()
+  // only once all of its set_next() calls have returned.
+  void complete() noexcept {
+    UNIFEX_TRY {
+      T result = std::move(init_);
+      const std::size_t claimed = std::min(
+          claimedCount_.load(std::memory_order_relaxed), partialCount_);
+      for (std::size_t i = 0; i < claimed; ++i) {
+        if (partials_[i].value_) {
+          result = std::invoke(
+              op_, std::move(result), std::move(*partials_[i].value_));
+        }
+      }
+      if (overflow_) {
+        result = std::invoke(op_, std::move(result), std::move(*overflow_));
+      }
+      unifex::set_value(std::move(receiver_), std::move(result));
+    }
+    UNIFEX_CATCH(...) {
+      unifex::set_error(std::move(receiver_), std::current_exception());
+    }
+  }
+
+  const std::uint64_t id_ = next_operation_id();
+  const std::size_t partialCount_ = max_partials();
+  T init_;
+  UNIFEX_NO_UNIQUE_ADDRESS Op op_;
+  Receiver receiver_;
+  std::unique_ptr<partial[]> partials_;
+  std::atomic<std::size_t> claimedCount_{0};
+  std::mutex overflowMutex_;
+  std::optional<T> overflow_;
+  connect_result_t<Source, receiver_t> sourceOp_;
+};
+
+template <typename Source, typename T, typename Op>
+struct _sender {
+  class type;
+};
+template <typename Source, typename T, typename Op>
+using sender = typename _sender<Source, T, Op>::type;
+
+template <typename Source, typename T, typename Op>
+class _sender<Source, T, Op>::type {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<T>>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename concat_type_lists_unique_t<
+      sender_error_types_t<Source, type_list>,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  static constexpr bool sends_done = sender_traits<Source>::sends_done;
+
+  static constexpr blocking_kind blocking = sender_traits<Source>::blocking;
+
+  static constexpr bool is_always_scheduler_affine =
+      sender_traits<Source>::is_always_scheduler_affine;
+
+  template <typename Source2, typename Op2>
+  explicit type(Source2&& source, T init, Op2&& op)
+    : source_((Source2 &&) source)
+    , init_(std::move(init))
+    , op_((Op2 &&) op) {}
+
+  template(typename Self, typename Receiver)  //
+      (requires same_as<remove_cvref_t<Self>, type> AND
+           receiver_of<Receiver, T>)  //
+      friend auto tag_invoke(
+          tag_t<unifex::connect>, Self&& self, Receiver&& r)
+          -> operation<member_t<Self, Source>, T, Op, Receiver> {
+    return operation<member_t<Self, Source>, T, Op, Receiver>{
+        static_cast<Self&&>(self).source_,
+        static_cast<Self&&>(self).init_,
+        static_cast<Self&&>(self).op_,
+        static_cast<Receiver&&>(r)};
+  }
+
+  friend constexpr blocking_kind
+  tag_invoke(tag_t<unifex::blocking>, const type& s) noexcept {
+    return unifex::blocking(s.source_);
+  }
+
+private:
+  UNIFEX_NO_UNIQUE_ADDRESS Source source_;
+  T init_;
+  UNIFEX_NO_UNIQUE_ADDRESS Op op_;
+};
+
+struct _fn {
+  template(typename Source, typename T, typename Op)  //
+      (requires bulk_sender<Source>)                  //
+      auto
+      operator()(Source&& source, T init, Op&& op) const
+      -> sender<remove_cvref_t<Source>, T, remove_cvref_t<Op>> {
+    return sender<remove_cvref_t<Source>, T, remove_cvref_t<Op>>{
+        (Source &&) source, std::move(init), (Op &&) op};
+  }
+  template <typename T, typename Op>
+  constexpr auto operator()(T init, Op&& op) const
+      noexcept(std::is_nothrow_invocable_v<tag_t<bind_back>, _fn, T, Op>)
+          -> bind_back_result_t<_fn, T, Op> {
+    return bind_back(*this, std::move(init), (Op &&) op);
+  }
+};
+}  // namespace _bulk_reduce
+
+// bulk_reduce(source, init, op) combines init and every value that the
+// ManySender source passes to set_next() into a single value of type T,
+// which it sends once the source completes.
+//
+// Each thread that the source calls set_next() on accumulates into its own
+// partial result, without synchronisation, starting from the first value
+// it receives (which must be convertible to T). The partials are combined
+// into init when the source completes, in an unspecified order, so op must
+// be associative and commutative and callable with (T, T) as well as
+// (T, value).
+inline constexpr _bulk_reduce::_fn bulk_reduce{};
+
+namespace _bulk_transform_reduce {
+struct _fn {
+  template(
+      typename Source,
+      typename T,
+      typename ReduceOp,
+      typename TransformOp)         //
+      (requires bulk_sender<Source>)  //
+      auto
+      operator()(
+          Source&& source,
+          T init,
+          ReduceOp&& reduceOp,
+          TransformOp&& transformOp) const {
+    return bulk_reduce(
+        bulk_transform((Source &&) source, (TransformOp &&) transformOp, par),
+        std::move(init),
+        (ReduceOp &&) reduceOp);
+  }
+  template <typename T, typename ReduceOp, typename TransformOp>
+  constexpr auto
+  operator()(T init, ReduceOp&& reduceOp, TransformOp&& transformOp) const
+      noexcept(std::is_nothrow_invocable_v<
+               tag_t<bind_back>,
+               _fn,
+               T,
+               ReduceOp,
+               TransformOp>)
+          -> bind_back_result_t<_fn, T, ReduceOp, TransformOp> {
+    return bind_back(
+        *this,
+        std::move(init),
+        (ReduceOp &&) reduceOp,
+        (TransformOp &&) transformOp);
+  }
+};
+}  // namespace _bulk_transform_reduce
+
+// bulk_transform_reduce(source, init, reduceOp, transformOp) is
+// bulk_reduce() of the results of transformOp applied to each value that
+// the source passes to set_next().
+inline constexpr _bulk_transform_reduce::_fn bulk_transform_reduce{};
+
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -21,6 +21,7 @@
 #include <unifex/execution_policy.hpp>
 #include <unifex/get_execution_policy.hpp>
 #include <unifex/get_stop_token.hpp>
+#include <unifex/index_range.hpp>
 #include <unifex/receiver_concepts.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
@@ -32,82 +33,109 @@ namespace unifex {
 // Size of chunk used for cancellation allowing for some vectorisation
 constexpr size_t bulk_cancellation_chunk_size = 16;
 
+namespace _bulk_chunk_size {
+struct _fn {
+  template(typename Scheduler)                         //
+      (requires tag_invocable<_fn, const Scheduler&>)  //
+      constexpr std::size_t
+      operator()(const Scheduler& s) const noexcept {
+    static_assert(is_nothrow_tag_invocable_v<_fn, const Scheduler&>);
+    return tag_invoke(_fn{}, s);
+  }
+
+  template(typename Scheduler)                           //
+      (requires(!tag_invocable<_fn, const Scheduler&>))  //
+      constexpr std::size_t
+      operator()(const Scheduler&) const noexcept {
+    return bulk_cancellation_chunk_size;
+  }
+};
+}  // namespace _bulk_chunk_size
+
+// The number of indices that the default bulk_schedule() implementations
+// deliver between checks for cancellation, and that bulk_schedule_chunked()
+// passes to each set_next() call. Schedulers can customise it with
+// tag_invoke().
+inline constexpr _bulk_chunk_size::_fn get_bulk_chunk_size{};
+
 namespace _bulk_schedule {
 
-template <typename Integral, typename Receiver>
+template <typename Receiver, typename Integral, bool Chunked>
+inline constexpr bool receives_chunks_v =
+    Chunked && is_next_receiver_v<Receiver, index_range<Integral>>;
+
+template <typename Integral, typename Receiver, bool Chunked>
 struct _schedule_receiver {
   class type;
 };
 
-template <typename Integral, typename Receiver>
-using schedule_receiver = typename _schedule_receiver<Integral, Receiver>::type;
+template <typename Integral, typename Receiver, bool Chunked = false>
+using schedule_receiver =
+    typename _schedule_receiver<Integral, Receiver, Chunked>::type;
+
+template <typename Integral, typename Receiver, bool Chunked>
+class _schedule_receiver<Integral, Receiver, Chunked>::type {
+  static constexpr bool receives_chunks =
+      receives_chunks_v<Receiver, Integral, Chunked>;
 
-template <typename Integral, typename Receiver>
-class _schedule_receiver<Integral, Receiver>::type {
 public:
   template <typename Receiver2>
-  explicit type(Integral count, Receiver2&& r)
+  explicit type(Integral count, std::size_t chunkSize, Receiver2&& r)
     : count_(std::move(count))
+    , chunkSize_(static_cast<Integral>(std::max<std::size_t>(chunkSize, 1)))
     , receiver_((Receiver2 &&) r) {}
 
-  void
-  set_value() noexcept(is_nothrow_receiver_of_v<Receiver>&&
-                           is_nothrow_next_receiver_v<Receiver, Integral>) {
-    using policy_t = decltype(get_execution_policy(receiver_));
+  void set_value() noexcept(
+      is_nothrow_receiver_of_v<Receiver> &&
+      (receives_chunks
+           ? is_nothrow_next_receiver_v<Receiver, index_range<Integral>>
+           : is_nothrow_next_receiver_v<Receiver, Integral>)) {
     auto stop_token = get_stop_token(receiver_);
     const bool stop_possible =
         !is_stop_never_possible_v<decltype(stop_token)> &&
         stop_token.stop_possible();
 
-    if (stop_possible) {
+    if (stop_possible || Chunked) {
       for (Integral chunk_start(0); chunk_start < count_;
-           chunk_start += bulk_cancellation_chunk_size) {
-        if (stop_token.stop_requested()) {
+           chunk_start += chunkSize_) {
+        if (stop_possible && stop_token.stop_requested()) {
           unifex::set_done(std::move(receiver_));
           return;
         }
-        Integral chunk_end = std::min(
-            chunk_start + static_cast<Integral>(bulk_cancellation_chunk_size),
-            count_);
-        if constexpr (is_one_of_v<
-                          policy_t,
-                          unsequenced_policy,
-                          parallel_unsequenced_policy>) {
-          UNIFEX_DIAGNOSTIC_PUSH
-
-          // Vectorisable version
-#if defined(__clang__)
-// When optimizing for size (e.g. with -Oz), Clang will not
-// vectorize this loop, and will emit a warning.  There's
-// nothing to be done about the warning, though, so just
-// suppress it.
-#  pragma clang diagnostic ignored "-Wpass-failed"
-#  pragma clang loop vectorize(enable) interleave(enable)
-#elif defined(__GNUC__)
-#  pragma GCC ivdep
-#elif defined(_MSC_VER)
-#  pragma loop(ivdep)
-#endif
-          for (Integral i(chunk_start); i < chunk_end; ++i) {
-            unifex::set_next(receiver_, Integral(i));
-          }
-
-          UNIFEX_DIAGNOSTIC_POP
-        } else {
-          // Sequenced version
-          for (Integral i(chunk_start); i < chunk_end; ++i) {
-            unifex::set_next(receiver_, Integral(i));
-          }
-        }
+        deliver(chunk_start, std::min(chunk_start + chunkSize_, count_));
       }
     } else {
-      if constexpr (is_one_of_v<
-                        policy_t,
-                        unsequenced_policy,
-                        parallel_unsequenced_policy>) {
-        UNIFEX_DIAGNOSTIC_PUSH
+      deliver(Integral(0), count_);
+    }
+
+    unifex::set_value(std::move(receiver_));
+  }
 
-        // Vectorisable version
+  template(typename Error)                  //
+      (requires receiver<Receiver, Error>)  //
+      void set_error(Error&& e) noexcept {
+    unifex::set_error(std::move(receiver_), (Error &&) e);
+  }
+
+  void set_done() noexcept { unifex::set_done(std::move(receiver_)); }
+
+private:
+  // Passes [first, last) to the receiver as one chunk if it takes chunks,
+  // otherwise one index at a time.
+  void deliver(Integral first, Integral last) noexcept(
+      receives_chunks
+          ? is_nothrow_next_receiver_v<Receiver, index_range<Integral>>
+          : is_nothrow_next_receiver_v<Receiver, Integral>) {
+    using policy_t = decltype(get_execution_policy(receiver_));
+    if constexpr (receives_chunks) {
+      unifex::set_next(receiver_, index_range<Integral>{first, last});
+    } else if constexpr (is_one_of_v<
+                             policy_t,
+                             unsequenced_policy,
+                             parallel_unsequenced_policy>) {
+      UNIFEX_DIAGNOSTIC_PUSH
+
+      // Vectorisable version
 #if defined(__clang__)
 // When optimizing for size (e.g. with -Oz), Clang will not
 // vectorize this loop, and will emit a warning.  There's
@@ -120,45 +148,35 @@ public:
 #elif defined(_MSC_VER)
 #  pragma loop(ivdep)
 #endif
-        for (Integral i(0); i < count_; ++i) {
-          unifex::set_next(receiver_, Integral(i));
-        }
+      for (Integral i(first); i < last; ++i) {
+        unifex::set_next(receiver_, Integral(i));
+      }
 
-        UNIFEX_DIAGNOSTIC_POP
-      } else {
-        // Sequenced version
-        for (Integral i(0); i < count_; ++i) {
-          unifex::set_next(receiver_, Integral(i));
-        }
+      UNIFEX_DIAGNOSTIC_POP
+    } else {
+      // Sequenced version
+      for (Integral i(first); i < last; ++i) {
+        unifex::set_next(receiver_, Integral(i));
       }
     }
-
-    unifex::set_value(std::move(receiver_));
-  }
-
-  template(typename Error)                  //
-      (requires receiver<Receiver, Error>)  //
-      void set_error(Error&& e) noexcept {
-    unifex::set_error(std::move(receiver_), (Error &&) e);
   }
 
-  void set_done() noexcept { unifex::set_done(std::move(receiver_)); }
-
-private:
   Integral count_;
+  Integral chunkSize_;
   Receiver receiver_;
 };
 
-template <typename Scheduler, typename Integral>
+template <typename Scheduler, typename Integral, bool Chunked>
 struct _default_sender {
   class type;
 };
 
-template <typename Scheduler, typename Integral>
-using default_sender = typename _default_sender<Scheduler, Integral>::type;
+template <typename Scheduler, typename Integral, bool Chunked = false>
+using default_sender =
+    typename _default_sender<Scheduler, Integral, Chunked>::type;
 
-template <typename Scheduler, typename Integral>
-class _default_sender<Scheduler, Integral>::type {
+template <typename Scheduler, typename Integral, bool Chunked>
+class _default_sender<Scheduler, Integral, Chunked>::type {
   using schedule_sender_t =
       decltype(unifex::schedule(UNIFEX_DECLVAL(const Scheduler&)));
 
@@ -175,7 +193,8 @@ public:
       class Variant,
       template <typename...>
       class Tuple>
-  using next_types = Variant<Tuple<Integral>>;
+  using next_types = Variant<
+      Tuple<std::conditional_t<Chunked, index_range<Integral>, Integral>>>;
 
   template <template <typename...> class Variant>
   using error_types = sender_error_types_t<schedule_sender_t, Variant>;
@@ -195,15 +214,18 @@ public:
 
   template(typename Self, typename BulkReceiver)  //
       (requires same_as<remove_cvref_t<Self>, type> AND
-           receiver_of<BulkReceiver> AND is_next_receiver_v<
-               BulkReceiver,
-               Integral>)  //
+           receiver_of<BulkReceiver> AND(
+               is_next_receiver_v<BulkReceiver, Integral> ||
+               receives_chunks_v<BulkReceiver, Integral, Chunked>))  //
       friend auto tag_invoke(
           tag_t<unifex::connect>, Self&& s, BulkReceiver&& r) {
+    const std::size_t chunkSize = get_bulk_chunk_size(s.scheduler_);
     return unifex::connect(
         unifex::schedule(static_cast<Self&&>(s).scheduler_),
-        schedule_receiver<Integral, remove_cvref_t<BulkReceiver>>{
-            static_cast<Self&&>(s).count_, static_cast<BulkReceiver&&>(r)});
+        schedule_receiver<Integral, remove_cvref_t<BulkReceiver>, Chunked>{
+            static_cast<Self&&>(s).count_,
+            chunkSize,
+            static_cast<BulkReceiver&&>(r)});
   }
 
   friend blocking_kind tag_invoke(tag_t<blocking>, const type& self) noexcept {
@@ -245,10 +267,45 @@ struct _fn {
   }
 };
 
+struct _chunked_fn {
+  template(typename Scheduler, typename Integral)                 //
+      (requires tag_invocable<_chunked_fn, Scheduler, Integral>)  //
+      auto
+      operator()(Scheduler&& s, Integral n) const
+      noexcept(is_nothrow_tag_invocable_v<_chunked_fn, Scheduler, Integral>)
+          -> tag_invoke_result_t<_chunked_fn, Scheduler, Integral> {
+    return tag_invoke(_chunked_fn{}, (Scheduler &&) s, std::move(n));
+  }
+
+  template(typename Scheduler, typename Integral)  //
+      (requires scheduler<Scheduler> AND(
+          !tag_invocable<_chunked_fn, Scheduler, Integral>))  //
+      auto
+      operator()(Scheduler&& s, Integral n) const
+      noexcept(std::is_nothrow_constructible_v<
+               remove_cvref_t<Scheduler>,
+               Scheduler>&& std::is_nothrow_move_constructible_v<Integral>)
+          -> default_sender<remove_cvref_t<Scheduler>, Integral, true> {
+    return default_sender<remove_cvref_t<Scheduler>, Integral, true>{
+        (Scheduler &&) s, std::move(n)};
+  }
+  template <typename Integral>
+  constexpr auto operator()(Integral n) const noexcept(
+      std::is_nothrow_invocable_v<tag_t<bind_back>, _chunked_fn, Integral>)
+      -> bind_back_result_t<_chunked_fn, Integral> {
+    return bind_back(*this, n);
+  }
+};
+
 }  // namespace _bulk_schedule
 
 inline constexpr _bulk_schedule::_fn bulk_schedule{};
 
+// Like bulk_schedule(), but sends index_range<Integral> chunks of
+// get_bulk_chunk_size(sched) indices instead of single indices. A
+// receiver that only takes single indices gets them one at a time.
+inline constexpr _bulk_schedule::_chunked_fn bulk_schedule_chunked{};
+
 }  // namespace unifex
 
 #include <unifex/detail/epilogue.hpp>
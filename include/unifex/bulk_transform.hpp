@@ -19,6 +19,7 @@
 #include <unifex/bind_back.hpp>
 #include <unifex/execution_policy.hpp>
 #include <unifex/get_execution_policy.hpp>
+#include <unifex/index_range.hpp>
 #include <unifex/receiver_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/type_list.hpp>
@@ -71,6 +72,28 @@ public:
     unifex::set_next(receiver_, std::invoke(func_, (Values &&) values...));
   }
 
+  // A function of a single index applied to a chunk of indices, which
+  // produces one set_next() call per index, as for an unchunked source.
+  template(typename Integral)  //
+      (requires(!std::is_invocable_v<Func&, index_range<Integral>>) AND
+           std::is_invocable_v<Func&, Integral>)  //
+      void set_next(index_range<Integral> range) & noexcept(
+          std::is_nothrow_invocable_v<Func&, Integral>&&
+              is_nothrow_next_receiver_v<
+                  Receiver,
+                  std::invoke_result_t<Func&, Integral>>) {
+    if constexpr (std::is_void_v<std::invoke_result_t<Func&, Integral>>) {
+      for (Integral i : range) {
+        std::invoke(func_, Integral(i));
+        unifex::set_next(receiver_);
+      }
+    } else {
+      for (Integral i : range) {
+        unifex::set_next(receiver_, std::invoke(func_, Integral(i)));
+      }
+    }
+  }
+
   template(typename... Values)                     //
       (requires receiver_of<Receiver, Values...>)  //
       void set_value(Values&&... values) noexcept(
@@ -143,11 +166,30 @@ struct result_overload<Result, std::enable_if_t<std::is_void_v<Result>>> {
   using type = type_list<>;
 };
 
+// The result of applying Func to a set_next() call's values, with a
+// function of a single index applied to each index of a chunk.
+template <typename Func, typename... Values>
+struct _next_result {
+  using type = std::invoke_result_t<Func&, Values...>;
+};
+template <typename Func, typename Integral>
+struct _next_result<Func, index_range<Integral>>
+  : std::conditional_t<
+        std::is_invocable_v<Func&, index_range<Integral>>,
+        std::invoke_result<Func&, index_range<Integral>>,
+        std::invoke_result<Func&, Integral>> {};
+template <typename Func, typename Integral>
+struct _next_result<Func, index_range<Integral>&>
+  : _next_result<Func, index_range<Integral>> {};
+template <typename Func, typename Integral>
+struct _next_result<Func, const index_range<Integral>&>
+  : _next_result<Func, index_range<Integral>> {};
+
 template <typename Source, typename Func, typename Policy>
 class _tfx_sender<Source, Func, Policy>::type {
   template <typename... Values>
-  using result = type_list<
-      typename result_overload<std::invoke_result_t<Func&, Values...>>::type>;
+  using result = type_list<typename result_overload<
+      typename _next_result<Func, Values...>::type>::type>;
 
 public:
   template <
@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/defer.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/repeat_effect_until.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/socket_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/then.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/detail/intrusive_list.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _conn_pool {
+
+struct connection_pool_options {
+  // Maximum number of connections, idle or leased, that the pool keeps open.
+  // Once reached, acquire() waits until another lease is released.
+  std::size_t maxConnections = 64;
+
+  // Idle connections older than this are closed by reap_idle().
+  std::chrono::milliseconds idleTimeout = std::chrono::seconds(30);
+
+  // How often reap_idle() checks for expired idle connections.
+  std::chrono::milliseconds reapInterval = std::chrono::seconds(1);
+};
+
+// A pool of connections to a single address.
+//
+// Connections are opened with async_connect(scheduler, address) and handed
+// out as move-only leases that return the connection to the pool when they
+// are destroyed. When the pool is at capacity, acquire() waits for a lease
+// to be released; released connections are handed directly to the oldest
+// waiter and delivered to it by rescheduling onto the pool's scheduler.
+//
+// The pool may be used from any thread. It must outlive every lease and
+// every outstanding acquire() and reap_idle() operation.
+template <typename Scheduler, typename Address>
+class connection_pool {
+  using connect_sender_t = decltype(async_connect(
+      UNIFEX_DECLVAL(Scheduler&), UNIFEX_DECLVAL(const Address&)));
+
+public:
+  using connection_type = sender_single_value_result_t<connect_sender_t>;
+  using time_point = decltype(now(UNIFEX_DECLVAL(Scheduler&)));
+
+  class lease;
+  class acquire_sender;
+
+  explicit connection_pool(
+      Scheduler scheduler,
+      Address address,
+      connection_pool_options options = {})
+    : scheduler_(std::move(scheduler))
+    , address_(std::move(address))
+    , options_(options) {}
+
+  connection_pool(connection_pool&&) = delete;
+
+  ~connection_pool() { UNIFEX_ASSERT(waiters_.empty()); }
+
+  // Returns a sender that completes with a lease on an idle connection,
+  // opening a new connection if there is none and the pool is below
+  // capacity.
+  [[nodiscard]] acquire_sender acquire() noexcept {
+    return acquire_sender{*this};
+  }
+
+  // Returns a sender that closes expired idle connections every
+  // reapInterval, using the pool scheduler's timers. It completes with done
+  // once stop is requested, or with an error if reaping fails.
+  [[nodiscard]] auto reap_idle() noexcept {
+    return repeat_effect(defer([this]() noexcept {
+      return schedule_at(
+                 scheduler_, now(scheduler_) + options_.reapInterval) |
+          then([this] { (void)reap_expired(); });
+    }));
+  }
+
+  // Closes the idle connections that have been idle for longer than
+  // idleTimeout and returns how many were closed. Throws if the list of
+  // expired connections can't be allocated, in which case the connections
+  // that weren't moved to it stay idle.
+  std::size_t reap_expired() {
+    std::deque<idle_connection> expired;
+    {
+      const auto deadline = now(scheduler_);
+      std::lock_guard lock{mutex_};
+      // Connections are appended as they are released, so the ones that
+      // have been idle the longest are at the front.
+      while (!idle_.empty() &&
+             idle_.front().idleSince_ + options_.idleTimeout <= deadline) {
+        expired.push_back(std::move(idle_.front()));
+        idle_.pop_front();
+        --openCount_;
+      }
+    }
+    // The expired connections are closed when `expired` is destroyed, after
+    // the lock has been released.
+    return expired.size();
+  }
+
+  std::size_t idle_count() const noexcept {
+    std::lock_guard lock{mutex_};
+    return idle_.size();
+  }
+
+  std::size_t open_count() const noexcept {
+    std::lock_guard lock{mutex_};
+    return openCount_;
+  }
+
+private:
+  struct idle_connection {
+    connection_type connection_;
+    time_point idleSince_;
+  };
+
+  struct waiter_base {
+    waiter_base* next_;
+    waiter_base* prev_;
+    // Called without the lock held once the waiter has been removed from
+    // the queue, either with a connection in connection_, with nothing if
+    // it was granted the right to open a new connection, or because it
+    // was cancelled.
+    void (*resume_)(waiter_base*) noexcept;
+    std::optional<connection_type> connection_;
+    // Both guarded by the pool's mutex.
+    bool queued_ = false;
+    bool stopped_ = false;
+  };
+
+  lease make_lease(connection_type&& connection) noexcept {
+    return lease{*this, std::move(connection)};
+  }
+
+  enum class try_acquire_result { connection, open, wait, stopped };
+
+  // Takes an idle connection or reserves a slot for a new one. Otherwise, if
+  // a waiter is given, enqueues it unless stop was already requested.
+  try_acquire_result try_acquire(
+      std::optional<connection_type>& out, waiter_base* waiter) noexcept {
+    std::lock_guard lock{mutex_};
+    if (!idle_.empty()) {
+      // Reuse the most recently released connection since it is the least
+      // likely to have been closed by the peer.
+      out.emplace(std::move(idle_.back().connection_));
+      idle_.pop_back();
+      return try_acquire_result::connection;
+    }
+    if (openCount_ < options_.maxConnections) {
+      ++openCount_;
+      return try_acquire_result::open;
+    }
+    if (waiter == nullptr) {
+      return try_acquire_result::wait;
+    }
+    if (waiter->stopped_) {
+      return try_acquire_result::stopped;
+    }
+    waiter->queued_ = true;
+    waiters_.push_back(waiter);
+    return try_acquire_result::wait;
+  }
+
+  // Returns true if the waiter was removed from the queue before being
+  // granted a connection.
+  bool try_remove_waiter(waiter_base* waiter) noexcept {
+    std::lock_guard lock{mutex_};
+    if (!waiter->queued_) {
+      // Either not enqueued yet, in which case try_acquire() won't enqueue
+      // it, or already granted a connection.
+      waiter->stopped_ = true;
+      return false;
+    }
+    waiters_.remove(waiter);
+    waiter->queued_ = false;
+    return true;
+  }
+
+  void release(connection_type&& connection) noexcept {
+    std::unique_lock lock{mutex_};
+    if (!waiters_.empty()) {
+      waiter_base* waiter = waiters_.pop_front();
+      waiter->queued_ = false;
+      waiter->connection_.emplace(std::move(connection));
+      lock.unlock();
+      waiter->resume_(waiter);
+      return;
+    }
+    UNIFEX_TRY {
+      idle_.push_back(idle_connection{std::move(connection), now(scheduler_)});
+    }
+    UNIFEX_CATCH(...) {
+      // Out of memory, close the connection instead.
+      --openCount_;
+    }
+  }
+
+  // Called when a connection slot reserved by try_acquire() is given up,
+  // either because the connection could not be opened or because it was
+  // discarded by its lease.
+  void release_slot() noexcept {
+    std::unique_lock lock{mutex_};
+    if (!waiters_.empty()) {
+      // Transfer the slot to the oldest waiter, which will open a new
+      // connection.
+      waiter_base* waiter = waiters_.pop_front();
+      waiter->queued_ = false;
+      lock.unlock();
+      waiter->resume_(waiter);
+      return;
+    }
+    --openCount_;
+  }
+
+  template <typename Receiver>
+  struct _op {
+    class type;
+  };
+  template <typename Receiver>
+  using operation = typename _op<remove_cvref_t<Receiver>>::type;
+
+  Scheduler scheduler_;
+  Address address_;
+  connection_pool_options options_;
+  mutable std::mutex mutex_;
+  std::deque<idle_connection> idle_;
+  intrusive_list<waiter_base, &waiter_base::next_, &waiter_base::prev_>
+      waiters_;
+  std::size_t openCount_ = 0;
+};
+
+// A leased connection. Destroying the lease returns the connection to the
+// pool; call discard() instead if the connection is known to be broken.
+template <typename Scheduler, typename Address>
+class connection_pool<Scheduler, Address>::lease {
+public:
+  lease(lease&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr))
+    , connection_(std::move(other.connection_)) {
+    other.connection_.reset();
+  }
+
+  lease& operator=(lease&&) = delete;
+
+  ~lease() {
+    if (pool_ != nullptr) {
+      pool_->release(std::move(*connection_));
+    }
+  }
+
+  connection_type& get() noexcept { return *connection_; }
+  connection_type& operator*() noexcept { return *connection_; }
+  connection_type* operator->() noexcept { return &*connection_; }
+
+  // Closes the connection instead of returning it to the pool.
+  void discard() noexcept {
+    if (auto* pool = std::exchange(pool_, nullptr)) {
+      connection_.reset();
+      pool->release_slot();
+    }
+  }
+
+private:
+  friend connection_pool;
+
+  explicit lease(connection_pool& pool, connection_type&& connection) noexcept
+    : pool_(&pool)
+    , connection_(std::move(connection)) {}
+
+  connection_pool* pool_;
+  std::optional<connection_type> connection_;
+};
+
+template <typename Scheduler, typename Address>
+template <typename Receiver>
+class connection_pool<Scheduler, Address>::_op<Receiver>::type
+  : private waiter_base {
+  struct connect_receiver {
+    type& op_;
+
+    void set_value(connection_type&& connection) noexcept {
+      op_.deliver(std::move(connection));
+    }
+
+    template <typename Error>
+    void set_error(Error&& error) noexcept {
+      op_.pool_.release_slot();
+      unifex::set_error(std::move(op_.receiver_), (Error &&) error);
+    }
+
+    void set_done() noexcept {
+      op_.pool_.release_slot();
+      unifex::set_done(std::move(op_.receiver_));
+    }
+
+    template(typename CPO, typename R)                   //
+        (requires is_receiver_query_cpo_v<CPO> AND       //
+             same_as<R, connect_receiver> AND            //
+                 std::is_invocable_v<CPO, const Receiver&>)  //
+        friend auto tag_invoke(CPO cpo, const R& r) noexcept(
+            std::is_nothrow_invocable_v<CPO, const Receiver&>)
+            -> std::invoke_result_t<CPO, const Receiver&> {
+      return std::move(cpo)(r.get_receiver());
+    }
+
+    const Receiver& get_receiver() const noexcept { return op_.receiver_; }
+  };
+
+  // Delivers the result of waiting on the pool's scheduler rather than on
+  // the thread that released the connection.
+  struct resume_receiver {
+    type& op_;
+
+    void set_value() noexcept { op_.on_resumed(); }
+
+    template <typename Error>
+    void set_error(Error&& error) noexcept {
+      op_.stopCallback_.destruct();
+      op_.give_back();
+      unifex::set_error(std::move(op_.receiver_), (Error &&) error);
+    }
+
+    void set_done() noexcept {
+      op_.stopCallback_.destruct();
+      op_.give_back();
+      unifex::set_done(std::move(op_.receiver_));
+    }
+  };
+
+  struct cancel_callback {
+    type& op_;
+
+    void operator()() noexcept {
+      if (op_.pool_.try_remove_waiter(&op_)) {
+        op_.cancelled_ = true;
+        op_.start_resume();
+      }
+    }
+  };
+
+  using stop_callback_t = typename stop_token_type_t<
+      Receiver&>::template callback_type<cancel_callback>;
+  using connect_op_t = connect_result_t<connect_sender_t, connect_receiver>;
+  using resume_op_t =
+      connect_result_t<schedule_result_t<Scheduler&>, resume_receiver>;
+
+public:
+  template <typename Receiver2>
+  explicit type(connection_pool& pool, Receiver2&& r) noexcept(
+      std::is_nothrow_constructible_v<Receiver, Receiver2>)
+    : pool_(pool)
+    , receiver_((Receiver2 &&) r) {
+    this->resume_ = [](waiter_base* self) noexcept {
+      static_cast<type*>(self)->start_resume();
+    };
+  }
+
+  type(type&&) = delete;
+
+  ~type() {
+    if (connectStarted_) {
+      connectOp_.destruct();
+    }
+    if (resumeStarted_) {
+      resumeOp_.destruct();
+    }
+  }
+
+  void start() noexcept {
+    std::optional<connection_type> connection;
+    auto result = pool_.try_acquire(connection, nullptr);
+    if (result == try_acquire_result::wait) {
+      // Register for cancellation before enqueueing so that a waiter that
+      // is resumed concurrently always finds the callback constructed.
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_callback{*this});
+      result = pool_.try_acquire(connection, this);
+      if (result == try_acquire_result::wait) {
+        return;
+      }
+      stopCallback_.destruct();
+    }
+
+    switch (result) {
+      case try_acquire_result::connection:
+        deliver(std::move(*connection));
+        break;
+      case try_acquire_result::open:
+        start_connect();
+        break;
+      default:
+        unifex::set_done(std::move(receiver_));
+        break;
+    }
+  }
+
+private:
+  void deliver(connection_type&& connection) noexcept {
+    if constexpr (is_nothrow_receiver_of_v<Receiver, lease>) {
+      unifex::set_value(
+          std::move(receiver_), pool_.make_lease(std::move(connection)));
+    } else {
+      UNIFEX_TRY {
+        unifex::set_value(
+            std::move(receiver_), pool_.make_lease(std::move(connection)));
+      }
+      UNIFEX_CATCH(...) {
+        unifex::set_error(std::move(receiver_), std::current_exception());
+      }
+    }
+  }
+
+  void start_connect() noexcept {
+    UNIFEX_TRY {
+      connectOp_.construct_with([&] {
+        return unifex::connect(
+            async_connect(pool_.scheduler_, std::as_const(pool_.address_)),
+            connect_receiver{*this});
+      });
+      connectStarted_ = true;
+    }
+    UNIFEX_CATCH(...) {
+      pool_.release_slot();
+      unifex::set_error(std::move(receiver_), std::current_exception());
+      return;
+    }
+    unifex::start(connectOp_.get());
+  }
+
+  void start_resume() noexcept {
+    UNIFEX_TRY {
+      resumeOp_.construct_with([&] {
+        return unifex::connect(
+            schedule(pool_.scheduler_), resume_receiver{*this});
+      });
+      resumeStarted_ = true;
+    }
+    UNIFEX_CATCH(...) {
+      stopCallback_.destruct();
+      give_back();
+      unifex::set_error(std::move(receiver_), std::current_exception());
+      return;
+    }
+    unifex::start(resumeOp_.get());
+  }
+
+  void on_resumed() noexcept {
+    stopCallback_.destruct();
+    if (cancelled_ || get_stop_token(receiver_).stop_requested()) {
+      give_back();
+      unifex::set_done(std::move(receiver_));
+    } else if (this->connection_.has_value()) {
+      auto connection = std::move(*this->connection_);
+      this->connection_.reset();
+      deliver(std::move(connection));
+    } else {
+      // We were handed the slot of a connection that was closed.
+      start_connect();
+    }
+  }
+
+  // Returns whatever this waiter was granted back to the pool.
+  void give_back() noexcept {
+    if (cancelled_) {
+      return;
+    }
+    if (this->connection_.has_value()) {
+      auto connection = std::move(*this->connection_);
+      this->connection_.reset();
+      pool_.release(std::move(connection));
+    } else {
+      pool_.release_slot();
+    }
+  }
+
+  connection_pool& pool_;
+  Receiver receiver_;
+  manual_lifetime<stop_callback_t> stopCallback_;
+  manual_lifetime<connect_op_t> connectOp_;
+  manual_lifetime<resume_op_t> resumeOp_;
+  bool connectStarted_ = false;
+  bool resumeStarted_ = false;
+  bool cancelled_ = false;
+};
+
+template <typename Scheduler, typename Address>
+class connection_pool<Scheduler, Address>::acquire_sender {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<lease>>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename concat_type_lists_unique_t<
+      sender_error_types_t<connect_sender_t, type_list>,
+      sender_error_types_t<schedule_result_t<Scheduler&>, type_list>,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  static constexpr bool sends_done = true;
+
+  template <typename Receiver>
+  operation<Receiver> connect(Receiver&& r) const noexcept(
+      std::is_nothrow_constructible_v<remove_cvref_t<Receiver>, Receiver>) {
+    return operation<Receiver>{pool_, (Receiver &&) r};
+  }
+
+private:
+  friend connection_pool;
+
+  explicit acquire_sender(connection_pool& pool) noexcept : pool_(pool) {}
+
+  connection_pool& pool_;
+};
+
+}  // namespace _conn_pool
+
+using _conn_pool::connection_pool;
+using _conn_pool::connection_pool_options;
+
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -111,6 +111,33 @@ public:
     return oldValue == inactive;
   }
 
+  // Enqueue all of the items in a queue, in order, with a single
+  // atomic update of the queue.
+  //
+  // Returns true if the producer is inactive and needs to be
+  // woken up, as for enqueue().
+  [[nodiscard]] bool enqueue_all(intrusive_queue<Item, Next> items) noexcept {
+    UNIFEX_ASSERT(!items.empty());
+    // The queue is held as a stack, newest first, so link the items up
+    // in reverse.
+    Item* const last = items.front();
+    Item* first = nullptr;
+    while (!items.empty()) {
+      Item* item = items.pop_front();
+      item->*Next = first;
+      first = item;
+    }
+
+    void* const inactive = producer_inactive_value();
+    void* oldValue = head_.load(std::memory_order_relaxed);
+    do {
+      last->*Next =
+          (oldValue == inactive) ? nullptr : static_cast<Item*>(oldValue);
+    } while (!head_.compare_exchange_weak(
+        oldValue, first, std::memory_order_acq_rel));
+    return oldValue == inactive;
+  }
+
   // Dequeue all items. Resetting the queue back to empty.
   // Not valid to call if the producer is inactive.
   [[nodiscard]] intrusive_queue<Item, Next> dequeue_all() noexcept {
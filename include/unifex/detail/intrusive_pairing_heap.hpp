@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+
+// An intrusive min-heap of items ordered by their 'SortKey' field.
+//
+// Implemented as a pairing heap: insert() is O(1), while pop() and
+// remove() of an arbitrary item are amortised O(log n). Items with equal
+// keys are not guaranteed to come out in insertion order.
+//
+// Each item is linked to its first child, and to its next sibling. 'Prev'
+// points at the previous sibling, or at the parent for a first child.
+template <
+    typename T,
+    T* T::*Child,
+    T* T::*Next,
+    T* T::*Prev,
+    typename Key,
+    Key T::*SortKey>
+class intrusive_pairing_heap {
+public:
+  intrusive_pairing_heap() noexcept : root_(nullptr) {}
+
+  ~intrusive_pairing_heap() { UNIFEX_ASSERT(empty()); }
+
+  bool empty() const noexcept { return root_ == nullptr; }
+
+  T* top() const noexcept {
+    UNIFEX_ASSERT(!empty());
+    return root_;
+  }
+
+  T* pop() noexcept {
+    UNIFEX_ASSERT(!empty());
+    T* item = root_;
+    root_ = merge_pairs(item->*Child);
+    return item;
+  }
+
+  void insert(T* item) noexcept {
+    item->*Child = nullptr;
+    item->*Next = nullptr;
+    item->*Prev = nullptr;
+    root_ = root_ == nullptr ? item : meld(root_, item);
+  }
+
+  void remove(T* item) noexcept {
+    if (item == root_) {
+      (void)pop();
+      return;
+    }
+
+    // Cut the item's subtree out of its parent's list of children.
+    T* prev = item->*Prev;
+    T* next = item->*Next;
+    UNIFEX_ASSERT(prev != nullptr);
+    if (prev->*Child == item) {
+      prev->*Child = next;
+    } else {
+      prev->*Next = next;
+    }
+    if (next != nullptr) {
+      next->*Prev = prev;
+    }
+
+    if (T* children = merge_pairs(item->*Child)) {
+      root_ = meld(root_, children);
+    }
+  }
+
+private:
+  // Links two roots, making the one with the larger key the first child
+  // of the other. Returns the new root.
+  static T* meld(T* a, T* b) noexcept {
+    if (b->*SortKey < a->*SortKey) {
+      std::swap(a, b);
+    }
+    b->*Prev = a;
+    b->*Next = a->*Child;
+    if (b->*Next != nullptr) {
+      b->*Next->*Prev = b;
+    }
+    a->*Child = b;
+    return a;
+  }
+
+  // Combines a list of siblings into a single tree: meld them in pairs
+  // from left to right, then meld the pairs together from right to left.
+  static T* merge_pairs(T* first) noexcept {
+    if (first == nullptr) {
+      return nullptr;
+    }
+
+    // The melded pairs, linked through 'Next' in reverse order.
+    T* pairs = nullptr;
+    while (first != nullptr) {
+      T* a = first;
+      T* b = a->*Next;
+      first = b != nullptr ? b->*Next : nullptr;
+      a->*Next = nullptr;
+      a->*Prev = nullptr;
+      T* pair = a;
+      if (b != nullptr) {
+        b->*Next = nullptr;
+        b->*Prev = nullptr;
+        pair = meld(a, b);
+      }
+      pair->*Next = pairs;
+      pairs = pair;
+    }
+
+    T* result = pairs;
+    pairs = pairs->*Next;
+    result->*Next = nullptr;
+    while (pairs != nullptr) {
+      T* pair = pairs;
+      pairs = pairs->*Next;
+      pair->*Next = nullptr;
+      result = meld(result, pair);
+    }
+    result->*Prev = nullptr;
+    return result;
+  }
+
+  T* root_;
+};
+
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -57,6 +57,8 @@ public:
 
   [[nodiscard]] bool empty() const noexcept { return head_ == nullptr; }
 
+  [[nodiscard]] Item* front() const noexcept { return head_; }
+
   [[nodiscard]] Item* pop_front() noexcept {
     UNIFEX_ASSERT(!empty());
     Item* item = std::exchange(head_, head_->*Next);
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/type_traits.hpp>
+
+#include <unifex/detail/stream_pump.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+// Shared machinery for streams that read from several source streams at
+// once, such as merge_streams() and zip_streams().
+namespace unifex::_fan_in {
+
+using _stream_pump::cleanup_errors_t;
+using _stream_pump::next_errors_t;
+using _stream_pump::source;
+using _stream_pump::source_init;
+using _stream_pump::stream;
+using _stream_pump::value_t;
+
+// Pulls from the sources, keeping at most one value waiting per source,
+// and stops them all on the first error.
+//
+// Derived provides, all called with the mutex held:
+//   for_each_source(f)    calls f(source&) for each source.
+//   source_count()        the number of sources.
+//   should_pull()         whether idle sources should be pulled from now.
+//   value_arrived(src)    called after src.value_ has been set.
+//   take_outcome()        the outcome for a pending next(), if there's one.
+//   stop_on_end           whether the end of one source ends the stream.
+template <
+    typename Derived,
+    typename ValueList,
+    typename ErrorList,
+    typename CleanupErrorList>
+class state_base : public _stream_pump::state_base<
+                       Derived,
+                       ValueList,
+                       ErrorList,
+                       CleanupErrorList> {
+public:
+  using pump = _stream_pump::
+      state_base<Derived, ValueList, ErrorList, CleanupErrorList>;
+
+  template <typename Source, typename... Values>
+  void on_value(Source& s, Values&&... values) noexcept {
+    std::unique_lock lk{this->mutex_};
+    s.active_ = false;
+    UNIFEX_TRY { s.value_.emplace((Values &&) values...); }
+    UNIFEX_CATCH(...) {
+      s.ended_ = true;
+      fail(lk, std::current_exception());
+      return;
+    }
+    this->derived().value_arrived(s);
+    this->pump_if_idle(lk);
+  }
+
+  template <typename Source, typename Error>
+  void on_error(Source& s, Error&& error) noexcept {
+    std::unique_lock lk{this->mutex_};
+    s.active_ = false;
+    s.ended_ = true;
+    fail(lk, (Error &&) error);
+  }
+
+  template <typename Source>
+  void on_end(Source& s) noexcept {
+    std::unique_lock lk{this->mutex_};
+    s.active_ = false;
+    s.ended_ = true;
+    if constexpr (Derived::stop_on_end) {
+      this->request_stop(lk);
+    }
+    this->pump_if_idle(lk);
+  }
+
+private:
+  friend pump;
+
+  // Starts next() on the first source that's ready for it, if any.
+  bool step(std::unique_lock<std::mutex>& lk) noexcept {
+    if (this->stopping_ || this->error_ || !this->derived().should_pull()) {
+      return false;
+    }
+    bool started = false;
+    this->derived().for_each_source([&](auto& s) {
+      if (started || s.active_ || s.ended_ || s.value_) {
+        return;
+      }
+      started = true;
+      s.active_ = true;
+      lk.unlock();
+      s.start_next();
+      lk.lock();
+    });
+    return started;
+  }
+
+  bool idle() noexcept {
+    bool active = false;
+    this->derived().for_each_source(
+        [&](auto& s) { active = active || s.active_; });
+    return !active;
+  }
+
+  // Records the first error, which is emitted once the values ready ahead
+  // of it have been taken, and stops the other sources.
+  template <typename Error>
+  void fail(std::unique_lock<std::mutex>& lk, Error&& error) noexcept {
+    this->record_error((Error &&) error);
+    this->request_stop(lk);
+    this->pump_if_idle(lk);
+  }
+};
+}  // namespace unifex::_fan_in
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,604 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <unifex/detail/prologue.hpp>
+
+// Shared machinery for stream adaptors that keep their state behind a
+// pointer and drive their source streams from a single "pumping" thread,
+// such as transform_stream_async(), batch_stream() and merge_streams().
+namespace unifex::_stream_pump {
+
+template <typename Stream>
+using value_t = sender_single_value_result_t<next_sender_t<Stream>>;
+
+template <typename Stream>
+using next_errors_t = sender_error_types_t<next_sender_t<Stream>, type_list>;
+
+template <typename Stream>
+using cleanup_errors_t =
+    sender_error_types_t<cleanup_sender_t<Stream>, type_list>;
+
+template <typename Source>
+struct _next_receiver {
+  class type;
+};
+template <typename Source>
+using next_receiver = typename _next_receiver<Source>::type;
+
+template <typename Source>
+class _next_receiver<Source>::type {
+public:
+  explicit type(Source* source) noexcept : source_(source) {}
+
+  template <typename... Values>
+  void set_value(Values&&... values) noexcept {
+    source_->owner_->on_value(*source_, (Values &&) values...);
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) noexcept {
+    source_->owner_->on_error(*source_, (Error &&) error);
+  }
+
+  void set_done() noexcept { source_->owner_->on_end(*source_); }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.get_stop_token();
+  }
+
+private:
+  inplace_stop_token get_stop_token() const noexcept {
+    return source_->owner_->stop_token();
+  }
+
+  Source* source_;
+};
+
+template <typename Source>
+struct _cleanup_receiver {
+  class type;
+};
+template <typename Source>
+using cleanup_receiver = typename _cleanup_receiver<Source>::type;
+
+template <typename Source>
+class _cleanup_receiver<Source>::type {
+public:
+  explicit type(Source* source) noexcept : source_(source) {}
+
+  void set_value() noexcept { source_->owner_->on_cleanup_complete(); }
+
+  template <typename Error>
+  void set_error(Error&& error) noexcept {
+    source_->owner_->on_cleanup_error((Error &&) error);
+  }
+
+  void set_done() noexcept { source_->owner_->on_cleanup_complete(); }
+
+private:
+  Source* source_;
+};
+
+template <typename Owner, typename Stream>
+struct _source {
+  class type;
+};
+template <typename Owner, typename Stream>
+using source = typename _source<Owner, Stream>::type;
+
+// Arguments for constructing a source in place, e.g. as a tuple element.
+template <typename Owner, typename Stream>
+struct source_init {
+  Owner* owner_;
+  std::size_t index_;
+  Stream&& stream_;
+};
+
+// A source stream along with storage for its next() and cleanup()
+// operations and the value it last produced. Only the owner's pumping
+// thread starts operations, see state_base.
+//
+// The source's next() completes by calling owner_->on_value(source&,
+// values...), on_error(source&, error) or on_end(source&) and its cleanup()
+// by calling owner_->on_cleanup_complete() or on_cleanup_error(error).
+template <typename Owner, typename Stream>
+class _source<Owner, Stream>::type {
+public:
+  template <typename Stream2>
+  explicit type(source_init<Owner, Stream2> init)
+    : owner_(init.owner_)
+    , index_(init.index_)
+    , stream_((Stream2 &&) init.stream_) {}
+
+  type(type&&) = delete;
+
+  ~type() {
+    if (nextConstructed_) {
+      nextOp_.destruct();
+    }
+    if (cleanupConstructed_) {
+      cleanupOp_.destruct();
+    }
+  }
+
+  void start_next() noexcept {
+    if (nextConstructed_) {
+      nextConstructed_ = false;
+      nextOp_.destruct();
+    }
+    UNIFEX_TRY {
+      nextOp_.construct_with([&] {
+        return unifex::connect(next(stream_), next_receiver<type>{this});
+      });
+      nextConstructed_ = true;
+    }
+    UNIFEX_CATCH(...) {
+      owner_->on_error(*this, std::current_exception());
+      return;
+    }
+    unifex::start(nextOp_.get());
+  }
+
+  void start_cleanup() noexcept {
+    if (nextConstructed_) {
+      nextConstructed_ = false;
+      nextOp_.destruct();
+    }
+    UNIFEX_TRY {
+      cleanupOp_.construct_with([&] {
+        return unifex::connect(cleanup(stream_), cleanup_receiver<type>{this});
+      });
+      cleanupConstructed_ = true;
+    }
+    UNIFEX_CATCH(...) {
+      owner_->on_cleanup_error(std::current_exception());
+      return;
+    }
+    unifex::start(cleanupOp_.get());
+  }
+
+  Owner* const owner_;
+  const std::size_t index_;
+  bool active_ = false;
+  bool ended_ = false;
+  std::optional<value_t<Stream>> value_;
+
+private:
+  Stream stream_;
+  bool nextConstructed_ = false;
+  bool cleanupConstructed_ = false;
+  manual_lifetime<next_operation_t<Stream, next_receiver<type>>> nextOp_;
+  manual_lifetime<cleanup_operation_t<Stream, cleanup_receiver<type>>>
+      cleanupOp_;
+};
+
+// The state shared by a stream's next() and cleanup() operations, which
+// outlives moves of the stream object.
+//
+// At most one thread at a time "pumps" the state: starts work on the
+// sources, hands an outcome to a pending next() or starts cleaning up the
+// sources. Any other thread that changes the state while one is pumping
+// leaves the follow-up work to it. This keeps inline completions from
+// recursing and means that once a thread has handed over, it no longer
+// touches the state.
+//
+// Derived provides, all called with the mutex held:
+//   take_outcome()        the outcome for a pending next(), if there's one.
+//   step(lk)              starts the next piece of work, if any, and
+//                         returns whether it did. May unlock lk meanwhile.
+//   idle()                whether no work is outstanding, so that the
+//                         sources can be cleaned up.
+//   for_each_source(f)    calls f(source&) for each source.
+//   source_count()        the number of sources.
+template <
+    typename Derived,
+    typename ValueList,
+    typename ErrorList,
+    typename CleanupErrorList>
+class state_base {
+public:
+  using payload_t = typename ValueList::template apply<std::tuple>;
+  using value_list = ValueList;
+
+  template <template <typename...> class Variant>
+  using error_types = typename concat_type_lists_unique_t<
+      ErrorList,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  template <template <typename...> class Variant>
+  using cleanup_error_types = typename concat_type_lists_unique_t<
+      CleanupErrorList,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  using error_t = error_types<std::variant>;
+  using cleanup_error_t = cleanup_error_types<std::variant>;
+
+  struct done_t {};
+  using outcome_t = std::variant<done_t, payload_t, error_t>;
+  using cleanup_outcome_t = std::optional<cleanup_error_t>;
+
+  // A pending next() operation.
+  struct waiter {
+    void (*complete_)(waiter*, outcome_t&&) noexcept;
+  };
+
+  // A cleanup() operation, which completes with the first error from
+  // cleaning up a source or else with done.
+  struct cleanup_waiter {
+    void (*complete_)(cleanup_waiter*, cleanup_outcome_t&&) noexcept;
+  };
+
+  state_base() = default;
+  state_base(state_base&&) = delete;
+
+  inplace_stop_token stop_token() noexcept { return stopSource_.get_token(); }
+
+  void add_waiter(waiter* w) noexcept {
+    std::unique_lock lk{mutex_};
+    waiter_ = w;
+    pump_if_idle(lk);
+  }
+
+  // Stops starting new work and asks outstanding work to stop. A pending
+  // next() completes with done once the work it's waiting on completes.
+  void cancel() noexcept {
+    {
+      std::lock_guard lk{mutex_};
+      stopping_ = true;
+    }
+    stopSource_.request_stop();
+  }
+
+  // Waits for outstanding work and then cleans up all the sources
+  // concurrently.
+  void add_cleanup(cleanup_waiter* c) noexcept {
+    cancel();
+    std::unique_lock lk{mutex_};
+    cleanupWaiter_ = c;
+    pump_if_idle(lk);
+  }
+
+  void on_cleanup_complete() noexcept {
+    std::unique_lock lk{mutex_};
+    finish_cleanup(lk);
+  }
+
+  template <typename Error>
+  void on_cleanup_error(Error&& error) noexcept {
+    std::unique_lock lk{mutex_};
+    if (!cleanupError_) {
+      cleanupError_.emplace(
+          std::in_place_type<remove_cvref_t<Error>>, (Error &&) error);
+    }
+    finish_cleanup(lk);
+  }
+
+protected:
+  Derived& derived() noexcept { return *static_cast<Derived*>(this); }
+
+  bool waiter_pending() const noexcept { return waiter_ != nullptr; }
+
+  void pump_if_idle(std::unique_lock<std::mutex>& lk) noexcept {
+    if (!pumping_) {
+      pumping_ = true;
+      pump(lk);
+    }
+  }
+
+  // Asks outstanding work to stop, without holding the mutex.
+  void request_stop(std::unique_lock<std::mutex>& lk) noexcept {
+    lk.unlock();
+    stopSource_.request_stop();
+    lk.lock();
+  }
+
+  // Records the first error, which take_outcome() emits once the values
+  // ready ahead of it have been taken.
+  template <typename Error>
+  void record_error(Error&& error) noexcept {
+    if (!error_) {
+      error_.emplace(
+          std::in_place_type<remove_cvref_t<Error>>, (Error &&) error);
+    }
+  }
+
+  std::mutex mutex_;
+  bool stopping_ = false;
+  bool finished_ = false;
+  std::optional<error_t> error_;
+
+private:
+  void pump(std::unique_lock<std::mutex>& lk) noexcept {
+    while (true) {
+      if (waiter_ != nullptr) {
+        if (auto outcome = derived().take_outcome()) {
+          waiter* w = std::exchange(waiter_, nullptr);
+          lk.unlock();
+          w->complete_(w, std::move(*outcome));
+          lk.lock();
+          continue;
+        }
+      }
+
+      if (derived().step(lk)) {
+        continue;
+      }
+
+      if (cleanupWaiter_ != nullptr && !cleanupStarted_ && derived().idle()) {
+        // The extra count keeps the last cleanup to complete from
+        // finishing while we're still starting the others.
+        cleanupStarted_ = true;
+        cleanupsPending_ = derived().source_count() + 1;
+        pumping_ = false;
+        lk.unlock();
+        derived().for_each_source([](auto& s) { s.start_cleanup(); });
+        lk.lock();
+        finish_cleanup(lk);
+        return;
+      }
+
+      break;
+    }
+    pumping_ = false;
+  }
+
+  void finish_cleanup(std::unique_lock<std::mutex>& lk) noexcept {
+    if (--cleanupsPending_ != 0) {
+      return;
+    }
+    cleanup_waiter* c = std::exchange(cleanupWaiter_, nullptr);
+    cleanup_outcome_t outcome = std::move(cleanupError_);
+    lk.unlock();
+    c->complete_(c, std::move(outcome));
+  }
+
+  bool pumping_ = false;
+  waiter* waiter_ = nullptr;
+  cleanup_waiter* cleanupWaiter_ = nullptr;
+  bool cleanupStarted_ = false;
+  std::size_t cleanupsPending_ = 0;
+  std::optional<cleanup_error_t> cleanupError_;
+  inplace_stop_source stopSource_;
+};
+
+template <typename State, typename Receiver>
+struct _next_op {
+  class type;
+};
+template <typename State, typename Receiver>
+using next_operation =
+    typename _next_op<State, remove_cvref_t<Receiver>>::type;
+
+template <typename State, typename Receiver>
+class _next_op<State, Receiver>::type : private State::waiter {
+  using outcome_t = typename State::outcome_t;
+
+  struct cancel_callback {
+    State* state_;
+    void operator()() noexcept { state_->cancel(); }
+  };
+
+public:
+  template <typename Receiver2>
+  explicit type(State* state, Receiver2&& receiver) noexcept(
+      std::is_nothrow_constructible_v<Receiver, Receiver2>)
+    : State::waiter{&complete}
+    , state_(state)
+    , receiver_((Receiver2 &&) receiver) {}
+
+  type(type&&) = delete;
+
+  void start() & noexcept {
+    stopCallback_.construct(
+        get_stop_token(receiver_), cancel_callback{state_});
+    state_->add_waiter(this);
+  }
+
+private:
+  static void
+  complete(typename State::waiter* w, outcome_t&& outcome) noexcept {
+    auto& self = *static_cast<type*>(w);
+    self.stopCallback_.destruct();
+    switch (outcome.index()) {
+      case 0:
+        unifex::set_done(std::move(self.receiver_));
+        break;
+      case 1:
+        std::apply(
+            [&](auto&&... values) {
+              unifex::set_value(
+                  std::move(self.receiver_), std::move(values)...);
+            },
+            std::move(std::get<1>(outcome)));
+        break;
+      default:
+        std::visit(
+            [&](auto&& error) {
+              unifex::set_error(std::move(self.receiver_), std::move(error));
+            },
+            std::move(std::get<2>(outcome)));
+        break;
+    }
+  }
+
+  State* state_;
+  Receiver receiver_;
+  manual_lifetime<typename stop_token_type_t<
+      Receiver&>::template callback_type<cancel_callback>>
+      stopCallback_;
+};
+
+template <typename State>
+struct _next_sender {
+  class type;
+};
+template <typename State>
+using next_sender = typename _next_sender<State>::type;
+
+template <typename State>
+class _next_sender<State>::type {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types =
+      Variant<typename State::value_list::template apply<Tuple>>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename State::template error_types<Variant>;
+
+  static constexpr bool sends_done = true;
+
+  explicit type(State* state) noexcept : state_(state) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      next_operation<State, Receiver> connect(Receiver&& r) const {
+    return next_operation<State, Receiver>{state_, (Receiver &&) r};
+  }
+
+private:
+  State* state_;
+};
+
+template <typename State, typename Receiver>
+struct _cleanup_op {
+  class type;
+};
+template <typename State, typename Receiver>
+using cleanup_operation =
+    typename _cleanup_op<State, remove_cvref_t<Receiver>>::type;
+
+template <typename State, typename Receiver>
+class _cleanup_op<State, Receiver>::type : private State::cleanup_waiter {
+  using outcome_t = typename State::cleanup_outcome_t;
+
+public:
+  template <typename Receiver2>
+  explicit type(State* state, Receiver2&& receiver) noexcept(
+      std::is_nothrow_constructible_v<Receiver, Receiver2>)
+    : State::cleanup_waiter{&complete}
+    , state_(state)
+    , receiver_((Receiver2 &&) receiver) {}
+
+  type(type&&) = delete;
+
+  void start() & noexcept { state_->add_cleanup(this); }
+
+private:
+  static void complete(
+      typename State::cleanup_waiter* c, outcome_t&& outcome) noexcept {
+    auto& self = *static_cast<type*>(c);
+    if (outcome) {
+      std::visit(
+          [&](auto&& error) {
+            unifex::set_error(std::move(self.receiver_), std::move(error));
+          },
+          std::move(*outcome));
+    } else {
+      unifex::set_done(std::move(self.receiver_));
+    }
+  }
+
+  State* state_;
+  Receiver receiver_;
+};
+
+template <typename State>
+struct _cleanup_sender {
+  class type;
+};
+template <typename State>
+using cleanup_sender = typename _cleanup_sender<State>::type;
+
+template <typename State>
+class _cleanup_sender<State>::type {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename State::template cleanup_error_types<Variant>;
+
+  static constexpr bool sends_done = true;
+
+  explicit type(State* state) noexcept : state_(state) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      cleanup_operation<State, Receiver> connect(Receiver&& r) const {
+    return cleanup_operation<State, Receiver>{state_, (Receiver &&) r};
+  }
+
+private:
+  State* state_;
+};
+
+template <typename State>
+struct _stream {
+  class type;
+};
+template <typename State>
+using stream = typename _stream<State>::type;
+
+template <typename State>
+class _stream<State>::type {
+public:
+  explicit type(std::unique_ptr<State> state) noexcept
+    : state_(std::move(state)) {}
+
+  friend next_sender<State> tag_invoke(tag_t<next>, type& s) noexcept {
+    return next_sender<State>{s.state_.get()};
+  }
+
+  friend cleanup_sender<State> tag_invoke(tag_t<cleanup>, type& s) noexcept {
+    return cleanup_sender<State>{s.state_.get()};
+  }
+
+private:
+  std::unique_ptr<State> state_;
+};
+}  // namespace unifex::_stream_pump
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/get_stop_token.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/detail/intrusive_queue.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _elastic_thread_pool {
+struct task_base {
+  task_base* next;
+  void (*execute)(task_base*) noexcept;
+};
+
+template <typename Receiver>
+struct _op {
+  class type;
+};
+template <typename Receiver>
+using operation = typename _op<remove_cvref_t<Receiver>>::type;
+
+// A thread pool for work that blocks, eg. legacy APIs without an
+// asynchronous form, so that it doesn't tie up event-loop threads.
+//
+// Work never waits for a thread while the pool is below its cap: a thread
+// is started whenever there is more queued work than idle threads. Threads
+// that have been idle for the idle timeout exit.
+class context {
+  template <typename Receiver>
+  friend struct _op;
+
+public:
+  struct options {
+    // The most threads the pool runs at once. Work queues up beyond this.
+    std::uint32_t maxThreads = 64;
+
+    // How long a thread waits for work before it exits.
+    std::chrono::steady_clock::duration idleTimeout = std::chrono::seconds(10);
+  };
+
+  context();
+  explicit context(const options& opts);
+
+  // Runs the work that is still queued, then joins every thread.
+  ~context();
+
+  class scheduler {
+    template <typename Receiver>
+    friend struct _op;
+    class schedule_sender {
+    public:
+      template <
+          template <typename...>
+          class Variant,
+          template <typename...>
+          class Tuple>
+      using value_types = Variant<Tuple<>>;
+
+      template <template <typename...> class Variant>
+      using error_types = Variant<std::exception_ptr>;
+
+      static constexpr bool sends_done = true;
+
+      // Starting the first thread can fail, which is reported inline.
+      static constexpr blocking_kind blocking = blocking_kind::maybe;
+
+      static constexpr bool is_always_scheduler_affine = false;
+
+      template <typename Receiver>
+      operation<Receiver> connect(Receiver&& r) const {
+        return operation<Receiver>{pool_, (Receiver &&) r};
+      }
+
+    private:
+      friend scheduler;
+
+      explicit schedule_sender(context& pool) noexcept : pool_(pool) {}
+
+      context& pool_;
+    };
+
+    friend context;
+
+    explicit scheduler(context& pool) noexcept : pool_(&pool) {}
+
+    bool currently_on_() const noexcept {
+      return pool_->is_running_on_pool_thread();
+    }
+
+    friend bool
+    tag_invoke(tag_t<currently_on>, const scheduler& s) noexcept {
+      return s.currently_on_();
+    }
+
+    context* pool_;
+
+  public:
+    schedule_sender schedule() const noexcept {
+      return schedule_sender{*pool_};
+    }
+
+    friend bool operator==(scheduler a, scheduler b) noexcept {
+      return a.pool_ == b.pool_;
+    }
+    friend bool operator!=(scheduler a, scheduler b) noexcept {
+      return a.pool_ != b.pool_;
+    }
+  };
+
+  scheduler get_scheduler() noexcept { return scheduler{*this}; }
+
+  // The number of threads currently running, busy or idle.
+  std::uint32_t thread_count() const;
+
+  // A pool shared by the I/O contexts for the calls they can't make
+  // asynchronously. Created with the default options on first use.
+  static context& shared();
+
+private:
+  using thread_list = std::list<std::thread>;
+
+  // Throws if there are no threads and starting one fails.
+  void enqueue(task_base* task);
+  void run(thread_list::iterator self) noexcept;
+  bool is_running_on_pool_thread() const noexcept;
+
+  const options options_;
+  mutable std::mutex mutex_;
+  std::condition_variable workCv_;
+  std::condition_variable exitCv_;
+  intrusive_queue<task_base, &task_base::next> queue_;
+  std::size_t queuedCount_ = 0;
+  std::uint32_t idleCount_ = 0;
+  std::uint32_t threadCount_ = 0;
+  bool stop_ = false;
+  // Threads that are running, and threads that have exited and are
+  // waiting to be joined.
+  thread_list threads_;
+  thread_list exited_;
+};
+
+template <typename Receiver>
+class _op<Receiver>::type : task_base {
+  friend context::scheduler::schedule_sender;
+
+  context& pool_;
+  Receiver receiver_;
+
+  template <typename Receiver2>
+  explicit type(context& pool, Receiver2&& r)
+    : pool_(pool)
+    , receiver_((Receiver2 &&) r) {
+    this->execute = [](task_base* t) noexcept {
+      auto& op = *static_cast<type*>(t);
+      if constexpr (!is_stop_never_possible_v<stop_token_type_t<Receiver>>) {
+        if (get_stop_token(op.receiver_).stop_requested()) {
+          unifex::set_done((Receiver &&) op.receiver_);
+          return;
+        }
+      }
+      if constexpr (is_nothrow_receiver_of_v<Receiver>) {
+        unifex::set_value((Receiver &&) op.receiver_);
+      } else {
+        UNIFEX_TRY { unifex::set_value((Receiver &&) op.receiver_); }
+        UNIFEX_CATCH(...) {
+          unifex::set_error(
+              (Receiver &&) op.receiver_, std::current_exception());
+        }
+      }
+    };
+  }
+
+public:
+  void start() noexcept {
+    UNIFEX_TRY { pool_.enqueue(this); }
+    UNIFEX_CATCH(...) {
+      unifex::set_error((Receiver &&) receiver_, std::current_exception());
+    }
+  }
+};
+}  // namespace _elastic_thread_pool
+
+using elastic_thread_pool = _elastic_thread_pool::context;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
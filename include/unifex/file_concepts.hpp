@@ -23,48 +23,68 @@
 
 namespace unifex {
 namespace _filesystem {
+// Each of these accepts optional, context-specific open options after the
+// path, eg. linuxos::direct_io.
 inline const struct open_file_read_only_cpo {
-  template <typename Executor>
-  auto operator()(Executor&& executor, const filesystem::path& path) const
+  template <typename Executor, typename... Options>
+  auto operator()(
+      Executor&& executor,
+      const filesystem::path& path,
+      Options&&... options) const
       noexcept(is_nothrow_tag_invocable_v<
                open_file_read_only_cpo,
                Executor,
-               const filesystem::path&>)
+               const filesystem::path&,
+               Options...>)
           -> tag_invoke_result_t<
               open_file_read_only_cpo,
               Executor,
-              const filesystem::path&> {
-    return unifex::tag_invoke(*this, (Executor &&) executor, path);
+              const filesystem::path&,
+              Options...> {
+    return unifex::tag_invoke(
+        *this, (Executor &&) executor, path, (Options &&) options...);
   }
 } open_file_read_only{};
 
 inline const struct open_file_write_only_cpo {
-  template <typename Executor>
-  auto operator()(Executor&& executor, const filesystem::path& path) const
+  template <typename Executor, typename... Options>
+  auto operator()(
+      Executor&& executor,
+      const filesystem::path& path,
+      Options&&... options) const
       noexcept(is_nothrow_tag_invocable_v<
                open_file_write_only_cpo,
                Executor,
-               const filesystem::path&>)
+               const filesystem::path&,
+               Options...>)
           -> tag_invoke_result_t<
               open_file_write_only_cpo,
               Executor,
-              const filesystem::path&> {
-    return unifex::tag_invoke(*this, (Executor &&) executor, path);
+              const filesystem::path&,
+              Options...> {
+    return unifex::tag_invoke(
+        *this, (Executor &&) executor, path, (Options &&) options...);
   }
 } open_file_write_only{};
 
 inline const struct open_file_read_write_cpo {
-  template <typename Executor>
-  auto operator()(Executor&& executor, const filesystem::path& path) const
+  template <typename Executor, typename... Options>
+  auto operator()(
+      Executor&& executor,
+      const filesystem::path& path,
+      Options&&... options) const
       noexcept(is_nothrow_tag_invocable_v<
                open_file_read_write_cpo,
                Executor,
-               const filesystem::path&>)
+               const filesystem::path&,
+               Options...>)
           -> tag_invoke_result_t<
               open_file_read_write_cpo,
               Executor,
-              const filesystem::path&> {
-    return unifex::tag_invoke(*this, (Executor &&) executor, path);
+              const filesystem::path&,
+              Options...> {
+    return unifex::tag_invoke(
+        *this, (Executor &&) executor, path, (Options &&) options...);
   }
 } open_file_read_write{};
 }  // namespace _filesystem
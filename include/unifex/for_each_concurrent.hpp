@@ -0,0 +1,595 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/blocking.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/std_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _for_each_conc {
+
+template <typename Iterator>
+using child_sender_t = remove_cvref_t<decltype(*UNIFEX_DECLVAL(Iterator&))>;
+
+// Collects the result of each child into a vector in iteration order.
+template <typename T, typename Allocator>
+class collect {
+  using optional_allocator_t = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<std::optional<T>>;
+  using result_allocator_t =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+public:
+  using result_vector_t = std::vector<T, result_allocator_t>;
+
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<result_vector_t>>;
+
+  explicit collect(const Allocator& allocator)
+    : results_(optional_allocator_t(allocator)) {}
+
+  collect(collect&& other) : results_(std::move(other.results_)) {}
+
+  collect(const collect& other) : results_(other.results_) {}
+
+  void on_start(std::size_t index) {
+    std::lock_guard lk{mutex_};
+    if (results_.size() <= index) {
+      results_.resize(index + 1);
+    }
+  }
+
+  template <typename... Values>
+  void on_value(std::size_t index, Values&&... values) {
+    std::lock_guard lk{mutex_};
+    results_[index].emplace((Values &&) values...);
+  }
+
+  template <typename Receiver>
+  void complete(Receiver&& receiver) {
+    result_vector_t values(result_allocator_t(results_.get_allocator()));
+    values.reserve(results_.size());
+    for (auto& result : results_) {
+      values.push_back(std::move(*result));
+    }
+    unifex::set_value((Receiver &&) receiver, std::move(values));
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<std::optional<T>, optional_allocator_t> results_;
+};
+
+// Passes the result of each child to a function as it completes.
+template <typename Func>
+class invoke_each {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<>>;
+
+  template <typename Func2>
+  explicit invoke_each(Func2&& func) : func_((Func2 &&) func) {}
+
+  invoke_each(invoke_each&& other) : func_(std::move(other.func_)) {}
+
+  invoke_each(const invoke_each& other) : func_(other.func_) {}
+
+  void on_start(std::size_t) noexcept {}
+
+  // Calls to the function are serialised.
+  template <typename... Values>
+  void on_value(std::size_t, Values&&... values) {
+    std::lock_guard lk{mutex_};
+    std::invoke(func_, (Values &&) values...);
+  }
+
+  template <typename Receiver>
+  void complete(Receiver&& receiver) {
+    unifex::set_value((Receiver &&) receiver);
+  }
+
+private:
+  std::mutex mutex_;
+  UNIFEX_NO_UNIQUE_ADDRESS Func func_;
+};
+
+template <
+    typename Iterator,
+    typename Sentinel,
+    typename Consumer,
+    typename Allocator,
+    typename Receiver>
+struct _op {
+  class type;
+};
+template <
+    typename Iterator,
+    typename Sentinel,
+    typename Consumer,
+    typename Allocator,
+    typename Receiver>
+using operation = typename _op<
+    Iterator,
+    Sentinel,
+    Consumer,
+    Allocator,
+    remove_cvref_t<Receiver>>::type;
+
+template <typename Op>
+struct _child_receiver {
+  class type;
+};
+template <typename Op>
+using child_receiver = typename _child_receiver<Op>::type;
+
+template <typename Op>
+class _child_receiver<Op>::type {
+  using slot_t = typename Op::slot;
+
+public:
+  explicit type(slot_t* slot) noexcept : slot_(slot) {}
+
+  template <typename... Values>
+  void set_value(Values&&... values) noexcept {
+    slot_->op_->on_value(*slot_, (Values &&) values...);
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) noexcept {
+    slot_->op_->on_error(*slot_, (Error &&) error);
+  }
+
+  void set_done() noexcept { slot_->op_->on_done(*slot_); }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.get_stop_token();
+  }
+
+  template(typename CPO, typename Self)             //
+      (requires is_receiver_query_cpo_v<CPO> AND    //
+           same_as<Self, type> AND                  //
+               std::is_invocable_v<CPO, const typename Op::receiver_t&>)  //
+      friend auto tag_invoke(CPO cpo, const Self& r) noexcept(
+          std::is_nothrow_invocable_v<CPO, const typename Op::receiver_t&>)
+          -> std::invoke_result_t<CPO, const typename Op::receiver_t&> {
+    return std::move(cpo)(std::as_const(r.get_receiver()));
+  }
+
+private:
+  const typename Op::receiver_t& get_receiver() const noexcept {
+    return slot_->op_->receiver_;
+  }
+
+  inplace_stop_token get_stop_token() const noexcept {
+    return slot_->op_->stopSource_.get_token();
+  }
+
+  slot_t* slot_;
+};
+
+template <
+    typename Iterator,
+    typename Sentinel,
+    typename Consumer,
+    typename Allocator,
+    typename Receiver>
+class _op<Iterator, Sentinel, Consumer, Allocator, Receiver>::type {
+  using sender_t = child_sender_t<Iterator>;
+
+public:
+  using receiver_t = Receiver;
+
+  // One of the maxConcurrency op-state slots that children are connected
+  // into. A slot is reused for another child once its child has completed.
+  struct slot {
+    explicit slot(type* op) noexcept : op_(op) {}
+
+    type* op_;
+    slot* nextFree_ = nullptr;
+    std::size_t index_ = 0;
+    bool constructed_ = false;
+    manual_lifetime<connect_result_t<sender_t, child_receiver<type>>> child_;
+  };
+
+  template <typename Consumer2, typename Receiver2>
+  explicit type(
+      Iterator first,
+      Sentinel last,
+      std::size_t maxConcurrency,
+      const Allocator& allocator,
+      Consumer2&& consumer,
+      Receiver2&& receiver)
+    : next_(std::move(first))
+    , last_(std::move(last))
+    , consumer_((Consumer2 &&) consumer)
+    , receiver_((Receiver2 &&) receiver)
+    , allocator_(allocator)
+    , slotCount_(std::max<std::size_t>(maxConcurrency, 1)) {
+    if constexpr (std::is_base_of_v<
+                      std::random_access_iterator_tag,
+                      typename std::iterator_traits<
+                          Iterator>::iterator_category> &&
+                  std::is_same_v<Iterator, Sentinel>) {
+      slotCount_ = std::max<std::size_t>(
+          std::min(slotCount_, std::size_t(std::distance(next_, last_))), 1);
+    }
+    slots_ = std::allocator_traits<slot_allocator_t>::allocate(
+        allocator_, slotCount_);
+    for (std::size_t i = 0; i < slotCount_; ++i) {
+      slot* s = ::new (static_cast<void*>(slots_ + i)) slot(this);
+      s->nextFree_ = freeSlots_;
+      freeSlots_ = s;
+    }
+  }
+
+  type(type&&) = delete;
+
+  ~type() {
+    for (std::size_t i = 0; i < slotCount_; ++i) {
+      if (slots_[i].constructed_) {
+        slots_[i].child_.destruct();
+      }
+      slots_[i].~slot();
+    }
+    std::allocator_traits<slot_allocator_t>::deallocate(
+        allocator_, slots_, slotCount_);
+  }
+
+  void start() & noexcept {
+    stopCallback_.construct(
+        get_stop_token(receiver_), cancel_callback{stopSource_});
+    std::unique_lock lk{mutex_};
+    pumping_ = true;
+    pump(lk);
+  }
+
+private:
+  friend child_receiver<type>;
+
+  using slot_allocator_t = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<slot>;
+
+  using error_variant_t = typename concat_type_lists_unique_t<
+      sender_error_types_t<sender_t, type_list>,
+      type_list<std::exception_ptr>>::template apply<std::variant>;
+
+  struct cancel_callback {
+    inplace_stop_source& stopSource_;
+    void operator()() noexcept { stopSource_.request_stop(); }
+  };
+
+  // Starts children while there are free slots. Only one thread at a time
+  // does this, the one that set pumping_; a child that completes meanwhile,
+  // e.g. inline from start(), just returns its slot and leaves starting the
+  // next child to that thread. This bounds the stack depth and means that
+  // whichever thread finds nothing running and nothing left to start is the
+  // only one that can complete the operation.
+  void pump(std::unique_lock<std::mutex>& lk) noexcept {
+    while (freeSlots_ != nullptr && !failed_ &&
+           !stopSource_.stop_requested() && !(next_ == last_)) {
+      slot* s = freeSlots_;
+      freeSlots_ = s->nextFree_;
+      s->index_ = started_++;
+      ++active_;
+      lk.unlock();
+      start_child(*s);
+      lk.lock();
+    }
+    pumping_ = false;
+    const bool finished = active_ == 0;
+    lk.unlock();
+    if (finished) {
+      finish();
+    }
+  }
+
+  // Called without the lock held, but only by the pumping thread, which is
+  // the only one that touches next_.
+  void start_child(slot& s) noexcept {
+    UNIFEX_TRY {
+      consumer_.on_start(s.index_);
+      if (s.constructed_) {
+        s.constructed_ = false;
+        s.child_.destruct();
+      }
+      s.child_.construct_with([&] {
+        if constexpr (std::is_lvalue_reference_v<decltype(*next_)>) {
+          // Leave the caller's senders intact, as the unbounded
+          // when_all_range(first, last) does.
+          return unifex::connect(
+              sender_t(*next_), child_receiver<type>{&s});
+        } else {
+          // A std::move_iterator, or an iterator that produces senders by
+          // value.
+          return unifex::connect(*next_, child_receiver<type>{&s});
+        }
+      });
+      s.constructed_ = true;
+      ++next_;
+    }
+    UNIFEX_CATCH(...) {
+      ++next_;
+      on_error(s, std::current_exception());
+      return;
+    }
+    unifex::start(s.child_.get());
+  }
+
+  template <typename... Values>
+  void on_value(slot& s, Values&&... values) noexcept {
+    UNIFEX_TRY {
+      consumer_.on_value(s.index_, (Values &&) values...);
+    }
+    UNIFEX_CATCH(...) {
+      on_error(s, std::current_exception());
+      return;
+    }
+    child_complete(s);
+  }
+
+  template <typename Error>
+  void on_error(slot& s, Error&& error) noexcept {
+    {
+      std::lock_guard lk{mutex_};
+      if (!failed_) {
+        failed_ = true;
+        error_.emplace(
+            std::in_place_type<remove_cvref_t<Error>>, (Error &&) error);
+      }
+    }
+    stopSource_.request_stop();
+    child_complete(s);
+  }
+
+  void on_done(slot& s) noexcept {
+    {
+      std::lock_guard lk{mutex_};
+      failed_ = true;
+    }
+    stopSource_.request_stop();
+    child_complete(s);
+  }
+
+  // Returns the slot, and starts more children unless another thread
+  // already is. Nothing may touch *this after this returns without having
+  // become the pumping thread.
+  void child_complete(slot& s) noexcept {
+    std::unique_lock lk{mutex_};
+    s.nextFree_ = freeSlots_;
+    freeSlots_ = &s;
+    --active_;
+    if (!pumping_) {
+      pumping_ = true;
+      pump(lk);
+    }
+  }
+
+  void finish() noexcept {
+    stopCallback_.destruct();
+    if (error_.has_value()) {
+      std::visit(
+          [this](auto&& error) {
+            unifex::set_error(std::move(receiver_), std::move(error));
+          },
+          std::move(*error_));
+    } else if (failed_ || !(next_ == last_)) {
+      // A child completed with done, or stop was requested before all of
+      // the children had been started.
+      unifex::set_done(std::move(receiver_));
+    } else {
+      UNIFEX_TRY { consumer_.complete(std::move(receiver_)); }
+      UNIFEX_CATCH(...) {
+        unifex::set_error(std::move(receiver_), std::current_exception());
+      }
+    }
+  }
+
+  Iterator next_;
+  Sentinel last_;
+  Consumer consumer_;
+  Receiver receiver_;
+  UNIFEX_NO_UNIQUE_ADDRESS slot_allocator_t allocator_;
+  std::size_t slotCount_;
+  slot* slots_ = nullptr;
+
+  std::mutex mutex_;
+  slot* freeSlots_ = nullptr;
+  std::size_t started_ = 0;
+  std::size_t active_ = 0;
+  bool pumping_ = false;
+  bool failed_ = false;
+  std::optional<error_variant_t> error_;
+
+  inplace_stop_source stopSource_;
+  manual_lifetime<typename stop_token_type_t<
+      Receiver&>::template callback_type<cancel_callback>>
+      stopCallback_;
+};
+
+template <
+    typename Iterator,
+    typename Sentinel,
+    typename Consumer,
+    typename Allocator>
+struct _sender {
+  class type;
+};
+template <
+    typename Iterator,
+    typename Sentinel,
+    typename Consumer,
+    typename Allocator>
+using sender =
+    typename _sender<Iterator, Sentinel, Consumer, Allocator>::type;
+
+template <
+    typename Iterator,
+    typename Sentinel,
+    typename Consumer,
+    typename Allocator>
+class _sender<Iterator, Sentinel, Consumer, Allocator>::type {
+  using sender_t = child_sender_t<Iterator>;
+
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = typename Consumer::template value_types<Variant, Tuple>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename concat_type_lists_unique_t<
+      sender_error_types_t<sender_t, type_list>,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  static constexpr bool sends_done = true;
+
+  static constexpr blocking_kind blocking =
+      std::min(blocking_kind::maybe(), sender_traits<sender_t>::blocking());
+
+  template <typename Consumer2>
+  explicit type(
+      Iterator first,
+      Sentinel last,
+      std::size_t maxConcurrency,
+      Consumer2&& consumer,
+      const Allocator& allocator)
+    : first_(std::move(first))
+    , last_(std::move(last))
+    , maxConcurrency_(maxConcurrency)
+    , consumer_((Consumer2 &&) consumer)
+    , allocator_(allocator) {}
+
+  template(typename Receiver)           //
+      (requires receiver<Receiver>)     //
+      operation<Iterator, Sentinel, Consumer, Allocator, Receiver>
+      connect(Receiver&& r) && {
+    return operation<Iterator, Sentinel, Consumer, Allocator, Receiver>{
+        std::move(first_),
+        std::move(last_),
+        maxConcurrency_,
+        allocator_,
+        std::move(consumer_),
+        (Receiver &&) r};
+  }
+
+  template(typename Receiver)                                  //
+      (requires receiver<Receiver> AND                         //
+           copy_constructible<Iterator> AND                    //
+               copy_constructible<Sentinel> AND                //
+                   copy_constructible<Consumer>)               //
+      operation<Iterator, Sentinel, Consumer, Allocator, Receiver>
+      connect(Receiver&& r) const& {
+    return operation<Iterator, Sentinel, Consumer, Allocator, Receiver>{
+        first_, last_, maxConcurrency_, allocator_, consumer_, (Receiver &&) r};
+  }
+
+private:
+  Iterator first_;
+  Sentinel last_;
+  std::size_t maxConcurrency_;
+  Consumer consumer_;
+  UNIFEX_NO_UNIQUE_ADDRESS Allocator allocator_;
+};
+
+struct _fn {
+  template(
+      typename Iterator,
+      typename Sentinel,
+      typename Func,
+      typename Allocator = std::allocator<std::byte>)  //
+      (requires unifex::sender<child_sender_t<Iterator>>)  //
+      auto
+      operator()(
+          Iterator first,
+          Sentinel last,
+          std::size_t maxConcurrency,
+          Func&& func,
+          const Allocator& allocator = {}) const {
+    return sender<
+        Iterator,
+        Sentinel,
+        invoke_each<remove_cvref_t<Func>>,
+        Allocator>{
+        std::move(first),
+        std::move(last),
+        maxConcurrency,
+        invoke_each<remove_cvref_t<Func>>{(Func &&) func},
+        allocator};
+  }
+};
+
+template <
+    typename Iterator,
+    typename Sentinel,
+    typename Allocator = std::allocator<std::byte>>
+auto collect_concurrent(
+    Iterator first,
+    Sentinel last,
+    std::size_t maxConcurrency,
+    const Allocator& allocator = {}) {
+  using value_t = sender_single_value_result_t<child_sender_t<Iterator>>;
+  using consumer_t = collect<value_t, Allocator>;
+  return sender<Iterator, Sentinel, consumer_t, Allocator>{
+      std::move(first),
+      std::move(last),
+      maxConcurrency,
+      consumer_t{allocator},
+      allocator};
+}
+}  // namespace _for_each_conc
+
+// Connects and starts a sender for each element of [first, last), at most
+// maxConcurrency at a time, and calls func with the values that each sends,
+// in the order in which they complete. Senders that the iterators refer to
+// as lvalues are copied; pass std::move_iterator to move them instead.
+inline constexpr _for_each_conc::_fn for_each_concurrent{};
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
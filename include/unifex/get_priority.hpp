@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/tag_invoke.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+// The relative urgency of a piece of work, for schedulers that can run
+// more urgent work ahead of less urgent work.
+enum class priority : std::uint8_t { low, normal, high };
+
+inline constexpr std::size_t priority_count = 3;
+
+namespace _get_priority {
+struct _fn {
+  template(typename PriorityProvider)                         //
+      (requires tag_invocable<_fn, const PriorityProvider&>)  //
+      constexpr priority
+      operator()(const PriorityProvider& provider) const noexcept {
+    return tag_invoke(_fn{}, provider);
+  }
+
+  template(typename PriorityProvider)                           //
+      (requires(!tag_invocable<_fn, const PriorityProvider&>))  //
+      constexpr priority
+      operator()(const PriorityProvider&) const noexcept {
+    return priority::normal;
+  }
+};
+}  // namespace _get_priority
+
+// Queries the priority of a scheduler, or of the work a receiver belongs
+// to. Like other queries, it is forwarded through receivers, so
+// with_query_value(sender, get_priority, priority::high) sets the priority
+// for everything that sender starts. Defaults to priority::normal.
+inline constexpr _get_priority::_fn get_priority{};
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
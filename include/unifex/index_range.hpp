@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+// The half-open range of indices [first, last) that a chunked bulk
+// sender passes to set_next() in place of one call per index.
+template <typename Integral>
+struct index_range {
+  class iterator {
+  public:
+    using value_type = Integral;
+    using difference_type = std::ptrdiff_t;
+    using reference = Integral;
+    using pointer = void;
+    using iterator_category = std::input_iterator_tag;
+
+    constexpr iterator() noexcept = default;
+    constexpr explicit iterator(Integral index) noexcept : index_(index) {}
+
+    constexpr Integral operator*() const noexcept { return index_; }
+
+    constexpr iterator& operator++() noexcept {
+      ++index_;
+      return *this;
+    }
+    constexpr iterator operator++(int) noexcept {
+      iterator prev = *this;
+      ++index_;
+      return prev;
+    }
+
+    friend constexpr bool operator==(iterator a, iterator b) noexcept {
+      return a.index_ == b.index_;
+    }
+    friend constexpr bool operator!=(iterator a, iterator b) noexcept {
+      return a.index_ != b.index_;
+    }
+
+  private:
+    Integral index_{};
+  };
+
+  Integral first;
+  Integral last;
+
+  constexpr iterator begin() const noexcept { return iterator{first}; }
+  constexpr iterator end() const noexcept { return iterator{last}; }
+  constexpr Integral size() const noexcept { return Integral(last - first); }
+  constexpr bool empty() const noexcept { return !(first < last); }
+};
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -19,14 +19,25 @@
 #include <unifex/bind_back.hpp>
 #include <unifex/blocking.hpp>
 #include <unifex/continuations.hpp>
+#include <unifex/execution_policy.hpp>
 #include <unifex/get_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/std_concepts.hpp>
 #include <unifex/type_list.hpp>
 #include <unifex/type_traits.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <tuple>
 #include <type_traits>
 
 namespace execution {
@@ -38,72 +49,336 @@ class parallel_policy;
 
 namespace unifex {
 namespace _ifor {
-template <typename Policy, typename Range, typename Func, typename Receiver>
+// Used in place of a scheduler to run parallel loops on the scheduler
+// that get_scheduler() returns for the receiver, if there is one.
+struct receiver_scheduler {};
+
+template <typename Policy>
+inline constexpr bool is_parallel_policy_v = is_one_of_v<
+    Policy,
+    execution::parallel_policy,
+    parallel_policy,
+    parallel_unsequenced_policy>;
+
+template <typename Range>
+inline constexpr bool is_random_access_range_v = std::is_base_of_v<
+    std::random_access_iterator_tag,
+    typename std::iterator_traits<
+        typename Range::iterator>::iterator_category>;
+
+// Whether the loop may be split into chunks that run concurrently.
+template <typename Policy, typename Range>
+inline constexpr bool is_parallel_loop_v =
+    is_parallel_policy_v<Policy> && is_random_access_range_v<Range>;
+
+template <typename Scheduler, typename Receiver>
+struct _loop_scheduler {
+  using type = Scheduler;
+};
+template <typename Receiver, bool = scheduler_provider<const Receiver&>>
+struct _receiver_scheduler {
+  using type = void;
+};
+template <typename Receiver>
+struct _receiver_scheduler<Receiver, true> {
+  using type = remove_cvref_t<get_scheduler_result_t<const Receiver&>>;
+};
+template <typename Receiver>
+struct _loop_scheduler<receiver_scheduler, Receiver>
+  : _receiver_scheduler<Receiver> {};
+
+// The scheduler that chunks of a parallel loop run on, or void if there
+// isn't one.
+template <typename Scheduler, typename Receiver>
+using loop_scheduler_t = typename _loop_scheduler<Scheduler, Receiver>::type;
+
+// A few chunks per hardware thread, so that uneven chunks and other work
+// on the scheduler don't leave threads idle at the end of the loop.
+inline std::size_t max_parallel_chunks() noexcept {
+  static const std::size_t maxChunks =
+      4 * std::max(1u, std::thread::hardware_concurrency());
+  return maxChunks;
+}
+
+template <
+    typename Range,
+    typename Func,
+    typename Receiver,
+    typename Scheduler,
+    typename... Values>
+struct _par_op {
+  class type;
+};
+template <
+    typename Range,
+    typename Func,
+    typename Receiver,
+    typename Scheduler,
+    typename... Values>
+using parallel_operation =
+    typename _par_op<Range, Func, Receiver, Scheduler, Values...>::type;
+
+// The state of a loop that has been split into chunks. It is allocated
+// when the predecessor completes and frees itself before completing the
+// receiver.
+template <
+    typename Range,
+    typename Func,
+    typename Receiver,
+    typename Scheduler,
+    typename... Values>
+class _par_op<Range, Func, Receiver, Scheduler, Values...>::type {
+  class chunk_receiver {
+  public:
+    explicit chunk_receiver(type* op, std::size_t chunk) noexcept
+      : op_(op)
+      , chunk_(chunk) {}
+
+    void set_value() && noexcept { op_->run_chunk(chunk_); }
+
+    template <typename Error>
+    void set_error(Error&& error) && noexcept {
+      if constexpr (std::is_same_v<remove_cvref_t<Error>, std::exception_ptr>) {
+        op_->finish_early(failed, (Error &&) error);
+      } else {
+        op_->finish_early(failed, std::make_exception_ptr((Error &&) error));
+      }
+      op_->chunk_done();
+    }
+
+    void set_done() && noexcept {
+      op_->finish_early(cancelled, nullptr);
+      op_->chunk_done();
+    }
+
+    template(typename CPO)                       //
+        (requires is_receiver_query_cpo_v<CPO>)  //
+        friend auto tag_invoke(CPO cpo, const chunk_receiver& r) noexcept(
+            std::is_nothrow_invocable_v<CPO, const Receiver&>)
+            -> std::invoke_result_t<CPO, const Receiver&> {
+      return std::move(cpo)(r.get_receiver());
+    }
+
+  private:
+    const Receiver& get_receiver() const noexcept { return op_->receiver_; }
+
+    type* op_;
+    std::size_t chunk_;
+  };
+
+  using chunk_op_t =
+      connect_result_t<schedule_result_t<Scheduler&>, chunk_receiver>;
+
+  enum state { running, failed, cancelled };
+
+public:
+  template <typename... Values2>
+  explicit type(
+      Range& range,
+      Func& func,
+      Receiver& receiver,
+      Scheduler scheduler,
+      std::size_t chunks,
+      Values2&&... values)
+    : range_(range)
+    , func_(func)
+    , receiver_(receiver)
+    , scheduler_(std::move(scheduler))
+    , values_((Values2 &&) values...)
+    , chunks_(chunks)
+    , remaining_(chunks)
+    , ops_(std::make_unique<manual_lifetime<chunk_op_t>[]>(chunks)) {}
+
+  // Runs the first chunk on the calling thread and schedules the others.
+  void start() noexcept {
+    UNIFEX_TRY {
+      for (; connected_ < chunks_; ++connected_) {
+        ops_[connected_].construct_with([&] {
+          return unifex::connect(
+              unifex::schedule(scheduler_),
+              chunk_receiver{this, connected_});
+        });
+      }
+    }
+    UNIFEX_CATCH(...) {
+      finish_early(failed, std::current_exception());
+      complete();
+      return;
+    }
+
+    for (std::size_t chunk = 1; chunk < chunks_; ++chunk) {
+      unifex::start(ops_[chunk].get());
+    }
+    run_chunk(0);
+  }
+
+private:
+  void run_chunk(std::size_t chunk) noexcept {
+    if (state_.load(std::memory_order_relaxed) == running) {
+      auto first = range_.begin();
+      const std::size_t size = range_.size();
+      const std::size_t end = size * (chunk + 1) / chunks_;
+      UNIFEX_TRY {
+        for (std::size_t idx = size * chunk / chunks_; idx < end; ++idx) {
+          std::apply(
+              [&](Values&... values) {
+                std::invoke(func_, first[idx], values...);
+              },
+              values_);
+        }
+      }
+      UNIFEX_CATCH(...) { finish_early(failed, std::current_exception()); }
+    }
+    chunk_done();
+  }
+
+  // The first error or cancellation wins, and stops chunks that haven't
+  // started yet from running.
+  void finish_early(state s, std::exception_ptr error) noexcept {
+    int expected = running;
+    if (state_.compare_exchange_strong(
+            expected, s, std::memory_order_relaxed)) {
+      error_ = std::move(error);
+    }
+  }
+
+  void chunk_done() noexcept {
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      complete();
+    }
+  }
+
+  void complete() noexcept {
+    // Chunk 0 runs inline, without an operation.
+    for (std::size_t chunk = 1; chunk < connected_; ++chunk) {
+      ops_[chunk].destruct();
+    }
+
+    std::unique_ptr<type> self{this};
+    Receiver& receiver = receiver_;
+    switch (state_.load(std::memory_order_relaxed)) {
+      case running:
+        UNIFEX_TRY {
+          std::tuple<Values...> values = std::move(values_);
+          self.reset();
+          std::apply(
+              [&](Values&... vs) {
+                unifex::set_value(
+                    static_cast<Receiver&&>(receiver), std::move(vs)...);
+              },
+              values);
+        }
+        UNIFEX_CATCH(...) {
+          unifex::set_error(
+              static_cast<Receiver&&>(receiver), std::current_exception());
+        }
+        break;
+      case failed: {
+        std::exception_ptr error = std::move(error_);
+        self.reset();
+        unifex::set_error(static_cast<Receiver&&>(receiver), std::move(error));
+        break;
+      }
+      case cancelled:
+        self.reset();
+        unifex::set_done(static_cast<Receiver&&>(receiver));
+        break;
+    }
+  }
+
+  Range& range_;
+  Func& func_;
+  Receiver& receiver_;
+  UNIFEX_NO_UNIQUE_ADDRESS Scheduler scheduler_;
+  std::tuple<Values...> values_;
+  const std::size_t chunks_;
+  std::size_t connected_ = 1;
+  std::atomic<std::size_t> remaining_;
+  std::atomic<int> state_{running};
+  std::exception_ptr error_;
+  std::unique_ptr<manual_lifetime<chunk_op_t>[]> ops_;
+};
+
+template <
+    typename Policy,
+    typename Range,
+    typename Func,
+    typename Receiver,
+    typename Scheduler>
 struct _receiver {
   struct type;
 };
-template <typename Policy, typename Range, typename Func, typename Receiver>
-using receiver_t =
-    typename _receiver<Policy, Range, Func, remove_cvref_t<Receiver>>::type;
-template <typename Policy, typename Range, typename Func, typename Receiver>
-struct _receiver<Policy, Range, Func, Receiver>::type {
+template <
+    typename Policy,
+    typename Range,
+    typename Func,
+    typename Receiver,
+    typename Scheduler>
+using receiver_t = typename _receiver<
+    Policy,
+    Range,
+    Func,
+    remove_cvref_t<Receiver>,
+    Scheduler>::type;
+template <
+    typename Policy,
+    typename Range,
+    typename Func,
+    typename Receiver,
+    typename Scheduler>
+struct _receiver<Policy, Range, Func, Receiver, Scheduler>::type {
   UNIFEX_NO_UNIQUE_ADDRESS Func func_;
   UNIFEX_NO_UNIQUE_ADDRESS Policy policy_;
   UNIFEX_NO_UNIQUE_ADDRESS Range range_;
   UNIFEX_NO_UNIQUE_ADDRESS Receiver receiver_;
+  UNIFEX_NO_UNIQUE_ADDRESS Scheduler scheduler_;
 
-  // sequenced_policy version supports forward range
-  template <typename... Values>
-  static void apply_func_with_policy(
-      const execution::sequenced_policy&,
-      Range&& range,
-      Func&& func,
-      Values&... values) noexcept(std::
-                                      is_nothrow_invocable_v<
-                                          Func,
-                                          typename std::iterator_traits<
-                                              typename Range::iterator>::
-                                              reference,
-                                          Values...>) {
-    for (auto idx : range) {
-      std::invoke(func, idx, values...);
-    }
-  }
-
-  // parallel_policy version requires random access range
+  using loop_scheduler = loop_scheduler_t<Scheduler, Receiver>;
+
+  // Parallel policies over a random access range index into the range;
+  // otherwise, including for a forward range, iterate it in order.
   template <typename... Values>
-  static void apply_func_with_policy(
-      const execution::parallel_policy&,
-      Range&& range,
-      Func&& func,
-      Values&... values) noexcept(std::
-                                      is_nothrow_invocable_v<
-                                          Func,
-                                          typename std::iterator_traits<
-                                              typename Range::iterator>::
-                                              reference,
-                                          Values...>) {
-    auto first = range.begin();
-    using size_type = decltype(range.size());
-    for (size_type idx = 0; idx < range.size(); ++idx) {
-      std::invoke(func, first[idx], values...);
+  static void apply_func(Range& range, Func& func, Values&... values) noexcept(
+      std::is_nothrow_invocable_v<
+          Func&,
+          typename std::iterator_traits<typename Range::iterator>::reference,
+          Values&...>) {
+    if constexpr (is_parallel_loop_v<Policy, Range>) {
+      auto first = range.begin();
+      using size_type = decltype(range.size());
+      for (size_type idx = 0; idx < range.size(); ++idx) {
+        std::invoke(func, first[idx], values...);
+      }
+    } else {
+      for (auto idx : range) {
+        std::invoke(func, idx, values...);
+      }
     }
   }
 
   template <typename... Values>
   void set_value(Values&&... values) && noexcept {
+    if constexpr (
+        is_parallel_loop_v<Policy, Range> &&
+        !std::is_void_v<loop_scheduler>) {
+      const std::size_t chunks = std::min<std::size_t>(
+          static_cast<std::size_t>(range_.size()), max_parallel_chunks());
+      if (chunks > 1) {
+        start_parallel(chunks, (Values &&) values...);
+        return;
+      }
+    }
+
     if constexpr (std::is_nothrow_invocable_v<
                       Func&,
                       typename std::iterator_traits<
                           typename Range::iterator>::reference,
                       Values...>) {
-      apply_func_with_policy(
-          policy_, (Range&&)range_, (Func&&)func_, values...);
+      apply_func(range_, func_, values...);
       unifex::set_value((Receiver&&)receiver_, (Values&&)values...);
     } else {
       UNIFEX_TRY {
-        apply_func_with_policy(
-            policy_, (Range&&)range_, (Func&&)func_, values...);
+        apply_func(range_, func_, values...);
         unifex::set_value((Receiver&&)receiver_, (Values&&)values...);
       }
       UNIFEX_CATCH(...) {
@@ -134,26 +409,82 @@ struct _receiver<Policy, Range, Func, Receiver>::type {
     std::invoke(visit, r.receiver_);
   }
 #endif
+
+private:
+  loop_scheduler get_loop_scheduler() const noexcept {
+    if constexpr (std::is_same_v<Scheduler, receiver_scheduler>) {
+      return get_scheduler(receiver_);
+    } else {
+      return scheduler_;
+    }
+  }
+
+  template <typename... Values>
+  void start_parallel(std::size_t chunks, Values&&... values) noexcept {
+    using op_t = parallel_operation<
+        Range,
+        Func,
+        Receiver,
+        loop_scheduler,
+        std::decay_t<Values>...>;
+    op_t* op = nullptr;
+    UNIFEX_TRY {
+      op = new op_t{
+          range_,
+          func_,
+          receiver_,
+          get_loop_scheduler(),
+          chunks,
+          (Values &&) values...};
+    }
+    UNIFEX_CATCH(...) {
+      unifex::set_error((Receiver&&)receiver_, std::current_exception());
+      return;
+    }
+    op->start();
+  }
 };
 
-template <typename Predecessor, typename Policy, typename Range, typename Func>
+template <
+    typename Predecessor,
+    typename Policy,
+    typename Range,
+    typename Func,
+    typename Scheduler>
 struct _sender {
   struct type;
 };
-template <typename Predecessor, typename Policy, typename Range, typename Func>
+template <
+    typename Predecessor,
+    typename Policy,
+    typename Range,
+    typename Func,
+    typename Scheduler = receiver_scheduler>
 using sender = typename _sender<
     remove_cvref_t<Predecessor>,
     std::decay_t<Policy>,
     std::decay_t<Range>,
-    std::decay_t<Func>>::type;
+    std::decay_t<Func>,
+    remove_cvref_t<Scheduler>>::type;
 
-template <typename Predecessor, typename Policy, typename Range, typename Func>
-struct _sender<Predecessor, Policy, Range, Func>::type {
+template <
+    typename Predecessor,
+    typename Policy,
+    typename Range,
+    typename Func,
+    typename Scheduler>
+struct _sender<Predecessor, Policy, Range, Func, Scheduler>::type {
   using sender = type;
   UNIFEX_NO_UNIQUE_ADDRESS Predecessor pred_;
   UNIFEX_NO_UNIQUE_ADDRESS Policy policy_;
   UNIFEX_NO_UNIQUE_ADDRESS Range range_;
   UNIFEX_NO_UNIQUE_ADDRESS Func func_;
+  UNIFEX_NO_UNIQUE_ADDRESS Scheduler scheduler_;
+
+  // Chunks of a parallel loop may complete on another thread, or be
+  // cancelled before they run.
+  static constexpr bool may_run_in_parallel =
+      is_parallel_loop_v<Policy, Range>;
 
   template <
       template <typename...>
@@ -167,40 +498,77 @@ struct _sender<Predecessor, Policy, Range, Func>::type {
       sender_error_types_t<Predecessor, type_list>,
       type_list<std::exception_ptr>>::template apply<Variant>;
 
-  static constexpr bool sends_done = sender_traits<Predecessor>::sends_done;
+  static constexpr bool sends_done =
+      sender_traits<Predecessor>::sends_done || may_run_in_parallel;
 
-  static constexpr blocking_kind blocking =
-      sender_traits<Predecessor>::blocking;
+  static constexpr blocking_kind blocking = may_run_in_parallel &&
+          sender_traits<Predecessor>::blocking != blocking_kind::never
+      ? blocking_kind::maybe
+      : sender_traits<Predecessor>::blocking;
 
   static constexpr bool is_always_scheduler_affine =
-      sender_traits<Predecessor>::is_always_scheduler_affine;
+      sender_traits<Predecessor>::is_always_scheduler_affine &&
+      !may_run_in_parallel;
 
   friend constexpr blocking_kind
   tag_invoke(tag_t<blocking>, const sender& sender) {
-    return unifex::blocking(sender.pred_);
+    const blocking_kind predBlocking = unifex::blocking(sender.pred_);
+    if (may_run_in_parallel && predBlocking != blocking_kind::never) {
+      return blocking_kind::maybe;
+    }
+    return predBlocking;
   }
 
   template <typename Receiver>
   auto connect(Receiver&& receiver) && {
     return unifex::connect(
         std::move(pred_),
-        _ifor::receiver_t<Policy, Range, Func, Receiver>{
+        _ifor::receiver_t<Policy, Range, Func, Receiver, Scheduler>{
             (Func&&)func_,
             (Policy&&)policy_,
             (Range&&)range_,
-            (Receiver&&)receiver});
+            (Receiver&&)receiver,
+            (Scheduler&&)scheduler_});
   }
 };
 }  // namespace _ifor
 
 namespace _ifor_cpo {
 struct _fn {
-  template <typename Sender, typename Policy, typename Range, typename Func>
-  auto
-  operator()(Sender&& predecessor, Policy&& policy, Range&& range, Func&& func)
-      const -> _ifor::sender<Sender, Policy, Range, Func> {
+  template(typename Sender, typename Policy, typename Range, typename Func)  //
+      (requires(!scheduler<Sender>))                                         //
+      auto
+      operator()(
+          Sender&& predecessor, Policy&& policy, Range&& range, Func&& func)
+          const -> _ifor::sender<Sender, Policy, Range, Func> {
     return _ifor::sender<Sender, Policy, Range, Func>{
-        (Sender&&)predecessor, (Policy&&)policy, (Range&&)range, (Func&&)func};
+        (Sender&&)predecessor,
+        (Policy&&)policy,
+        (Range&&)range,
+        (Func&&)func,
+        _ifor::receiver_scheduler{}};
+  }
+  template(
+      typename Sender,
+      typename Scheduler,
+      typename Policy,
+      typename Range,
+      typename Func)                    //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Sender&& predecessor,
+          Scheduler&& sched,
+          Policy&& policy,
+          Range&& range,
+          Func&& func) const
+      -> _ifor::sender<Sender, Policy, Range, Func, Scheduler> {
+    return _ifor::sender<Sender, Policy, Range, Func, Scheduler>{
+        (Sender&&)predecessor,
+        (Policy&&)policy,
+        (Range&&)range,
+        (Func&&)func,
+        (Scheduler&&)sched};
   }
   template <typename Policy, typename Range, typename Func>
   constexpr auto
@@ -209,8 +577,41 @@ struct _fn {
       -> bind_back_result_t<_fn, Policy, Range, Func> {
     return bind_back(*this, (Policy&&)policy, (Range&&)range, (Func&&)f);
   }
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Range,
+      typename Func)                    //
+      (requires scheduler<Scheduler>)  //
+      constexpr auto
+      operator()(Scheduler&& sched, Policy&& policy, Range&& range, Func&& f)
+          const noexcept(std::is_nothrow_invocable_v<
+                         tag_t<bind_back>,
+                         _fn,
+                         Scheduler,
+                         Policy,
+                         Range,
+                         Func>)
+              -> bind_back_result_t<_fn, Scheduler, Policy, Range, Func> {
+    return bind_back(
+        *this,
+        (Scheduler&&)sched,
+        (Policy&&)policy,
+        (Range&&)range,
+        (Func&&)f);
+  }
 } indexed_for{};
 }  // namespace _ifor_cpo
+
+// indexed_for(predecessor, [scheduler,] policy, range, func) invokes
+// func(idx, values...) for each idx in range, passing the predecessor's
+// values as lvalues, and then forwards those values.
+//
+// With a parallel policy (execution::par, par or par_unseq) and a random
+// access range, the loop is split into chunks: one runs on the thread on
+// which the predecessor completed and the others are scheduled on the
+// given scheduler or, without one, on get_scheduler() of the receiver.
+// Otherwise the loop runs sequentially on that thread.
 using _ifor_cpo::indexed_for;
 
 }  // namespace unifex
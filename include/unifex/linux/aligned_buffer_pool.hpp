@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/exception.hpp>
+#include <unifex/span.hpp>
+
+#include <unifex/linux/mmap_region.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace linuxos {
+
+// A fixed set of equally sized buffers carved out of a single anonymous
+// memory mapping, each aligned for direct I/O.
+//
+// Buffers are handed out as move-only leases that return themselves to the
+// pool on destruction. The pool does no synchronisation of its own and is
+// intended to be used from a single thread, eg. the thread driving the
+// requests that use the buffers. It must outlive all of its leases.
+class aligned_buffer_pool {
+public:
+  class buffer {
+  public:
+    buffer() noexcept = default;
+
+    buffer(buffer&& other) noexcept
+      : pool_(std::exchange(other.pool_, nullptr))
+      , data_(std::exchange(other.data_, nullptr)) {}
+
+    ~buffer() { reset(); }
+
+    buffer& operator=(buffer other) noexcept {
+      std::swap(pool_, other.pool_);
+      std::swap(data_, other.data_);
+      return *this;
+    }
+
+    // Return the buffer to the pool early.
+    void reset() noexcept {
+      if (pool_ != nullptr) {
+        pool_->release(std::exchange(data_, nullptr));
+        pool_ = nullptr;
+      }
+    }
+
+    explicit operator bool() const noexcept { return data_ != nullptr; }
+
+    span<std::byte> data() const noexcept {
+      return span<std::byte>{data_, pool_ ? pool_->bufferSize_ : 0};
+    }
+
+    std::size_t size() const noexcept {
+      return pool_ ? pool_->bufferSize_ : 0;
+    }
+
+  private:
+    friend aligned_buffer_pool;
+
+    explicit buffer(aligned_buffer_pool& pool, std::byte* data) noexcept
+      : pool_(&pool)
+      , data_(data) {}
+
+    aligned_buffer_pool* pool_ = nullptr;
+    std::byte* data_ = nullptr;
+  };
+
+  // Maps memory for 'count' buffers of 'bufferSize' bytes each.
+  // 'alignment' must be a power of two; buffer sizes are rounded up to a
+  // multiple of it.
+  explicit aligned_buffer_pool(
+      std::size_t bufferSize,
+      std::size_t count,
+      std::size_t alignment = 4096)
+    : bufferSize_(round_up(bufferSize, alignment)) {
+    UNIFEX_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+    // mmap() only guarantees page alignment, so over-allocate if more is
+    // needed.
+    const auto pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t slack = alignment > pageSize ? alignment : 0;
+    const std::size_t size = bufferSize_ * count + slack;
+    if (size == 0) {
+      return;
+    }
+
+    void* ptr = ::mmap(
+        nullptr,
+        size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+        -1,
+        0);
+    if (ptr == MAP_FAILED) {
+      int errorCode = errno;
+      throw_(std::system_error{errorCode, std::system_category()});
+    }
+    region_ = mmap_region{ptr, size};
+
+    auto* first = static_cast<std::byte*>(ptr) +
+        (round_up(reinterpret_cast<std::uintptr_t>(ptr), alignment) -
+         reinterpret_cast<std::uintptr_t>(ptr));
+
+    // Hand out buffers in address order.
+    freeList_.reserve(count);
+    for (std::size_t i = count; i > 0; --i) {
+      freeList_.push_back(first + (i - 1) * bufferSize_);
+    }
+  }
+
+  aligned_buffer_pool(aligned_buffer_pool&&) = delete;
+
+  // Lease a buffer, or an empty buffer if all are in use.
+  buffer try_acquire() noexcept {
+    if (freeList_.empty()) {
+      return buffer{};
+    }
+    std::byte* data = freeList_.back();
+    freeList_.pop_back();
+    return buffer{*this, data};
+  }
+
+  std::size_t buffer_size() const noexcept { return bufferSize_; }
+
+  std::size_t available() const noexcept { return freeList_.size(); }
+
+private:
+  static std::size_t
+  round_up(std::size_t value, std::size_t alignment) noexcept {
+    return (value + alignment - 1) & ~(alignment - 1);
+  }
+
+  void release(std::byte* data) noexcept {
+    // Never reallocates since the capacity covers every buffer.
+    freeList_.push_back(data);
+  }
+
+  std::size_t bufferSize_;
+  mmap_region region_;
+  std::vector<std::byte*> freeList_;
+};
+
+}  // namespace linuxos
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/defer.hpp>
+#include <unifex/exception.hpp>
+#include <unifex/let_value_with.hpp>
+#include <unifex/pipe_concepts.hpp>
+#include <unifex/repeat_effect_until.hpp>
+#include <unifex/then.hpp>
+#include <unifex/when_all.hpp>
+
+#include <unifex/linux/safe_file_descriptor.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace linuxos {
+namespace _transfer {
+// Size of the intermediate pipe. Reading into the pipe overlaps with
+// writing out of it, so this bounds the number of bytes in flight.
+inline constexpr std::size_t default_chunk_size = 64 * 1024;
+
+class state {
+public:
+  explicit state(std::size_t bytes, std::size_t chunkSize)
+    : remaining_(bytes)
+    , chunkSize_(chunkSize) {
+    int fds[2];
+    if (::pipe2(fds, O_CLOEXEC) < 0) {
+      throw_(std::system_error{errno, std::system_category(), "pipe2"});
+    }
+    pipeRead_ = safe_file_descriptor{fds[0]};
+    pipeWrite_ = safe_file_descriptor{fds[1]};
+
+    // Best effort: the kernel may round the size up to a power-of-two
+    // number of pages, or refuse sizes above /proc/sys/fs/pipe-max-size.
+    (void)::fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(chunkSize));
+  }
+
+  int pipe_read() const noexcept { return pipeRead_.get(); }
+  int pipe_write() const noexcept { return pipeWrite_.get(); }
+
+  std::size_t chunk_size() const noexcept { return chunkSize_; }
+
+  std::size_t next_chunk() const noexcept {
+    return std::min(chunkSize_, remaining_);
+  }
+
+  void on_filled(ssize_t bytes) noexcept {
+    const auto count = static_cast<std::size_t>(bytes);
+    eof_ = (count == 0);
+    remaining_ -= count;
+  }
+
+  bool filled() const noexcept { return eof_ || remaining_ == 0; }
+
+  // Once the write end is closed, draining the pipe ends with end-of-file
+  // after the last buffered byte.
+  void close_pipe_write() noexcept { pipeWrite_.close(); }
+
+  void on_drained(ssize_t bytes) noexcept {
+    const auto count = static_cast<std::size_t>(bytes);
+    drained_ = (count == 0);
+    transferred_ += count;
+  }
+
+  bool drained() const noexcept { return drained_; }
+
+  std::size_t transferred() const noexcept { return transferred_; }
+
+private:
+  safe_file_descriptor pipeRead_;
+  safe_file_descriptor pipeWrite_;
+  std::size_t remaining_;
+  std::size_t chunkSize_;
+  std::size_t transferred_ = 0;
+  bool eof_ = false;
+  bool drained_ = false;
+};
+}  // namespace _transfer
+
+namespace _transfer_cpo {
+// async_transfer(scheduler, fdIn, fdOut, bytes[, chunkSize])
+//
+// Returns a sender that moves up to 'bytes' bytes from 'fdIn' to 'fdOut'
+// by splicing them through a private pipe, so that the data never crosses
+// into user space. Neither file descriptor needs to be a pipe, which makes
+// this suitable for socket-to-socket proxying and file-to-socket sends.
+//
+// Filling the pipe from 'fdIn' and draining it into 'fdOut' run
+// concurrently, each waiting only while the pipe is full or empty
+// respectively. The pipe is sized to 'chunkSize', which bounds the number
+// of bytes in flight.
+//
+// Completes with the number of bytes transferred, which is less than
+// 'bytes' only if 'fdIn' reached end-of-file first.
+inline const struct _fn {
+  template <typename Scheduler>
+  auto operator()(
+      Scheduler sched,
+      int fdIn,
+      int fdOut,
+      std::size_t bytes,
+      std::size_t chunkSize = _transfer::default_chunk_size) const {
+    return let_value_with(
+        [bytes, chunkSize] { return _transfer::state{bytes, chunkSize}; },
+        [sched, fdIn, fdOut](_transfer::state& state) {
+          auto fill =
+              repeat_effect_until(
+                  defer([sched, fdIn, &state]() noexcept {
+                    return async_splice(
+                               sched,
+                               fdIn,
+                               splice_no_offset,
+                               state.pipe_write(),
+                               splice_no_offset,
+                               state.next_chunk()) |
+                        then([&state](ssize_t bytes) noexcept {
+                          state.on_filled(bytes);
+                        });
+                  }),
+                  [&state]() noexcept { return state.filled(); }) |
+              then([&state]() noexcept { state.close_pipe_write(); });
+          auto drain = repeat_effect_until(
+              defer([sched, fdOut, &state]() noexcept {
+                return async_splice(
+                           sched,
+                           state.pipe_read(),
+                           splice_no_offset,
+                           fdOut,
+                           splice_no_offset,
+                           state.chunk_size()) |
+                    then([&state](ssize_t bytes) noexcept {
+                      state.on_drained(bytes);
+                    });
+              }),
+              [&state]() noexcept { return state.drained(); });
+          return when_all(std::move(fill), std::move(drain)) |
+              then([&state](auto&&...) noexcept {
+                return state.transferred();
+              });
+        });
+  }
+} async_transfer{};
+}  // namespace _transfer_cpo
+
+using _transfer_cpo::async_transfer;
+}  // namespace linuxos
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
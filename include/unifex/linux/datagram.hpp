@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/exception.hpp>
+#include <unifex/just_done.hpp>
+#include <unifex/socket_concepts.hpp>
+#include <unifex/span.hpp>
+#include <unifex/then.hpp>
+
+#include <unifex/linux/safe_file_descriptor.hpp>
+#include <unifex/linux/socket_address.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace linuxos {
+
+// One message slot for async_recv_batch()/async_send_batch().
+//
+// On receive, 'buffer' is the storage to receive into and the remaining
+// fields are filled in. On send, the first 'size' bytes of 'buffer' are sent
+// to 'peer', or to the connected peer if 'peer' is empty.
+//
+// 'segment_size' is non-zero when the slot holds several equally sized
+// datagrams back to back: received with UDP_GRO enabled, or sent with
+// UDP_SEGMENT (GSO) so that the kernel splits the payload.
+struct datagram {
+  span<std::byte> buffer;
+  std::size_t size = 0;
+  socket_address peer;
+  std::uint16_t segment_size = 0;
+};
+
+// Enables UDP_GRO on 'fd' so that the kernel may coalesce consecutive
+// datagrams from the same flow into one slot. Slots then need room for up to
+// 64 KiB. Returns false if the kernel does not support it.
+inline bool enable_udp_gro(int fd) noexcept {
+#ifdef UDP_GRO
+  int on = 1;
+  return ::setsockopt(fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
+namespace _dgram {
+inline safe_file_descriptor open_socket(const socket_address& address) {
+  safe_file_descriptor fd{::socket(
+      address.family(), SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+  if (!fd.valid()) {
+    int errorCode = errno;
+    throw_(std::system_error{errorCode, std::system_category(), "socket"});
+  }
+  if (::bind(fd.get(), address.data(), address.size()) < 0) {
+    int errorCode = errno;
+    throw_(std::system_error{errorCode, std::system_category(), "bind"});
+  }
+  return fd;
+}
+
+// The scratch space that an in-flight batch hands to recvmmsg()/sendmmsg().
+// It lives in the operation state so that a batch does not allocate.
+class message_batch {
+public:
+  // Slots beyond this are left for the next batch.
+  static constexpr std::size_t max_slots = 64;
+
+  explicit message_batch(span<datagram> slots) noexcept
+    : slots_(slots.data())
+    , count_(std::min(slots.size(), max_slots)) {}
+
+  // Returns the number of slots filled in, or -errno.
+  int receive(int fd) noexcept {
+    for (std::size_t i = 0; i < count_; ++i) {
+      datagram& slot = slots_[i];
+      iovecs_[i].iov_base = slot.buffer.data();
+      iovecs_[i].iov_len = slot.buffer.size();
+      msghdr& header = headers_[i].msg_hdr;
+      header.msg_name = slot.peer.data();
+      header.msg_namelen = socket_address::capacity();
+      header.msg_iov = &iovecs_[i];
+      header.msg_iovlen = 1;
+      header.msg_control = control_[i].bytes;
+      header.msg_controllen = sizeof(control_[i].bytes);
+      header.msg_flags = 0;
+    }
+
+    const int count = ::recvmmsg(
+        fd, headers_, static_cast<unsigned>(count_), MSG_DONTWAIT, nullptr);
+    if (count < 0) {
+      return -errno;
+    }
+
+    for (int i = 0; i < count; ++i) {
+      datagram& slot = slots_[i];
+      msghdr& header = headers_[i].msg_hdr;
+      slot.size = headers_[i].msg_len;
+      slot.peer.resize(header.msg_namelen);
+      slot.segment_size = 0;
+#ifdef UDP_GRO
+      for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+           cmsg = CMSG_NXTHDR(&header, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+          int segmentSize;
+          std::memcpy(&segmentSize, CMSG_DATA(cmsg), sizeof(segmentSize));
+          slot.segment_size = static_cast<std::uint16_t>(segmentSize);
+        }
+      }
+#endif
+    }
+    return count;
+  }
+
+  // Returns the number of slots sent, or -errno.
+  int send(int fd) noexcept {
+    for (std::size_t i = 0; i < count_; ++i) {
+      datagram& slot = slots_[i];
+      iovecs_[i].iov_base = slot.buffer.data();
+      iovecs_[i].iov_len = slot.size;
+      msghdr& header = headers_[i].msg_hdr;
+      header.msg_name = slot.peer.size() != 0 ? slot.peer.data() : nullptr;
+      header.msg_namelen = slot.peer.size();
+      header.msg_iov = &iovecs_[i];
+      header.msg_iovlen = 1;
+      header.msg_control = nullptr;
+      header.msg_controllen = 0;
+      header.msg_flags = 0;
+#ifdef UDP_SEGMENT
+      if (slot.segment_size != 0) {
+        header.msg_control = control_[i].bytes;
+        header.msg_controllen = CMSG_SPACE(sizeof(std::uint16_t));
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&header);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+        std::memcpy(
+            CMSG_DATA(cmsg), &slot.segment_size, sizeof(slot.segment_size));
+      }
+#endif
+    }
+
+    const int count = ::sendmmsg(
+        fd, headers_, static_cast<unsigned>(count_), MSG_DONTWAIT);
+    return count < 0 ? -errno : count;
+  }
+
+private:
+  struct control_buffer {
+    alignas(cmsghdr) char bytes[CMSG_SPACE(sizeof(int))];
+  };
+
+  datagram* slots_;
+  std::size_t count_;
+  mmsghdr headers_[max_slots];
+  iovec iovecs_[max_slots];
+  control_buffer control_[max_slots];
+};
+}  // namespace _dgram
+
+namespace _recv_stream {
+template <typename Socket>
+struct _stream {
+  class type;
+};
+
+// A stream that produces the filled-in prefix of 'slots' for every batch
+// received on 'socket'. The slots are reused by the next batch, so each
+// batch must be consumed before asking for the next one.
+template <typename Socket>
+class _stream<Socket>::type {
+public:
+  explicit type(Socket& socket, span<datagram> slots) noexcept
+    : socket_(socket)
+    , slots_(slots) {}
+
+  auto next() noexcept(noexcept(async_recv_batch(
+      UNIFEX_DECLVAL(Socket&), UNIFEX_DECLVAL(span<datagram>)))) {
+    return async_recv_batch(socket_, slots_) |
+        then([slots = slots_](std::size_t count) noexcept {
+             return slots.first(count);
+           });
+  }
+
+  auto cleanup() noexcept { return just_done(); }
+
+private:
+  Socket& socket_;
+  span<datagram> slots_;
+};
+}  // namespace _recv_stream
+
+template <typename Socket>
+using recv_batch_stream = typename _recv_stream::_stream<Socket>::type;
+
+namespace _recv_stream_cpo {
+inline const struct _fn {
+  template <typename Socket>
+  recv_batch_stream<Socket>
+  operator()(Socket& socket, span<datagram> slots) const noexcept {
+    return recv_batch_stream<Socket>{socket, slots};
+  }
+} datagram_stream{};
+}  // namespace _recv_stream_cpo
+
+using _recv_stream_cpo::datagram_stream;
+}  // namespace linuxos
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
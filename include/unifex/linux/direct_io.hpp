@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/exception.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace linuxos {
+
+// Open option for open_file_read_only() and friends requesting that the
+// file be opened with O_DIRECT, bypassing the page cache.
+//
+// Direct I/O requires the file offset, the transfer length and the buffer
+// address to be multiples of the file's direct_io_alignment(). Contexts
+// check this before submitting a request and fail misaligned requests with
+// EINVAL rather than leaving it to the kernel.
+struct direct_io_t {};
+inline constexpr direct_io_t direct_io{};
+
+// Alignment assumed when the kernel does not report one via statx().
+inline constexpr std::uint32_t default_direct_io_alignment = 4096;
+
+// Query the alignment required for direct I/O on an open file.
+//
+// Throws std::system_error with EINVAL if the filesystem does not support
+// direct I/O on this file.
+inline std::uint32_t query_direct_io_alignment(int fd) {
+#ifdef STATX_DIOALIGN
+  struct statx stx;
+  if (::statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) < 0) {
+    int errorCode = errno;
+    throw_(std::system_error{errorCode, std::system_category()});
+  }
+  if ((stx.stx_mask & STATX_DIOALIGN) != 0) {
+    if (stx.stx_dio_mem_align == 0) {
+      throw_(std::system_error{EINVAL, std::system_category()});
+    }
+    return std::max(stx.stx_dio_mem_align, stx.stx_dio_offset_align);
+  }
+#else
+  (void)fd;
+#endif
+  return default_direct_io_alignment;
+}
+
+// Whether a direct I/O request violates the given alignment.
+// An alignment of zero means the file was opened for buffered I/O.
+inline bool is_misaligned_for_direct_io(
+    std::uint32_t alignment,
+    std::int64_t offset,
+    const void* data,
+    std::size_t size) noexcept {
+  if (alignment == 0) {
+    return false;
+  }
+  const auto mask = static_cast<std::uintptr_t>(alignment - 1);
+  return ((static_cast<std::uintptr_t>(offset) |
+           reinterpret_cast<std::uintptr_t>(data) | size) &
+          mask) != 0;
+}
+
+}  // namespace linuxos
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -18,19 +18,24 @@
 #include <unifex/config.hpp>
 #if !UNIFEX_NO_EPOLL
 
+#  include <unifex/elastic_thread_pool.hpp>
 #  include <unifex/get_stop_token.hpp>
 #  include <unifex/io_concepts.hpp>
 #  include <unifex/manual_lifetime.hpp>
 #  include <unifex/pipe_concepts.hpp>
 #  include <unifex/receiver_concepts.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/socket_concepts.hpp>
 #  include <unifex/span.hpp>
 #  include <unifex/stop_token_concepts.hpp>
 #  include <unifex/detail/atomic_intrusive_queue.hpp>
 #  include <unifex/detail/intrusive_heap.hpp>
 #  include <unifex/detail/intrusive_queue.hpp>
 
+#  include <unifex/linux/datagram.hpp>
 #  include <unifex/linux/monotonic_clock.hpp>
 #  include <unifex/linux/safe_file_descriptor.hpp>
+#  include <unifex/linux/socket_address.hpp>
 
 #  include <atomic>
 #  include <cstddef>
@@ -39,8 +44,12 @@
 #  include <system_error>
 #  include <utility>
 
+#  include <fcntl.h>
+#  include <poll.h>
 #  include <sys/epoll.h>
+#  include <sys/socket.h>
 #  include <sys/uio.h>
+#  include <unistd.h>
 
 #  include <unifex/detail/prologue.hpp>
 
@@ -58,6 +67,12 @@ public:
   class write_sender;
   class async_reader;
   class async_writer;
+  class async_socket;
+  class connect_sender;
+  class splice_sender;
+  class copy_file_range_sender;
+  class datagram_batch_sender;
+  class async_datagram_socket;
 
   io_epoll_context();
 
@@ -489,8 +504,46 @@ public:
 private:
   friend io_epoll_context;
 
+  bool currently_on_() const noexcept {
+    return context_->is_running_on_io_thread();
+  }
+
+  friend bool tag_invoke(tag_t<currently_on>, const scheduler& s) noexcept {
+    return s.currently_on_();
+  }
+
   friend std::pair<async_reader, async_writer>
   tag_invoke(tag_t<open_pipe>, scheduler s);
+  friend connect_sender tag_invoke(
+      tag_t<async_connect>,
+      scheduler s,
+      const socket_address& address) noexcept;
+  friend splice_sender tag_invoke(
+      tag_t<async_splice>,
+      scheduler s,
+      int fdIn,
+      std::int64_t offsetIn,
+      int fdOut,
+      std::int64_t offsetOut,
+      std::size_t length) noexcept;
+  friend splice_sender tag_invoke(
+      tag_t<async_tee>,
+      scheduler s,
+      int fdIn,
+      int fdOut,
+      std::size_t length) noexcept;
+  friend copy_file_range_sender tag_invoke(
+      tag_t<async_copy_file_range>,
+      scheduler s,
+      int fdIn,
+      std::int64_t offsetIn,
+      int fdOut,
+      std::int64_t offsetOut,
+      std::size_t length) noexcept;
+  friend async_datagram_socket tag_invoke(
+      tag_t<open_datagram_socket>,
+      scheduler s,
+      const socket_address& address);
 
   friend bool operator==(scheduler a, scheduler b) noexcept {
     return a.context_ == b.context_;
@@ -971,6 +1024,9 @@ public:
     : context_(context)
     , fd_(fd) {}
 
+  // The underlying file descriptor, eg. for async_splice().
+  int native_handle() const noexcept { return fd_.get(); }
+
 private:
   friend scheduler;
 
@@ -991,6 +1047,9 @@ public:
     : context_(context)
     , fd_(fd) {}
 
+  // The underlying file descriptor, eg. for async_splice().
+  int native_handle() const noexcept { return fd_.get(); }
+
 private:
   friend scheduler;
 
@@ -1005,6 +1064,938 @@ private:
   safe_file_descriptor fd_;
 };
 
+// A connected stream socket.
+//
+// Note that only one read and one write may be outstanding at a time and
+// that they may not be outstanding concurrently, since each operation
+// registers the file descriptor with epoll for the duration of the wait.
+class io_epoll_context::async_socket {
+public:
+  explicit async_socket(io_epoll_context& context, int fd) noexcept
+    : context_(context)
+    , fd_(fd) {}
+
+  // The underlying file descriptor, eg. for async_splice().
+  int native_handle() const noexcept { return fd_.get(); }
+
+private:
+  friend scheduler;
+
+  friend read_sender tag_invoke(
+      tag_t<async_read_some>,
+      async_socket& socket,
+      span<std::byte> buffer) noexcept {
+    return read_sender{socket.context_, socket.fd_.get(), buffer};
+  }
+
+  friend write_sender tag_invoke(
+      tag_t<async_write_some>,
+      async_socket& socket,
+      span<const std::byte> buffer) noexcept {
+    return write_sender{socket.context_, socket.fd_.get(), buffer};
+  }
+
+  io_epoll_context& context_;
+  safe_file_descriptor fd_;
+};
+
+class io_epoll_context::connect_sender {
+  struct done_op : operation_base {};
+
+  template <typename Receiver>
+  class operation
+    : private completion_base
+    , private done_op {
+    friend io_epoll_context;
+
+    static constexpr bool is_stop_ever_possible =
+        !is_stop_never_possible_v<stop_token_type_t<Receiver>>;
+
+  public:
+    template <typename Receiver2>
+    explicit operation(const connect_sender& sender, Receiver2&& r)
+      : context_(sender.context_)
+      , address_(sender.address_)
+      , receiver_((Receiver2 &&) r) {}
+
+    operation(operation&&) = delete;
+
+    void start() noexcept {
+      if (!context_.is_running_on_io_thread()) {
+        static_cast<completion_base*>(this)->execute_ =
+            &operation::on_schedule_complete;
+        context_.schedule_remote(static_cast<completion_base*>(this));
+      } else {
+        start_io();
+      }
+    }
+
+  private:
+    static void on_schedule_complete(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
+      self.start_io();
+    }
+
+    void start_io() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+
+      fd_ = safe_file_descriptor{::socket(
+          address_.family(),
+          SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+          IPPROTO_TCP)};
+      if (!fd_.valid()) {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{errno, std::system_category()});
+        return;
+      }
+
+      if (::connect(fd_.get(), address_.data(), address_.size()) == 0) {
+        // Connected synchronously, eg. to a loopback address.
+        deliver_result(0);
+        return;
+      }
+
+      if (errno != EINPROGRESS) {
+        deliver_result(errno);
+        return;
+      }
+
+      // The socket becomes writable once the connection attempt finishes.
+      if constexpr (is_stop_ever_possible) {
+        stopCallback_.construct(
+            get_stop_token(receiver_), cancel_callback{*this});
+      }
+      UNIFEX_ASSERT(static_cast<completion_base*>(this)->enqueued_.load() == 0);
+      static_cast<completion_base*>(this)->execute_ =
+          &operation::on_connect_complete;
+      epoll_event event;
+      event.data.ptr = static_cast<completion_base*>(this);
+      event.events = EPOLLOUT | EPOLLRDHUP | EPOLLHUP;
+      (void)epoll_ctl(
+          context_.epollFd_.get(), EPOLL_CTL_ADD, fd_.get(), &event);
+    }
+
+    static void on_connect_complete(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
+
+      UNIFEX_ASSERT(static_cast<completion_base&>(self).enqueued_.load() == 0);
+
+      self.stopCallback_.destruct();
+
+      auto oldState = self.state_.fetch_add(
+          io_epoll_context::connect_sender::operation<Receiver>::io_flag,
+          std::memory_order_acq_rel);
+      if ((oldState &
+           io_epoll_context::connect_sender::operation<
+               Receiver>::cancel_pending_mask) != 0) {
+        // io has been cancelled by a remote thread.
+        // The other thread is responsible for enqueueing the operation
+        // completion
+        return;
+      }
+
+      epoll_event event = {};
+      (void)epoll_ctl(
+          self.context_.epollFd_.get(), EPOLL_CTL_DEL, self.fd_.get(), &event);
+
+      int errorCode = 0;
+      socklen_t errorCodeSize = sizeof(errorCode);
+      if (getsockopt(
+              self.fd_.get(),
+              SOL_SOCKET,
+              SO_ERROR,
+              &errorCode,
+              &errorCodeSize) < 0) {
+        errorCode = errno;
+      }
+      self.deliver_result(errorCode);
+    }
+
+    void deliver_result(int errorCode) noexcept {
+      if (errorCode == 0) {
+        // The connected socket now belongs to the async_socket.
+        if constexpr (is_nothrow_receiver_of_v<Receiver, async_socket>) {
+          unifex::set_value(
+              std::move(receiver_), async_socket{context_, fd_.release()});
+        } else {
+          UNIFEX_TRY {
+            unifex::set_value(
+                std::move(receiver_), async_socket{context_, fd_.release()});
+          }
+          UNIFEX_CATCH(...) {
+            unifex::set_error(std::move(receiver_), std::current_exception());
+          }
+        }
+      } else if (errorCode == ECANCELED) {
+        unifex::set_done(std::move(receiver_));
+      } else {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{errorCode, std::system_category()});
+      }
+    }
+
+    static void complete_with_done(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(static_cast<done_op*>(op));
+
+      UNIFEX_ASSERT(static_cast<done_op&>(self).enqueued_.load() == 0);
+
+      if (static_cast<completion_base&>(self).enqueued_.load() == 0) {
+        // Avoid instantiating set_done() if we're not going to call it.
+        if constexpr (is_stop_ever_possible) {
+          unifex::set_done(std::move(self.receiver_));
+        } else {
+          // This should never be called if stop is not possible.
+          UNIFEX_ASSERT(false);
+        }
+      } else {
+        // reschedule after queued io is cleared
+        static_cast<done_op&>(self).execute_ = &operation::complete_with_done;
+        self.context_.schedule_local(static_cast<done_op*>(&self));
+      }
+    }
+
+    void request_stop() noexcept {
+      auto oldState = this->state_.fetch_add(
+          io_epoll_context::connect_sender::operation<
+              Receiver>::cancel_pending_flag,
+          std::memory_order_acq_rel);
+      if ((oldState & io_epoll_context::connect_sender::operation<
+                          Receiver>::io_mask) == 0) {
+        // IO not yet completed.
+        epoll_event event = {};
+        (void)epoll_ctl(
+            this->context_.epollFd_.get(),
+            EPOLL_CTL_DEL,
+            this->fd_.get(),
+            &event);
+
+        // We are responsible for scheduling the completion of this io
+        // operation.
+        static_cast<done_op&>(*this).execute_ = &operation::complete_with_done;
+        this->context_.schedule_remote(static_cast<done_op*>(this));
+      }
+    }
+
+    struct cancel_callback {
+      operation& op_;
+
+      void operator()() noexcept { op_.request_stop(); }
+    };
+
+    io_epoll_context& context_;
+    socket_address address_;
+    safe_file_descriptor fd_;
+    Receiver receiver_;
+    manual_lifetime<typename stop_token_type_t<
+        Receiver>::template callback_type<cancel_callback>>
+        stopCallback_;
+    static constexpr std::uint32_t io_flag = 0x00010000;
+    static constexpr std::uint32_t io_mask = 0xFFFF0000;
+    static constexpr std::uint32_t cancel_pending_flag = 1;
+    static constexpr std::uint32_t cancel_pending_mask = 0xFFFF;
+    std::atomic<std::uint32_t> state_ = 0;
+  };
+
+public:
+  // Produces the connected socket.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<async_socket>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit connect_sender(
+      io_epoll_context& context, const socket_address& address) noexcept
+    : context_(context)
+    , address_(address) {}
+
+  template <typename Receiver>
+  operation<std::decay_t<Receiver>> connect(Receiver&& r) const {
+    return operation<std::decay_t<Receiver>>{*this, (Receiver &&) r};
+  }
+
+private:
+  io_epoll_context& context_;
+  socket_address address_;
+};
+
+inline io_epoll_context::connect_sender tag_invoke(
+    tag_t<async_connect>,
+    io_epoll_context::scheduler s,
+    const socket_address& address) noexcept {
+  return io_epoll_context::connect_sender{*s.context_, address};
+}
+
+// Splices (or tees) between two file descriptors using the nonblocking
+// syscall. When the kernel reports EAGAIN the operation waits for whichever
+// file descriptor is not ready yet and then tries again.
+//
+// Note that while waiting the file descriptor is registered with epoll, so
+// it may not be used by another outstanding operation at the same time.
+class io_epoll_context::splice_sender {
+  struct done_op : operation_base {};
+
+  template <typename Receiver>
+  class operation
+    : private completion_base
+    , private done_op {
+    friend io_epoll_context;
+
+    static constexpr bool is_stop_ever_possible =
+        !is_stop_never_possible_v<stop_token_type_t<Receiver>>;
+
+  public:
+    template <typename Receiver2>
+    explicit operation(const splice_sender& sender, Receiver2&& r)
+      : context_(sender.context_)
+      , tee_(sender.tee_)
+      , fdIn_(sender.fdIn_)
+      , offsetIn_(sender.offsetIn_)
+      , fdOut_(sender.fdOut_)
+      , offsetOut_(sender.offsetOut_)
+      , length_(sender.length_)
+      , receiver_((Receiver2 &&) r) {}
+
+    operation(operation&&) = delete;
+
+    void start() noexcept {
+      if (!context_.is_running_on_io_thread()) {
+        static_cast<completion_base*>(this)->execute_ =
+            &operation::on_schedule_complete;
+        context_.schedule_remote(static_cast<completion_base*>(this));
+      } else {
+        try_splice();
+      }
+    }
+
+  private:
+    static void on_schedule_complete(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
+      self.try_splice();
+    }
+
+    ssize_t splice_some() noexcept {
+      if (tee_) {
+        return ::tee(fdIn_, fdOut_, length_, SPLICE_F_NONBLOCK);
+      }
+      return ::splice(
+          fdIn_,
+          offsetIn_ < 0 ? nullptr : &offsetIn_,
+          fdOut_,
+          offsetOut_ < 0 ? nullptr : &offsetOut_,
+          length_,
+          SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+    }
+
+    void try_splice() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+
+      const ssize_t result = splice_some();
+      if (result >= 0) {
+        deliver_value(result);
+        return;
+      }
+
+      if (errno != EAGAIN) {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{errno, std::system_category()});
+        return;
+      }
+
+      // Either side may be the one that would block. If both have become
+      // ready in the meantime, waiting on the output retries promptly.
+      pollfd fds[2] = {{fdIn_, POLLIN, 0}, {fdOut_, POLLOUT, 0}};
+      (void)::poll(fds, 2, 0);
+      if ((fds[0].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+        wait_until_ready(fdIn_, EPOLLIN | EPOLLRDHUP | EPOLLHUP);
+      } else {
+        wait_until_ready(fdOut_, EPOLLOUT | EPOLLHUP);
+      }
+    }
+
+    void wait_until_ready(int fd, std::uint32_t events) noexcept {
+      UNIFEX_ASSERT(static_cast<completion_base*>(this)->enqueued_.load() == 0);
+      waitFd_ = fd;
+      static_cast<completion_base*>(this)->execute_ = &operation::on_ready;
+      epoll_event event;
+      event.data.ptr = static_cast<completion_base*>(this);
+      event.events = events;
+      (void)epoll_ctl(context_.epollFd_.get(), EPOLL_CTL_ADD, fd, &event);
+
+      // Registered after epoll_ctl() so that a stop request always finds the
+      // file descriptor registered.
+      if constexpr (is_stop_ever_possible) {
+        stopCallback_.construct(
+            get_stop_token(receiver_), cancel_callback{*this});
+      }
+    }
+
+    static void on_ready(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
+
+      UNIFEX_ASSERT(static_cast<completion_base&>(self).enqueued_.load() == 0);
+
+      if constexpr (is_stop_ever_possible) {
+        // Once the callback is destroyed request_stop() can no longer run.
+        self.stopCallback_.destruct();
+        if (self.stopRequested_.load(std::memory_order_acquire)) {
+          // The stop callback is responsible for completing the operation.
+          return;
+        }
+      }
+
+      epoll_event event = {};
+      (void)epoll_ctl(
+          self.context_.epollFd_.get(), EPOLL_CTL_DEL, self.waitFd_, &event);
+      self.try_splice();
+    }
+
+    void deliver_value(ssize_t result) noexcept {
+      if constexpr (is_nothrow_receiver_of_v<Receiver, ssize_t>) {
+        unifex::set_value(std::move(receiver_), result);
+      } else {
+        UNIFEX_TRY { unifex::set_value(std::move(receiver_), result); }
+        UNIFEX_CATCH(...) {
+          unifex::set_error(std::move(receiver_), std::current_exception());
+        }
+      }
+    }
+
+    static void complete_with_done(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(static_cast<done_op*>(op));
+
+      UNIFEX_ASSERT(static_cast<done_op&>(self).enqueued_.load() == 0);
+
+      if (static_cast<completion_base&>(self).enqueued_.load() == 0) {
+        // Avoid instantiating set_done() if we're not going to call it.
+        if constexpr (is_stop_ever_possible) {
+          unifex::set_done(std::move(self.receiver_));
+        } else {
+          // This should never be called if stop is not possible.
+          UNIFEX_ASSERT(false);
+        }
+      } else {
+        // reschedule after queued io is cleared
+        static_cast<done_op&>(self).execute_ = &operation::complete_with_done;
+        self.context_.schedule_local(static_cast<done_op*>(&self));
+      }
+    }
+
+    void request_stop() noexcept {
+      stopRequested_.store(true, std::memory_order_release);
+      epoll_event event = {};
+      (void)epoll_ctl(
+          this->context_.epollFd_.get(), EPOLL_CTL_DEL, this->waitFd_, &event);
+
+      // We are responsible for scheduling the completion of this operation.
+      static_cast<done_op&>(*this).execute_ = &operation::complete_with_done;
+      this->context_.schedule_remote(static_cast<done_op*>(this));
+    }
+
+    struct cancel_callback {
+      operation& op_;
+
+      void operator()() noexcept { op_.request_stop(); }
+    };
+
+    io_epoll_context& context_;
+    bool tee_;
+    int fdIn_;
+    loff_t offsetIn_;
+    int fdOut_;
+    loff_t offsetOut_;
+    std::size_t length_;
+    int waitFd_ = -1;
+    Receiver receiver_;
+    manual_lifetime<typename stop_token_type_t<
+        Receiver>::template callback_type<cancel_callback>>
+        stopCallback_;
+    std::atomic<bool> stopRequested_{false};
+  };
+
+public:
+  // Produces number of bytes moved, 0 at end-of-file.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<ssize_t>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit splice_sender(
+      io_epoll_context& context,
+      bool tee,
+      int fdIn,
+      std::int64_t offsetIn,
+      int fdOut,
+      std::int64_t offsetOut,
+      std::size_t length) noexcept
+    : context_(context)
+    , tee_(tee)
+    , fdIn_(fdIn)
+    , offsetIn_(offsetIn)
+    , fdOut_(fdOut)
+    , offsetOut_(offsetOut)
+    , length_(length) {}
+
+  template <typename Receiver>
+  operation<std::decay_t<Receiver>> connect(Receiver&& r) const {
+    return operation<std::decay_t<Receiver>>{*this, (Receiver &&) r};
+  }
+
+private:
+  io_epoll_context& context_;
+  bool tee_;
+  int fdIn_;
+  std::int64_t offsetIn_;
+  int fdOut_;
+  std::int64_t offsetOut_;
+  std::size_t length_;
+};
+
+inline io_epoll_context::splice_sender tag_invoke(
+    tag_t<async_splice>,
+    io_epoll_context::scheduler s,
+    int fdIn,
+    std::int64_t offsetIn,
+    int fdOut,
+    std::int64_t offsetOut,
+    std::size_t length) noexcept {
+  return io_epoll_context::splice_sender{
+      *s.context_, false, fdIn, offsetIn, fdOut, offsetOut, length};
+}
+
+inline io_epoll_context::splice_sender tag_invoke(
+    tag_t<async_tee>,
+    io_epoll_context::scheduler s,
+    int fdIn,
+    int fdOut,
+    std::size_t length) noexcept {
+  return io_epoll_context::splice_sender{
+      *s.context_,
+      true,
+      fdIn,
+      splice_no_offset,
+      fdOut,
+      splice_no_offset,
+      length};
+}
+
+// Regular files are always ready as far as epoll is concerned and
+// copy_file_range() blocks for the duration of the copy, so the call is
+// made on the shared elastic_thread_pool rather than the I/O thread. The
+// operation then completes back on the I/O thread.
+class io_epoll_context::copy_file_range_sender {
+  template <typename Receiver>
+  class operation : private operation_base {
+    friend io_epoll_context;
+
+    // Makes the copy once the operation reaches a pool thread.
+    struct copy_receiver {
+      operation& op_;
+
+      void set_value() noexcept { op_.copy(); }
+      void set_error(std::exception_ptr ex) noexcept {
+        op_.exception_ = std::move(ex);
+        op_.complete_on_io_thread();
+      }
+      void set_done() noexcept {
+        op_.cancelled_ = true;
+        op_.complete_on_io_thread();
+      }
+    };
+
+    using copy_op_t = connect_result_t<
+        schedule_result_t<elastic_thread_pool::scheduler>,
+        copy_receiver>;
+
+  public:
+    template <typename Receiver2>
+    explicit operation(const copy_file_range_sender& sender, Receiver2&& r)
+      : context_(sender.context_)
+      , fdIn_(sender.fdIn_)
+      , offsetIn_(sender.offsetIn_)
+      , fdOut_(sender.fdOut_)
+      , offsetOut_(sender.offsetOut_)
+      , length_(sender.length_)
+      , receiver_((Receiver2 &&) r) {}
+
+    operation(operation&&) = delete;
+
+    void start() noexcept {
+      UNIFEX_TRY {
+        copyOp_.construct_with([&] {
+          return unifex::connect(
+              unifex::schedule(elastic_thread_pool::shared().get_scheduler()),
+              copy_receiver{*this});
+        });
+      }
+      UNIFEX_CATCH(...) {
+        unifex::set_error(std::move(receiver_), std::current_exception());
+        return;
+      }
+      unifex::start(copyOp_.get());
+    }
+
+  private:
+    void copy() noexcept {
+      if (get_stop_token(receiver_).stop_requested()) {
+        cancelled_ = true;
+      } else {
+        loff_t offsetIn = offsetIn_;
+        loff_t offsetOut = offsetOut_;
+        result_ = ::copy_file_range(
+            fdIn_,
+            offsetIn_ < 0 ? nullptr : &offsetIn,
+            fdOut_,
+            offsetOut_ < 0 ? nullptr : &offsetOut,
+            length_,
+            0);
+        errno_ = result_ < 0 ? errno : 0;
+      }
+      complete_on_io_thread();
+    }
+
+    void complete_on_io_thread() noexcept {
+      this->execute_ = &operation::on_copy_complete;
+      context_.schedule_remote(this);
+    }
+
+    static void on_copy_complete(operation_base* op) noexcept {
+      static_cast<operation*>(op)->complete();
+    }
+
+    void complete() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+      copyOp_.destruct();
+      if (exception_) {
+        unifex::set_error(std::move(receiver_), std::move(exception_));
+        return;
+      }
+      if (cancelled_) {
+        unifex::set_done(std::move(receiver_));
+        return;
+      }
+      if (result_ < 0) {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{errno_, std::system_category()});
+        return;
+      }
+
+      if constexpr (is_nothrow_receiver_of_v<Receiver, ssize_t>) {
+        unifex::set_value(std::move(receiver_), result_);
+      } else {
+        UNIFEX_TRY { unifex::set_value(std::move(receiver_), result_); }
+        UNIFEX_CATCH(...) {
+          unifex::set_error(std::move(receiver_), std::current_exception());
+        }
+      }
+    }
+
+    io_epoll_context& context_;
+    int fdIn_;
+    loff_t offsetIn_;
+    int fdOut_;
+    loff_t offsetOut_;
+    std::size_t length_;
+    Receiver receiver_;
+    manual_lifetime<copy_op_t> copyOp_;
+    ssize_t result_ = 0;
+    int errno_ = 0;
+    bool cancelled_ = false;
+    std::exception_ptr exception_;
+  };
+
+public:
+  // Produces number of bytes copied, 0 at end-of-file.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<ssize_t>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit copy_file_range_sender(
+      io_epoll_context& context,
+      int fdIn,
+      std::int64_t offsetIn,
+      int fdOut,
+      std::int64_t offsetOut,
+      std::size_t length) noexcept
+    : context_(context)
+    , fdIn_(fdIn)
+    , offsetIn_(offsetIn)
+    , fdOut_(fdOut)
+    , offsetOut_(offsetOut)
+    , length_(length) {}
+
+  template <typename Receiver>
+  operation<std::decay_t<Receiver>> connect(Receiver&& r) const {
+    return operation<std::decay_t<Receiver>>{*this, (Receiver &&) r};
+  }
+
+private:
+  io_epoll_context& context_;
+  int fdIn_;
+  std::int64_t offsetIn_;
+  int fdOut_;
+  std::int64_t offsetOut_;
+  std::size_t length_;
+};
+
+inline io_epoll_context::copy_file_range_sender tag_invoke(
+    tag_t<async_copy_file_range>,
+    io_epoll_context::scheduler s,
+    int fdIn,
+    std::int64_t offsetIn,
+    int fdOut,
+    std::int64_t offsetOut,
+    std::size_t length) noexcept {
+  return io_epoll_context::copy_file_range_sender{
+      *s.context_, fdIn, offsetIn, fdOut, offsetOut, length};
+}
+
+// Receives or sends a batch of datagrams with recvmmsg()/sendmmsg(),
+// waiting in epoll whenever the socket is not ready.
+class io_epoll_context::datagram_batch_sender {
+  struct done_op : operation_base {};
+
+  template <typename Receiver>
+  class operation
+    : private completion_base
+    , private done_op {
+    friend io_epoll_context;
+
+    static constexpr bool is_stop_ever_possible =
+        !is_stop_never_possible_v<stop_token_type_t<Receiver>>;
+
+  public:
+    template <typename Receiver2>
+    explicit operation(const datagram_batch_sender& sender, Receiver2&& r)
+      : context_(sender.context_)
+      , fd_(sender.fd_)
+      , send_(sender.send_)
+      , batch_(sender.slots_)
+      , receiver_((Receiver2 &&) r) {}
+
+    operation(operation&&) = delete;
+
+    void start() noexcept {
+      if (!context_.is_running_on_io_thread()) {
+        static_cast<completion_base*>(this)->execute_ =
+            &operation::on_schedule_complete;
+        context_.schedule_remote(static_cast<completion_base*>(this));
+      } else {
+        try_io();
+      }
+    }
+
+  private:
+    static void on_schedule_complete(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
+      self.try_io();
+    }
+
+    void try_io() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+
+      const int result = send_ ? batch_.send(fd_) : batch_.receive(fd_);
+      if (result >= 0) {
+        if constexpr (is_nothrow_receiver_of_v<Receiver, std::size_t>) {
+          unifex::set_value(std::move(receiver_), std::size_t(result));
+        } else {
+          UNIFEX_TRY {
+            unifex::set_value(std::move(receiver_), std::size_t(result));
+          }
+          UNIFEX_CATCH(...) {
+            unifex::set_error(std::move(receiver_), std::current_exception());
+          }
+        }
+        return;
+      }
+
+      if (result != -EAGAIN) {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{-result, std::system_category()});
+        return;
+      }
+
+      UNIFEX_ASSERT(static_cast<completion_base*>(this)->enqueued_.load() == 0);
+      static_cast<completion_base*>(this)->execute_ = &operation::on_ready;
+      epoll_event event;
+      event.data.ptr = static_cast<completion_base*>(this);
+      event.events = send_ ? EPOLLOUT : EPOLLIN;
+      (void)epoll_ctl(context_.epollFd_.get(), EPOLL_CTL_ADD, fd_, &event);
+
+      // Registered after epoll_ctl() so that a stop request always finds the
+      // file descriptor registered.
+      if constexpr (is_stop_ever_possible) {
+        stopCallback_.construct(
+            get_stop_token(receiver_), cancel_callback{*this});
+      }
+    }
+
+    static void on_ready(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
+
+      UNIFEX_ASSERT(static_cast<completion_base&>(self).enqueued_.load() == 0);
+
+      if constexpr (is_stop_ever_possible) {
+        // Once the callback is destroyed request_stop() can no longer run.
+        self.stopCallback_.destruct();
+        if (self.stopRequested_.load(std::memory_order_acquire)) {
+          // The stop callback is responsible for completing the operation.
+          return;
+        }
+      }
+
+      epoll_event event = {};
+      (void)epoll_ctl(
+          self.context_.epollFd_.get(), EPOLL_CTL_DEL, self.fd_, &event);
+      self.try_io();
+    }
+
+    static void complete_with_done(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(static_cast<done_op*>(op));
+
+      UNIFEX_ASSERT(static_cast<done_op&>(self).enqueued_.load() == 0);
+
+      if (static_cast<completion_base&>(self).enqueued_.load() == 0) {
+        // Avoid instantiating set_done() if we're not going to call it.
+        if constexpr (is_stop_ever_possible) {
+          unifex::set_done(std::move(self.receiver_));
+        } else {
+          // This should never be called if stop is not possible.
+          UNIFEX_ASSERT(false);
+        }
+      } else {
+        // reschedule after queued io is cleared
+        static_cast<done_op&>(self).execute_ = &operation::complete_with_done;
+        self.context_.schedule_local(static_cast<done_op*>(&self));
+      }
+    }
+
+    void request_stop() noexcept {
+      stopRequested_.store(true, std::memory_order_release);
+      epoll_event event = {};
+      (void)epoll_ctl(
+          this->context_.epollFd_.get(), EPOLL_CTL_DEL, this->fd_, &event);
+
+      // We are responsible for scheduling the completion of this operation.
+      static_cast<done_op&>(*this).execute_ = &operation::complete_with_done;
+      this->context_.schedule_remote(static_cast<done_op*>(this));
+    }
+
+    struct cancel_callback {
+      operation& op_;
+
+      void operator()() noexcept { op_.request_stop(); }
+    };
+
+    io_epoll_context& context_;
+    int fd_;
+    bool send_;
+    _dgram::message_batch batch_;
+    Receiver receiver_;
+    manual_lifetime<typename stop_token_type_t<
+        Receiver>::template callback_type<cancel_callback>>
+        stopCallback_;
+    std::atomic<bool> stopRequested_{false};
+  };
+
+public:
+  // Produces the number of slots received or sent.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<std::size_t>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit datagram_batch_sender(
+      io_epoll_context& context,
+      int fd,
+      span<datagram> slots,
+      bool send) noexcept
+    : context_(context)
+    , fd_(fd)
+    , slots_(slots)
+    , send_(send) {}
+
+  template <typename Receiver>
+  operation<std::decay_t<Receiver>> connect(Receiver&& r) const {
+    return operation<std::decay_t<Receiver>>{*this, (Receiver &&) r};
+  }
+
+private:
+  io_epoll_context& context_;
+  int fd_;
+  span<datagram> slots_;
+  bool send_;
+};
+
+// A bound datagram socket.
+//
+// Note that only one batch may be outstanding at a time, since each
+// operation registers the file descriptor with epoll while it waits.
+class io_epoll_context::async_datagram_socket {
+public:
+  explicit async_datagram_socket(io_epoll_context& context, int fd) noexcept
+    : context_(context)
+    , fd_(fd) {}
+
+  // The underlying file descriptor, eg. for async_splice().
+  int native_handle() const noexcept { return fd_.get(); }
+
+private:
+  friend scheduler;
+
+  friend datagram_batch_sender tag_invoke(
+      tag_t<async_recv_batch>,
+      async_datagram_socket& socket,
+      span<datagram> slots) noexcept {
+    return datagram_batch_sender{
+        socket.context_, socket.fd_.get(), slots, false};
+  }
+
+  friend datagram_batch_sender tag_invoke(
+      tag_t<async_send_batch>,
+      async_datagram_socket& socket,
+      span<datagram> slots) noexcept {
+    return datagram_batch_sender{
+        socket.context_, socket.fd_.get(), slots, true};
+  }
+
+  io_epoll_context& context_;
+  safe_file_descriptor fd_;
+};
+
 }  // namespace linuxos
 }  // namespace unifex
 
@@ -19,6 +19,7 @@
 #if !UNIFEX_NO_LIBURING
 
 #  include <unifex/defer.hpp>
+#  include <unifex/elastic_thread_pool.hpp>
 #  include <unifex/file_concepts.hpp>
 #  include <unifex/filesystem.hpp>
 #  include <unifex/get_stop_token.hpp>
@@ -26,7 +27,9 @@
 #  include <unifex/just_done.hpp>
 #  include <unifex/let_value_with.hpp>
 #  include <unifex/manual_lifetime.hpp>
+#  include <unifex/pipe_concepts.hpp>
 #  include <unifex/receiver_concepts.hpp>
+#  include <unifex/scheduler_concepts.hpp>
 #  include <unifex/socket_concepts.hpp>
 #  include <unifex/span.hpp>
 #  include <unifex/stop_token_concepts.hpp>
@@ -34,10 +37,14 @@
 #  include <unifex/detail/intrusive_heap.hpp>
 #  include <unifex/detail/intrusive_queue.hpp>
 
+#  include <unifex/linux/datagram.hpp>
+#  include <unifex/linux/direct_io.hpp>
 #  include <unifex/linux/mmap_region.hpp>
 #  include <unifex/linux/monotonic_clock.hpp>
 #  include <unifex/linux/safe_file_descriptor.hpp>
+#  include <unifex/linux/socket_address.hpp>
 
+#  include <algorithm>
 #  include <atomic>
 #  include <cstddef>
 #  include <cstdint>
@@ -49,6 +56,7 @@
 #  include UNIFEX_LIBURING_HEADER
 
 #  include <netinet/in.h>
+#  include <poll.h>
 #  include <sys/socket.h>
 #  include <sys/uio.h>
 #  include <unistd.h>
@@ -72,11 +80,40 @@ public:
   class scheduler;
   class accept_sender;
   class accept_stream;
+  class connect_sender;
+  class splice_sender;
+  class copy_file_range_sender;
+  class datagram_batch_sender;
+  class async_datagram_socket;
+
+  struct options {
+    // Requested number of submission queue entries.
+    unsigned entries = 256;
+
+    // Create the ring with IORING_SETUP_IOPOLL so that the I/O thread reaps
+    // completions by polling the device rather than waiting for interrupts.
+    //
+    // Only reads and writes on files opened with direct_io are supported by
+    // a polled ring, and the I/O thread busy-polls while they are in flight.
+    // Remote wake-ups and timers are also polled for instead of being
+    // submitted to the ring.
+    bool polledIo = false;
+
+    // When this context's I/O thread schedules work onto another, idle
+    // io_uring_context, wake the other context by submitting an
+    // IORING_OP_MSG_RING to this context's ring rather than by writing to
+    // its eventfd. Ignored if the kernel doesn't support MSG_RING.
+    bool msgRingWakeups = true;
+  };
 
   io_uring_context();
 
+  explicit io_uring_context(const options& opts);
+
   ~io_uring_context();
 
+  bool polled_io() const noexcept { return polledIo_; }
+
   template <typename StopToken>
   void run(StopToken stopToken);
 
@@ -141,6 +178,14 @@ private:
   void schedule_local(operation_base* op) noexcept;
   void schedule_local(operation_queue ops) noexcept;
   void schedule_remote(operation_base* op) noexcept;
+  void schedule_remote(operation_queue ops) noexcept;
+
+  // The operations held back on a thread by a schedule_batch.
+  struct batch;
+
+  // Wake the I/O thread after enqueue() or enqueue_all() on the
+  // remoteQueue reported that it is inactive.
+  void wake_inactive_io_thread() noexcept;
 
   // Schedule some operation to be run when there is next available I/O slots.
   void schedule_pending_io(operation_base* op) noexcept;
@@ -168,9 +213,12 @@ private:
   // for the remote queue eventfd as a way of registering for asynchronous
   // notification of someone enqueueing
   //
+  // If the POLL_ADD is still outstanding because we were last woken by a
+  // MSG_RING completion then this just marks the remote queue as inactive.
+  //
   // Returns true if successful. If so then it is no longer permitted
-  // to call 'acquire_remote_queued_items()' until after the completion
-  // for this POLL_ADD operation is received.
+  // to call 'acquire_remote_queued_items()' until after a wake-up
+  // completion, for either the POLL_ADD or a MSG_RING, is received.
   //
   // Returns false if either no more operations can be submitted at this
   // time (submission queue full or too many pending completions) or if
@@ -184,6 +232,50 @@ private:
   // inactive.
   void signal_remote_queue();
 
+  // The remote queue eventfd.
+  //
+  // This is reference-counted so that a context whose MSG_RING wake-up
+  // fails can still fall back to writing to the target's eventfd after
+  // the target has been destroyed. The owning context holds one reference
+  // and each MSG_RING wake-up it is the target of holds another until the
+  // sender has processed the completion.
+  struct remote_queue_eventfd {
+    explicit remote_queue_eventfd(safe_file_descriptor fd) noexcept
+      : fd_(std::move(fd)) {}
+
+    void signal();
+
+    void add_ref() noexcept {
+      refCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() noexcept {
+      if (refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+      }
+    }
+
+    safe_file_descriptor fd_;
+    std::atomic<std::uint32_t> refCount_{1};
+  };
+
+  // Wake the inactive I/O thread of 'target' by posting a completion to
+  // its ring with IORING_OP_MSG_RING, submitted to this context's ring.
+  // Must be called on this context's I/O thread.
+  //
+  // Returns false if MSG_RING wake-ups are disabled or the submission
+  // queue is full, in which case the caller must signal the eventfd.
+  bool try_submit_msg_ring_wakeup(io_uring_context& target) noexcept;
+
+  // Release the target eventfd references held by MSG_RING wake-ups whose
+  // completions will now never be processed, either because they were
+  // never flushed or because their completions were never reaped.
+  void release_unprocessed_msg_ring_wakeups() noexcept;
+
+  // Run-loop step for a polled ring: flush the submission queue and poll
+  // the device once for completions, or yield if nothing is in flight.
+  void poll_io();
+
   void remove_timer(schedule_at_operation* op) noexcept;
   void update_timers() noexcept;
   bool try_submit_timer_io(const time_point& dueTime) noexcept;
@@ -245,7 +337,7 @@ private:
 
   // Resources
   safe_file_descriptor iouringFd_;
-  safe_file_descriptor remoteQueueEventFd_;
+  remote_queue_eventfd* remoteQueueEventFd_ = nullptr;
   mmap_region cqMmap_;
   mmap_region sqMmap_;
   mmap_region sqeMmap_;
@@ -274,8 +366,17 @@ private:
   // we don't end up with an overflowed completion queue.
   std::uint32_t cqPendingCount_ = 0;
 
+  // Whether the IORING_OP_POLL_ADD on the remote queue eventfd is
+  // outstanding. It stays armed across wake-ups received via MSG_RING.
   bool remoteQueueReadSubmitted_ = false;
+
+  // Whether the remote queue is marked inactive and we are waiting for
+  // either the eventfd poll or a MSG_RING completion to wake us up.
+  bool remoteQueueInactive_ = false;
+
   bool timersAreDirty_ = false;
+  bool polledIo_ = false;
+  bool msgRingWakeups_ = false;
 
   std::uint32_t activeTimerCount_ = 0;
 
@@ -425,13 +526,22 @@ class io_uring_context::read_sender {
       : context_(sender.context_)
       , fd_(sender.fd_)
       , offset_(sender.offset_)
+      , alignment_(sender.alignment_)
       , receiver_((Receiver2 &&) r) {
       buffer_[0].iov_base = sender.buffer_.data();
       buffer_[0].iov_len = sender.buffer_.size();
     }
 
     void start() noexcept {
-      if (!context_.is_running_on_io_thread()) {
+      if (is_misaligned_for_direct_io(
+              alignment_,
+              offset_,
+              buffer_[0].iov_base,
+              buffer_[0].iov_len)) {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{EINVAL, std::system_category()});
+      } else if (!context_.is_running_on_io_thread()) {
         this->execute_ = &operation::on_schedule_complete;
         context_.schedule_remote(this);
       } else {
@@ -563,6 +673,7 @@ class io_uring_context::read_sender {
     io_uring_context& context_;
     int fd_;
     offset_t offset_;
+    std::uint32_t alignment_;
     iovec buffer_[1];
     Receiver receiver_;
     manual_lifetime<typename stop_token_type_t<
@@ -592,11 +703,13 @@ public:
       io_uring_context& context,
       int fd,
       offset_t offset,
-      span<std::byte> buffer) noexcept
+      span<std::byte> buffer,
+      std::uint32_t alignment = 0) noexcept
     : context_(context)
     , fd_(fd)
     , offset_(offset)
-    , buffer_(buffer) {}
+    , buffer_(buffer)
+    , alignment_(alignment) {}
 
   template <typename Receiver>
   operation<remove_cvref_t<Receiver>> connect(Receiver&& r) && {
@@ -608,6 +721,7 @@ private:
   int fd_;
   offset_t offset_;
   span<std::byte> buffer_;
+  std::uint32_t alignment_;
 };
 
 class io_uring_context::write_sender {
@@ -623,13 +737,22 @@ class io_uring_context::write_sender {
       : context_(sender.context_)
       , fd_(sender.fd_)
       , offset_(sender.offset_)
+      , alignment_(sender.alignment_)
       , receiver_((Receiver2 &&) r) {
       buffer_[0].iov_base = (void*)sender.buffer_.data();
       buffer_[0].iov_len = sender.buffer_.size();
     }
 
     void start() noexcept {
-      if (!context_.is_running_on_io_thread()) {
+      if (is_misaligned_for_direct_io(
+              alignment_,
+              offset_,
+              buffer_[0].iov_base,
+              buffer_[0].iov_len)) {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{EINVAL, std::system_category()});
+      } else if (!context_.is_running_on_io_thread()) {
         this->execute_ = &operation::on_schedule_complete;
         context_.schedule_remote(this);
       } else {
@@ -761,6 +884,7 @@ class io_uring_context::write_sender {
     io_uring_context& context_;
     int fd_;
     offset_t offset_;
+    std::uint32_t alignment_;
     iovec buffer_[1];
     Receiver receiver_;
     manual_lifetime<typename stop_token_type_t<
@@ -790,11 +914,13 @@ public:
       io_uring_context& context,
       int fd,
       offset_t offset,
-      span<const std::byte> buffer) noexcept
+      span<const std::byte> buffer,
+      std::uint32_t alignment = 0) noexcept
     : context_(context)
     , fd_(fd)
     , offset_(offset)
-    , buffer_(buffer) {}
+    , buffer_(buffer)
+    , alignment_(alignment) {}
 
   template <typename Receiver>
   operation<remove_cvref_t<Receiver>> connect(Receiver&& r) {
@@ -806,15 +932,25 @@ private:
   int fd_;
   offset_t offset_;
   span<const std::byte> buffer_;
+  std::uint32_t alignment_;
 };
 
 class io_uring_context::async_read_only_file {
 public:
   using offset_t = std::int64_t;
 
-  explicit async_read_only_file(io_uring_context& context, int fd) noexcept
+  explicit async_read_only_file(
+      io_uring_context& context, int fd, std::uint32_t alignment = 0) noexcept
     : context_(context)
-    , fd_(fd) {}
+    , fd_(fd)
+    , alignment_(alignment) {}
+
+  // The underlying file descriptor, eg. for async_splice().
+  int native_handle() const noexcept { return fd_.get(); }
+
+  // Alignment required of offsets, lengths and buffers if the file was
+  // opened with direct_io, otherwise zero.
+  std::uint32_t direct_io_alignment() const noexcept { return alignment_; }
 
 private:
   friend scheduler;
@@ -824,20 +960,31 @@ private:
       async_read_only_file& file,
       offset_t offset,
       span<std::byte> buffer) noexcept {
-    return read_sender{file.context_, file.fd_.get(), offset, buffer};
+    return read_sender{
+        file.context_, file.fd_.get(), offset, buffer, file.alignment_};
   }
 
   io_uring_context& context_;
   safe_file_descriptor fd_;
+  std::uint32_t alignment_;
 };
 
 class io_uring_context::async_write_only_file {
 public:
   using offset_t = std::int64_t;
 
-  explicit async_write_only_file(io_uring_context& context, int fd) noexcept
+  explicit async_write_only_file(
+      io_uring_context& context, int fd, std::uint32_t alignment = 0) noexcept
     : context_(context)
-    , fd_(fd) {}
+    , fd_(fd)
+    , alignment_(alignment) {}
+
+  // The underlying file descriptor, eg. for async_splice().
+  int native_handle() const noexcept { return fd_.get(); }
+
+  // Alignment required of offsets, lengths and buffers if the file was
+  // opened with direct_io, otherwise zero.
+  std::uint32_t direct_io_alignment() const noexcept { return alignment_; }
 
 private:
   friend scheduler;
@@ -847,20 +994,31 @@ private:
       async_write_only_file& file,
       offset_t offset,
       span<const std::byte> buffer) noexcept {
-    return write_sender{file.context_, file.fd_.get(), offset, buffer};
+    return write_sender{
+        file.context_, file.fd_.get(), offset, buffer, file.alignment_};
   }
 
   io_uring_context& context_;
   safe_file_descriptor fd_;
+  std::uint32_t alignment_;
 };
 
 class io_uring_context::async_read_write_file {
 public:
   using offset_t = std::int64_t;
 
-  explicit async_read_write_file(io_uring_context& context, int fd) noexcept
+  explicit async_read_write_file(
+      io_uring_context& context, int fd, std::uint32_t alignment = 0) noexcept
     : context_(context)
-    , fd_(fd) {}
+    , fd_(fd)
+    , alignment_(alignment) {}
+
+  // The underlying file descriptor, eg. for async_splice().
+  int native_handle() const noexcept { return fd_.get(); }
+
+  // Alignment required of offsets, lengths and buffers if the file was
+  // opened with direct_io, otherwise zero.
+  std::uint32_t direct_io_alignment() const noexcept { return alignment_; }
 
 private:
   friend scheduler;
@@ -870,7 +1028,8 @@ private:
       async_read_write_file& file,
       offset_t offset,
       span<const std::byte> buffer) noexcept {
-    return write_sender{file.context_, file.fd_.get(), offset, buffer};
+    return write_sender{
+        file.context_, file.fd_.get(), offset, buffer, file.alignment_};
   }
 
   friend read_sender tag_invoke(
@@ -878,11 +1037,13 @@ private:
       async_read_write_file& file,
       offset_t offset,
       span<std::byte> buffer) noexcept {
-    return read_sender{file.context_, file.fd_.get(), offset, buffer};
+    return read_sender{
+        file.context_, file.fd_.get(), offset, buffer, file.alignment_};
   }
 
   io_uring_context& context_;
   safe_file_descriptor fd_;
+  std::uint32_t alignment_;
 };
 
 class io_uring_context::schedule_at_sender {
@@ -1093,14 +1254,67 @@ public:
 private:
   friend io_uring_context;
 
+  bool currently_on_() const noexcept {
+    return context_->is_running_on_io_thread();
+  }
+
+  friend bool tag_invoke(tag_t<currently_on>, const scheduler& s) noexcept {
+    return s.currently_on_();
+  }
+
   friend async_read_only_file tag_invoke(
       tag_t<open_file_read_only>, scheduler s, const filesystem::path& path);
   friend async_read_write_file tag_invoke(
       tag_t<open_file_read_write>, scheduler s, const filesystem::path& path);
   friend async_write_only_file tag_invoke(
       tag_t<open_file_write_only>, scheduler s, const filesystem::path& path);
+  friend async_read_only_file tag_invoke(
+      tag_t<open_file_read_only>,
+      scheduler s,
+      const filesystem::path& path,
+      direct_io_t);
+  friend async_read_write_file tag_invoke(
+      tag_t<open_file_read_write>,
+      scheduler s,
+      const filesystem::path& path,
+      direct_io_t);
+  friend async_write_only_file tag_invoke(
+      tag_t<open_file_write_only>,
+      scheduler s,
+      const filesystem::path& path,
+      direct_io_t);
   friend accept_stream
   tag_invoke(tag_t<open_listening_socket>, scheduler s, port_t port);
+  friend connect_sender tag_invoke(
+      tag_t<async_connect>,
+      scheduler s,
+      const socket_address& address) noexcept;
+  friend splice_sender tag_invoke(
+      tag_t<async_splice>,
+      scheduler s,
+      int fdIn,
+      std::int64_t offsetIn,
+      int fdOut,
+      std::int64_t offsetOut,
+      std::size_t length) noexcept;
+  friend splice_sender tag_invoke(
+      tag_t<async_tee>,
+      scheduler s,
+      int fdIn,
+      int fdOut,
+      std::size_t length) noexcept;
+  friend copy_file_range_sender tag_invoke(
+      tag_t<async_copy_file_range>,
+      scheduler s,
+      int fdIn,
+      std::int64_t offsetIn,
+      int fdOut,
+      std::int64_t offsetOut,
+      std::size_t length) noexcept;
+  friend async_datagram_socket tag_invoke(
+      tag_t<open_datagram_socket>,
+      scheduler s,
+      const socket_address& address);
 
   friend bool operator==(scheduler a, scheduler b) noexcept {
     return a.context_ == b.context_;
@@ -1313,6 +1527,991 @@ private:
   int fd_;
 };
 
+class io_uring_context::connect_sender {
+  template <typename Receiver>
+  class operation : private completion_base {
+    friend io_uring_context;
+
+  public:
+    template <typename Receiver2>
+    explicit operation(const connect_sender& sender, Receiver2&& r) noexcept(
+        std::is_nothrow_constructible_v<Receiver, Receiver2>)
+      : context_(sender.context_)
+      , address_(sender.address_)
+      , receiver_((Receiver2 &&) r) {}
+
+    operation(operation&&) = delete;
+
+    void start() noexcept {
+      if (!context_.is_running_on_io_thread()) {
+        this->execute_ = &operation::on_schedule_complete;
+        context_.schedule_remote(this);
+      } else {
+        start_io();
+      }
+    }
+
+  private:
+    static void on_schedule_complete(operation_base* op) noexcept {
+      static_cast<operation*>(op)->start_io();
+    }
+
+    static void on_submit_pending(operation_base* op) noexcept {
+      static_cast<operation*>(op)->submit_io();
+    }
+
+    void start_io() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+      if (get_stop_token(receiver_).stop_requested()) {
+        unifex::set_done(std::move(receiver_));
+        return;
+      }
+      fd_ = safe_file_descriptor{::socket(
+          address_.family(),
+          SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+          IPPROTO_TCP)};
+      if (!fd_.valid()) {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{errno, std::system_category()});
+        return;
+      }
+
+      // Queue the connect before registering for stop requests, so that
+      // the cancellation a stop request submits comes after it.
+      submit_io();
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_callback{*this});
+    }
+
+    void submit_io() noexcept {
+      auto populateSqe = [this](io_uring_sqe& sqe) noexcept {
+        sqe.opcode = IORING_OP_CONNECT;
+        sqe.fd = fd_.get();
+        // sqe.addr is the socket address, sqe.off is its length
+        sqe.addr = reinterpret_cast<std::uintptr_t>(address_.data());
+        sqe.off = address_.size();
+
+        sqe.user_data = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(this));
+
+        this->execute_ = &operation::on_connect;
+      };
+
+      if (!context_.try_submit_io(populateSqe)) {
+        this->execute_ = &operation::on_submit_pending;
+        context_.schedule_pending_io(this);
+      }
+    }
+
+    void request_stop() noexcept {
+      if (char expected = 1; !refCount_.compare_exchange_strong(
+              expected, 2, std::memory_order_relaxed)) {
+        // lost race with on_connect
+        UNIFEX_ASSERT(expected == 0);
+        return;
+      }
+      if (context_.is_running_on_io_thread()) {
+        request_stop_local();
+      } else {
+        request_stop_remote();
+      }
+    }
+
+    void request_stop_local() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+      auto populateSqe = [this](io_uring_sqe& sqe) noexcept {
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.fd = -1;
+        sqe.off = 0;
+        auto op = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(this));
+        // sqe.addr is the user_data to look for and cancel
+        sqe.addr = op;
+        sqe.len = 0;
+        auto cop = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(&cop_));
+        sqe.user_data = cop;
+        cop_.execute_ = &cancel_operation::on_stop_complete;
+      };
+
+      if (!context_.try_submit_io(populateSqe)) {
+        cop_.execute_ = &cancel_operation::on_schedule_stop_complete;
+        context_.schedule_pending_io(&cop_);
+      }
+    }
+
+    void request_stop_remote() noexcept {
+      cop_.execute_ = &cancel_operation::on_schedule_stop_complete;
+      context_.schedule_remote(&cop_);
+    }
+
+    static void on_connect(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(op);
+      if (self.refCount_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        // stop callback is running, must complete the op
+        return;
+      }
+      self.stopCallback_.destruct();
+      if (get_stop_token(self.receiver_).stop_requested()) {
+        unifex::set_done(std::move(self.receiver_));
+      } else if (self.result_ >= 0) {
+        // The connected socket now belongs to the async_read_write_file.
+        if constexpr (noexcept(unifex::set_value(
+                          std::move(self.receiver_),
+                          async_read_write_file{self.context_, -1}))) {
+          unifex::set_value(
+              std::move(self.receiver_),
+              async_read_write_file{self.context_, self.fd_.release()});
+        } else {
+          UNIFEX_TRY {
+            unifex::set_value(
+                std::move(self.receiver_),
+                async_read_write_file{self.context_, self.fd_.release()});
+          }
+          UNIFEX_CATCH(...) {
+            unifex::set_error(
+                std::move(self.receiver_), std::current_exception());
+          }
+        }
+      } else if (self.result_ == -ECANCELED) {
+        unifex::set_done(std::move(self.receiver_));
+      } else {
+        unifex::set_error(
+            std::move(self.receiver_),
+            std::error_code{-self.result_, std::system_category()});
+      }
+    }
+
+    struct cancel_operation final : completion_base {
+      operation& op_;
+
+      explicit cancel_operation(operation& op) noexcept : op_(op) {}
+      // intrusive list breaks if the same operation is submitted twice
+      // break the cycle: `on_stop_complete` delegates to the parent operation
+      static void on_stop_complete(operation_base* op) noexcept {
+        operation::on_connect(&static_cast<cancel_operation*>(op)->op_);
+      }
+
+      static void on_schedule_stop_complete(operation_base* op) noexcept {
+        static_cast<cancel_operation*>(op)->op_.request_stop_local();
+      }
+    };
+
+    struct cancel_callback final {
+      operation& op_;
+
+      void operator()() noexcept { op_.request_stop(); }
+    };
+
+    io_uring_context& context_;
+    socket_address address_;
+    safe_file_descriptor fd_;
+    Receiver receiver_;
+    manual_lifetime<typename stop_token_type_t<
+        Receiver>::template callback_type<cancel_callback>>
+        stopCallback_;
+    std::atomic_char refCount_{1};
+    cancel_operation cop_{*this};
+  };
+
+public:
+  // Produces an open read-write file corresponding to the connected socket.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<async_read_write_file>>;
+
+  // Note: Only case it might complete with exception_ptr is if the
+  // receiver's set_value() exits with an exception.
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+  static constexpr blocking_kind blocking = blocking_kind::never;
+  // always completes on the io_uring context
+  static constexpr bool is_always_scheduler_affine = false;
+
+  explicit connect_sender(
+      io_uring_context& context, const socket_address& address) noexcept
+    : context_(context)
+    , address_(address) {}
+
+  template <typename Receiver>
+  operation<remove_cvref_t<Receiver>> connect(Receiver&& r) const {
+    return operation<remove_cvref_t<Receiver>>{*this, (Receiver &&) r};
+  }
+
+private:
+  io_uring_context& context_;
+  socket_address address_;
+};
+
+inline io_uring_context::connect_sender tag_invoke(
+    tag_t<async_connect>,
+    io_uring_context::scheduler s,
+    const socket_address& address) noexcept {
+  return io_uring_context::connect_sender{*s.context_, address};
+}
+
+class io_uring_context::splice_sender {
+  using offset_t = std::int64_t;
+
+  template <typename Receiver>
+  class operation : private completion_base {
+    friend io_uring_context;
+
+  public:
+    template <typename Receiver2>
+    explicit operation(const splice_sender& sender, Receiver2&& r)
+      : context_(sender.context_)
+      , opcode_(sender.opcode_)
+      , fdIn_(sender.fdIn_)
+      , offsetIn_(sender.offsetIn_)
+      , fdOut_(sender.fdOut_)
+      , offsetOut_(sender.offsetOut_)
+      , length_(sender.length_)
+      , receiver_((Receiver2 &&) r) {}
+
+    operation(operation&&) = delete;
+
+    void start() noexcept {
+      if (!context_.is_running_on_io_thread()) {
+        this->execute_ = &operation::on_schedule_complete;
+        context_.schedule_remote(this);
+      } else {
+        start_io();
+      }
+    }
+
+  private:
+    static void on_schedule_complete(operation_base* op) noexcept {
+      static_cast<operation*>(op)->start_io();
+    }
+
+    void start_io() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_callback{*this});
+      submit_splice();
+    }
+
+    static void on_schedule_splice(operation_base* op) noexcept {
+      static_cast<operation*>(op)->submit_splice();
+    }
+
+    void submit_splice() noexcept {
+      polling_ = false;
+      auto populateSqe = [this](io_uring_sqe& sqe) noexcept {
+        sqe.opcode = opcode_;
+        sqe.fd = fdOut_;
+        // An offset of -1 selects the current file position, which is the
+        // only option for pipes and sockets. IORING_OP_TEE takes neither.
+        sqe.off = static_cast<std::uint64_t>(offsetOut_);
+        sqe.splice_off_in = static_cast<std::uint64_t>(offsetIn_);
+        sqe.splice_fd_in = fdIn_;
+        sqe.len = length_;
+        sqe.user_data = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(this));
+
+        this->execute_ = &operation::on_splice_complete;
+      };
+
+      if (!context_.try_submit_io(populateSqe)) {
+        this->execute_ = &operation::on_schedule_splice;
+        context_.schedule_pending_io(this);
+      }
+    }
+
+    // The kernel does not poll for splice readiness itself, so nonblocking
+    // sockets complete with -EAGAIN. Wait for whichever side is not ready
+    // with IORING_OP_POLL_ADD before splicing again.
+    void wait_until_ready() noexcept {
+      pollfd fds[2] = {{fdIn_, POLLIN, 0}, {fdOut_, POLLOUT, 0}};
+      (void)::poll(fds, 2, 0);
+      if ((fds[0].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+        pollFd_ = fdIn_;
+        pollEvents_ = POLLIN | POLLRDHUP;
+      } else {
+        pollFd_ = fdOut_;
+        pollEvents_ = POLLOUT;
+      }
+      submit_poll();
+    }
+
+    static void on_schedule_poll(operation_base* op) noexcept {
+      static_cast<operation*>(op)->submit_poll();
+    }
+
+    void submit_poll() noexcept {
+      polling_ = true;
+      auto populateSqe = [this](io_uring_sqe& sqe) noexcept {
+        sqe.opcode = IORING_OP_POLL_ADD;
+        sqe.fd = pollFd_;
+        sqe.poll32_events = pollEvents_;
+        sqe.user_data = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(this));
+
+        this->execute_ = &operation::on_poll_complete;
+      };
+
+      if (!context_.try_submit_io(populateSqe)) {
+        this->execute_ = &operation::on_schedule_poll;
+        context_.schedule_pending_io(this);
+        return;
+      }
+
+      // Registered only once the poll is submitted, as a poll that is
+      // submitted after the cancellation request would never complete.
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_callback{*this});
+    }
+
+    void request_stop() noexcept {
+      if (char expected = 1; !refCount_.compare_exchange_strong(
+              expected, 2, std::memory_order_relaxed)) {
+        // lost race with on_splice_complete
+        UNIFEX_ASSERT(expected == 0);
+        return;
+      }
+      if (context_.is_running_on_io_thread()) {
+        request_stop_local();
+      } else {
+        request_stop_remote();
+      }
+    }
+
+    void request_stop_local() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+      auto populateSqe = [this](io_uring_sqe& sqe) noexcept {
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.fd = -1;
+        sqe.off = 0;
+        auto op = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(this));
+        // sqe.addr is the user_data to look for and cancel
+        sqe.addr = op;
+        sqe.len = 0;
+        auto cop = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(&cop_));
+        sqe.user_data = cop;
+        cop_.execute_ = &cancel_operation::on_stop_complete;
+      };
+
+      if (!context_.try_submit_io(populateSqe)) {
+        cop_.execute_ = &cancel_operation::on_schedule_stop_complete;
+        context_.schedule_pending_io(&cop_);
+      }
+    }
+
+    void request_stop_remote() noexcept {
+      cop_.execute_ = &cancel_operation::on_schedule_stop_complete;
+      context_.schedule_remote(&cop_);
+    }
+
+    static void on_splice_complete(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(op);
+      if (self.refCount_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        // stop callback is running, must complete the op
+        return;
+      }
+      self.stopCallback_.destruct();
+      if (get_stop_token(self.receiver_).stop_requested()) {
+        unifex::set_done(std::move(self.receiver_));
+      } else if (self.result_ == -EAGAIN) {
+        self.refCount_.store(1, std::memory_order_relaxed);
+        self.wait_until_ready();
+      } else if (self.result_ >= 0) {
+        if constexpr (noexcept(unifex::set_value(
+                          std::move(self.receiver_), ssize_t(self.result_)))) {
+          unifex::set_value(std::move(self.receiver_), ssize_t(self.result_));
+        } else {
+          UNIFEX_TRY {
+            unifex::set_value(std::move(self.receiver_), ssize_t(self.result_));
+          }
+          UNIFEX_CATCH(...) {
+            unifex::set_error(
+                std::move(self.receiver_), std::current_exception());
+          }
+        }
+      } else if (self.result_ == -ECANCELED) {
+        unifex::set_done(std::move(self.receiver_));
+      } else {
+        unifex::set_error(
+            std::move(self.receiver_),
+            std::error_code{-self.result_, std::system_category()});
+      }
+    }
+
+    static void on_poll_complete(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(op);
+      if (self.refCount_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        // stop callback is running, must complete the op
+        return;
+      }
+      self.stopCallback_.destruct();
+      if (get_stop_token(self.receiver_).stop_requested() ||
+          self.result_ == -ECANCELED) {
+        unifex::set_done(std::move(self.receiver_));
+      } else if (self.result_ < 0) {
+        unifex::set_error(
+            std::move(self.receiver_),
+            std::error_code{-self.result_, std::system_category()});
+      } else {
+        self.refCount_.store(1, std::memory_order_relaxed);
+        self.start_io();
+      }
+    }
+
+    struct cancel_operation final : completion_base {
+      operation& op_;
+
+      explicit cancel_operation(operation& op) noexcept : op_(op) {}
+      // intrusive list breaks if the same operation is submitted twice
+      // break the cycle: `on_stop_complete` delegates to the parent operation
+      static void on_stop_complete(operation_base* op) noexcept {
+        auto& parent = static_cast<cancel_operation*>(op)->op_;
+        if (parent.polling_) {
+          operation::on_poll_complete(&parent);
+        } else {
+          operation::on_splice_complete(&parent);
+        }
+      }
+
+      static void on_schedule_stop_complete(operation_base* op) noexcept {
+        static_cast<cancel_operation*>(op)->op_.request_stop_local();
+      }
+    };
+
+    struct cancel_callback final {
+      operation& op_;
+
+      void operator()() noexcept { op_.request_stop(); }
+    };
+
+    io_uring_context& context_;
+    std::uint8_t opcode_;
+    int fdIn_;
+    offset_t offsetIn_;
+    int fdOut_;
+    offset_t offsetOut_;
+    std::uint32_t length_;
+    int pollFd_ = -1;
+    std::uint32_t pollEvents_ = 0;
+    bool polling_ = false;
+    Receiver receiver_;
+    manual_lifetime<typename stop_token_type_t<
+        Receiver>::template callback_type<cancel_callback>>
+        stopCallback_;
+    std::atomic_char refCount_{1};
+    cancel_operation cop_{*this};
+  };
+
+public:
+  // Produces number of bytes moved, 0 at end-of-file.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<ssize_t>>;
+
+  // Note: Only case it might complete with exception_ptr is if the
+  // receiver's set_value() exits with an exception.
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  // Moves bytes with IORING_OP_SPLICE or, given 'IORING_OP_TEE' and zero
+  // offsets, duplicates them between two pipes.
+  explicit splice_sender(
+      io_uring_context& context,
+      std::uint8_t opcode,
+      int fdIn,
+      offset_t offsetIn,
+      int fdOut,
+      offset_t offsetOut,
+      std::size_t length) noexcept
+    : context_(context)
+    , opcode_(opcode)
+    , fdIn_(fdIn)
+    , offsetIn_(offsetIn)
+    , fdOut_(fdOut)
+    , offsetOut_(offsetOut)
+    , length_(static_cast<std::uint32_t>(
+          std::min<std::size_t>(length, UINT32_MAX))) {}
+
+  template <typename Receiver>
+  operation<remove_cvref_t<Receiver>> connect(Receiver&& r) const {
+    return operation<remove_cvref_t<Receiver>>{*this, (Receiver &&) r};
+  }
+
+private:
+  io_uring_context& context_;
+  std::uint8_t opcode_;
+  int fdIn_;
+  offset_t offsetIn_;
+  int fdOut_;
+  offset_t offsetOut_;
+  std::uint32_t length_;
+};
+
+inline io_uring_context::splice_sender tag_invoke(
+    tag_t<async_splice>,
+    io_uring_context::scheduler s,
+    int fdIn,
+    std::int64_t offsetIn,
+    int fdOut,
+    std::int64_t offsetOut,
+    std::size_t length) noexcept {
+  return io_uring_context::splice_sender{
+      *s.context_, IORING_OP_SPLICE, fdIn, offsetIn, fdOut, offsetOut, length};
+}
+
+inline io_uring_context::splice_sender tag_invoke(
+    tag_t<async_tee>,
+    io_uring_context::scheduler s,
+    int fdIn,
+    int fdOut,
+    std::size_t length) noexcept {
+  return io_uring_context::splice_sender{
+      *s.context_, IORING_OP_TEE, fdIn, 0, fdOut, 0, length};
+}
+
+// io_uring has no copy_file_range() opcode and the syscall blocks for the
+// duration of the copy, so the call is made on the shared
+// elastic_thread_pool rather than the I/O thread. The operation then
+// completes back on the I/O thread.
+class io_uring_context::copy_file_range_sender {
+  using offset_t = std::int64_t;
+
+  template <typename Receiver>
+  class operation : private operation_base {
+    friend io_uring_context;
+
+    // Makes the copy once the operation reaches a pool thread.
+    struct copy_receiver {
+      operation& op_;
+
+      void set_value() noexcept { op_.copy(); }
+      void set_error(std::exception_ptr ex) noexcept {
+        op_.exception_ = std::move(ex);
+        op_.complete_on_io_thread();
+      }
+      void set_done() noexcept {
+        op_.cancelled_ = true;
+        op_.complete_on_io_thread();
+      }
+    };
+
+    using copy_op_t = connect_result_t<
+        schedule_result_t<elastic_thread_pool::scheduler>,
+        copy_receiver>;
+
+  public:
+    template <typename Receiver2>
+    explicit operation(const copy_file_range_sender& sender, Receiver2&& r)
+      : context_(sender.context_)
+      , fdIn_(sender.fdIn_)
+      , offsetIn_(sender.offsetIn_)
+      , fdOut_(sender.fdOut_)
+      , offsetOut_(sender.offsetOut_)
+      , length_(sender.length_)
+      , receiver_((Receiver2 &&) r) {}
+
+    operation(operation&&) = delete;
+
+    void start() noexcept {
+      UNIFEX_TRY {
+        copyOp_.construct_with([&] {
+          return unifex::connect(
+              unifex::schedule(elastic_thread_pool::shared().get_scheduler()),
+              copy_receiver{*this});
+        });
+      }
+      UNIFEX_CATCH(...) {
+        unifex::set_error(std::move(receiver_), std::current_exception());
+        return;
+      }
+      unifex::start(copyOp_.get());
+    }
+
+  private:
+    void copy() noexcept {
+      if (get_stop_token(receiver_).stop_requested()) {
+        cancelled_ = true;
+      } else {
+        loff_t offsetIn = offsetIn_;
+        loff_t offsetOut = offsetOut_;
+        result_ = ::copy_file_range(
+            fdIn_,
+            offsetIn_ < 0 ? nullptr : &offsetIn,
+            fdOut_,
+            offsetOut_ < 0 ? nullptr : &offsetOut,
+            length_,
+            0);
+        errno_ = result_ < 0 ? errno : 0;
+      }
+      complete_on_io_thread();
+    }
+
+    void complete_on_io_thread() noexcept {
+      this->execute_ = &operation::on_copy_complete;
+      context_.schedule_remote(this);
+    }
+
+    static void on_copy_complete(operation_base* op) noexcept {
+      static_cast<operation*>(op)->complete();
+    }
+
+    void complete() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+      copyOp_.destruct();
+      if (exception_) {
+        unifex::set_error(std::move(receiver_), std::move(exception_));
+        return;
+      }
+      if (cancelled_) {
+        unifex::set_done(std::move(receiver_));
+        return;
+      }
+      if (result_ < 0) {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{errno_, std::system_category()});
+        return;
+      }
+
+      if constexpr (is_nothrow_receiver_of_v<Receiver, ssize_t>) {
+        unifex::set_value(std::move(receiver_), result_);
+      } else {
+        UNIFEX_TRY { unifex::set_value(std::move(receiver_), result_); }
+        UNIFEX_CATCH(...) {
+          unifex::set_error(std::move(receiver_), std::current_exception());
+        }
+      }
+    }
+
+    io_uring_context& context_;
+    int fdIn_;
+    offset_t offsetIn_;
+    int fdOut_;
+    offset_t offsetOut_;
+    std::size_t length_;
+    Receiver receiver_;
+    manual_lifetime<copy_op_t> copyOp_;
+    ssize_t result_ = 0;
+    int errno_ = 0;
+    bool cancelled_ = false;
+    std::exception_ptr exception_;
+  };
+
+public:
+  // Produces number of bytes copied, 0 at end-of-file.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<ssize_t>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit copy_file_range_sender(
+      io_uring_context& context,
+      int fdIn,
+      offset_t offsetIn,
+      int fdOut,
+      offset_t offsetOut,
+      std::size_t length) noexcept
+    : context_(context)
+    , fdIn_(fdIn)
+    , offsetIn_(offsetIn)
+    , fdOut_(fdOut)
+    , offsetOut_(offsetOut)
+    , length_(length) {}
+
+  template <typename Receiver>
+  operation<remove_cvref_t<Receiver>> connect(Receiver&& r) const {
+    return operation<remove_cvref_t<Receiver>>{*this, (Receiver &&) r};
+  }
+
+private:
+  io_uring_context& context_;
+  int fdIn_;
+  offset_t offsetIn_;
+  int fdOut_;
+  offset_t offsetOut_;
+  std::size_t length_;
+};
+
+inline io_uring_context::copy_file_range_sender tag_invoke(
+    tag_t<async_copy_file_range>,
+    io_uring_context::scheduler s,
+    int fdIn,
+    std::int64_t offsetIn,
+    int fdOut,
+    std::int64_t offsetOut,
+    std::size_t length) noexcept {
+  return io_uring_context::copy_file_range_sender{
+      *s.context_, fdIn, offsetIn, fdOut, offsetOut, length};
+}
+
+// Receives or sends a batch of datagrams with a single recvmmsg() or
+// sendmmsg() issued from the I/O thread. When the socket is not ready the
+// operation waits for it with IORING_OP_POLL_ADD and then tries again.
+class io_uring_context::datagram_batch_sender {
+  template <typename Receiver>
+  class operation : private completion_base {
+    friend io_uring_context;
+
+  public:
+    template <typename Receiver2>
+    explicit operation(const datagram_batch_sender& sender, Receiver2&& r)
+      : context_(sender.context_)
+      , fd_(sender.fd_)
+      , send_(sender.send_)
+      , batch_(sender.slots_)
+      , receiver_((Receiver2 &&) r) {}
+
+    operation(operation&&) = delete;
+
+    void start() noexcept {
+      if (!context_.is_running_on_io_thread()) {
+        this->execute_ = &operation::on_schedule_complete;
+        context_.schedule_remote(this);
+      } else {
+        try_io();
+      }
+    }
+
+  private:
+    static void on_schedule_complete(operation_base* op) noexcept {
+      static_cast<operation*>(op)->try_io();
+    }
+
+    void try_io() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+
+      const int result = send_ ? batch_.send(fd_) : batch_.receive(fd_);
+      if (result >= 0) {
+        if constexpr (is_nothrow_receiver_of_v<Receiver, std::size_t>) {
+          unifex::set_value(std::move(receiver_), std::size_t(result));
+        } else {
+          UNIFEX_TRY {
+            unifex::set_value(std::move(receiver_), std::size_t(result));
+          }
+          UNIFEX_CATCH(...) {
+            unifex::set_error(std::move(receiver_), std::current_exception());
+          }
+        }
+      } else if (result == -EAGAIN) {
+        submit_poll();
+      } else {
+        unifex::set_error(
+            std::move(receiver_),
+            std::error_code{-result, std::system_category()});
+      }
+    }
+
+    static void on_schedule_poll(operation_base* op) noexcept {
+      static_cast<operation*>(op)->submit_poll();
+    }
+
+    void submit_poll() noexcept {
+      auto populateSqe = [this](io_uring_sqe& sqe) noexcept {
+        sqe.opcode = IORING_OP_POLL_ADD;
+        sqe.fd = fd_;
+        sqe.poll32_events = send_ ? POLLOUT : POLLIN;
+        sqe.user_data = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(this));
+
+        this->execute_ = &operation::on_poll_complete;
+      };
+
+      if (!context_.try_submit_io(populateSqe)) {
+        this->execute_ = &operation::on_schedule_poll;
+        context_.schedule_pending_io(this);
+        return;
+      }
+
+      // Registered only once the poll is submitted, as a poll that is
+      // submitted after the cancellation request would never complete.
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_callback{*this});
+    }
+
+    void request_stop() noexcept {
+      if (char expected = 1; !refCount_.compare_exchange_strong(
+              expected, 2, std::memory_order_relaxed)) {
+        // lost race with on_poll_complete
+        UNIFEX_ASSERT(expected == 0);
+        return;
+      }
+      if (context_.is_running_on_io_thread()) {
+        request_stop_local();
+      } else {
+        request_stop_remote();
+      }
+    }
+
+    void request_stop_local() noexcept {
+      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+      auto populateSqe = [this](io_uring_sqe& sqe) noexcept {
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.fd = -1;
+        sqe.off = 0;
+        auto op = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(this));
+        // sqe.addr is the user_data to look for and cancel
+        sqe.addr = op;
+        sqe.len = 0;
+        auto cop = reinterpret_cast<std::uintptr_t>(
+            static_cast<completion_base*>(&cop_));
+        sqe.user_data = cop;
+        cop_.execute_ = &cancel_operation::on_stop_complete;
+      };
+
+      if (!context_.try_submit_io(populateSqe)) {
+        cop_.execute_ = &cancel_operation::on_schedule_stop_complete;
+        context_.schedule_pending_io(&cop_);
+      }
+    }
+
+    void request_stop_remote() noexcept {
+      cop_.execute_ = &cancel_operation::on_schedule_stop_complete;
+      context_.schedule_remote(&cop_);
+    }
+
+    static void on_poll_complete(operation_base* op) noexcept {
+      auto& self = *static_cast<operation*>(op);
+      if (self.refCount_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        // stop callback is running, must complete the op
+        return;
+      }
+      self.stopCallback_.destruct();
+      if (get_stop_token(self.receiver_).stop_requested() ||
+          self.result_ == -ECANCELED) {
+        unifex::set_done(std::move(self.receiver_));
+      } else if (self.result_ < 0) {
+        unifex::set_error(
+            std::move(self.receiver_),
+            std::error_code{-self.result_, std::system_category()});
+      } else {
+        self.refCount_.store(1, std::memory_order_relaxed);
+        self.try_io();
+      }
+    }
+
+    struct cancel_operation final : completion_base {
+      operation& op_;
+
+      explicit cancel_operation(operation& op) noexcept : op_(op) {}
+      // intrusive list breaks if the same operation is submitted twice
+      // break the cycle: `on_stop_complete` delegates to the parent operation
+      static void on_stop_complete(operation_base* op) noexcept {
+        operation::on_poll_complete(&static_cast<cancel_operation*>(op)->op_);
+      }
+
+      static void on_schedule_stop_complete(operation_base* op) noexcept {
+        static_cast<cancel_operation*>(op)->op_.request_stop_local();
+      }
+    };
+
+    struct cancel_callback final {
+      operation& op_;
+
+      void operator()() noexcept { op_.request_stop(); }
+    };
+
+    io_uring_context& context_;
+    int fd_;
+    bool send_;
+    _dgram::message_batch batch_;
+    Receiver receiver_;
+    manual_lifetime<typename stop_token_type_t<
+        Receiver>::template callback_type<cancel_callback>>
+        stopCallback_;
+    std::atomic_char refCount_{1};
+    cancel_operation cop_{*this};
+  };
+
+public:
+  // Produces the number of slots received or sent.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<std::size_t>>;
+
+  // Note: Only case it might complete with exception_ptr is if the
+  // receiver's set_value() exits with an exception.
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit datagram_batch_sender(
+      io_uring_context& context,
+      int fd,
+      span<datagram> slots,
+      bool send) noexcept
+    : context_(context)
+    , fd_(fd)
+    , slots_(slots)
+    , send_(send) {}
+
+  template <typename Receiver>
+  operation<remove_cvref_t<Receiver>> connect(Receiver&& r) const {
+    return operation<remove_cvref_t<Receiver>>{*this, (Receiver &&) r};
+  }
+
+private:
+  io_uring_context& context_;
+  int fd_;
+  span<datagram> slots_;
+  bool send_;
+};
+
+class io_uring_context::async_datagram_socket {
+public:
+  explicit async_datagram_socket(io_uring_context& context, int fd) noexcept
+    : context_(context)
+    , fd_(fd) {}
+
+  // The underlying file descriptor, eg. for async_splice().
+  int native_handle() const noexcept { return fd_.get(); }
+
+private:
+  friend scheduler;
+
+  friend datagram_batch_sender tag_invoke(
+      tag_t<async_recv_batch>,
+      async_datagram_socket& socket,
+      span<datagram> slots) noexcept {
+    return datagram_batch_sender{
+        socket.context_, socket.fd_.get(), slots, false};
+  }
+
+  friend datagram_batch_sender tag_invoke(
+      tag_t<async_send_batch>,
+      async_datagram_socket& socket,
+      span<datagram> slots) noexcept {
+    return datagram_batch_sender{
+        socket.context_, socket.fd_.get(), slots, true};
+  }
+
+  io_uring_context& context_;
+  safe_file_descriptor fd_;
+};
+
 class io_uring_context::accept_stream {
 public:
   using offset_t = std::int64_t;
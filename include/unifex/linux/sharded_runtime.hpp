@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#if !UNIFEX_NO_LIBURING
+
+#  include <unifex/get_stop_token.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+#  include <unifex/manual_lifetime.hpp>
+#  include <unifex/memory_resource.hpp>
+#  include <unifex/receiver_concepts.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/stop_token_concepts.hpp>
+
+#  include <atomic>
+#  include <cstddef>
+#  include <exception>
+#  include <memory>
+#  include <type_traits>
+#  include <vector>
+
+#  include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace linuxos {
+
+// A thread-per-core runtime: a fixed set of shards, each of which is a
+// thread, optionally pinned to its own CPU, driving its own
+// io_uring_context.
+//
+// Work is moved between shards by scheduling onto another shard's
+// scheduler. When this is done from one of the runtime's shard threads the
+// operation is pushed onto a bounded single-producer/single-consumer ring
+// that is dedicated to that pair of shards, so cross-shard schedule()
+// takes no locks. The receiving shard is only woken (through its
+// io_uring_context's remote queue) when its ring goes from idle to
+// non-empty. From any other thread, or when the ring is full, schedule()
+// falls back to the target io_uring_context's own scheduler.
+//
+// Each shard also owns a memory resource that is only ever used from that
+// shard's thread and so needs no synchronisation.
+class sharded_runtime {
+  struct task_base {
+    void (*execute_)(task_base*) noexcept;
+  };
+
+  class spsc_ring;
+  struct drain_receiver;
+  struct shard;
+
+public:
+  class schedule_sender;
+  class scheduler;
+
+  static constexpr std::size_t no_shard = static_cast<std::size_t>(-1);
+
+  struct options {
+    // Number of shards. Zero means one per hardware thread.
+    std::size_t shardCount = 0;
+
+    // Pin the i'th shard's thread to the i'th CPU the process may run on,
+    // wrapping around if there are more shards than CPUs. Failure to pin is
+    // ignored.
+    bool pinThreads = true;
+
+    // Capacity of each cross-shard ring. Rounded up to a power of two.
+    std::size_t ringCapacity = 1024;
+
+    // Options for each shard's io_uring_context.
+    io_uring_context::options ioOptions;
+  };
+
+  sharded_runtime();
+
+  explicit sharded_runtime(const options& opts);
+
+  // Calls shutdown().
+  ~sharded_runtime();
+
+  sharded_runtime(sharded_runtime&&) = delete;
+
+  std::size_t shard_count() const noexcept { return shards_.size(); }
+
+  scheduler shard_scheduler(std::size_t index) noexcept;
+
+  // The shard's io_uring_context, eg. for opening files and sockets.
+  io_uring_context& shard_context(std::size_t index) noexcept;
+
+  // The index of the shard that the calling thread runs, or no_shard if
+  // the calling thread isn't one of this runtime's shard threads.
+  std::size_t this_shard() const noexcept;
+
+#  if !UNIFEX_NO_MEMORY_RESOURCE
+  // A memory resource for use by the given shard's thread only.
+  pmr::memory_resource& shard_memory_resource(std::size_t index) noexcept;
+
+  // The calling shard's memory resource, or the default memory resource if
+  // the calling thread isn't a shard thread of any sharded_runtime.
+  static pmr::memory_resource& this_shard_memory_resource() noexcept;
+#  endif
+
+  // Waits until every operation scheduled onto a shard has completed and
+  // no work is left in flight between shards, then stops and joins every
+  // shard thread. Must not be called from a shard thread.
+  //
+  // Work that is waiting on I/O or timers isn't waited for and must be
+  // cancelled or completed beforehand. Scheduling onto a shard after
+  // shutdown() has returned is not allowed.
+  void shutdown() noexcept;
+
+private:
+  // Pushes the task onto the ring from the calling shard to the target
+  // shard, waking the target if necessary. Returns false if the calling
+  // thread isn't another shard of this runtime or if the ring is full.
+  bool try_submit(std::size_t target, task_base* task) noexcept;
+
+  void fallback_finished() noexcept {
+    fallbackFinished_.fetch_add(1, std::memory_order_release);
+  }
+
+  void start_drain(spsc_ring& ring) noexcept;
+  void drain(spsc_ring& ring) noexcept;
+  void run_shard(std::size_t index, int cpu) noexcept;
+
+  std::vector<std::unique_ptr<shard>> shards_;
+  bool shutDown_ = false;
+
+  // Count schedule() operations that didn't go through a ring, so that
+  // shutdown() can wait for them too.
+  std::atomic<std::size_t> fallbackStarted_{0};
+  std::atomic<std::size_t> fallbackFinished_{0};
+};
+
+class sharded_runtime::schedule_sender {
+  template <typename Receiver>
+  class operation : private task_base {
+    // Completing the receiver may destroy the operation, so the runtime
+    // is read out of it first.
+    struct inner_receiver {
+      operation* op_;
+
+      void set_value() noexcept {
+        sharded_runtime& runtime = op_->runtime_;
+        op_->complete();
+        runtime.fallback_finished();
+      }
+
+      void set_error(std::exception_ptr ex) noexcept {
+        sharded_runtime& runtime = op_->runtime_;
+        unifex::set_error(
+            static_cast<Receiver&&>(op_->receiver_), std::move(ex));
+        runtime.fallback_finished();
+      }
+
+      void set_done() noexcept {
+        sharded_runtime& runtime = op_->runtime_;
+        unifex::set_done(static_cast<Receiver&&>(op_->receiver_));
+        runtime.fallback_finished();
+      }
+    };
+
+    using inner_op_t = connect_result_t<
+        schedule_result_t<io_uring_context::scheduler>,
+        inner_receiver>;
+
+  public:
+    template <typename Receiver2>
+    explicit operation(
+        sharded_runtime& runtime,
+        io_uring_context& context,
+        std::size_t index,
+        Receiver2&&
+            r) noexcept(std::is_nothrow_constructible_v<Receiver, Receiver2>)
+      : runtime_(runtime)
+      , context_(context)
+      , index_(index)
+      , receiver_(static_cast<Receiver2&&>(r)) {
+      this->execute_ = &execute_impl;
+    }
+
+    operation(operation&&) = delete;
+
+    ~operation() {
+      if (fallback_) {
+        innerOp_.destruct();
+      }
+    }
+
+    void start() & noexcept {
+      if (runtime_.try_submit(index_, this)) {
+        return;
+      }
+      innerOp_.construct_with([&]() noexcept {
+        return unifex::connect(
+            unifex::schedule(context_.get_scheduler()),
+            inner_receiver{this});
+      });
+      fallback_ = true;
+      runtime_.fallbackStarted_.fetch_add(1, std::memory_order_relaxed);
+      unifex::start(innerOp_.get());
+    }
+
+  private:
+    static void execute_impl(task_base* t) noexcept {
+      static_cast<operation*>(t)->complete();
+    }
+
+    void complete() noexcept {
+      if constexpr (!is_stop_never_possible_v<stop_token_type_t<Receiver>>) {
+        if (get_stop_token(receiver_).stop_requested()) {
+          unifex::set_done(static_cast<Receiver&&>(receiver_));
+          return;
+        }
+      }
+
+      if constexpr (is_nothrow_receiver_of_v<Receiver>) {
+        unifex::set_value(static_cast<Receiver&&>(receiver_));
+      } else {
+        UNIFEX_TRY { unifex::set_value(static_cast<Receiver&&>(receiver_)); }
+        UNIFEX_CATCH(...) {
+          unifex::set_error(
+              static_cast<Receiver&&>(receiver_), std::current_exception());
+        }
+      }
+    }
+
+    sharded_runtime& runtime_;
+    io_uring_context& context_;
+    std::size_t index_;
+    UNIFEX_NO_UNIQUE_ADDRESS Receiver receiver_;
+    manual_lifetime<inner_op_t> innerOp_;
+    bool fallback_ = false;
+  };
+
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  template <typename Receiver>
+  operation<remove_cvref_t<Receiver>> connect(Receiver&& r) const {
+    return operation<remove_cvref_t<Receiver>>{
+        *runtime_, *context_, index_, static_cast<Receiver&&>(r)};
+  }
+
+private:
+  friend sharded_runtime::scheduler;
+
+  explicit schedule_sender(
+      sharded_runtime& runtime,
+      io_uring_context& context,
+      std::size_t index) noexcept
+    : runtime_(&runtime)
+    , context_(&context)
+    , index_(index) {}
+
+  sharded_runtime* runtime_;
+  io_uring_context* context_;
+  std::size_t index_;
+};
+
+class sharded_runtime::scheduler {
+public:
+  schedule_sender schedule() const noexcept {
+    return schedule_sender{*runtime_, *context_, index_};
+  }
+
+  // Timers are handled by the shard's io_uring_context.
+  auto now() const noexcept { return io_scheduler().now(); }
+
+  auto schedule_at(const monotonic_clock::time_point& dueTime) const noexcept {
+    return io_scheduler().schedule_at(dueTime);
+  }
+
+  // The shard's io_uring_context scheduler, for file and socket I/O.
+  io_uring_context::scheduler io_scheduler() const noexcept {
+    return context_->get_scheduler();
+  }
+
+  std::size_t index() const noexcept { return index_; }
+
+  friend bool operator==(scheduler a, scheduler b) noexcept {
+    return a.context_ == b.context_;
+  }
+  friend bool operator!=(scheduler a, scheduler b) noexcept {
+    return a.context_ != b.context_;
+  }
+
+private:
+  friend sharded_runtime;
+
+  explicit scheduler(
+      sharded_runtime& runtime,
+      io_uring_context& context,
+      std::size_t index) noexcept
+    : runtime_(&runtime)
+    , context_(&context)
+    , index_(index) {}
+
+  bool currently_on_() const noexcept {
+    return runtime_->this_shard() == index_;
+  }
+
+  friend bool tag_invoke(tag_t<currently_on>, const scheduler& s) noexcept {
+    return s.currently_on_();
+  }
+
+  sharded_runtime* runtime_;
+  io_uring_context* context_;
+  std::size_t index_;
+};
+
+inline sharded_runtime::scheduler
+sharded_runtime::shard_scheduler(std::size_t index) noexcept {
+  return scheduler{*this, shard_context(index), index};
+}
+
+}  // namespace linuxos
+}  // namespace unifex
+
+#  include <unifex/detail/epilogue.hpp>
+
+#endif  // !UNIFEX_NO_LIBURING
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/socket_concepts.hpp>
+
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace linuxos {
+
+// A copyable IPv4 or IPv6 endpoint that can be passed to async_connect(),
+// or filled in by the kernel with the peer of a received datagram.
+class socket_address {
+public:
+  socket_address() noexcept : size_(0) {
+    std::memset(&storage_, 0, sizeof(storage_));
+  }
+
+  explicit socket_address(const sockaddr_in& addr) noexcept
+    : socket_address() {
+    std::memcpy(&storage_, &addr, sizeof(addr));
+    size_ = sizeof(addr);
+  }
+
+  explicit socket_address(const sockaddr_in6& addr) noexcept
+    : socket_address() {
+    std::memcpy(&storage_, &addr, sizeof(addr));
+    size_ = sizeof(addr);
+  }
+
+  static socket_address ipv4_loopback(port_t port) noexcept {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return socket_address{addr};
+  }
+
+  static socket_address ipv6_loopback(port_t port) noexcept {
+    sockaddr_in6 addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_port = htons(port);
+    addr.sin6_addr = in6addr_loopback;
+    return socket_address{addr};
+  }
+
+  // The address that the socket 'fd' is bound to, or an empty address if
+  // it cannot be determined.
+  static socket_address local_address_of(int fd) noexcept {
+    socket_address result;
+    socklen_t size = capacity();
+    if (::getsockname(fd, result.data(), &size) == 0) {
+      result.resize(size);
+    }
+    return result;
+  }
+
+  int family() const noexcept { return storage_.ss_family; }
+
+  port_t port() const noexcept {
+    switch (family()) {
+      case AF_INET:
+        return ntohs(reinterpret_cast<const sockaddr_in&>(storage_).sin_port);
+      case AF_INET6:
+        return ntohs(
+            reinterpret_cast<const sockaddr_in6&>(storage_).sin6_port);
+      default:
+        return 0;
+    }
+  }
+
+  const sockaddr* data() const noexcept {
+    return reinterpret_cast<const sockaddr*>(&storage_);
+  }
+
+  sockaddr* data() noexcept { return reinterpret_cast<sockaddr*>(&storage_); }
+
+  socklen_t size() const noexcept { return size_; }
+
+  static constexpr socklen_t capacity() noexcept {
+    return sizeof(sockaddr_storage);
+  }
+
+  // Records how much of the storage was filled in through data().
+  void resize(socklen_t size) noexcept { size_ = size; }
+
+private:
+  sockaddr_storage storage_;
+  socklen_t size_;
+};
+
+}  // namespace linuxos
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
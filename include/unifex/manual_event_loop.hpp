@@ -18,6 +18,7 @@
 #include <unifex/blocking.hpp>
 #include <unifex/get_stop_token.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
 #include <unifex/stop_token_concepts.hpp>
 
 #include <condition_variable>
@@ -121,6 +122,11 @@ public:
   public:
     schedule_task schedule() const noexcept { return schedule_task{loop_}; }
 
+    friend bool
+    tag_invoke(tag_t<currently_on>, const scheduler& s) noexcept {
+      return s.currently_on_();
+    }
+
     friend bool operator==(scheduler a, scheduler b) noexcept {
       return a.loop_ == b.loop_;
     }
@@ -129,6 +135,10 @@ public:
     }
 
   private:
+    bool currently_on_() const noexcept {
+      return loop_->is_running_on_loop_thread();
+    }
+
     context* loop_;
   };
 
@@ -139,8 +149,17 @@ public:
   void stop();
 
 private:
+  // The tasks held back on a thread by a schedule_batch.
+  struct batch;
+
   void enqueue(task_base* task);
 
+  // Appends the tasks linked from head to tail with a single wake-up.
+  void enqueue_list(task_base* head, task_base* tail);
+
+  // Whether the calling thread is inside a call to run() on this loop.
+  bool is_running_on_loop_thread() const noexcept;
+
   std::mutex mutex_;
   std::condition_variable cv_;
   task_base* head_ = nullptr;
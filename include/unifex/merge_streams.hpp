@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <unifex/detail/stream_fan_in.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _merge_streams {
+
+// The merge of the streams in Sources, which is either a std::tuple of
+// the source streams or a std::vector of them.
+template <typename Sources>
+struct _state {
+  class type;
+};
+template <typename Sources>
+using state = typename _state<Sources>::type;
+
+template <typename Sources>
+struct _traits;
+
+template <typename... Streams>
+struct _traits<std::tuple<Streams...>> {
+  using value_t = std::common_type_t<_fan_in::value_t<Streams>...>;
+  using errors =
+      concat_type_lists_unique_t<_fan_in::next_errors_t<Streams>...>;
+  using cleanup_errors =
+      concat_type_lists_unique_t<_fan_in::cleanup_errors_t<Streams>...>;
+
+  template <typename Owner>
+  using storage = std::tuple<_fan_in::source<Owner, Streams>...>;
+};
+
+template <typename Stream>
+struct _traits<std::vector<Stream>> {
+  using value_t = _fan_in::value_t<Stream>;
+  using errors = _fan_in::next_errors_t<Stream>;
+  using cleanup_errors = _fan_in::cleanup_errors_t<Stream>;
+
+  template <typename Owner>
+  using storage =
+      std::vector<std::unique_ptr<_fan_in::source<Owner, Stream>>>;
+};
+
+template <typename Sources>
+using state_base = _fan_in::state_base<
+    state<Sources>,
+    type_list<typename _traits<Sources>::value_t>,
+    typename _traits<Sources>::errors,
+    typename _traits<Sources>::cleanup_errors>;
+
+// Keeps a next() outstanding on each source once the first next() has been
+// called and emits values in the order they arrive. Each source has at
+// most one value waiting to be emitted, so the queue of sources with a
+// value waiting never holds more than one entry per source.
+template <typename Sources>
+class _state<Sources>::type : public state_base<Sources> {
+public:
+  using base = state_base<Sources>;
+  using value_t = typename _traits<Sources>::value_t;
+  using outcome_t = typename base::outcome_t;
+
+  friend base;
+  friend typename base::pump;
+
+  static constexpr bool stop_on_end = false;
+
+  template <typename... Streams>
+  explicit type(std::tuple<Streams...>&& streams)
+    : type(std::move(streams), std::index_sequence_for<Streams...>{}) {}
+
+  template <typename Stream>
+  explicit type(std::vector<Stream>&& streams) : ready_(streams.size()) {
+    sources_.reserve(streams.size());
+    for (std::size_t i = 0; i < streams.size(); ++i) {
+      sources_.push_back(std::make_unique<_fan_in::source<type, Stream>>(
+          _fan_in::source_init<type, Stream>{this, i, std::move(streams[i])}));
+    }
+  }
+
+private:
+  template <typename... Streams, std::size_t... Is>
+  explicit type(std::tuple<Streams...>&& streams, std::index_sequence<Is...>)
+    : sources_(_fan_in::source_init<type, Streams>{
+          this, Is, std::get<Is>(std::move(streams))}...)
+    , ready_(sizeof...(Streams)) {}
+
+  template <typename Func>
+  void for_each_source(Func&& func) {
+    if constexpr (is_vector_v) {
+      for (auto& s : sources_) {
+        func(*s);
+      }
+    } else {
+      std::apply([&](auto&... s) { (func(s), ...); }, sources_);
+    }
+  }
+
+  std::size_t source_count() const noexcept { return ready_.size(); }
+
+  // Sources are pulled from once the first next() has been called.
+  bool should_pull() noexcept {
+    pulling_ = pulling_ || this->waiter_pending();
+    return pulling_;
+  }
+
+  template <typename Source>
+  void value_arrived(Source& s) noexcept {
+    ready_[(readyHead_ + readyCount_++) % ready_.size()] = s.index_;
+  }
+
+  std::optional<outcome_t> take_outcome() noexcept {
+    if (this->finished_ || this->stopping_) {
+      this->finished_ = true;
+      return outcome_t{std::in_place_index<0>};
+    }
+    if (readyCount_ != 0) {
+      const std::size_t index = ready_[readyHead_];
+      readyHead_ = (readyHead_ + 1) % ready_.size();
+      --readyCount_;
+      std::optional<outcome_t> outcome;
+      for_each_source([&](auto& s) {
+        if (s.index_ == index) {
+          UNIFEX_TRY {
+            outcome.emplace(
+                std::in_place_index<1>, value_t(std::move(*s.value_)));
+          }
+          UNIFEX_CATCH(...) {
+            this->finished_ = true;
+            outcome.emplace(
+                std::in_place_index<2>,
+                std::in_place_type<std::exception_ptr>,
+                std::current_exception());
+          }
+          s.value_.reset();
+        }
+      });
+      return outcome;
+    }
+    if (this->error_) {
+      this->finished_ = true;
+      outcome_t outcome{std::in_place_index<2>, std::move(*this->error_)};
+      this->error_.reset();
+      return outcome;
+    }
+    bool allEnded = true;
+    for_each_source([&](auto& s) { allEnded = allEnded && s.ended_; });
+    if (allEnded) {
+      this->finished_ = true;
+      return outcome_t{std::in_place_index<0>};
+    }
+    return std::nullopt;
+  }
+
+  static constexpr bool is_vector_v = instance_of_v<std::vector, Sources>;
+
+  typename _traits<Sources>::template storage<type> sources_;
+  bool pulling_ = false;
+
+  // Indices of the sources with a value waiting, in order of arrival.
+  std::vector<std::size_t> ready_;
+  std::size_t readyHead_ = 0;
+  std::size_t readyCount_ = 0;
+};
+
+template <typename Sources>
+using stream = _fan_in::stream<state<Sources>>;
+
+inline const struct _fn {
+  template(typename... Streams)                                        //
+      (requires(sizeof...(Streams) > 0) AND                            //
+       (!(instance_of_v<std::vector, remove_cvref_t<Streams>> || ...)))  //
+      stream<std::tuple<remove_cvref_t<Streams>...>>
+      operator()(Streams&&... streams) const {
+    using sources_t = std::tuple<remove_cvref_t<Streams>...>;
+    return stream<sources_t>{std::make_unique<state<sources_t>>(
+        sources_t{(Streams &&) streams...})};
+  }
+
+  template <typename Stream>
+  stream<std::vector<Stream>> operator()(std::vector<Stream> streams) const {
+    using sources_t = std::vector<Stream>;
+    return stream<sources_t>{
+        std::make_unique<state<sources_t>>(std::move(streams))};
+  }
+} merge_streams{};
+}  // namespace _merge_streams
+
+// Interleaves the values of several streams in the order they are produced.
+//
+// Takes the streams either as arguments, which must produce values of a
+// common type, or as a std::vector of streams. Once next() is first called
+// a next() is kept outstanding on every source, and the stream ends once
+// all sources have ended. The first error from a source stops the other
+// sources, and is emitted after the values that arrived before it.
+// cleanup() cleans up all sources concurrently.
+using _merge_streams::merge_streams;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -18,11 +18,14 @@
 #include <unifex/get_stop_token.hpp>
 #include <unifex/receiver_concepts.hpp>
 
-#include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <exception>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <unifex/detail/prologue.hpp>
 
@@ -30,6 +33,16 @@ namespace unifex {
 namespace _new_thread {
 class context;
 
+struct task_base {
+  using execute_fn = void(task_base*) noexcept;
+
+  explicit task_base(execute_fn* execute) noexcept : execute_(execute) {}
+
+  void execute() noexcept { execute_(this); }
+
+  execute_fn* execute_;
+};
+
 template <typename Receiver>
 struct _op {
   class type;
@@ -38,25 +51,21 @@ template <typename Receiver>
 using operation = typename _op<remove_cvref_t<Receiver>>::type;
 
 template <typename Receiver>
-class _op<Receiver>::type final {
+class _op<Receiver>::type final : task_base {
 public:
   template <typename Receiver2>
   explicit type(context* ctx, Receiver2&& r)
-    : ctx_(ctx)
+    : task_base(&type::execute_impl)
+    , ctx_(ctx)
     , receiver_((Receiver2 &&) r) {}
 
-  ~type() { UNIFEX_ASSERT(!thread_.joinable()); }
-
   void start() & noexcept;
 
 private:
-  void run() noexcept;
+  static void execute_impl(task_base* t) noexcept;
 
   context* ctx_;
   Receiver receiver_;
-
-  std::mutex mut_;
-  std::thread thread_;
 };
 
 class context {
@@ -111,39 +120,107 @@ private:
     context* context_;
   };
 
+  // A thread that is either running a task or parked in idle_ waiting for
+  // the next one.
+  struct worker {
+    std::thread thread_;
+    std::condition_variable cv_;
+    task_base* task_ = nullptr;
+    bool stop_ = false;
+  };
+
 public:
-  context() = default;
+  static constexpr std::size_t default_max_cached_threads = 16;
+
+  context() noexcept : context(default_max_cached_threads) {}
+
+  // Threads that finish running an operation park themselves until the
+  // next schedule() rather than exiting, as long as fewer than
+  // maxCachedThreads are already parked. Passing 0 starts a fresh thread
+  // for every operation.
+  explicit context(std::size_t maxCachedThreads) noexcept
+    : maxCachedThreads_(maxCachedThreads) {}
 
   ~context() {
-    // The activeThreadCount_ counter is initialised to 1 so it will never get
-    // to zero until after enter the destructor and decrement the last count
-    // here. We do this so that the retire_thread() call doesn't end up calling
-    // into the cv_.notify_one() until we are about to start waiting on the
-    // cv.
-    activeThreadCount_.fetch_sub(1, std::memory_order_relaxed);
-
-    std::unique_lock lk{mut_};
-    cv_.wait(lk, [this]() noexcept {
-      return activeThreadCount_.load(std::memory_order_relaxed) == 0;
-    });
-    if (threadToJoin_.joinable()) {
-      threadToJoin_.join();
+    std::thread lastThread;
+    {
+      std::unique_lock lk{mut_};
+      stopping_ = true;
+      for (worker* w : idle_) {
+        w->stop_ = true;
+        w->cv_.notify_one();
+      }
+      idle_.clear();
+
+      // Threads still running an operation see stopping_ once they are done
+      // and exit rather than parking.
+      cv_.wait(lk, [this]() noexcept { return threadCount_ == 0; });
+      lastThread = std::move(threadToJoin_);
+    }
+
+    // The last thread to exit joins the one that exited before it, so once
+    // this join returns every thread has finished, including destroying its
+    // thread-locals.
+    if (lastThread.joinable()) {
+      lastThread.join();
     }
   }
 
   scheduler get_scheduler() noexcept { return scheduler{this}; }
 
 private:
-  void retire_thread(std::thread t) noexcept {
-    std::thread prevThread;
-    {
-      std::lock_guard lk{mut_};
-      prevThread = std::exchange(threadToJoin_, std::move(t));
-      if (activeThreadCount_.fetch_sub(1, std::memory_order_relaxed) == 1) {
-        cv_.notify_one();
+  // Hands the task to a parked thread if there is one, otherwise starts a
+  // new thread for it. Either way the task gets a thread to itself.
+  void run_on_own_thread(task_base* task) {
+    std::lock_guard lk{mut_};
+    if (!idle_.empty()) {
+      worker* w = idle_.back();
+      idle_.pop_back();
+      w->task_ = task;
+      w->cv_.notify_one();
+      return;
+    }
+
+    auto w = std::make_unique<worker>();
+    w->task_ = task;
+    // The new thread can't retire, and so read thread_, until it acquires
+    // mut_, which we hold until after thread_ has been assigned.
+    w->thread_ = std::thread([this, w = w.get()]() noexcept { run(w); });
+    ++threadCount_;
+    w.release();
+  }
+
+  void run(worker* w) noexcept {
+    task_base* task = w->task_;
+    std::unique_lock lk{mut_, std::defer_lock};
+    for (;;) {
+      task->execute();
+
+      lk.lock();
+      if (stopping_ || idle_.size() >= maxCachedThreads_) {
+        break;
       }
+      w->task_ = nullptr;
+      idle_.push_back(w);
+      w->cv_.wait(
+          lk, [w]() noexcept { return w->task_ != nullptr || w->stop_; });
+      if (w->stop_) {
+        break;
+      }
+      task = w->task_;
+      lk.unlock();
+    }
+
+    // Retire: leave our std::thread for the next thread to exit (or the
+    // destructor) to join, and join the one that exited before us.
+    std::thread prevThread =
+        std::exchange(threadToJoin_, std::move(w->thread_));
+    if (--threadCount_ == 0) {
+      cv_.notify_one();
     }
+    lk.unlock();
 
+    delete w;
     if (prevThread.joinable()) {
       prevThread.join();
     }
@@ -151,66 +228,32 @@ private:
 
   std::mutex mut_;
   std::condition_variable cv_;
+  std::vector<worker*> idle_;
+  const std::size_t maxCachedThreads_;
+  std::size_t threadCount_ = 0;
   std::thread threadToJoin_;
-  std::atomic<size_t> activeThreadCount_ = 1;
+  bool stopping_ = false;
 };
 
 template <typename Receiver>
 inline void _op<Receiver>::type::start() & noexcept {
-  UNIFEX_TRY {
-    // Acquire the lock before launching the thread.
-    // This prevents the run() method from trying to read the thread_ variable
-    // until after we have finished assigning it.
-    //
-    // Note that this thread_ variable is private to this particular operation
-    // state and so will only be accessed by this start() method and the run()
-    // method.
-    std::lock_guard opLock{mut_};
-    thread_ = std::thread([this]() noexcept { this->run(); });
-
-    // Now that we've successfully launched the thread, increment the active
-    // thread count in the context. Do this before we release the lock so that
-    // we ensure the count increment happens before the count decrement that
-    // is performed when the thread is being retired.
-    ctx_->activeThreadCount_.fetch_add(1, std::memory_order_relaxed);
-  }
+  UNIFEX_TRY { ctx_->run_on_own_thread(this); }
   UNIFEX_CATCH(...) {
     unifex::set_error(std::move(receiver_), std::current_exception());
   }
 }
 
 template <typename Receiver>
-inline void _op<Receiver>::type::run() noexcept {
-  // Read the thread_ and ctx_ members out from the operation-state
-  // and store them as local variables on the stack before calling the
-  // receiver completion-signalling methods as the receiver methods
-  // will likely end up destroying the operation-state object before
-  // they return.
-  context* ctx = ctx_;
-
-  std::thread thisThread;
-  {
-    // Wait until we can acquire the mutex here.
-    // This ensures that the read of thread_ happens-after the write to thread_
-    // inside start().
-    //
-    // TODO: This can be replaced with an atomic<bool>::wait() once we have
-    // access to C++20 atomics. This would eliminate the unnecessary
-    // synchronisation performed by the unlock() at end-of-scope here.
-    std::lock_guard opLock{mut_};
-    thisThread = std::move(thread_);
-  }
-
-  if (get_stop_token(receiver_).stop_requested()) {
-    unifex::set_done(std::move(receiver_));
+inline void _op<Receiver>::type::execute_impl(task_base* t) noexcept {
+  auto& self = *static_cast<type*>(t);
+  if (get_stop_token(self.receiver_).stop_requested()) {
+    unifex::set_done(std::move(self.receiver_));
   } else {
-    UNIFEX_TRY { unifex::set_value(std::move(receiver_)); }
+    UNIFEX_TRY { unifex::set_value(std::move(self.receiver_)); }
     UNIFEX_CATCH(...) {
-      unifex::set_error(std::move(receiver_), std::current_exception());
+      unifex::set_error(std::move(self.receiver_), std::current_exception());
     }
   }
-
-  ctx->retire_thread(std::move(thisThread));
 }
 
 }  // namespace _new_thread
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/finally.hpp>
+#include <unifex/just_from.hpp>
+#include <unifex/on.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/unstoppable.hpp>
+
+#include <type_traits>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _offload {
+inline const struct _fn {
+  template(typename Scheduler, typename Fn)  //
+      (requires scheduler<Scheduler> AND
+           std::is_invocable_v<remove_cvref_t<Fn>&>)  //
+      auto
+      operator()(Scheduler&& scheduler, Fn&& fn) const {
+    // Whatever fn produces is delivered once back on the scheduler of the
+    // receiver, which can't be cancelled once fn has run.
+    return finally(
+        on((Scheduler &&) scheduler, just_from((Fn &&) fn)),
+        unstoppable(schedule()));
+  }
+} offload{};
+}  // namespace _offload
+
+// Calls fn on the given scheduler's context, typically an
+// elastic_thread_pool, then completes with its result on the scheduler of
+// the receiver it is connected to. Meant for calls that block, so that
+// they don't hold up the caller's event loop.
+using _offload::offload;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
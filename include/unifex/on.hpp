@@ -16,6 +16,7 @@
 #pragma once
 
 #include <unifex/bind_back.hpp>
+#include <unifex/schedule_if_needed.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/sequence.hpp>
@@ -45,7 +46,8 @@ inline const struct _fn {
            scheduler<Scheduler> AND(!tag_invocable<_fn, Scheduler, Sender>))  //
       auto
       operator()(Scheduler&& scheduler, Sender&& sender) const {
-    auto scheduleSender = schedule(scheduler);
+    // Starts the sender inline if already on the scheduler's context.
+    auto scheduleSender = schedule_if_needed(scheduler);
     return sequence(
         std::move(scheduleSender),
         with_query_value(
@@ -0,0 +1,655 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/bulk_join.hpp>
+#include <unifex/bulk_schedule.hpp>
+#include <unifex/bulk_transform.hpp>
+#include <unifex/defer.hpp>
+#include <unifex/execution_policy.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/just_void_or_done.hpp>
+#include <unifex/let_value.hpp>
+#include <unifex/let_value_with.hpp>
+#include <unifex/let_value_with_stop_token.hpp>
+#include <unifex/repeat_effect_until.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sequence.hpp>
+#include <unifex/then.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _par_algo {
+
+// Chunks smaller than this aren't worth scheduling separately.
+inline constexpr std::size_t min_chunk_size = 1024;
+
+inline std::size_t max_chunks() noexcept {
+  static const std::size_t maxChunks =
+      4 * std::max(1u, std::thread::hardware_concurrency());
+  return maxChunks;
+}
+
+template <typename Policy>
+inline constexpr bool is_parallel_policy_v = is_one_of_v<
+    remove_cvref_t<Policy>,
+    parallel_policy,
+    parallel_unsequenced_policy>;
+
+// The number of chunks to split n elements into. Sequenced policies run the
+// whole range as a single chunk.
+template <typename Policy>
+std::size_t chunk_count(const Policy&, std::size_t n) noexcept {
+  if constexpr (is_parallel_policy_v<Policy>) {
+    return std::clamp<std::size_t>(n / min_chunk_size, 1, max_chunks());
+  } else {
+    return 1;
+  }
+}
+
+// The offset of the first element of chunk c of n elements split into
+// chunkCount chunks. chunk_offset(n, chunkCount, chunkCount) == n.
+template <typename Diff>
+Diff chunk_offset(Diff n, std::size_t chunkCount, std::size_t c) noexcept {
+  return static_cast<Diff>(
+      static_cast<std::size_t>(n) * c / std::max<std::size_t>(chunkCount, 1));
+}
+
+template <typename Iterator>
+using diff_t = typename std::iterator_traits<Iterator>::difference_type;
+
+template <typename Iterator>
+using value_t = typename std::iterator_traits<Iterator>::value_type;
+
+// Runs func(c) for each chunk c in [0, chunkCount) on sched, concurrently if
+// the policy allows it. Chunks that haven't started when stop is requested
+// are skipped, and the sender then completes with done.
+template <typename Scheduler, typename Policy, typename Func>
+auto for_each_chunk(
+    Scheduler sched, Policy policy, std::size_t chunkCount, Func func) {
+  return let_value_with_stop_token(
+      [sched = std::move(sched), policy, chunkCount, func = std::move(func)](
+          inplace_stop_token stopToken) mutable {
+        return let_value(
+            bulk_join(bulk_transform(
+                bulk_schedule(sched, chunkCount),
+                [&func, stopToken](std::size_t c) {
+                  if (!stopToken.stop_requested()) {
+                    func(c);
+                  }
+                },
+                policy)),
+            [stopToken]() {
+              return just_void_or_done(!stopToken.stop_requested());
+            });
+      });
+}
+
+inline const struct _for_each_n_fn {
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Iterator,
+      typename Size,
+      typename Func)                   //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Scheduler sched,
+          Policy policy,
+          Iterator first,
+          Size n,
+          Func func) const {
+    const auto count = static_cast<diff_t<Iterator>>(n);
+    const std::size_t chunks =
+        chunk_count(policy, static_cast<std::size_t>(count));
+    return then(
+        for_each_chunk(
+            std::move(sched),
+            policy,
+            chunks,
+            [first, count, chunks, func = std::move(func)](
+                std::size_t c) mutable {
+              const auto end = first + chunk_offset(count, chunks, c + 1);
+              for (auto it = first + chunk_offset(count, chunks, c); it != end;
+                   ++it) {
+                std::invoke(func, *it);
+              }
+            }),
+        [first, count]() { return first + count; });
+  }
+} for_each_n{};
+
+inline const struct _transform_fn {
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Iterator,
+      typename OutIterator,
+      typename Func)                   //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Scheduler sched,
+          Policy policy,
+          Iterator first,
+          Iterator last,
+          OutIterator out,
+          Func func) const {
+    const auto count = std::distance(first, last);
+    const std::size_t chunks =
+        chunk_count(policy, static_cast<std::size_t>(count));
+    return then(
+        for_each_chunk(
+            std::move(sched),
+            policy,
+            chunks,
+            [first, out, count, chunks, func = std::move(func)](
+                std::size_t c) mutable {
+              const auto begin = chunk_offset(count, chunks, c);
+              const auto end = chunk_offset(count, chunks, c + 1);
+              std::transform(first + begin, first + end, out + begin, func);
+            }),
+        [out, count]() { return out + count; });
+  }
+} transform{};
+
+inline const struct _count_if_fn {
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Iterator,
+      typename Pred)                   //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Scheduler sched,
+          Policy policy,
+          Iterator first,
+          Iterator last,
+          Pred pred) const {
+    const auto count = std::distance(first, last);
+    const std::size_t chunks =
+        chunk_count(policy, static_cast<std::size_t>(count));
+    return let_value_with(
+        [chunks]() { return std::vector<diff_t<Iterator>>(chunks); },
+        [sched = std::move(sched),
+         policy,
+         first,
+         count,
+         chunks,
+         pred = std::move(pred)](
+            std::vector<diff_t<Iterator>>& counts) mutable {
+          return then(
+              for_each_chunk(
+                  std::move(sched),
+                  policy,
+                  chunks,
+                  [&counts, first, count, chunks, pred = std::move(pred)](
+                      std::size_t c) mutable {
+                    counts[c] = std::count_if(
+                        first + chunk_offset(count, chunks, c),
+                        first + chunk_offset(count, chunks, c + 1),
+                        pred);
+                  }),
+              [&counts]() {
+                return std::accumulate(
+                    counts.begin(), counts.end(), diff_t<Iterator>(0));
+              });
+        });
+  }
+} count_if{};
+
+inline const struct _min_element_fn {
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Iterator,
+      typename Compare = std::less<>)  //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Scheduler sched,
+          Policy policy,
+          Iterator first,
+          Iterator last,
+          Compare comp = {}) const {
+    const auto count = std::distance(first, last);
+    const std::size_t chunks =
+        chunk_count(policy, static_cast<std::size_t>(count));
+    return let_value_with(
+        [chunks, last]() { return std::vector<Iterator>(chunks, last); },
+        [sched = std::move(sched), policy, first, last, count, chunks, comp](
+            std::vector<Iterator>& minima) mutable {
+          return then(
+              for_each_chunk(
+                  std::move(sched),
+                  policy,
+                  chunks,
+                  [&minima, first, count, chunks, comp](std::size_t c) {
+                    const auto end = first + chunk_offset(count, chunks, c + 1);
+                    const auto it = std::min_element(
+                        first + chunk_offset(count, chunks, c), end, comp);
+                    if (it != end) {
+                      minima[c] = it;
+                    }
+                  }),
+              // Only replace the result with a strictly smaller minimum from
+              // a later chunk so that, like std::min_element(), this finds
+              // the first of several equal minima.
+              [&minima, last, comp]() {
+                Iterator result = last;
+                for (Iterator it : minima) {
+                  if (it != last &&
+                      (result == last || std::invoke(comp, *it, *result))) {
+                    result = it;
+                  }
+                }
+                return result;
+              });
+        });
+  }
+} min_element{};
+
+template <typename T>
+struct scan_state {
+  // The reduction of each chunk but the last, and the value carried into
+  // each chunk from the chunks before it.
+  std::vector<std::optional<T>> sums;
+  std::vector<std::optional<T>> carries;
+};
+
+// Two-pass block scan: the first pass reduces each chunk but the last, the
+// chunk reductions are scanned serially, and the second pass scans each
+// chunk starting from the value carried into it.
+template <
+    bool Exclusive,
+    typename T,
+    typename Scheduler,
+    typename Policy,
+    typename Iterator,
+    typename OutIterator,
+    typename Op>
+auto scan(
+    Scheduler sched,
+    Policy policy,
+    Iterator first,
+    Iterator last,
+    OutIterator out,
+    Op op,
+    std::optional<T> init) {
+  const auto count = std::distance(first, last);
+  const std::size_t chunks =
+      chunk_count(policy, static_cast<std::size_t>(count));
+  return let_value_with(
+      [chunks, init = std::move(init)]() {
+        scan_state<T> state{
+            std::vector<std::optional<T>>(chunks - 1),
+            std::vector<std::optional<T>>(chunks)};
+        state.carries[0] = init;
+        return state;
+      },
+      [sched = std::move(sched), policy, first, out, count, chunks, op](
+          scan_state<T>& state) mutable {
+        auto reduce = for_each_chunk(
+            sched, policy, chunks - 1, [&state, first, count, chunks, op](
+                                           std::size_t c) mutable {
+              std::optional<T> sum;
+              const auto end = first + chunk_offset(count, chunks, c + 1);
+              for (auto it = first + chunk_offset(count, chunks, c); it != end;
+                   ++it) {
+                if (sum) {
+                  sum = std::invoke(op, std::move(*sum), *it);
+                } else {
+                  sum.emplace(*it);
+                }
+              }
+              state.sums[c] = std::move(sum);
+            });
+        auto carry = [&state, chunks, op]() mutable {
+          for (std::size_t c = 0; c + 1 < chunks; ++c) {
+            std::optional<T>& next = state.carries[c + 1];
+            next = state.carries[c];
+            if (state.sums[c]) {
+              if (next) {
+                next = std::invoke(op, std::move(*next), *state.sums[c]);
+              } else {
+                next = state.sums[c];
+              }
+            }
+          }
+        };
+        auto scanChunks = for_each_chunk(
+            std::move(sched),
+            policy,
+            chunks,
+            [&state, first, out, count, chunks, op](std::size_t c) mutable {
+              std::optional<T> acc = std::move(state.carries[c]);
+              const auto begin = chunk_offset(count, chunks, c);
+              const auto end = chunk_offset(count, chunks, c + 1);
+              for (auto i = begin; i != end; ++i) {
+                // Read the input before writing the output as the scan may
+                // be done in place.
+                if constexpr (Exclusive) {
+                  T value = first[i];
+                  out[i] = *acc;
+                  acc = std::invoke(op, std::move(*acc), std::move(value));
+                } else {
+                  if (acc) {
+                    acc = std::invoke(op, std::move(*acc), first[i]);
+                  } else {
+                    acc.emplace(first[i]);
+                  }
+                  out[i] = *acc;
+                }
+              }
+            });
+        return then(
+            sequence(
+                then(std::move(reduce), std::move(carry)),
+                std::move(scanChunks)),
+            [out, count]() { return out + count; });
+      });
+}
+
+inline const struct _inclusive_scan_fn {
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Iterator,
+      typename OutIterator,
+      typename Op = std::plus<>)       //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Scheduler sched,
+          Policy policy,
+          Iterator first,
+          Iterator last,
+          OutIterator out,
+          Op op = {}) const {
+    return scan<false, value_t<Iterator>>(
+        std::move(sched),
+        policy,
+        first,
+        last,
+        out,
+        std::move(op),
+        std::nullopt);
+  }
+
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Iterator,
+      typename OutIterator,
+      typename Op,
+      typename T)                      //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Scheduler sched,
+          Policy policy,
+          Iterator first,
+          Iterator last,
+          OutIterator out,
+          Op op,
+          T init) const {
+    return scan<false, T>(
+        std::move(sched),
+        policy,
+        first,
+        last,
+        out,
+        std::move(op),
+        std::optional<T>{std::move(init)});
+  }
+} inclusive_scan{};
+
+inline const struct _exclusive_scan_fn {
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Iterator,
+      typename OutIterator,
+      typename T,
+      typename Op = std::plus<>)       //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Scheduler sched,
+          Policy policy,
+          Iterator first,
+          Iterator last,
+          OutIterator out,
+          T init,
+          Op op = {}) const {
+    return scan<true, T>(
+        std::move(sched),
+        policy,
+        first,
+        last,
+        out,
+        std::move(op),
+        std::optional<T>{std::move(init)});
+  }
+} exclusive_scan{};
+
+template <typename Iterator>
+struct partition_state {
+  std::vector<unsigned char> matches;
+  // The number of matching elements in each chunk, and then the offset of
+  // the first matching element of each chunk in the result.
+  std::vector<diff_t<Iterator>> offsets;
+  diff_t<Iterator> matchCount = 0;
+  std::vector<std::optional<value_t<Iterator>>> scratch;
+};
+
+inline const struct _partition_fn {
+  // Stable: elements keep their relative order within each partition.
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Iterator,
+      typename Pred)                   //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Scheduler sched,
+          Policy policy,
+          Iterator first,
+          Iterator last,
+          Pred pred) const {
+    const auto count = std::distance(first, last);
+    const std::size_t chunks =
+        chunk_count(policy, static_cast<std::size_t>(count));
+    return let_value_with(
+        [count, chunks]() {
+          return partition_state<Iterator>{
+              std::vector<unsigned char>(static_cast<std::size_t>(count)),
+              std::vector<diff_t<Iterator>>(chunks),
+              0,
+              std::vector<std::optional<value_t<Iterator>>>(
+                  static_cast<std::size_t>(count))};
+        },
+        [sched = std::move(sched),
+         policy,
+         first,
+         count,
+         chunks,
+         pred = std::move(pred)](
+            partition_state<Iterator>& state) mutable {
+          auto classify = for_each_chunk(
+              sched,
+              policy,
+              chunks,
+              [&state, first, count, chunks, pred = std::move(pred)](
+                  std::size_t c) mutable {
+                diff_t<Iterator> matched = 0;
+                const auto end = chunk_offset(count, chunks, c + 1);
+                for (auto i = chunk_offset(count, chunks, c); i != end; ++i) {
+                  const bool match = std::invoke(pred, first[i]);
+                  state.matches[static_cast<std::size_t>(i)] = match;
+                  matched += match;
+                }
+                state.offsets[c] = matched;
+              });
+          auto prefix = [&state]() {
+            for (auto& offset : state.offsets) {
+              const auto matched = offset;
+              offset = state.matchCount;
+              state.matchCount += matched;
+            }
+          };
+          auto scatter = for_each_chunk(
+              sched,
+              policy,
+              chunks,
+              [&state, first, count, chunks](std::size_t c) {
+                const auto begin = chunk_offset(count, chunks, c);
+                const auto end = chunk_offset(count, chunks, c + 1);
+                auto matchOut = state.offsets[c];
+                auto otherOut = state.matchCount + (begin - matchOut);
+                for (auto i = begin; i != end; ++i) {
+                  auto& out = state.matches[static_cast<std::size_t>(i)]
+                      ? matchOut
+                      : otherOut;
+                  state.scratch[static_cast<std::size_t>(out++)].emplace(
+                      std::move(first[i]));
+                }
+              });
+          auto moveBack = for_each_chunk(
+              std::move(sched),
+              policy,
+              chunks,
+              [&state, first, count, chunks](std::size_t c) {
+                const auto end = chunk_offset(count, chunks, c + 1);
+                for (auto i = chunk_offset(count, chunks, c); i != end; ++i) {
+                  first[i] =
+                      std::move(*state.scratch[static_cast<std::size_t>(i)]);
+                }
+              });
+          return then(
+              sequence(
+                  then(std::move(classify), std::move(prefix)),
+                  std::move(scatter),
+                  std::move(moveBack)),
+              [&state, first]() { return first + state.matchCount; });
+        });
+  }
+} partition{};
+
+struct sort_state {
+  // The number of sorted chunks in each run.
+  std::size_t runChunks = 1;
+};
+
+inline const struct _sort_fn {
+  // Sorts each chunk and then merges pairs of adjacent runs of sorted chunks
+  // until the whole range is one run.
+  template(
+      typename Scheduler,
+      typename Policy,
+      typename Iterator,
+      typename Compare = std::less<>)  //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Scheduler sched,
+          Policy policy,
+          Iterator first,
+          Iterator last,
+          Compare comp = {}) const {
+    const auto count = std::distance(first, last);
+    const std::size_t chunks =
+        chunk_count(policy, static_cast<std::size_t>(count));
+    return let_value_with(
+        []() { return sort_state{}; },
+        [sched = std::move(sched), policy, first, count, chunks, comp](
+            sort_state& state) mutable {
+          auto sortChunks = for_each_chunk(
+              sched, policy, chunks, [first, count, chunks, comp](
+                                         std::size_t c) {
+                std::sort(
+                    first + chunk_offset(count, chunks, c),
+                    first + chunk_offset(count, chunks, c + 1),
+                    comp);
+              });
+          auto mergeRuns =
+              defer([&state, sched, policy, first, count, chunks, comp]() {
+                const std::size_t width = state.runChunks;
+                const std::size_t pairs =
+                    (chunks + 2 * width - 1) / (2 * width);
+                return then(
+                    for_each_chunk(
+                        sched,
+                        policy,
+                        pairs,
+                        [first, count, chunks, width, comp](std::size_t p) {
+                          const std::size_t begin = 2 * p * width;
+                          const std::size_t mid =
+                              std::min(begin + width, chunks);
+                          const std::size_t end =
+                              std::min(begin + 2 * width, chunks);
+                          std::inplace_merge(
+                              first + chunk_offset(count, chunks, begin),
+                              first + chunk_offset(count, chunks, mid),
+                              first + chunk_offset(count, chunks, end),
+                              comp);
+                        }),
+                    [&state]() { state.runChunks *= 2; });
+              });
+          return sequence(
+              std::move(sortChunks),
+              repeat_effect_until(std::move(mergeRuns), [&state, chunks]() {
+                return state.runChunks >= chunks;
+              }));
+        });
+  }
+} sort{};
+
+}  // namespace _par_algo
+
+// Sender-returning versions of standard algorithms over random access
+// ranges. Each algorithm splits its range into chunks and runs them on the
+// given scheduler, concurrently if the execution policy is par or
+// par_unseq. Cancellation is checked before each chunk.
+namespace parallel {
+using _par_algo::count_if;
+using _par_algo::exclusive_scan;
+using _par_algo::for_each_n;
+using _par_algo::inclusive_scan;
+using _par_algo::min_element;
+using _par_algo::partition;
+using _par_algo::sort;
+using _par_algo::transform;
+}  // namespace parallel
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -17,6 +17,9 @@
 
 #include <unifex/tag_invoke.hpp>
 
+#include <cstddef>
+#include <cstdint>
+
 #include <unifex/detail/prologue.hpp>
 
 namespace unifex {
@@ -29,8 +32,112 @@ inline const struct open_pipe_cpo {
     return unifex::tag_invoke(*this, (Executor &&) executor);
   }
 } open_pipe{};
+
+// Offset to pass to async_splice()/async_copy_file_range() to use (and
+// advance) the file position instead. Pipes and sockets have no offset.
+inline constexpr std::int64_t splice_no_offset = -1;
+
+// async_splice(scheduler, fdIn, offsetIn, fdOut, offsetOut, length)
+//
+// Returns a sender that moves up to 'length' bytes from 'fdIn' to 'fdOut'
+// without copying them through user space. At least one of the file
+// descriptors must refer to a pipe. Produces the number of bytes moved,
+// where 0 means that 'fdIn' reached end-of-file.
+inline const struct async_splice_cpo {
+  template <typename Scheduler>
+  auto operator()(
+      Scheduler&& sched,
+      int fdIn,
+      std::int64_t offsetIn,
+      int fdOut,
+      std::int64_t offsetOut,
+      std::size_t length) const
+      noexcept(is_nothrow_tag_invocable_v<
+               async_splice_cpo,
+               Scheduler,
+               int,
+               std::int64_t,
+               int,
+               std::int64_t,
+               std::size_t>)
+          -> tag_invoke_result_t<
+              async_splice_cpo,
+              Scheduler,
+              int,
+              std::int64_t,
+              int,
+              std::int64_t,
+              std::size_t> {
+    return unifex::tag_invoke(
+        *this, (Scheduler &&) sched, fdIn, offsetIn, fdOut, offsetOut, length);
+  }
+} async_splice{};
+
+// async_tee(scheduler, fdIn, fdOut, length)
+//
+// Returns a sender that duplicates up to 'length' bytes from the pipe 'fdIn'
+// into the pipe 'fdOut' without consuming them from 'fdIn'. Produces the
+// number of bytes duplicated.
+inline const struct async_tee_cpo {
+  template <typename Scheduler>
+  auto operator()(
+      Scheduler&& sched, int fdIn, int fdOut, std::size_t length) const
+      noexcept(is_nothrow_tag_invocable_v<
+               async_tee_cpo,
+               Scheduler,
+               int,
+               int,
+               std::size_t>)
+          -> tag_invoke_result_t<
+              async_tee_cpo,
+              Scheduler,
+              int,
+              int,
+              std::size_t> {
+    return unifex::tag_invoke(*this, (Scheduler &&) sched, fdIn, fdOut, length);
+  }
+} async_tee{};
+
+// async_copy_file_range(scheduler, fdIn, offsetIn, fdOut, offsetOut, length)
+//
+// Returns a sender that copies up to 'length' bytes between two regular
+// files inside the kernel, which lets file systems that support it share
+// the extents instead of copying them. Produces the number of bytes copied.
+inline const struct async_copy_file_range_cpo {
+  template <typename Scheduler>
+  auto operator()(
+      Scheduler&& sched,
+      int fdIn,
+      std::int64_t offsetIn,
+      int fdOut,
+      std::int64_t offsetOut,
+      std::size_t length) const
+      noexcept(is_nothrow_tag_invocable_v<
+               async_copy_file_range_cpo,
+               Scheduler,
+               int,
+               std::int64_t,
+               int,
+               std::int64_t,
+               std::size_t>)
+          -> tag_invoke_result_t<
+              async_copy_file_range_cpo,
+              Scheduler,
+              int,
+              std::int64_t,
+              int,
+              std::int64_t,
+              std::size_t> {
+    return unifex::tag_invoke(
+        *this, (Scheduler &&) sched, fdIn, offsetIn, fdOut, offsetOut, length);
+  }
+} async_copy_file_range{};
 }  // namespace _pipe_cpo
 
+using _pipe_cpo::async_copy_file_range;
+using _pipe_cpo::async_splice;
+using _pipe_cpo::async_tee;
+using _pipe_cpo::splice_no_offset;
 using _pipe_cpo::open_pipe;
 }  // namespace unifex
 
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+
+#include <cstddef>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+
+// While a schedule_batch is alive on a thread, schedulers that support
+// batching hold back the work started on that thread and, when the
+// outermost batch on the thread is destroyed, hand each context all of
+// its work at once: one splice into its queue and one wake-up, rather
+// than one of each per operation.
+//
+// Only wrap code that starts operations which don't complete or block
+// inside start(), eg. a group of schedule() operations. Anything that
+// waits for held-back work before the batch ends will deadlock.
+class schedule_batch {
+public:
+  // The work that one kind of scheduler has held back on this thread.
+  struct pending {
+    using flush_fn = void(pending*) noexcept;
+
+    explicit pending(flush_fn* flush) noexcept : flush_(flush) {}
+
+    flush_fn* flush_;
+    pending* next_ = nullptr;
+    bool queued_ = false;
+  };
+
+  schedule_batch() noexcept { ++depth_; }
+
+  schedule_batch(const schedule_batch&) = delete;
+  schedule_batch& operator=(const schedule_batch&) = delete;
+
+  ~schedule_batch() {
+    if (--depth_ == 0) {
+      flush();
+    }
+  }
+
+  // Whether work started on this thread may be held back.
+  static bool active() noexcept { return depth_ != 0; }
+
+  // Arranges for p to be flushed when the outermost batch ends. Does
+  // nothing if it is already arranged.
+  static void defer(pending& p) noexcept;
+
+private:
+  static void flush() noexcept;
+
+  static thread_local std::size_t depth_;
+  static thread_local pending* head_;
+};
+
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/blocking.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <cstddef>
+#include <exception>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _sched_if_needed {
+
+// Bounds the number of nested inline completions on a thread so that a
+// loop that keeps completing inline can't overflow the stack.
+struct inline_depth {
+  static constexpr std::size_t max = 16;
+  static thread_local std::size_t current_;
+};
+
+template <typename Scheduler, typename Receiver>
+struct _op {
+  class type;
+};
+template <typename Scheduler, typename Receiver>
+using operation = typename _op<Scheduler, remove_cvref_t<Receiver>>::type;
+
+template <typename Scheduler, typename Receiver>
+class _op<Scheduler, Receiver>::type {
+  using schedule_op_t =
+      connect_result_t<schedule_result_t<Scheduler&>, Receiver>;
+
+public:
+  template <typename Receiver2>
+  explicit type(const Scheduler& scheduler, Receiver2&& receiver) noexcept(
+      std::is_nothrow_copy_constructible_v<Scheduler>&&
+          std::is_nothrow_constructible_v<Receiver, Receiver2>)
+    : scheduler_(scheduler)
+    , receiver_(static_cast<Receiver2&&>(receiver)) {}
+
+  type(type&&) = delete;
+
+  ~type() {
+    if (scheduled_) {
+      scheduleOp_.destruct();
+    }
+  }
+
+  void start() & noexcept {
+    if (inline_depth::current_ < inline_depth::max &&
+        currently_on(scheduler_)) {
+      ++inline_depth::current_;
+      complete_inline();
+      --inline_depth::current_;
+      return;
+    }
+
+    UNIFEX_TRY {
+      scheduleOp_.construct_with([&] {
+        return unifex::connect(
+            unifex::schedule(scheduler_), static_cast<Receiver&&>(receiver_));
+      });
+      scheduled_ = true;
+    }
+    UNIFEX_CATCH(...) {
+      unifex::set_error(
+          static_cast<Receiver&&>(receiver_), std::current_exception());
+      return;
+    }
+    unifex::start(scheduleOp_.get());
+  }
+
+private:
+  // Completes as schedule() would, including with done if stop has
+  // already been requested.
+  void complete_inline() noexcept {
+    if constexpr (sender_traits<schedule_result_t<Scheduler&>>::sends_done) {
+      if (get_stop_token(receiver_).stop_requested()) {
+        unifex::set_done(static_cast<Receiver&&>(receiver_));
+        return;
+      }
+    }
+    if constexpr (is_nothrow_receiver_of_v<Receiver>) {
+      unifex::set_value(static_cast<Receiver&&>(receiver_));
+    } else {
+      UNIFEX_TRY {
+        unifex::set_value(static_cast<Receiver&&>(receiver_));
+      }
+      UNIFEX_CATCH(...) {
+        unifex::set_error(
+            static_cast<Receiver&&>(receiver_), std::current_exception());
+      }
+    }
+  }
+
+  UNIFEX_NO_UNIQUE_ADDRESS Scheduler scheduler_;
+  UNIFEX_NO_UNIQUE_ADDRESS Receiver receiver_;
+  manual_lifetime<schedule_op_t> scheduleOp_;
+  bool scheduled_ = false;
+};
+
+template <typename Scheduler>
+struct _sender {
+  class type;
+};
+template <typename Scheduler>
+using sender = typename _sender<remove_cvref_t<Scheduler>>::type;
+
+template <typename Scheduler>
+class _sender<Scheduler>::type {
+  using schedule_sender_t = schedule_result_t<Scheduler&>;
+
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<>>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename concat_type_lists_unique_t<
+      sender_error_types_t<schedule_sender_t, type_list>,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  static constexpr bool sends_done =
+      sender_traits<schedule_sender_t>::sends_done;
+
+  // Inline if already on the scheduler's context, otherwise whatever
+  // schedule() does.
+  static constexpr blocking_kind blocking = blocking_kind::maybe;
+
+  explicit type(Scheduler scheduler) noexcept(
+      std::is_nothrow_move_constructible_v<Scheduler>)
+    : scheduler_(static_cast<Scheduler&&>(scheduler)) {}
+
+  template(typename Receiver)                            //
+      (requires sender_to<schedule_sender_t, Receiver>)  //
+      operation<Scheduler, Receiver> connect(Receiver&& r) const {
+    return operation<Scheduler, Receiver>{
+        scheduler_, static_cast<Receiver&&>(r)};
+  }
+
+private:
+  UNIFEX_NO_UNIQUE_ADDRESS Scheduler scheduler_;
+};
+
+inline const struct _fn {
+  template(typename Scheduler)         //
+      (requires scheduler<Scheduler>)  //
+      sender<Scheduler>
+      operator()(Scheduler&& s) const
+      noexcept(std::is_nothrow_constructible_v<
+               remove_cvref_t<Scheduler>,
+               Scheduler>) {
+    return sender<Scheduler>{static_cast<Scheduler&&>(s)};
+  }
+} schedule_if_needed{};
+}  // namespace _sched_if_needed
+
+// A sender that completes on the given scheduler's execution context.
+//
+// Unlike schedule(), it completes inline, without a round trip through the
+// scheduler's queue, if currently_on(scheduler) reports that the calling
+// thread is already running on that context. An inline completion still
+// completes with done if stop has been requested and schedule() can
+// complete with done.
+using _sched_if_needed::schedule_if_needed;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
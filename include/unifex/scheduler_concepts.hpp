@@ -460,6 +460,32 @@ public:
 }  // namespace _now
 using _now::now;
 
+namespace _currently_on {
+// Query whether the calling thread is currently executing work on the
+// scheduler's execution context, such that a continuation could run inline
+// where it would otherwise have been scheduled onto that context.
+//
+// Returns false for schedulers that don't customise it. A false negative
+// only costs a redundant reschedule.
+inline const struct _fn {
+  template(typename Scheduler)                         //
+      (requires tag_invocable<_fn, const Scheduler&>)  //
+      bool
+      operator()(const Scheduler& s) const noexcept {
+    static_assert(is_nothrow_tag_invocable_v<_fn, const Scheduler&>);
+    return tag_invoke(*this, s);
+  }
+
+  template(typename Scheduler)                           //
+      (requires(!tag_invocable<_fn, const Scheduler&>))  //
+      constexpr bool
+      operator()(const Scheduler&) const noexcept {
+    return false;
+  }
+} currently_on{};
+}  // namespace _currently_on
+using _currently_on::currently_on;
+
 namespace _current {
 #if !UNIFEX_NO_COROUTINES
 template <typename Scheduler>
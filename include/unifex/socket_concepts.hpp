@@ -33,8 +33,77 @@ inline constexpr struct open_listening_socket_cpo final {
     return tag_invoke(*this, static_cast<Scheduler&&>(sched), port);
   }
 } open_listening_socket{};
+
+// async_connect(scheduler, address)
+//
+// Returns a sender that opens a stream socket and connects it to 'address'.
+// The sender completes with the connected socket object of the scheduler's
+// I/O context, which supports async_read_some()/async_write_some() (or their
+// '_at' variants) and closes the socket when destroyed.
+inline constexpr struct async_connect_cpo final {
+  template <typename Scheduler, typename Address>
+  constexpr auto operator()(Scheduler&& sched, const Address& address) const
+      noexcept(is_nothrow_tag_invocable_v<
+               async_connect_cpo,
+               Scheduler,
+               const Address&>)
+          -> tag_invoke_result_t<async_connect_cpo, Scheduler, const Address&> {
+    return tag_invoke(*this, static_cast<Scheduler&&>(sched), address);
+  }
+} async_connect{};
+
+// open_datagram_socket(scheduler, address)
+//
+// Opens a datagram socket of the scheduler's I/O context that is bound to
+// 'address'. Pass port 0 to let the kernel pick a free port.
+inline constexpr struct open_datagram_socket_cpo final {
+  template <typename Scheduler, typename Address>
+  constexpr auto operator()(Scheduler&& sched, const Address& address) const
+      noexcept(is_nothrow_tag_invocable_v<
+               open_datagram_socket_cpo,
+               Scheduler,
+               const Address&>)
+          -> tag_invoke_result_t<
+              open_datagram_socket_cpo,
+              Scheduler,
+              const Address&> {
+    return tag_invoke(*this, static_cast<Scheduler&&>(sched), address);
+  }
+} open_datagram_socket{};
+
+// async_recv_batch(socket, slots)
+//
+// Returns a sender that receives as many datagrams as are available, up to
+// one per slot, with a single completion. Produces the number of slots that
+// were filled in; the remaining slots are left untouched.
+inline constexpr struct async_recv_batch_cpo final {
+  template <typename Socket, typename Slots>
+  constexpr auto operator()(Socket& socket, Slots&& slots) const
+      noexcept(is_nothrow_tag_invocable_v<async_recv_batch_cpo, Socket&, Slots>)
+          -> tag_invoke_result_t<async_recv_batch_cpo, Socket&, Slots> {
+    return tag_invoke(*this, socket, static_cast<Slots&&>(slots));
+  }
+} async_recv_batch{};
+
+// async_send_batch(socket, slots)
+//
+// Returns a sender that sends one datagram per slot with a single
+// completion. Produces the number of slots that were sent, which may be
+// fewer than were passed if the socket's send buffer filled up.
+inline constexpr struct async_send_batch_cpo final {
+  template <typename Socket, typename Slots>
+  constexpr auto operator()(Socket& socket, Slots&& slots) const
+      noexcept(is_nothrow_tag_invocable_v<async_send_batch_cpo, Socket&, Slots>)
+          -> tag_invoke_result_t<async_send_batch_cpo, Socket&, Slots> {
+    return tag_invoke(*this, socket, static_cast<Slots&&>(slots));
+  }
+} async_send_batch{};
 }  // namespace _socket
 
+using _socket::async_connect;
+using _socket::async_recv_batch;
+using _socket::async_send_batch;
+using _socket::open_datagram_socket;
 using _socket::open_listening_socket;
 using _socket::port_t;
 }  // namespace unifex
@@ -15,16 +15,31 @@
  */
 #pragma once
 
+#include <unifex/bulk_schedule.hpp>
+#include <unifex/execution_policy.hpp>
+#include <unifex/get_execution_policy.hpp>
+#include <unifex/get_priority.hpp>
 #include <unifex/get_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/schedule_batch.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/stop_token_concepts.hpp>
+#include <unifex/detail/intrusive_pairing_heap.hpp>
 #include <unifex/detail/intrusive_queue.hpp>
 
+#include <array>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <type_traits>
 #include <vector>
@@ -36,8 +51,25 @@ namespace _static_thread_pool {
 struct task_base {
   task_base* next;
   void (*execute)(task_base*) noexcept;
+  // Only set when the pool's lanes use aging.
+  std::chrono::steady_clock::time_point enqueueTime;
 };
 
+// A task that waits in one worker's timer heap until it is due.
+struct timer_base : task_base {
+  timer_base* timerChild;
+  timer_base* timerNext;
+  timer_base* timerPrev;
+  std::chrono::steady_clock::time_point dueTime;
+  // The worker whose heap the timer goes in, and the lane it is moved to
+  // if it is cancelled before it is due.
+  std::uint32_t worker;
+  priority lane;
+  bool inHeap = false;
+};
+
+struct timer_cancel_callback;
+
 template <typename Receiver>
 struct _op {
   class type;
@@ -45,18 +77,86 @@ struct _op {
 template <typename Receiver>
 using operation = typename _op<remove_cvref_t<Receiver>>::type;
 
+template <typename Receiver>
+struct _timer_op {
+  class type;
+};
+template <typename Receiver>
+using timer_operation = typename _timer_op<remove_cvref_t<Receiver>>::type;
+
+template <typename Integral, typename Receiver, bool Chunked>
+struct _bulk_op {
+  class type;
+};
+template <typename Integral, typename Receiver, bool Chunked = false>
+using bulk_operation =
+    typename _bulk_op<Integral, remove_cvref_t<Receiver>, Chunked>::type;
+
 class context {
   template <typename Receiver>
   friend struct _op;
+  template <typename Receiver>
+  friend struct _timer_op;
+  template <typename Integral, typename Receiver, bool Chunked>
+  friend struct _bulk_op;
+  friend timer_cancel_callback;
 
 public:
+  // Selects every worker thread in the pool rather than those of one node.
+  static constexpr std::uint32_t any_node = ~std::uint32_t(0);
+
+  struct options {
+    // Number of worker threads. Zero means one per hardware thread.
+    std::uint32_t threadCount = 0;
+
+    // Pin each worker thread to one of the CPUs the process may run on,
+    // round robin within the worker's node. Ignored where unsupported.
+    bool pinThreads = false;
+
+    // Spread the worker threads over the NUMA nodes listed in sysfs, in
+    // proportion to the number of usable CPUs on each node. Each node's
+    // workers can be targeted with get_scheduler(node), and idle workers
+    // steal from the other workers on their node before trying other
+    // nodes. Without this, or where the topology can't be read, the pool
+    // has a single node.
+    bool numaAware = false;
+
+    // How workers keep higher priority lanes from starving lower ones.
+    enum class lane_policy {
+      // While several lanes have work, each lane gets a share of the
+      // worker's time in proportion to its weight.
+      weighted,
+      // Lanes are served strictly in priority order, except that a task
+      // that has waited longer than agingThreshold runs first.
+      aging
+    };
+    lane_policy lanePolicy = lane_policy::weighted;
+
+    // Indexed by priority. Must be non-zero.
+    std::array<std::uint32_t, priority_count> laneWeights = {1, 4, 16};
+
+    std::chrono::steady_clock::duration agingThreshold =
+        std::chrono::milliseconds(1);
+
+    // How many times a worker that runs out of work looks for more,
+    // spinning and then yielding in between, before it parks. At most
+    // half of the workers spin at once, and while any are spinning, new
+    // work doesn't wake a parked worker. Zero parks straight away.
+    std::uint32_t spinCount = 32;
+  };
+
   context();
   context(std::uint32_t threadCount);
+  explicit context(const options& opts);
   ~context();
 
   class scheduler {
     template <typename Receiver>
     friend struct _op;
+    template <typename Receiver>
+    friend struct _timer_op;
+    template <typename Integral, typename Receiver, bool Chunked>
+    friend struct _bulk_op;
     class schedule_sender {
     public:
       template <
@@ -78,7 +178,8 @@ public:
     private:
       template <typename Receiver>
       operation<Receiver> make_operation_(Receiver&& r) const {
-        return operation<Receiver>{pool_, (Receiver &&) r};
+        const priority lane = inheritPriority_ ? get_priority(r) : priority_;
+        return operation<Receiver>{pool_, node_, lane, (Receiver &&) r};
       }
 
       template(typename Receiver)           //
@@ -90,60 +191,418 @@ public:
 
       friend class context::scheduler;
 
-      explicit schedule_sender(context& pool) noexcept : pool_(pool) {}
+      explicit schedule_sender(
+          context& pool,
+          std::uint32_t node,
+          priority p,
+          bool inheritPriority) noexcept
+        : pool_(pool)
+        , node_(node)
+        , priority_(p)
+        , inheritPriority_(inheritPriority) {}
 
       context& pool_;
+      std::uint32_t node_;
+      priority priority_;
+      bool inheritPriority_;
     };
 
-    schedule_sender make_sender_() const { return schedule_sender{pool_}; }
+    // Completes once the due time has passed, which is measured from
+    // start() for schedule_after().
+    class timer_sender {
+    public:
+      template <
+          template <typename...>
+          class Variant,
+          template <typename...>
+          class Tuple>
+      using value_types = Variant<Tuple<>>;
+
+      template <template <typename...> class Variant>
+      using error_types = Variant<>;
+
+      static constexpr bool sends_done = true;
+
+      static constexpr blocking_kind blocking = blocking_kind::never;
+
+      static constexpr bool is_always_scheduler_affine = false;
+
+    private:
+      template <typename Receiver>
+      timer_operation<Receiver> make_operation_(Receiver&& r) const {
+        const priority lane = inheritPriority_ ? get_priority(r) : priority_;
+        return timer_operation<Receiver>{
+            pool_, node_, lane, dueTime_, delay_, (Receiver &&) r};
+      }
+
+      template(typename Receiver)           //
+          (requires receiver_of<Receiver>)  //
+          friend timer_operation<Receiver> tag_invoke(
+              tag_t<connect>, const timer_sender& s, Receiver&& r) {
+        return s.make_operation_((Receiver &&) r);
+      }
+
+      friend class context::scheduler;
+
+      explicit timer_sender(
+          context& pool,
+          std::uint32_t node,
+          priority p,
+          bool inheritPriority,
+          std::optional<std::chrono::steady_clock::time_point> dueTime,
+          std::chrono::steady_clock::duration delay) noexcept
+        : pool_(pool)
+        , node_(node)
+        , priority_(p)
+        , inheritPriority_(inheritPriority)
+        , dueTime_(dueTime)
+        , delay_(delay) {}
+
+      context& pool_;
+      std::uint32_t node_;
+      priority priority_;
+      bool inheritPriority_;
+      // Unset for schedule_after().
+      std::optional<std::chrono::steady_clock::time_point> dueTime_;
+      std::chrono::steady_clock::duration delay_;
+    };
+
+    // Splits the indices into chunks that run on several workers at once
+    // if the receiver's execution policy allows it, otherwise runs them
+    // all in a single task. If Chunked, sends index_range<Integral> chunks
+    // of indices to a receiver that takes them, as bulk_schedule_chunked()
+    // does.
+    template <typename Integral, bool Chunked = false>
+    class bulk_sender {
+    public:
+      template <
+          template <typename...>
+          class Variant,
+          template <typename...>
+          class Tuple>
+      using value_types = Variant<Tuple<>>;
+
+      template <
+          template <typename...>
+          class Variant,
+          template <typename...>
+          class Tuple>
+      using next_types = Variant<Tuple<
+          std::conditional_t<Chunked, index_range<Integral>, Integral>>>;
+
+      template <template <typename...> class Variant>
+      using error_types = Variant<std::exception_ptr>;
+
+      static constexpr bool sends_done = true;
+
+      static constexpr blocking_kind blocking = blocking_kind::never;
+
+      static constexpr bool is_always_scheduler_affine = false;
+
+    private:
+      template <typename Receiver>
+      bulk_operation<Integral, Receiver, Chunked>
+      make_operation_(Receiver&& r) const {
+        const priority lane = inheritPriority_ ? get_priority(r) : priority_;
+        return bulk_operation<Integral, Receiver, Chunked>{
+            pool_, node_, lane, count_, chunkSize_, (Receiver &&) r};
+      }
+
+      template(typename Receiver)                       //
+          (requires receiver_of<Receiver> AND(          //
+              is_next_receiver_v<Receiver, Integral> ||  //
+              _bulk_schedule::receives_chunks_v<
+                  remove_cvref_t<Receiver>,
+                  Integral,
+                  Chunked>))  //
+          friend bulk_operation<Integral, Receiver, Chunked> tag_invoke(
+              tag_t<connect>, const bulk_sender& s, Receiver&& r) {
+        return s.make_operation_((Receiver &&) r);
+      }
+
+      friend class context::scheduler;
+
+      explicit bulk_sender(
+          context& pool,
+          std::uint32_t node,
+          priority p,
+          bool inheritPriority,
+          Integral count,
+          std::size_t chunkSize) noexcept
+        : pool_(pool)
+        , node_(node)
+        , priority_(p)
+        , inheritPriority_(inheritPriority)
+        , count_(count)
+        , chunkSize_(chunkSize) {}
+
+      context& pool_;
+      std::uint32_t node_;
+      priority priority_;
+      bool inheritPriority_;
+      Integral count_;
+      // How many indices run between checks for cancellation.
+      std::size_t chunkSize_;
+    };
+
+    schedule_sender make_sender_() const {
+      return schedule_sender{pool_, node_, priority_, inheritPriority_};
+    }
+
+    template <bool Chunked, typename Integral>
+    bulk_sender<Integral, Chunked> make_bulk_sender_(Integral count) const {
+      return bulk_sender<Integral, Chunked>{
+          pool_,
+          node_,
+          priority_,
+          inheritPriority_,
+          count,
+          get_bulk_chunk_size(*this)};
+    }
+
+    template(typename Integral)                    //
+        (requires std::is_integral_v<Integral>)  //
+        friend bulk_sender<Integral> tag_invoke(
+            tag_t<bulk_schedule>, const scheduler& s, Integral count) {
+      return s.make_bulk_sender_<false>(count);
+    }
+
+    template(typename Integral)                    //
+        (requires std::is_integral_v<Integral>)  //
+        friend bulk_sender<Integral, true> tag_invoke(
+            tag_t<bulk_schedule_chunked>,
+            const scheduler& s,
+            Integral count) {
+      return s.make_bulk_sender_<true>(count);
+    }
 
     friend schedule_sender
     tag_invoke(tag_t<schedule>, const scheduler& s) noexcept {
       return s.make_sender_();
     }
 
+    bool currently_on_() const noexcept {
+      return pool_.is_running_on_pool_thread(node_);
+    }
+
+    friend bool
+    tag_invoke(tag_t<currently_on>, const scheduler& s) noexcept {
+      return s.currently_on_();
+    }
+
+    friend priority
+    tag_invoke(tag_t<get_priority>, const scheduler& s) noexcept {
+      return s.priority_;
+    }
+
+  public:
+    std::chrono::steady_clock::time_point now() const noexcept {
+      return std::chrono::steady_clock::now();
+    }
+
+    template <typename Rep, typename Ratio>
+    timer_sender
+    schedule_after(std::chrono::duration<Rep, Ratio> delay) const noexcept {
+      return timer_sender{
+          pool_,
+          node_,
+          priority_,
+          inheritPriority_,
+          std::nullopt,
+          std::chrono::ceil<std::chrono::steady_clock::duration>(delay)};
+    }
+
+    timer_sender
+    schedule_at(std::chrono::steady_clock::time_point dueTime) const noexcept {
+      return timer_sender{
+          pool_,
+          node_,
+          priority_,
+          inheritPriority_,
+          dueTime,
+          std::chrono::steady_clock::duration{}};
+    }
+
+  private:
     friend class context;
-    explicit scheduler(context& pool) noexcept : pool_(pool) {}
+    explicit scheduler(
+        context& pool,
+        std::uint32_t node,
+        priority p = priority::normal,
+        bool inheritPriority = true) noexcept
+      : pool_(pool)
+      , node_(node)
+      , priority_(p)
+      , inheritPriority_(inheritPriority) {}
 
     friend bool operator==(scheduler a, scheduler b) noexcept {
-      return &a.pool_ == &b.pool_;
+      return &a.pool_ == &b.pool_ && a.node_ == b.node_ &&
+          a.priority_ == b.priority_ &&
+          a.inheritPriority_ == b.inheritPriority_;
     }
     friend bool operator!=(scheduler a, scheduler b) noexcept {
-      return &a.pool_ != &b.pool_;
+      return !(a == b);
     }
 
     context& pool_;
+    std::uint32_t node_;
+    priority priority_;
+    bool inheritPriority_;
   };
 
-  scheduler get_scheduler() noexcept { return scheduler{*this}; }
+  // Work scheduled with this scheduler goes in the lane given by
+  // get_priority() of the receiver it completes to, which is normal unless
+  // the work's priority has been set further up, eg. with
+  // with_query_value().
+  scheduler get_scheduler() noexcept { return scheduler{*this, any_node}; }
+
+  // Work scheduled with this scheduler goes in the given priority lane.
+  scheduler get_scheduler(priority p) noexcept {
+    return scheduler{*this, any_node, p, false};
+  }
+
+  // A scheduler whose work only runs on the given node's worker threads.
+  scheduler get_scheduler(std::uint32_t node) noexcept {
+    UNIFEX_ASSERT(node < node_count());
+    return scheduler{*this, node};
+  }
+
+  scheduler get_scheduler(std::uint32_t node, priority p) noexcept {
+    UNIFEX_ASSERT(node < node_count());
+    return scheduler{*this, node, p, false};
+  }
+
+  std::uint32_t node_count() const noexcept { return nodeCount_; }
 
   void request_stop() noexcept;
 
 private:
-  class thread_state {
+  using task_queue = intrusive_queue<task_base, &task_base::next>;
+
+  // The tasks held back on a thread by a schedule_batch.
+  struct batch;
+
+  // A worker's queues, one per priority lane.
+  //
+  // Each thread_state is allocated by its own worker thread, after the
+  // worker has been pinned, so that it is placed in memory local to the
+  // worker's node. It is also aligned so that workers don't falsely share
+  // cache lines.
+  class alignas(64) thread_state {
   public:
+    thread_state(
+        const options& opts,
+        const std::atomic<std::uint32_t>& searching) noexcept
+      : options_(opts)
+      , searching_(searching) {}
+
     task_base* try_pop();
     task_base* pop();
-    bool try_push(task_base* task);
-    void push(task_base* task);
+    bool try_push(task_base* task, priority p);
+    void push(task_base* task, priority p);
+    void push_all(task_queue tasks, std::size_t count, priority p);
     void request_stop();
 
+    // Whether any of the lanes has a task, without taking the lock.
+    bool has_queued() const noexcept {
+      return queued_.load(std::memory_order_seq_cst) != 0;
+    }
+    // Wakes the worker if it is parked while its lanes have tasks.
+    void wake_if_parked_with_work();
+
+    // Returns a timer that is due, if any, without blocking for long.
+    task_base* try_pop_timer();
+    void add_timer(timer_base* timer);
+    void cancel_timer(timer_base* timer);
+
   private:
+    bool empty() const noexcept;
+    task_base* pop_next() noexcept;
+    void push_locked(task_base* task, priority p) noexcept;
+    void wake_locked(bool evenIfSearching) noexcept;
+    timer_base*
+    pop_due_timer(std::chrono::steady_clock::time_point now) noexcept;
+    void update_next_due() noexcept;
+
+    const options& options_;
+    const std::atomic<std::uint32_t>& searching_;
     std::mutex mut_;
     std::condition_variable cv_;
-    intrusive_queue<task_base, &task_base::next> queue_;
+    std::array<task_queue, priority_count> lanes_;
+    // The number of tasks in lanes_.
+    std::atomic<std::size_t> queued_{0};
+    // Whether the worker is waiting on cv_ and hasn't been notified yet.
+    bool parked_ = false;
+    // For the weighted lane policy.
+    std::array<std::int64_t, priority_count> credits_{};
     bool stopRequested_ = false;
+
+    intrusive_pairing_heap<
+        timer_base,
+        &timer_base::timerChild,
+        &timer_base::timerNext,
+        &timer_base::timerPrev,
+        std::chrono::steady_clock::time_point,
+        &timer_base::dueTime>
+        timers_;
+    // The earliest due time in timers_, in ticks since the clock's epoch,
+    // so that the worker can check for due timers without the lock.
+    std::atomic<std::chrono::steady_clock::rep> nextDue_{no_timers};
+    static constexpr std::chrono::steady_clock::rep no_timers =
+        std::chrono::steady_clock::duration::max().count();
   };
 
-  void run(std::uint32_t index) noexcept;
+  // The worker threads [firstThread_, firstThread_ + threadCount_) belong
+  // to this node.
+  struct node_state {
+    std::vector<int> cpus_;
+    std::uint32_t firstThread_ = 0;
+    std::uint32_t threadCount_ = 0;
+    std::atomic<std::uint32_t> nextThread_{0};
+  };
+
+  void run(std::uint32_t index, std::uint32_t node, int cpu) noexcept;
   void join() noexcept;
 
-  void enqueue(task_base* task) noexcept;
+  // Whether the calling thread is one of this pool's worker threads and,
+  // unless node is any_node, belongs to that node.
+  bool is_running_on_pool_thread(std::uint32_t node) const noexcept;
+
+  bool try_start_searching() noexcept;
+  bool any_queued() const noexcept;
+  void wake_parked_with_work() noexcept;
 
+  void enqueue(task_base* task, std::uint32_t node, priority p) noexcept;
+
+  // Picks the worker whose heap a timer for the given node goes in: the
+  // calling worker if it qualifies, otherwise the next in turn.
+  std::uint32_t select_timer_worker(std::uint32_t node) noexcept;
+  void add_timer(timer_base* timer) noexcept;
+  void cancel_timer(timer_base* timer) noexcept;
+
+  // Enqueues a list of count tasks, split into at most one chunk per
+  // worker so that each worker is woken at most once.
+  void enqueue_list(
+      task_queue tasks,
+      std::size_t count,
+      std::uint32_t node,
+      priority p) noexcept;
+
+  const options options_;
   std::uint32_t threadCount_;
   std::vector<std::thread> threads_;
-  std::vector<thread_state> threadStates_;
+  std::vector<std::unique_ptr<thread_state>> threadStates_;
+  std::unique_ptr<node_state[]> nodes_;
+  std::uint32_t nodeCount_ = 0;
   std::atomic<std::uint32_t> nextThread_;
+  // The number of workers spinning in search of work.
+  std::atomic<std::uint32_t> searching_{0};
+
+  // Used to wait for every worker to allocate its thread_state.
+  std::mutex startupMutex_;
+  std::condition_variable startupCv_;
+  std::uint32_t startedCount_ = 0;
+  bool startupAborted_ = false;
 };
 
 template <typename Receiver>
@@ -151,10 +610,15 @@ class _op<Receiver>::type : task_base {
   friend context::scheduler::schedule_sender;
 
   context& pool_;
+  std::uint32_t node_;
+  priority priority_;
   Receiver receiver_;
 
-  explicit type(context& pool, Receiver&& r)
+  explicit type(
+      context& pool, std::uint32_t node, priority p, Receiver&& r)
     : pool_(pool)
+    , node_(node)
+    , priority_(p)
     , receiver_((Receiver &&) r) {
     this->execute = [](task_base* t) noexcept {
       auto& op = *static_cast<type*>(t);
@@ -168,11 +632,228 @@ class _op<Receiver>::type : task_base {
     };
   }
 
-  void enqueue_(task_base* op) const { pool_.enqueue(op); }
+  void enqueue_(task_base* op) const {
+    pool_.enqueue(op, node_, priority_);
+  }
 
   friend void tag_invoke(tag_t<start>, type& op) noexcept { op.enqueue_(&op); }
 };
 
+struct timer_cancel_callback {
+  context& pool_;
+  timer_base* timer_;
+
+  void operator()() noexcept { pool_.cancel_timer(timer_); }
+};
+
+template <typename Receiver>
+class _timer_op<Receiver>::type : timer_base {
+  friend context::scheduler::timer_sender;
+
+  using stop_callback_type = typename stop_token_type_t<
+      Receiver&>::template callback_type<timer_cancel_callback>;
+
+  context& pool_;
+  std::uint32_t node_;
+  bool relative_;
+  std::chrono::steady_clock::duration delay_;
+  Receiver receiver_;
+  UNIFEX_NO_UNIQUE_ADDRESS manual_lifetime<stop_callback_type> cancelCallback_;
+
+  explicit type(
+      context& pool,
+      std::uint32_t node,
+      priority p,
+      std::optional<std::chrono::steady_clock::time_point> dueTime,
+      std::chrono::steady_clock::duration delay,
+      Receiver&& r)
+    : pool_(pool)
+    , node_(node)
+    , relative_(!dueTime)
+    , delay_(delay)
+    , receiver_((Receiver &&) r) {
+    if (dueTime) {
+      this->dueTime = *dueTime;
+    }
+    this->lane = p;
+    this->execute = [](task_base* t) noexcept {
+      auto& op = *static_cast<type*>(t);
+      op.cancelCallback_.destruct();
+      if constexpr (!is_stop_never_possible_v<stop_token_type_t<Receiver>>) {
+        if (get_stop_token(op.receiver_).stop_requested()) {
+          unifex::set_done((Receiver &&) op.receiver_);
+          return;
+        }
+      }
+      unifex::set_value((Receiver &&) op.receiver_);
+    };
+  }
+
+public:
+  void start() noexcept {
+    if (relative_) {
+      this->dueTime = std::chrono::steady_clock::now() + delay_;
+    }
+    this->worker = pool_.select_timer_worker(node_);
+    cancelCallback_.construct(
+        get_stop_token(receiver_), timer_cancel_callback{pool_, this});
+    pool_.add_timer(this);
+  }
+};
+
+template <typename Integral, typename Receiver, bool Chunked>
+class _bulk_op<Integral, Receiver, Chunked>::type {
+  template <typename, bool>
+  friend class context::scheduler::bulk_sender;
+
+  static constexpr bool receives_chunks =
+      _bulk_schedule::receives_chunks_v<Receiver, Integral, Chunked>;
+
+  struct chunk_task : task_base {
+    type* op_;
+    Integral first_;
+    Integral last_;
+  };
+
+  enum state { running, failed, cancelled };
+
+  explicit type(
+      context& pool,
+      std::uint32_t node,
+      priority p,
+      Integral count,
+      std::size_t chunkSize,
+      Receiver&& r)
+    : pool_(pool)
+    , node_(node)
+    , priority_(p)
+    , count_(count)
+    , chunkSize_(static_cast<Integral>(std::max<std::size_t>(chunkSize, 1)))
+    , receiver_((Receiver &&) r) {}
+
+public:
+  type(type&&) = delete;
+
+  void start() noexcept {
+    using policy_t = decltype(get_execution_policy(receiver_));
+    const std::size_t count =
+        count_ > Integral(0) ? static_cast<std::size_t>(count_) : 0;
+    // A chunked sender splits the indices on chunk boundaries, so that
+    // only the last index_range is shorter than chunkSize_.
+    const std::size_t unit =
+        Chunked ? static_cast<std::size_t>(chunkSize_) : 1;
+    const std::size_t units = (count + unit - 1) / unit;
+    std::size_t chunks = 1;
+    if constexpr (is_one_of_v<
+                      policy_t,
+                      parallel_policy,
+                      parallel_unsequenced_policy>) {
+      // A few chunks per worker, so that workers that finish early can
+      // steal the remaining ones.
+      if (units > 1) {
+        chunks = std::min<std::size_t>(units, 4 * pool_.threadCount_);
+      }
+    }
+
+    UNIFEX_TRY { tasks_ = std::make_unique<chunk_task[]>(chunks); }
+    UNIFEX_CATCH(...) {
+      unifex::set_error((Receiver &&) receiver_, std::current_exception());
+      return;
+    }
+
+    remaining_.store(chunks, std::memory_order_relaxed);
+    // Wakes each worker at most once for all of the chunks.
+    schedule_batch batch;
+    for (std::size_t i = 0; i < chunks; ++i) {
+      chunk_task& task = tasks_[i];
+      task.execute = &type::run_chunk;
+      task.op_ = this;
+      task.first_ = static_cast<Integral>(
+          std::min(count, unit * (units * i / chunks)));
+      task.last_ = static_cast<Integral>(
+          std::min(count, unit * (units * (i + 1) / chunks)));
+      pool_.enqueue(&task, node_, priority_);
+    }
+  }
+
+private:
+  static void run_chunk(task_base* t) noexcept {
+    auto& task = *static_cast<chunk_task*>(t);
+    type& op = *task.op_;
+    op.run(task.first_, task.last_);
+    if (op.remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      op.complete();
+    }
+  }
+
+  void run(Integral first, Integral last) noexcept {
+    auto stopToken = get_stop_token(receiver_);
+    for (Integral i = first; i < last;) {
+      if (state_.load(std::memory_order_relaxed) != running) {
+        return;
+      }
+      if (stopToken.stop_requested()) {
+        finish_early(cancelled, nullptr);
+        return;
+      }
+      const Integral end = last - i > chunkSize_ ? i + chunkSize_ : last;
+      UNIFEX_TRY {
+        if constexpr (receives_chunks) {
+          unifex::set_next(receiver_, index_range<Integral>{i, end});
+          i = end;
+        } else {
+          for (; i < end; ++i) {
+            unifex::set_next(receiver_, Integral(i));
+          }
+        }
+      }
+      UNIFEX_CATCH(...) {
+        finish_early(failed, std::current_exception());
+        return;
+      }
+    }
+  }
+
+  // The first error or cancellation wins and stops the other chunks.
+  void finish_early(state s, std::exception_ptr error) noexcept {
+    int expected = running;
+    if (state_.compare_exchange_strong(
+            expected, s, std::memory_order_relaxed)) {
+      error_ = std::move(error);
+    }
+  }
+
+  void complete() noexcept {
+    tasks_.reset();
+    switch (state_.load(std::memory_order_relaxed)) {
+      case running:
+        UNIFEX_TRY { unifex::set_value((Receiver &&) receiver_); }
+        UNIFEX_CATCH(...) {
+          unifex::set_error(
+              (Receiver &&) receiver_, std::current_exception());
+        }
+        break;
+      case failed:
+        unifex::set_error((Receiver &&) receiver_, std::move(error_));
+        break;
+      case cancelled:
+        unifex::set_done((Receiver &&) receiver_);
+        break;
+    }
+  }
+
+  context& pool_;
+  std::uint32_t node_;
+  priority priority_;
+  Integral count_;
+  Integral chunkSize_;
+  Receiver receiver_;
+  std::unique_ptr<chunk_task[]> tasks_;
+  std::atomic<std::size_t> remaining_{0};
+  std::atomic<int> state_{running};
+  std::exception_ptr error_;
+};
+
 }  // namespace _static_thread_pool
 
 using static_thread_pool = _static_thread_pool::context;
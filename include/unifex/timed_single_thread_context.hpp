@@ -19,6 +19,7 @@
 #include <unifex/get_stop_token.hpp>
 #include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
 #include <unifex/stop_token_concepts.hpp>
 
 #include <chrono>
@@ -263,6 +264,8 @@ public:
   auto schedule() const noexcept {
     return schedule_after(std::chrono::milliseconds{0});
   }
+
+  friend bool tag_invoke(tag_t<currently_on>, const scheduler& s) noexcept;
 };
 }  // namespace _timed_single_thread_context
 
@@ -302,6 +305,10 @@ public:
 };
 
 namespace _timed_single_thread_context {
+inline bool tag_invoke(tag_t<currently_on>, const scheduler& s) noexcept {
+  return s.context_->get_thread_id() == std::this_thread::get_id();
+}
+
 template <typename Duration, typename Receiver>
 inline void _after_op<Duration, Receiver>::type::start() noexcept {
   this->dueTime_ = clock_t::now() + duration_;
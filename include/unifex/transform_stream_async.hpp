@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/bind_back.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <unifex/detail/stream_pump.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+
+// The order in which transform_stream_async() emits results.
+enum class transform_order {
+  // The order of the source elements they were produced from.
+  input,
+  // The order in which their async operations complete.
+  completion
+};
+
+namespace _tfx_async {
+
+template <typename Stream, typename Func>
+struct _state {
+  class type;
+};
+template <typename Stream, typename Func>
+using state = typename _state<Stream, Func>::type;
+
+template <typename Stream, typename Func>
+struct _traits {
+  using source_value_t = _stream_pump::value_t<Stream>;
+  using inner_sender_t = std::invoke_result_t<Func&, source_value_t>;
+  using result_t = sender_single_value_result_t<inner_sender_t>;
+
+  using value_list = conditional_t<
+      std::is_void_v<sender_single_value_return_type_t<inner_sender_t>>,
+      type_list<>,
+      type_list<result_t>>;
+
+  using errors = concat_type_lists_unique_t<
+      _stream_pump::next_errors_t<Stream>,
+      sender_error_types_t<inner_sender_t, type_list>>;
+};
+
+template <typename Stream, typename Func>
+using state_base = _stream_pump::state_base<
+    state<Stream, Func>,
+    typename _traits<Stream, Func>::value_list,
+    typename _traits<Stream, Func>::errors,
+    _stream_pump::cleanup_errors_t<Stream>>;
+
+template <typename State>
+struct _inner_receiver {
+  class type;
+};
+template <typename State>
+using inner_receiver = typename _inner_receiver<State>::type;
+
+template <typename State>
+class _inner_receiver<State>::type {
+  using slot_t = typename State::slot;
+
+public:
+  explicit type(slot_t* slot) noexcept : slot_(slot) {}
+
+  template <typename... Values>
+  void set_value(Values&&... values) noexcept {
+    slot_->state_->on_inner_value(*slot_, (Values &&) values...);
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) noexcept {
+    slot_->state_->on_inner_error(*slot_, (Error &&) error);
+  }
+
+  void set_done() noexcept { slot_->state_->on_inner_done(*slot_); }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.get_stop_token();
+  }
+
+private:
+  inplace_stop_token get_stop_token() const noexcept {
+    return slot_->state_->stop_token();
+  }
+
+  slot_t* slot_;
+};
+
+// The shared state of a transform_stream_async() stream. The pumping
+// thread, see _stream_pump::state_base, pulls the next element from the
+// source and starts the async operation for an element.
+template <typename Stream, typename Func>
+class _state<Stream, Func>::type : public state_base<Stream, Func> {
+  using base = state_base<Stream, Func>;
+  using traits = _traits<Stream, Func>;
+  using source_t = _stream_pump::source<type, Stream>;
+
+public:
+  using source_value_t = typename traits::source_value_t;
+  using inner_sender_t = typename traits::inner_sender_t;
+  using result_t = typename traits::result_t;
+  using outcome_t = typename base::outcome_t;
+
+  struct slot {
+    explicit slot(type* state) noexcept : state_(state) {}
+
+    type* state_;
+    slot* nextFree_ = nullptr;
+    std::size_t position_ = 0;
+    bool constructed_ = false;
+    manual_lifetime<connect_result_t<inner_sender_t, inner_receiver<type>>>
+        op_;
+  };
+
+  template <typename Stream2, typename Func2>
+  explicit type(
+      Stream2&& stream,
+      Func2&& func,
+      std::size_t maxInFlight,
+      transform_order order)
+    : source_(_stream_pump::source_init<type, Stream2>{
+          this, 0, (Stream2 &&) stream})
+    , func_((Func2 &&) func)
+    , maxInFlight_(std::max<std::size_t>(maxInFlight, 1))
+    , order_(order)
+    , ready_(maxInFlight_) {
+    slots_.reserve(maxInFlight_);
+    for (std::size_t i = 0; i < maxInFlight_; ++i) {
+      slots_.push_back(std::make_unique<slot>(this));
+      slots_.back()->nextFree_ = freeSlots_;
+      freeSlots_ = slots_.back().get();
+    }
+  }
+
+  ~type() {
+    for (auto& s : slots_) {
+      if (s->constructed_) {
+        s->op_.destruct();
+      }
+    }
+  }
+
+private:
+  friend base;
+  friend source_t;
+  friend _stream_pump::next_receiver<source_t>;
+  friend inner_receiver<type>;
+
+  bool step(std::unique_lock<std::mutex>& lk) noexcept {
+    if (source_.value_) {
+      if (this->stopping_) {
+        source_.value_.reset();
+        return true;
+      }
+      slot* s = freeSlots_;
+      freeSlots_ = s->nextFree_;
+      s->position_ = started_++;
+      ++inFlight_;
+      source_value_t value = std::move(*source_.value_);
+      source_.value_.reset();
+      lk.unlock();
+      start_inner(*s, std::move(value));
+      lk.lock();
+      return true;
+    }
+
+    // Backpressure: don't pull another element while maxInFlight_
+    // elements are either in flight or waiting to be taken by next().
+    if (!source_.active_ && !source_.ended_ && !this->stopping_ &&
+        started_ - delivered_ < maxInFlight_) {
+      source_.active_ = true;
+      lk.unlock();
+      source_.start_next();
+      lk.lock();
+      return true;
+    }
+    return false;
+  }
+
+  bool idle() const noexcept { return !source_.active_ && inFlight_ == 0; }
+
+  template <typename F>
+  void for_each_source(F&& f) {
+    f(source_);
+  }
+
+  static constexpr std::size_t source_count() noexcept { return 1; }
+
+  // The result for a pending next(), if there is one yet. Results that are
+  // ready to be emitted go before an error.
+  std::optional<outcome_t> take_outcome() noexcept {
+    if (this->finished_) {
+      return outcome_t{std::in_place_index<0>};
+    }
+    auto& next = ready_[delivered_ % maxInFlight_];
+    if (next) {
+      std::optional<outcome_t> outcome;
+      if constexpr (std::is_same_v<typename traits::value_list, type_list<>>) {
+        outcome.emplace(std::in_place_index<1>);
+      } else {
+        outcome.emplace(std::in_place_index<1>, std::move(*next));
+      }
+      next.reset();
+      ++delivered_;
+      return outcome;
+    }
+    if (this->error_) {
+      this->finished_ = true;
+      outcome_t outcome{std::in_place_index<2>, std::move(*this->error_)};
+      this->error_.reset();
+      return outcome;
+    }
+    if (this->stopping_ || (source_.ended_ && started_ == delivered_)) {
+      this->finished_ = true;
+      return outcome_t{std::in_place_index<0>};
+    }
+    return std::nullopt;
+  }
+
+  // Only called by the pumping thread.
+  void start_inner(slot& s, source_value_t&& value) noexcept {
+    if (s.constructed_) {
+      s.constructed_ = false;
+      s.op_.destruct();
+    }
+    UNIFEX_TRY {
+      s.op_.construct_with([&] {
+        return unifex::connect(
+            std::invoke(func_, std::move(value)), inner_receiver<type>{&s});
+      });
+      s.constructed_ = true;
+    }
+    UNIFEX_CATCH(...) {
+      on_inner_error(s, std::current_exception());
+      return;
+    }
+    unifex::start(s.op_.get());
+  }
+
+  template <typename... Values>
+  void on_value(source_t& s, Values&&... values) noexcept {
+    std::unique_lock lk{this->mutex_};
+    s.active_ = false;
+    UNIFEX_TRY { s.value_.emplace((Values &&) values...); }
+    UNIFEX_CATCH(...) {
+      s.ended_ = true;
+      fail(lk, std::current_exception());
+      return;
+    }
+    this->pump_if_idle(lk);
+  }
+
+  template <typename Error>
+  void on_error(source_t& s, Error&& error) noexcept {
+    std::unique_lock lk{this->mutex_};
+    s.active_ = false;
+    s.ended_ = true;
+    fail(lk, (Error &&) error);
+  }
+
+  void on_end(source_t& s) noexcept {
+    std::unique_lock lk{this->mutex_};
+    s.active_ = false;
+    s.ended_ = true;
+    this->pump_if_idle(lk);
+  }
+
+  template <typename... Values>
+  void on_inner_value(slot& s, Values&&... values) noexcept {
+    std::unique_lock lk{this->mutex_};
+    UNIFEX_TRY {
+      const std::size_t position =
+          order_ == transform_order::input ? s.position_ : completed_++;
+      ready_[position % maxInFlight_].emplace((Values &&) values...);
+    }
+    UNIFEX_CATCH(...) {
+      release(s);
+      fail(lk, std::current_exception());
+      return;
+    }
+    release(s);
+    this->pump_if_idle(lk);
+  }
+
+  template <typename Error>
+  void on_inner_error(slot& s, Error&& error) noexcept {
+    std::unique_lock lk{this->mutex_};
+    release(s);
+    fail(lk, (Error &&) error);
+  }
+
+  void on_inner_done(slot& s) noexcept {
+    std::unique_lock lk{this->mutex_};
+    release(s);
+    this->stopping_ = true;
+    this->request_stop(lk);
+    this->pump_if_idle(lk);
+  }
+
+  void release(slot& s) noexcept {
+    s.nextFree_ = freeSlots_;
+    freeSlots_ = &s;
+    --inFlight_;
+  }
+
+  // Records the first error, which the next call to next() completes with.
+  template <typename Error>
+  void fail(std::unique_lock<std::mutex>& lk, Error&& error) noexcept {
+    if (!this->stopping_) {
+      this->stopping_ = true;
+      this->record_error((Error &&) error);
+    }
+    this->request_stop(lk);
+    this->pump_if_idle(lk);
+  }
+
+  source_t source_;
+  Func func_;
+  const std::size_t maxInFlight_;
+  const transform_order order_;
+
+  std::vector<std::unique_ptr<slot>> slots_;
+  slot* freeSlots_ = nullptr;
+  std::size_t inFlight_ = 0;
+
+  // Results waiting to be taken by next(). Element i % maxInFlight_ holds
+  // the i'th result, counting in input order or in completion order. As
+  // started_ - delivered_ never exceeds maxInFlight_ the positions of
+  // undelivered results never collide.
+  std::vector<std::optional<result_t>> ready_;
+  std::size_t started_ = 0;
+  std::size_t completed_ = 0;
+  std::size_t delivered_ = 0;
+};
+
+template <typename Stream, typename Func>
+using stream = _stream_pump::stream<
+    state<remove_cvref_t<Stream>, remove_cvref_t<Func>>>;
+
+inline const struct _fn {
+  template(typename Stream, typename Func)                          //
+      (requires unifex::sender<next_sender_t<remove_cvref_t<Stream>>>)  //
+      stream<Stream, Func>
+      operator()(
+          Stream&& s,
+          Func&& func,
+          std::size_t maxInFlight,
+          transform_order order = transform_order::input) const {
+    using state_t = state<remove_cvref_t<Stream>, remove_cvref_t<Func>>;
+    return stream<Stream, Func>{std::make_unique<state_t>(
+        (Stream &&) s, (Func &&) func, maxInFlight, order)};
+  }
+
+  template <typename Func>
+  constexpr auto operator()(
+      Func&& func,
+      std::size_t maxInFlight,
+      transform_order order = transform_order::input) const
+      noexcept(std::is_nothrow_invocable_v<
+               tag_t<bind_back>,
+               _fn,
+               Func,
+               std::size_t,
+               transform_order>)
+          -> bind_back_result_t<_fn, Func, std::size_t, transform_order> {
+    return bind_back(*this, (Func &&) func, maxInFlight, order);
+  }
+} transform_stream_async{};
+}  // namespace _tfx_async
+
+// Like transform_stream(), but func returns a sender for each element and
+// up to maxInFlight of these run concurrently.
+//
+// Results are emitted in input order, holding back those that complete
+// early, or with transform_order::completion as soon as they complete.
+// No more elements are pulled from the source while maxInFlight results
+// are in flight or waiting to be taken by next(). cleanup() cancels any
+// in-flight work and waits for it before cleaning up the source.
+using _tfx_async::transform_stream_async;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
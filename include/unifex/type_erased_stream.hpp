@@ -16,19 +16,25 @@
 #pragma once
 
 #include <unifex/config.hpp>
+#include <unifex/any_ref.hpp>
 #include <unifex/any_scheduler.hpp>
+#include <unifex/any_unique.hpp>
 #include <unifex/bind_back.hpp>
 #include <unifex/continuations.hpp>
 #include <unifex/exception.hpp>
 #include <unifex/get_stop_token.hpp>
 #include <unifex/inplace_stop_token.hpp>
 #include <unifex/manual_lifetime.hpp>
+#include <unifex/overload.hpp>
 #include <unifex/receiver_concepts.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/stream_concepts.hpp>
+#include <unifex/this.hpp>
 
 #include <atomic>
+#include <memory>
+#include <utility>
 
 #include <unifex/detail/prologue.hpp>
 
@@ -42,68 +48,81 @@ struct _stream final {
 template <typename... Values>
 using stream = typename _stream<Values...>::type;
 
+// Returns the continuation_info of a receiver, so that visiting the
+// continuations of a type-erased receiver can be dispatched through its
+// vtable.
+struct _get_continuation_info_fn {
+  using type_erased_signature_t = continuation_info(const this_&) noexcept;
+
+  template <typename Receiver>
+  continuation_info operator()(const Receiver& r) const noexcept {
+    return tag_invoke(*this, r);
+  }
+};
+inline constexpr _get_continuation_info_fn _get_continuation_info{};
+
 template <typename... Values>
 struct _stream<Values...>::type final {
-  struct next_receiver_base {
-    virtual void set_value(Values&&... values) noexcept = 0;
-    virtual void set_done() noexcept = 0;
-    virtual void set_error(std::exception_ptr ex) noexcept = 0;
-
-    using visitor_t = void(const continuation_info&, void*);
+  using next_receiver_base = any_ref<
+      overload_t<unifex::set_value, void(this_&&, Values&&...) noexcept>,
+      overload_t<unifex::set_done, void(this_&&) noexcept>,
+      overload_t<
+          unifex::set_error,
+          void(this_&&, std::exception_ptr) noexcept>,
+      overload_t<unifex::get_scheduler, any_scheduler(const this_&) noexcept>,
+      _get_continuation_info_fn>;
+
+  using cleanup_receiver_base = any_ref<
+      overload_t<unifex::set_done, void(this_&&) noexcept>,
+      overload_t<
+          unifex::set_error,
+          void(this_&&, std::exception_ptr) noexcept>,
+      overload_t<unifex::get_scheduler, any_scheduler(const this_&) noexcept>,
+      _get_continuation_info_fn>;
+
+  // A reference to the receiver of a next() or cleanup() operation, with
+  // calls dispatched through a vtable rather than virtual functions.
+  template <typename Base>
+  struct receiver_ref final : Base {
+    using Base::Base;
 
-  private:
 #if UNIFEX_ENABLE_CONTINUATION_VISITATIONS
     template <typename Func>
     friend void tag_invoke(
-        tag_t<visit_continuations>,
-        const next_receiver_base& receiver,
-        Func&& func) {
-      visit_continuations(receiver.get_continuation_info(), (Func&&)func);
+        tag_t<visit_continuations>, const receiver_ref& receiver, Func&& func) {
+      visit_continuations(
+          _get_continuation_info(static_cast<const Base&>(receiver)),
+          (Func&&)func);
     }
 #endif
-
-    friend auto tag_invoke(
-        tag_t<get_scheduler>, const next_receiver_base& receiver) noexcept {
-      return receiver.get_scheduler();
+  };
+  using next_receiver_ref = receiver_ref<next_receiver_base>;
+  using cleanup_receiver_ref = receiver_ref<cleanup_receiver_base>;
+
+  struct start_next_fn {
+    using type_erased_signature_t =
+        void(this_&, next_receiver_ref, inplace_stop_token) noexcept;
+
+    template <typename Stream>
+    void operator()(
+        Stream& stream,
+        next_receiver_ref receiver,
+        inplace_stop_token stopToken) const noexcept {
+      tag_invoke(*this, stream, std::move(receiver), std::move(stopToken));
     }
-
-    virtual continuation_info get_continuation_info() const = 0;
-
-    virtual any_scheduler get_scheduler() const noexcept = 0;
   };
 
-  struct cleanup_receiver_base {
-    virtual void set_done() noexcept = 0;
-    virtual void set_error(std::exception_ptr ex) noexcept = 0;
+  struct start_cleanup_fn {
+    using type_erased_signature_t = void(this_&, cleanup_receiver_ref) noexcept;
 
-  private:
-#if UNIFEX_ENABLE_CONTINUATION_VISITATIONS
-    template <typename Func>
-    friend void tag_invoke(
-        tag_t<visit_continuations>,
-        const cleanup_receiver_base& receiver,
-        Func&& func) {
-      visit_continuations(receiver.get_continuation_info(), (Func&&)func);
-    }
-#endif
-
-    friend auto tag_invoke(
-        tag_t<get_scheduler>, const cleanup_receiver_base& receiver) noexcept {
-      return receiver.get_scheduler();
+    template <typename Stream>
+    void
+    operator()(Stream& stream, cleanup_receiver_ref receiver) const noexcept {
+      tag_invoke(*this, stream, std::move(receiver));
     }
-
-    virtual continuation_info get_continuation_info() const noexcept = 0;
-
-    virtual any_scheduler get_scheduler() const noexcept = 0;
   };
 
-  struct stream_base {
-    virtual ~stream_base() {}
-    virtual void start_next(
-        next_receiver_base& receiver,
-        inplace_stop_token stopToken) noexcept = 0;
-    virtual void start_cleanup(cleanup_receiver_base& receiver) noexcept = 0;
-  };
+  using stream_base = any_unique<start_next_fn, start_cleanup_fn>;
 
   struct next_op_base {
     // last caller owns result delivery by calling set_* on a receiver
@@ -121,7 +140,7 @@ struct _stream<Values...>::type final {
 
   template <typename Receiver>
   struct _next_receiver final {
-    struct type final : next_receiver_base {
+    struct type final {
       UNIFEX_NO_UNIQUE_ADDRESS Receiver receiver_;
       next_op_base* op_;
 
@@ -129,31 +148,33 @@ struct _stream<Values...>::type final {
         : receiver_((Receiver&&)receiver)
         , op_(op) {}
 
-      void set_value(Values&&... values) noexcept override {
+      void set_value(Values&&... values) && noexcept {
         if (op_->complete()) {
           unifex::set_value(std::move(receiver_), (Values&&)values...);
         }
       }
 
-      void set_done() noexcept override {
+      void set_done() && noexcept {
         if (op_->complete()) {
           unifex::set_done(std::move(receiver_));
         }
       }
 
-      void set_error(std::exception_ptr ex) noexcept override {
+      void set_error(std::exception_ptr ex) && noexcept {
         if (op_->complete()) {
           unifex::set_error(std::move(receiver_), std::move(ex));
         }
       }
 
     private:
-      continuation_info get_continuation_info() const noexcept override {
-        return continuation_info::from_continuation(receiver_);
+      friend continuation_info tag_invoke(
+          tag_t<_get_continuation_info>, const type& receiver) noexcept {
+        return continuation_info::from_continuation(receiver.receiver_);
       }
 
-      any_scheduler get_scheduler() const noexcept override {
-        return unifex::get_scheduler(receiver_);
+      friend any_scheduler
+      tag_invoke(tag_t<get_scheduler>, const type& receiver) noexcept {
+        return unifex::get_scheduler(receiver.receiver_);
       }
     };
   };
@@ -162,26 +183,26 @@ struct _stream<Values...>::type final {
 
   template <typename Receiver>
   struct _cleanup_receiver final {
-    struct type final : cleanup_receiver_base {
+    struct type final {
       UNIFEX_NO_UNIQUE_ADDRESS Receiver receiver_;
 
       explicit type(Receiver&& receiver) : receiver_((Receiver&&)receiver) {}
 
-      void set_done() noexcept override {
-        unifex::set_done(std::move(receiver_));
-      }
+      void set_done() && noexcept { unifex::set_done(std::move(receiver_)); }
 
-      void set_error(std::exception_ptr ex) noexcept override {
+      void set_error(std::exception_ptr ex) && noexcept {
         unifex::set_error(std::move(receiver_), std::move(ex));
       }
 
     private:
-      continuation_info get_continuation_info() const noexcept override {
-        return continuation_info::from_continuation(receiver_);
+      friend continuation_info tag_invoke(
+          tag_t<_get_continuation_info>, const type& receiver) noexcept {
+        return continuation_info::from_continuation(receiver.receiver_);
       }
 
-      any_scheduler get_scheduler() const noexcept override {
-        return unifex::get_scheduler(receiver_);
+      friend any_scheduler
+      tag_invoke(tag_t<get_scheduler>, const type& receiver) noexcept {
+        return unifex::get_scheduler(receiver.receiver_);
       }
     };
   };
@@ -191,7 +212,7 @@ struct _stream<Values...>::type final {
 
   template <typename Stream>
   struct _stream final {
-    struct type final : stream_base {
+    struct type final {
       using stream = type;
       UNIFEX_NO_UNIQUE_ADDRESS Stream stream_;
 
@@ -199,34 +220,39 @@ struct _stream<Values...>::type final {
       // by source Stream are convertible to and same arity as Values...
 
       struct next_receiver_wrapper final {
-        next_receiver_base& receiver_;
+        next_receiver_ref receiver_;
         stream& stream_;
         inplace_stop_token stopToken_;
 
+        // The receiver is copied out of this object before the next
+        // operation, which owns it, is destroyed.
         void set_value(Values&&... values) && noexcept {
+          next_receiver_ref receiver = receiver_;
           UNIFEX_TRY {
             // Take a copy of the values before destroying the next operation
             // state in case the values are references to objects stored in
             // the operation object.
             [&](Values... values) {
               unifex::deactivate_union_member(stream_.next_);
-              receiver_.set_value((Values&&)values...);
+              unifex::set_value(std::move(receiver), (Values&&)values...);
             }((Values&&)values...);
           }
           UNIFEX_CATCH(...) {
             unifex::deactivate_union_member(stream_.next_);
-            receiver_.set_error(std::current_exception());
+            unifex::set_error(std::move(receiver), std::current_exception());
           }
         }
 
         void set_done() && noexcept {
+          next_receiver_ref receiver = receiver_;
           unifex::deactivate_union_member(stream_.next_);
-          receiver_.set_done();
+          unifex::set_done(std::move(receiver));
         }
 
         void set_error(std::exception_ptr ex) && noexcept {
+          next_receiver_ref receiver = receiver_;
           unifex::deactivate_union_member(stream_.next_);
-          receiver_.set_error(std::move(ex));
+          unifex::set_error(std::move(receiver), std::move(ex));
         }
 
         template <typename Error>
@@ -258,17 +284,19 @@ struct _stream<Values...>::type final {
       };
 
       struct cleanup_receiver_wrapper final {
-        cleanup_receiver_base& receiver_;
+        cleanup_receiver_ref receiver_;
         stream& stream_;
 
         void set_done() && noexcept {
+          cleanup_receiver_ref receiver = receiver_;
           unifex::deactivate_union_member(stream_.cleanup_);
-          receiver_.set_done();
+          unifex::set_done(std::move(receiver));
         }
 
         void set_error(std::exception_ptr ex) && noexcept {
+          cleanup_receiver_ref receiver = receiver_;
           unifex::deactivate_union_member(stream_.cleanup_);
-          receiver_.set_error(std::move(ex));
+          unifex::set_error(std::move(receiver), std::move(ex));
         }
 
         template <typename Error>
@@ -305,32 +333,37 @@ struct _stream<Values...>::type final {
             cleanup_;
       };
 
-      void start_next(
-          next_receiver_base& receiver,
-          inplace_stop_token stopToken) noexcept override {
+      // Only one next() or cleanup() is outstanding at a time, so every
+      // operation reuses the storage of the union above.
+      friend void tag_invoke(
+          start_next_fn,
+          type& s,
+          next_receiver_ref receiver,
+          inplace_stop_token stopToken) noexcept {
         UNIFEX_TRY {
-          unifex::activate_union_member_with(next_, [&] {
+          unifex::activate_union_member_with(s.next_, [&] {
             return connect(
-                next(stream_),
-                next_receiver_wrapper{receiver, *this, stopToken});
+                next(s.stream_),
+                next_receiver_wrapper{receiver, s, stopToken});
           });
-          start(next_.get());
+          start(s.next_.get());
         }
         UNIFEX_CATCH(...) {
-          receiver.set_error(std::current_exception());
+          unifex::set_error(std::move(receiver), std::current_exception());
         }
       }
 
-      void start_cleanup(cleanup_receiver_base& receiver) noexcept override {
+      friend void tag_invoke(
+          start_cleanup_fn, type& s, cleanup_receiver_ref receiver) noexcept {
         UNIFEX_TRY {
-          unifex::activate_union_member_with(cleanup_, [&] {
+          unifex::activate_union_member_with(s.cleanup_, [&] {
             return connect(
-                cleanup(stream_), cleanup_receiver_wrapper{receiver, *this});
+                cleanup(s.stream_), cleanup_receiver_wrapper{receiver, s});
           });
-          start(cleanup_.get());
+          start(s.cleanup_.get());
         }
         UNIFEX_CATCH(...) {
-          receiver.set_error(std::current_exception());
+          unifex::set_error(std::move(receiver), std::current_exception());
         }
       }
     };
@@ -378,8 +411,9 @@ struct _stream<Values...>::type final {
                 get_stop_token(receiver_.receiver_), cancel_callback{*this}) {}
 
         void start() noexcept {
-          stream_.start_next(
-              receiver_,
+          start_next_fn{}(
+              stream_,
+              next_receiver_ref{receiver_},
               get_stop_token(receiver_.receiver_).stop_possible()
                   ? stopSource_.get_token()
                   : inplace_stop_token{});
@@ -394,7 +428,7 @@ struct _stream<Values...>::type final {
           }
           stopSource_.request_stop();
           // conditionally call set_*
-          receiver_.set_done();
+          std::move(receiver_).set_done();
         }
       };
     };
@@ -432,7 +466,9 @@ struct _stream<Values...>::type final {
           : stream_(stream)
           , receiver_((Receiver&&)receiver) {}
 
-        void start() noexcept { stream_.start_cleanup(receiver_); }
+        void start() noexcept {
+          start_cleanup_fn{}(stream_, cleanup_receiver_ref{receiver_});
+        }
       };
     };
     template <typename Receiver>
@@ -444,19 +480,30 @@ struct _stream<Values...>::type final {
     }
   };
 
-  std::unique_ptr<stream_base> stream_;
+  stream_base stream_;
 
   template <typename ConcreteStream>
   explicit type(ConcreteStream&& strm)
-    : stream_(std::make_unique<type::stream<ConcreteStream>>(
-          (ConcreteStream&&)strm)) {}
+    : stream_(
+          std::in_place_type<type::stream<ConcreteStream>>,
+          (ConcreteStream&&)strm) {}
+
+  // Allocates the wrapped stream, including the storage for its next() and
+  // cleanup() operations, with the given allocator.
+  template <typename ConcreteStream, typename Allocator>
+  explicit type(ConcreteStream&& strm, Allocator alloc)
+    : stream_(
+          std::allocator_arg,
+          std::move(alloc),
+          std::in_place_type<type::stream<ConcreteStream>>,
+          (ConcreteStream&&)strm) {}
 
   friend next_sender tag_invoke(tag_t<next>, type& s) noexcept {
-    return next_sender{*s.stream_};
+    return next_sender{s.stream_};
   }
 
   friend cleanup_sender tag_invoke(tag_t<cleanup>, type& s) noexcept {
-    return cleanup_sender{*s.stream_};
+    return cleanup_sender{s.stream_};
   }
 };
 }  // namespace _type_erase
@@ -468,6 +515,11 @@ struct _fn final {
   _type_erase::stream<Ts...> operator()(Stream&& strm) const {
     return _type_erase::stream<Ts...>{(Stream&&)strm};
   }
+  template <typename Stream, typename Allocator>
+  _type_erase::stream<Ts...>
+  operator()(Stream&& strm, Allocator alloc) const {
+    return _type_erase::stream<Ts...>{(Stream&&)strm, std::move(alloc)};
+  }
   constexpr auto operator()() const
       noexcept(std::is_nothrow_invocable_v<tag_t<bind_back>, _fn>)
           -> bind_back_result_t<_fn> {
@@ -17,6 +17,7 @@
 
 #include <unifex/bind_back.hpp>
 #include <unifex/finally.hpp>
+#include <unifex/schedule_if_needed.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/tag_invoke.hpp>
 
@@ -45,13 +46,15 @@ struct _fn {
       operator()(Source&& source, Scheduler&& scheduler) const
       noexcept(noexcept(finally(
           static_cast<Source&&>(source),
-          schedule(static_cast<Scheduler&&>(scheduler)))))
+          schedule_if_needed(static_cast<Scheduler&&>(scheduler)))))
           -> decltype(finally(
               static_cast<Source&&>(source),
-              schedule(static_cast<Scheduler&&>(scheduler)))) {
+              schedule_if_needed(static_cast<Scheduler&&>(scheduler)))) {
+    // Skips the reschedule if the source completes on the scheduler's
+    // context.
     return finally(
         static_cast<Source&&>(source),
-        schedule(static_cast<Scheduler&&>(scheduler)));
+        schedule_if_needed(static_cast<Scheduler&&>(scheduler)));
   }
   template(typename Scheduler)         //
       (requires scheduler<Scheduler>)  //
@@ -21,6 +21,7 @@
 #include <unifex/inplace_stop_token.hpp>
 #include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/schedule_batch.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/std_concepts.hpp>
 #include <unifex/type_list.hpp>
@@ -207,6 +208,11 @@ template <typename Receiver, typename... Senders>
 struct _op<Receiver, Senders...>::type {
   using operation = type;
   using receiver_type = Receiver;
+
+  static constexpr bool batch_starts = sizeof...(Senders) > 1 &&
+      (... &&
+       (sender_traits<remove_cvref_t<Senders>>::blocking ==
+        blocking_kind::never));
   template <std::size_t Index, typename Receiver2, typename... Senders2>
   friend struct _element_receiver;
 
@@ -219,7 +225,14 @@ struct _op<Receiver, Senders...>::type {
     stopCallback_.construct(
         get_stop_token(receiver_),
         cancel_operation<Receiver, Senders...>{*this});
-    ops_.start();
+    if constexpr (batch_starts) {
+      // None of the children can complete inside start(), so the work
+      // they schedule can be handed over in one go.
+      schedule_batch batch;
+      ops_.start();
+    } else {
+      ops_.start();
+    }
   }
 
   void request_stop() noexcept {
@@ -29,10 +29,12 @@
 
 #include <unifex/blocking.hpp>
 #include <unifex/continuations.hpp>
+#include <unifex/for_each_concurrent.hpp>
 #include <unifex/get_stop_token.hpp>
 #include <unifex/inplace_stop_token.hpp>
 #include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/schedule_batch.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/std_concepts.hpp>
 #include <unifex/type_list.hpp>
@@ -127,11 +129,22 @@ public:
     } else {
       stopCallback_.construct(
           unifex::get_stop_token(receiver_), cancel_operation{*this});
-      // last start() might destroy this
-      std::for_each(
-          holders_, holders_ + numHolders_, [](auto& holder) noexcept {
-            unifex::start(holder.connection);
-          });
+      auto startAll = [holders = holders_, count = numHolders_]() noexcept {
+        // last start() might destroy this
+        std::for_each(holders, holders + count, [](auto& holder) noexcept {
+          unifex::start(holder.connection);
+        });
+      };
+      if constexpr (
+          sender_traits<remove_cvref_t<Sender>>::blocking ==
+          blocking_kind::never) {
+        // None of the senders can complete inside start(), so the work
+        // they schedule can be handed over in one go.
+        schedule_batch batch;
+        startAll();
+      } else {
+        startAll();
+      }
     }
   }
 
@@ -370,6 +383,27 @@ public:
         std::vector<sender_from_iterator_t<Iterator>>(first, last),
         instruction_ptr::read_return_address());
   }
+
+  // Bounded version: at most maxConcurrency of the senders are connected
+  // and running at a time, in recycled operation states allocated with the
+  // given allocator. The senders are taken from [first, last) only as they
+  // are started, and their results are sent in iteration order. As in the
+  // unbounded version, lvalue senders are copied rather than moved from
+  // unless the iterators are std::move_iterators.
+  template(
+      typename Iterator,
+      typename Sentinel,
+      typename Allocator = std::allocator<std::byte>)    //
+      (requires unifex::sender<sender_from_iterator_t<Iterator>>)  //
+      auto
+      operator()(
+          Iterator first,
+          Sentinel last,
+          std::size_t maxConcurrency,
+          const Allocator& allocator = {}) const {
+    return _for_each_conc::collect_concurrent(
+        std::move(first), std::move(last), maxConcurrency, allocator);
+  }
 };
 }  // namespace _cpo
 }  // namespace _when_all_range
@@ -18,6 +18,7 @@
 #include <unifex/await_transform.hpp>
 #include <unifex/connect_awaitable.hpp>
 #include <unifex/finally.hpp>
+#include <unifex/schedule_if_needed.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/tag_invoke.hpp>
@@ -40,10 +41,13 @@ template <typename Sender, typename Scheduler>
 static auto
 _make_sender(Sender&& sender, Scheduler&& scheduler) noexcept(noexcept(finally(
     static_cast<Sender&&>(sender),
-    unstoppable(schedule(static_cast<Scheduler&&>(scheduler)))))) {
+    unstoppable(
+        schedule_if_needed(static_cast<Scheduler&&>(scheduler)))))) {
+  // Resumes inline if the sender already completed on the scheduler's
+  // context.
   return finally(
       static_cast<Sender&&>(sender),
-      unstoppable(schedule(static_cast<Scheduler&&>(scheduler))));
+      unstoppable(schedule_if_needed(static_cast<Scheduler&&>(scheduler))));
 }
 
 template <typename Sender, typename Scheduler>
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <unifex/detail/stream_fan_in.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _zip_streams {
+
+template <typename... Streams>
+struct _state {
+  class type;
+};
+template <typename... Streams>
+using state = typename _state<Streams...>::type;
+
+template <typename... Streams>
+using state_base = _fan_in::state_base<
+    state<Streams...>,
+    type_list<_fan_in::value_t<Streams>...>,
+    concat_type_lists_unique_t<_fan_in::next_errors_t<Streams>...>,
+    concat_type_lists_unique_t<_fan_in::cleanup_errors_t<Streams>...>>;
+
+// Only pulls while a next() is pending, so that each source is at most one
+// value ahead of the others.
+template <typename... Streams>
+class _state<Streams...>::type : public state_base<Streams...> {
+public:
+  using base = state_base<Streams...>;
+  using outcome_t = typename base::outcome_t;
+
+  friend base;
+  friend typename base::pump;
+
+  static constexpr bool stop_on_end = true;
+
+  explicit type(std::tuple<Streams...>&& streams)
+    : type(std::move(streams), std::index_sequence_for<Streams...>{}) {}
+
+private:
+  template <std::size_t... Is>
+  explicit type(std::tuple<Streams...>&& streams, std::index_sequence<Is...>)
+    : sources_(_fan_in::source_init<type, Streams>{
+          this, Is, std::get<Is>(std::move(streams))}...) {}
+
+  template <typename Func>
+  void for_each_source(Func&& func) {
+    std::apply([&](auto&... s) { (func(s), ...); }, sources_);
+  }
+
+  static constexpr std::size_t source_count() noexcept {
+    return sizeof...(Streams);
+  }
+
+  bool should_pull() const noexcept { return this->waiter_pending(); }
+
+  template <typename Source>
+  void value_arrived(Source&) noexcept {}
+
+  std::optional<outcome_t> take_outcome() noexcept {
+    if (this->finished_ || this->stopping_) {
+      this->finished_ = true;
+      return outcome_t{std::in_place_index<0>};
+    }
+    const bool allReady = std::apply(
+        [](auto&... s) { return (s.value_.has_value() && ...); }, sources_);
+    if (allReady) {
+      std::optional<outcome_t> outcome;
+      UNIFEX_TRY {
+        std::apply(
+            [&](auto&... s) {
+              outcome.emplace(
+                  std::in_place_index<1>, std::move(*s.value_)...);
+            },
+            sources_);
+      }
+      UNIFEX_CATCH(...) {
+        this->finished_ = true;
+        outcome.emplace(
+            std::in_place_index<2>,
+            std::in_place_type<std::exception_ptr>,
+            std::current_exception());
+      }
+      std::apply([](auto&... s) { (s.value_.reset(), ...); }, sources_);
+      return outcome;
+    }
+    if (this->error_) {
+      this->finished_ = true;
+      outcome_t outcome{std::in_place_index<2>, std::move(*this->error_)};
+      this->error_.reset();
+      return outcome;
+    }
+    const bool anyEnded = std::apply(
+        [](auto&... s) { return ((s.ended_ && !s.value_) || ...); },
+        sources_);
+    if (anyEnded) {
+      this->finished_ = true;
+      return outcome_t{std::in_place_index<0>};
+    }
+    return std::nullopt;
+  }
+
+  std::tuple<_fan_in::source<type, Streams>...> sources_;
+};
+
+template <typename... Streams>
+using stream = _fan_in::stream<state<Streams...>>;
+
+inline const struct _fn {
+  template(typename... Streams)             //
+      (requires(sizeof...(Streams) > 0))  //
+      stream<remove_cvref_t<Streams>...>
+      operator()(Streams&&... streams) const {
+    using state_t = state<remove_cvref_t<Streams>...>;
+    return stream<remove_cvref_t<Streams>...>{
+        std::make_unique<state_t>(std::tuple<remove_cvref_t<Streams>...>{
+            (Streams &&) streams...})};
+  }
+} zip_streams{};
+}  // namespace _zip_streams
+
+// Pulls from several streams in lockstep and produces each step's values
+// as a single pack, (a, b, ...), of one value per stream.
+//
+// Every next() pulls one value from each source concurrently. The stream
+// ends as soon as any source ends, and the first error from a source
+// stops the others. cleanup() cleans up all sources concurrently.
+using _zip_streams::zip_streams;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
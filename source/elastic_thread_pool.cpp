@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/elastic_thread_pool.hpp>
+
+#include <utility>
+
+namespace unifex {
+namespace _elastic_thread_pool {
+static thread_local const context* currentThreadPool = nullptr;
+
+context::context() : context(options{}) {
+}
+
+context::context(const options& opts) : options_(opts) {
+  UNIFEX_ASSERT(opts.maxThreads > 0);
+}
+
+context::~context() {
+  thread_list threads;
+  {
+    std::unique_lock lk{mutex_};
+    stop_ = true;
+    workCv_.notify_all();
+    exitCv_.wait(lk, [this] { return threadCount_ == 0; });
+    threads = std::move(exited_);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+std::uint32_t context::thread_count() const {
+  std::lock_guard lk{mutex_};
+  return threadCount_;
+}
+
+context& context::shared() {
+  static context pool;
+  return pool;
+}
+
+bool context::is_running_on_pool_thread() const noexcept {
+  return currentThreadPool == this;
+}
+
+void context::enqueue(task_base* task) {
+  thread_list exited;
+  {
+    std::lock_guard lk{mutex_};
+    if (queuedCount_ >= idleCount_ && threadCount_ < options_.maxThreads) {
+      // Every idle thread already has queued work to pick up.
+      UNIFEX_TRY {
+        threads_.emplace_front();
+        auto self = threads_.begin();
+        UNIFEX_TRY {
+          // The new thread can't look at 'self' until we unlock.
+          *self = std::thread([this, self] { run(self); });
+        }
+        UNIFEX_CATCH(...) {
+          threads_.erase(self);
+          UNIFEX_RETHROW();
+        }
+        ++threadCount_;
+      }
+      UNIFEX_CATCH(...) {
+        // Fine as long as some thread will get to the work.
+        if (threadCount_ == 0) {
+          UNIFEX_RETHROW();
+        }
+      }
+    }
+    queue_.push_back(task);
+    ++queuedCount_;
+    workCv_.notify_one();
+    exited = std::move(exited_);
+  }
+  for (auto& t : exited) {
+    t.join();
+  }
+}
+
+void context::run(thread_list::iterator self) noexcept {
+  currentThreadPool = this;
+
+  std::unique_lock lk{mutex_};
+  while (true) {
+    if (!queue_.empty()) {
+      task_base* task = queue_.pop_front();
+      --queuedCount_;
+      lk.unlock();
+      task->execute(task);
+      lk.lock();
+      continue;
+    }
+    if (stop_) {
+      break;
+    }
+
+    ++idleCount_;
+    const bool woken = workCv_.wait_for(lk, options_.idleTimeout, [this] {
+      return !queue_.empty() || stop_;
+    });
+    --idleCount_;
+    if (!woken) {
+      break;
+    }
+  }
+
+  // Whoever next enqueues work, or the destructor, joins this thread.
+  exited_.splice(exited_.end(), threads_, self);
+  if (--threadCount_ == 0) {
+    exitCv_.notify_all();
+  }
+}
+
+}  // namespace _elastic_thread_pool
+}  // namespace unifex
@@ -484,6 +484,14 @@ tag_invoke(tag_t<open_pipe>, io_epoll_context::scheduler scheduler) {
       io_epoll_context::async_writer{*scheduler.context_, fd[1]}};
 }
 
+io_epoll_context::async_datagram_socket tag_invoke(
+    tag_t<open_datagram_socket>,
+    io_epoll_context::scheduler scheduler,
+    const socket_address& address) {
+  return io_epoll_context::async_datagram_socket{
+      *scheduler.context_, _dgram::open_socket(address).release()};
+}
+
 }  // namespace unifex::linuxos
 
 #endif  // !UNIFEX_NO_EPOLL
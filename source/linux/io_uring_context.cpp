@@ -21,12 +21,16 @@
 #  include <unifex/linux/io_uring_context.hpp>
 
 #  include <unifex/exception.hpp>
+#  include <unifex/schedule_batch.hpp>
 #  include <unifex/scope_guard.hpp>
 
 #  include "io_uring_syscall.hpp"
 
+#  include <array>
 #  include <cstring>
 #  include <system_error>
+#  include <thread>
+#  include <utility>
 
 #  include <fcntl.h>
 #  include <poll.h>
@@ -270,6 +274,32 @@
 // to the completion queue and wake-up the I/O thread which will then acquire
 // the list of remotely scheduled items and add them to the list of
 // ready-to-run operations.
+//
+// If the remote thread is itself the I/O thread of another io_uring_context
+// then, rather than writing to the eventfd, it can submit an
+// IORING_OP_MSG_RING operation to its own ring that posts a completion
+// directly to our completion queue. This is flushed along with its other
+// submissions, saving a write() syscall, and leaves our eventfd POLL_ADD
+// armed so that it does not need to be re-submitted the next time we go
+// idle. If the MSG_RING operation fails then the remote thread falls back
+// to writing to the eventfd. Each MSG_RING operation holds a reference to
+// our eventfd, rather than to us, so that the fall-back is still safe if we
+// have been destroyed before the remote thread processes its completion.
+//
+// Polled I/O
+// ----------
+// If the io_uring_context is created with 'polledIo' set then the ring is
+// created with IORING_SETUP_IOPOLL. The kernel then does not post
+// completions from the device interrupt handler. Instead they are reaped by
+// calling io_uring_enter() with IORING_ENTER_GETEVENTS, which polls the
+// device's completion queues.
+//
+// A polled ring only accepts reads and writes on O_DIRECT files, so the
+// eventfd POLL_ADD and IORING_OP_TIMEOUT operations described above cannot
+// be used. The I/O thread never marks the remote queue as inactive and
+// instead checks it, and the timer heap, every time around the loop. When
+// there is no I/O in flight it yields its time-slice between iterations
+// rather than blocking.
 
 namespace unifex::linuxos {
 
@@ -277,11 +307,39 @@ static thread_local io_uring_context* currentThreadContext;
 
 static constexpr __u64 remote_queue_event_user_data = 0;
 
-io_uring_context::io_uring_context() {
+// user_data of the completion posted to the target ring by MSG_RING.
+static constexpr __u64 msg_ring_wakeup_user_data = 1;
+
+// Tag set in the user_data of a MSG_RING operation in the sending ring,
+// whose other bits hold the address of the target's remote_queue_eventfd. Completion
+// states are at least 8-byte aligned so never have this bit set.
+static constexpr __u64 msg_ring_sent_tag = 1;
+
+static bool is_op_supported(int ringFd, __u8 opcode) noexcept {
+  constexpr unsigned opCount = 256;
+  alignas(io_uring_probe) char
+      buffer[sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op)];
+  std::memset(buffer, 0, sizeof(buffer));
+  auto* probe = reinterpret_cast<io_uring_probe*>(buffer);
+  if (io_uring_register(ringFd, IORING_REGISTER_PROBE, probe, opCount) < 0) {
+    return false;
+  }
+  return opcode <= probe->last_op && opcode < probe->ops_len &&
+      (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+}
+
+io_uring_context::io_uring_context() : io_uring_context(options{}) {
+}
+
+io_uring_context::io_uring_context(const options& opts)
+  : polledIo_(opts.polledIo) {
   io_uring_params params;
   std::memset(&params, 0, sizeof(params));
+  if (polledIo_) {
+    params.flags |= IORING_SETUP_IOPOLL;
+  }
 
-  int ret = io_uring_setup(256, &params);
+  int ret = io_uring_setup(opts.entries, &params);
   if (ret < 0) {
     throw_(std::system_error{-ret, std::system_category()});
   }
@@ -376,20 +434,28 @@ io_uring_context::io_uring_context() {
     sqEntries_ = reinterpret_cast<io_uring_sqe*>(sqePtr);
   }
 
-  {
+  // A polled ring can't submit MSG_RING operations.
+  msgRingWakeups_ = opts.msgRingWakeups && !polledIo_ &&
+      is_op_supported(iouringFd_.get(), IORING_OP_MSG_RING);
+
+  if (!polledIo_) {
     int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
     if (fd < 0) {
       int errorCode = errno;
       throw_(std::system_error{errorCode, std::system_category()});
     }
 
-    remoteQueueEventFd_ = safe_file_descriptor{fd};
+    remoteQueueEventFd_ = new remote_queue_eventfd{safe_file_descriptor{fd}};
   }
 
   LOG("io_uring_context construction done");
 }
 
 io_uring_context::~io_uring_context() {
+  release_unprocessed_msg_ring_wakeups();
+  if (remoteQueueEventFd_ != nullptr) {
+    remoteQueueEventFd_->release();
+  }
 }
 
 void io_uring_context::run_impl(const bool& shouldStop) {
@@ -417,10 +483,9 @@ void io_uring_context::run_impl(const bool& shouldStop) {
     }
 
     // Check for remotely-queued items.
-    // Only do this if we haven't submitted a poll operation for the
-    // completion queue - in which case we'll just wait until we receive the
-    // completion-queue item).
-    if (!remoteQueueReadSubmitted_) {
+    // Only do this if we have marked the queue as inactive - in which case
+    // we'll just wait until we receive a wake-up completion-queue item.
+    if (!remoteQueueInactive_) {
       acquire_remote_queued_items();
     }
 
@@ -431,19 +496,21 @@ void io_uring_context::run_impl(const bool& shouldStop) {
       item->execute_(item);
     }
 
-    if (localQueue_.empty() || sqUnflushedCount_ > 0) {
+    if (polledIo_) {
+      poll_io();
+    } else if (localQueue_.empty() || sqUnflushedCount_ > 0) {
       const bool isIdle = sqUnflushedCount_ == 0 && localQueue_.empty();
       if (isIdle) {
-        if (!remoteQueueReadSubmitted_) {
+        if (!remoteQueueInactive_) {
           LOG("try_register_remote_queue_notification()");
-          remoteQueueReadSubmitted_ = try_register_remote_queue_notification();
+          remoteQueueInactive_ = try_register_remote_queue_notification();
         }
       }
 
       int minCompletionCount = 0;
       unsigned flags = 0;
       if (isIdle &&
-          (remoteQueueReadSubmitted_ ||
+          (remoteQueueInactive_ ||
            pending_operation_count() == cqEntryCount_)) {
         // No work to do until we receive a completion event.
         minCompletionCount = 1;
@@ -475,15 +542,97 @@ void io_uring_context::run_impl(const bool& shouldStop) {
   }
 }
 
+void io_uring_context::poll_io() {
+  const bool hasInFlightIo = cqPendingCount_ > 0;
+  if (sqUnflushedCount_ == 0 && !hasInFlightIo) {
+    if (localQueue_.empty() && pendingIoQueue_.empty()) {
+      // Nothing to reap. Let other threads run before checking the remote
+      // queue and timers again.
+      std::this_thread::yield();
+    }
+    return;
+  }
+
+  // Submit any new entries and, if anything is in flight, poll the device
+  // once for completions without waiting for a minimum number of them.
+  LOGX(
+      "io_uring_enter() - submit %u, poll for %u\n",
+      sqUnflushedCount_,
+      cqPendingCount_);
+
+  int result = io_uring_enter(
+      iouringFd_.get(),
+      sqUnflushedCount_,
+      0,
+      hasInFlightIo ? IORING_ENTER_GETEVENTS : 0,
+      nullptr);
+  if (result < 0) {
+    int errorCode = errno;
+    throw_(std::system_error{errorCode, std::system_category()});
+  }
+
+  sqUnflushedCount_ -= result;
+  cqPendingCount_ += result;
+}
+
 bool io_uring_context::is_running_on_io_thread() const noexcept {
   return this == currentThreadContext;
 }
 
+struct io_uring_context::batch : schedule_batch::pending {
+  // Operations for more distinct contexts than this are enqueued
+  // straight away.
+  static constexpr std::size_t max_groups = 8;
+
+  struct group {
+    io_uring_context* context_;
+    operation_queue ops_;
+  };
+
+  batch() noexcept : pending(&batch::flush) {}
+
+  static batch& current() noexcept {
+    static thread_local batch b;
+    return b;
+  }
+
+  bool try_defer(io_uring_context* context, operation_base* op) noexcept {
+    for (std::size_t i = 0; i < groupCount_; ++i) {
+      group& g = groups_[i];
+      if (g.context_ == context) {
+        g.ops_.push_back(op);
+        return true;
+      }
+    }
+    if (groupCount_ == max_groups) {
+      return false;
+    }
+    group& g = groups_[groupCount_++];
+    g.context_ = context;
+    g.ops_.push_back(op);
+    schedule_batch::defer(*this);
+    return true;
+  }
+
+  static void flush(pending* p) noexcept {
+    auto& self = *static_cast<batch*>(p);
+    const std::size_t groupCount = std::exchange(self.groupCount_, 0);
+    for (std::size_t i = 0; i < groupCount; ++i) {
+      group& g = self.groups_[i];
+      g.context_->schedule_remote(std::move(g.ops_));
+    }
+  }
+
+  std::array<group, max_groups> groups_;
+  std::size_t groupCount_ = 0;
+};
+
 void io_uring_context::schedule_impl(operation_base* op) {
   UNIFEX_ASSERT(op != nullptr);
   if (is_running_on_io_thread()) {
     schedule_local(op);
-  } else {
+  } else if (
+      !schedule_batch::active() || !batch::current().try_defer(this, op)) {
     schedule_remote(op);
   }
 }
@@ -499,13 +648,87 @@ void io_uring_context::schedule_local(operation_queue ops) noexcept {
 void io_uring_context::schedule_remote(operation_base* op) noexcept {
   bool ioThreadWasInactive = remoteQueue_.enqueue(op);
   if (ioThreadWasInactive) {
-    // We were the first to queue an item and the I/O thread is not
-    // going to check the queue until we signal it that new items
-    // have been enqueued remotely by writing to the eventfd.
+    wake_inactive_io_thread();
+  }
+}
+
+void io_uring_context::schedule_remote(operation_queue ops) noexcept {
+  bool ioThreadWasInactive = remoteQueue_.enqueue_all(std::move(ops));
+  if (ioThreadWasInactive) {
+    wake_inactive_io_thread();
+  }
+}
+
+void io_uring_context::wake_inactive_io_thread() noexcept {
+  // We were the first to queue an item and the I/O thread is not
+  // going to check the queue until we signal it that new items
+  // have been enqueued remotely, either with a MSG_RING from our own
+  // ring if we are running on another io_uring_context, or by writing
+  // to the eventfd.
+  auto* current = currentThreadContext;
+  if (current == nullptr || current == this ||
+      !current->try_submit_msg_ring_wakeup(*this)) {
     signal_remote_queue();
   }
 }
 
+bool io_uring_context::try_submit_msg_ring_wakeup(
+    io_uring_context& target) noexcept {
+  UNIFEX_ASSERT(is_running_on_io_thread());
+  if (!msgRingWakeups_ || target.remoteQueueEventFd_ == nullptr) {
+    return false;
+  }
+
+  auto populateSqe = [&](io_uring_sqe& sqe) noexcept {
+    sqe.opcode = IORING_OP_MSG_RING;
+    sqe.fd = target.iouringFd_.get();
+    sqe.addr = IORING_MSG_DATA;
+    sqe.len = 0;  // The 'res' of the target's completion.
+    sqe.off = msg_ring_wakeup_user_data;  // The target's 'user_data'.
+
+    // Keep the target's eventfd alive until we process the completion,
+    // which may be after the target has been destroyed.
+    target.remoteQueueEventFd_->add_ref();
+    sqe.user_data =
+        reinterpret_cast<std::uintptr_t>(target.remoteQueueEventFd_) |
+        msg_ring_sent_tag;
+  };
+
+  if (try_submit_io(populateSqe)) {
+    LOG("added MSG_RING wakeup to submission queue");
+    return true;
+  }
+
+  return false;
+}
+
+void io_uring_context::release_unprocessed_msg_ring_wakeups() noexcept {
+  const auto release = [](__u64 userData) noexcept {
+    reinterpret_cast<remote_queue_eventfd*>(
+        static_cast<std::uintptr_t>(userData & ~msg_ring_sent_tag))
+        ->release();
+  };
+
+  const std::uint32_t sqTail = sqTail_->load(std::memory_order_relaxed);
+  for (std::uint32_t i = sqTail - sqUnflushedCount_; i != sqTail; ++i) {
+    const auto& sqe = sqEntries_[sqIndexArray_[i & sqMask_]];
+    if (sqe.opcode == IORING_OP_MSG_RING) {
+      release(sqe.user_data);
+    }
+  }
+
+  const std::uint32_t cqTail = cqTail_->load(std::memory_order_acquire);
+  for (std::uint32_t i = cqHead_->load(std::memory_order_relaxed);
+       i != cqTail;
+       ++i) {
+    const auto& cqe = cqEntries_[i & cqMask_];
+    if (cqe.user_data != msg_ring_wakeup_user_data &&
+        (cqe.user_data & msg_ring_sent_tag) != 0) {
+      release(cqe.user_data);
+    }
+  }
+}
+
 void io_uring_context::schedule_pending_io(operation_base* op) noexcept {
   UNIFEX_ASSERT(is_running_on_io_thread());
   pendingIoQueue_.push_back(op);
@@ -561,6 +784,10 @@ void io_uring_context::acquire_completion_queue_items() noexcept {
 
     operation_queue completionQueue;
 
+    // Completions posted to our ring by other rings' MSG_RING operations.
+    // These don't count against cqPendingCount_.
+    std::uint32_t externalCount = 0;
+
     for (std::uint32_t i = 0; i < count; ++i) {
       auto& cqe = cqEntries_[(cqHead + i) & mask];
 
@@ -577,7 +804,7 @@ void io_uring_context::acquire_completion_queue_items() noexcept {
         // Read the eventfd to clear the signal.
         __u64 buffer;
         ssize_t bytesRead =
-            read(remoteQueueEventFd_.get(), &buffer, sizeof(buffer));
+            read(remoteQueueEventFd_->fd_.get(), &buffer, sizeof(buffer));
         if (bytesRead < 0) {
           // read() failed
           [[maybe_unused]] int errorCode = errno;
@@ -591,6 +818,29 @@ void io_uring_context::acquire_completion_queue_items() noexcept {
         // Skip processing this item and let the loop check
         // for the remote-queued items next time around.
         remoteQueueReadSubmitted_ = false;
+        remoteQueueInactive_ = false;
+        continue;
+      } else if (cqe.user_data == msg_ring_wakeup_user_data) {
+        LOG("got remote queue wakeup via MSG_RING");
+        ++externalCount;
+
+        // The remote thread that woke us has marked the queue as active.
+        // The eventfd poll stays armed for the next time we go idle.
+        remoteQueueInactive_ = false;
+        continue;
+      } else if ((cqe.user_data & msg_ring_sent_tag) != 0) {
+        auto* targetEventFd = reinterpret_cast<remote_queue_eventfd*>(
+            static_cast<std::uintptr_t>(cqe.user_data & ~msg_ring_sent_tag));
+        scope_guard releaseTarget = [&]() noexcept {
+          targetEventFd->release();
+        };
+        if (cqe.res < 0) {
+          LOGX("MSG_RING wakeup failed err: %i\n", cqe.res);
+
+          // Fall back to waking the target through its eventfd. This is
+          // harmless if the target has since been destroyed.
+          targetEventFd->signal();
+        }
         continue;
       } else if (cqe.user_data == timer_user_data()) {
         LOGX("got timer completion result %i\n", cqe.res);
@@ -627,12 +877,12 @@ void io_uring_context::acquire_completion_queue_items() noexcept {
 
     // Mark those completion queue entries as consumed.
     cqHead_->store(cqTail, std::memory_order_release);
-    cqPendingCount_ -= count;
+    cqPendingCount_ -= count - externalCount;
   }
 }
 
 void io_uring_context::acquire_remote_queued_items() noexcept {
-  UNIFEX_ASSERT(!remoteQueueReadSubmitted_);
+  UNIFEX_ASSERT(!remoteQueueInactive_);
   auto items = remoteQueue_.dequeue_all();
   LOG(items.empty() ? "remote queue is empty"
                     : "acquired items from remote queue");
@@ -640,6 +890,17 @@ void io_uring_context::acquire_remote_queued_items() noexcept {
 }
 
 bool io_uring_context::try_register_remote_queue_notification() noexcept {
+  if (remoteQueueReadSubmitted_) {
+    // We were last woken up via MSG_RING so the eventfd poll is still
+    // armed. We only need to mark the queue as inactive.
+    auto queuedItems = remoteQueue_.try_mark_inactive_or_dequeue_all();
+    if (!queuedItems.empty()) {
+      schedule_local(std::move(queuedItems));
+      return false;
+    }
+    return true;
+  }
+
   // Check that we haven't already hit the limit of pending
   // I/O completion events.
   const auto populateRemoteQueuePollSqe = [this](io_uring_sqe& sqe) noexcept {
@@ -650,7 +911,7 @@ bool io_uring_context::try_register_remote_queue_notification() noexcept {
     }
 
     sqe.opcode = IORING_OP_POLL_ADD;
-    sqe.fd = remoteQueueEventFd_.get();
+    sqe.fd = remoteQueueEventFd_->fd_.get();
     sqe.poll_events = POLL_IN;
     sqe.user_data = remote_queue_event_user_data;
 
@@ -659,6 +920,7 @@ bool io_uring_context::try_register_remote_queue_notification() noexcept {
 
   if (try_submit_io(populateRemoteQueuePollSqe)) {
     LOG("added eventfd poll to submission queue");
+    remoteQueueReadSubmitted_ = true;
     return true;
   }
 
@@ -666,12 +928,15 @@ bool io_uring_context::try_register_remote_queue_notification() noexcept {
 }
 
 void io_uring_context::signal_remote_queue() {
+  remoteQueueEventFd_->signal();
+}
+
+void io_uring_context::remote_queue_eventfd::signal() {
   LOG("writing bytes to eventfd");
 
   // Notify eventfd() by writing a 64-bit integer to it.
   const __u64 value = 1;
-  ssize_t bytesWritten =
-      write(remoteQueueEventFd_.get(), &value, sizeof(value));
+  ssize_t bytesWritten = write(fd_.get(), &value, sizeof(value));
   if (bytesWritten < 0) {
     // What to do here? Terminate/abort/ignore?
     // Try to dequeue the item before returning?
@@ -724,6 +989,13 @@ void io_uring_context::update_timers() noexcept {
     }
   }
 
+  if (polledIo_) {
+    // Timers can't be submitted to a polled ring. Keep checking the heap
+    // every time around the run loop while it is non-empty.
+    timersAreDirty_ = !timers_.empty();
+    return;
+  }
+
   // Check if we need to cancel or start some new OS timers.
   if (timers_.empty()) {
     if (currentDueTime_.has_value()) {
@@ -836,6 +1108,61 @@ io_uring_context::async_read_write_file tag_invoke(
   return io_uring_context::async_read_write_file{*scheduler.context_, result};
 }
 
+namespace {
+// Opens a file with O_DIRECT and returns the descriptor along with the
+// alignment its requests must satisfy.
+std::pair<int, std::uint32_t>
+open_direct(const filesystem::path& path, int flags) {
+  int result = ::open(path.c_str(), flags | O_DIRECT | O_CLOEXEC, 0644);
+  if (result < 0) {
+    int errorCode = errno;
+    throw_(std::system_error{errorCode, std::system_category()});
+  }
+
+  safe_file_descriptor fd{result};
+  std::uint32_t alignment = query_direct_io_alignment(fd.get());
+  return {fd.release(), alignment};
+}
+}  // namespace
+
+io_uring_context::async_read_only_file tag_invoke(
+    tag_t<open_file_read_only>,
+    io_uring_context::scheduler scheduler,
+    const filesystem::path& path,
+    direct_io_t) {
+  auto [fd, alignment] = open_direct(path, O_RDONLY);
+  return io_uring_context::async_read_only_file{
+      *scheduler.context_, fd, alignment};
+}
+
+io_uring_context::async_write_only_file tag_invoke(
+    tag_t<open_file_write_only>,
+    io_uring_context::scheduler scheduler,
+    const filesystem::path& path,
+    direct_io_t) {
+  auto [fd, alignment] = open_direct(path, O_WRONLY | O_CREAT);
+  return io_uring_context::async_write_only_file{
+      *scheduler.context_, fd, alignment};
+}
+
+io_uring_context::async_read_write_file tag_invoke(
+    tag_t<open_file_read_write>,
+    io_uring_context::scheduler scheduler,
+    const filesystem::path& path,
+    direct_io_t) {
+  auto [fd, alignment] = open_direct(path, O_RDWR | O_CREAT);
+  return io_uring_context::async_read_write_file{
+      *scheduler.context_, fd, alignment};
+}
+
+io_uring_context::async_datagram_socket tag_invoke(
+    tag_t<open_datagram_socket>,
+    io_uring_context::scheduler scheduler,
+    const socket_address& address) {
+  return io_uring_context::async_datagram_socket{
+      *scheduler.context_, _dgram::open_socket(address).release()};
+}
+
 io_uring_context::accept_stream tag_invoke(
     tag_t<open_listening_socket>,
     io_uring_context::scheduler scheduler,
@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+#if !UNIFEX_NO_LIBURING
+
+#  include <unifex/linux/sharded_runtime.hpp>
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+
+#  include <algorithm>
+#  include <atomic>
+#  include <thread>
+
+#  include <pthread.h>
+#  include <sched.h>
+
+namespace unifex::linuxos {
+
+namespace {
+struct current_shard {
+  const sharded_runtime* runtime_ = nullptr;
+  std::size_t index_ = sharded_runtime::no_shard;
+};
+
+thread_local current_shard currentShard;
+
+constexpr std::size_t cache_line_size = 64;
+
+std::size_t round_up_to_power_of_two(std::size_t n) noexcept {
+  std::size_t result = 1;
+  while (result < n) {
+    result <<= 1;
+  }
+  return result;
+}
+
+// The CPUs that the process is allowed to run on.
+std::vector<int> available_cpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+}  // namespace
+
+struct sharded_runtime::drain_receiver {
+  sharded_runtime* runtime_;
+  spsc_ring* ring_;
+
+  void set_value() noexcept;
+  void set_error(std::exception_ptr) noexcept;
+  void set_done() noexcept;
+};
+
+// A bounded ring of tasks from one shard (the producer) to another (the
+// consumer).
+//
+// The producer sets drainScheduled_ after pushing and, if it wasn't already
+// set, schedules drainOp_ onto the consumer's io_uring_context. The
+// consumer clears the flag before popping, so a push that races with a
+// drain either is seen by that drain or schedules another.
+class sharded_runtime::spsc_ring {
+public:
+  spsc_ring(io_uring_context& consumer, std::size_t capacity)
+    : consumer_(consumer)
+    , mask_(capacity - 1)
+    , slots_(new task_base*[capacity]) {}
+
+  // Producer only.
+  bool try_push(task_base* task) noexcept {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - headCache_ > mask_) {
+      headCache_ = head_.load(std::memory_order_acquire);
+      if (tail - headCache_ > mask_) {
+        return false;
+      }
+    }
+    slots_[tail & mask_] = task;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. The task's slot isn't released until pop() is called,
+  // so a ring stays non-empty while its tasks run.
+  task_base* front() noexcept {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tailCache_) {
+      tailCache_ = tail_.load(std::memory_order_acquire);
+      if (head == tailCache_) {
+        return nullptr;
+      }
+    }
+    return slots_[head & mask_];
+  }
+
+  // Consumer only.
+  void pop() noexcept {
+    head_.store(
+        head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // Total number of tasks ever pushed.
+  std::size_t pushed_count() const noexcept {
+    return tail_.load(std::memory_order_acquire);
+  }
+
+  // Whether the ring is empty and no drain is pending.
+  bool idle() const noexcept {
+    return head_.load(std::memory_order_acquire) ==
+        tail_.load(std::memory_order_acquire) &&
+        !drainScheduled_.load(std::memory_order_acquire);
+  }
+
+  std::size_t capacity() const noexcept { return mask_ + 1; }
+
+  io_uring_context& consumer_;
+  std::atomic<bool> drainScheduled_{false};
+  manual_lifetime<connect_result_t<
+      schedule_result_t<io_uring_context::scheduler>,
+      drain_receiver>>
+      drainOp_;
+
+private:
+  const std::size_t mask_;
+  const std::unique_ptr<task_base*[]> slots_;
+
+  // Written by the consumer.
+  alignas(cache_line_size) std::atomic<std::size_t> head_{0};
+  std::size_t tailCache_ = 0;
+
+  // Written by the producer.
+  alignas(cache_line_size) std::atomic<std::size_t> tail_{0};
+  std::size_t headCache_ = 0;
+};
+
+struct sharded_runtime::shard {
+  explicit shard(const io_uring_context::options& ioOptions)
+    : context_(ioOptions) {}
+
+  io_uring_context context_;
+  inplace_stop_source stopSource_;
+
+  // Indexed by the producing shard. The ring from a shard to itself is
+  // never used and left empty.
+  std::vector<std::unique_ptr<spsc_ring>> inbound_;
+
+#  if !UNIFEX_NO_MEMORY_RESOURCE
+  pmr::unsynchronized_pool_resource memory_;
+#  endif
+
+  std::thread thread_;
+};
+
+void sharded_runtime::drain_receiver::set_value() noexcept {
+  runtime_->drain(*ring_);
+}
+
+void sharded_runtime::drain_receiver::set_error(std::exception_ptr) noexcept {
+  // Scheduling onto the consumer failed. Let the next push try again.
+  spsc_ring& ring = *ring_;
+  ring.drainOp_.destruct();
+  ring.drainScheduled_.store(false, std::memory_order_release);
+}
+
+void sharded_runtime::drain_receiver::set_done() noexcept {
+  set_error(nullptr);
+}
+
+sharded_runtime::sharded_runtime() : sharded_runtime(options{}) {}
+
+sharded_runtime::sharded_runtime(const options& opts) {
+  std::size_t count = opts.shardCount;
+  if (count == 0) {
+    count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const std::size_t capacity = round_up_to_power_of_two(opts.ringCapacity);
+
+  shards_.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    shards_.push_back(std::make_unique<shard>(opts.ioOptions));
+  }
+  for (auto& s : shards_) {
+    s->inbound_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      s->inbound_.push_back(std::make_unique<spsc_ring>(s->context_, capacity));
+    }
+  }
+
+  std::vector<int> cpus;
+  if (opts.pinThreads) {
+    cpus = available_cpus();
+  }
+
+  UNIFEX_TRY {
+    for (std::size_t i = 0; i < count; ++i) {
+      int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+      shards_[i]->thread_ = std::thread{[this, i, cpu] {
+        run_shard(i, cpu);
+      }};
+    }
+  }
+  UNIFEX_CATCH(...) {
+    shutdown();
+    UNIFEX_RETHROW();
+  }
+}
+
+sharded_runtime::~sharded_runtime() {
+  shutdown();
+}
+
+io_uring_context& sharded_runtime::shard_context(std::size_t index) noexcept {
+  UNIFEX_ASSERT(index < shards_.size());
+  return shards_[index]->context_;
+}
+
+std::size_t sharded_runtime::this_shard() const noexcept {
+  const current_shard& current = currentShard;
+  return current.runtime_ == this ? current.index_ : no_shard;
+}
+
+#  if !UNIFEX_NO_MEMORY_RESOURCE
+pmr::memory_resource&
+sharded_runtime::shard_memory_resource(std::size_t index) noexcept {
+  UNIFEX_ASSERT(index < shards_.size());
+  return shards_[index]->memory_;
+}
+
+pmr::memory_resource& sharded_runtime::this_shard_memory_resource() noexcept {
+  const current_shard& current = currentShard;
+  if (current.runtime_ == nullptr) {
+    return *pmr::get_default_resource();
+  }
+  return current.runtime_->shards_[current.index_]->memory_;
+}
+#  endif
+
+void sharded_runtime::run_shard(std::size_t index, int cpu) noexcept {
+  if (cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    (void)::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+  }
+
+  currentShard = current_shard{this, index};
+  shard& s = *shards_[index];
+  s.context_.run(s.stopSource_.get_token());
+  currentShard = current_shard{};
+}
+
+bool sharded_runtime::try_submit(
+    std::size_t target, task_base* task) noexcept {
+  const current_shard& current = currentShard;
+  if (current.runtime_ != this || current.index_ == target) {
+    return false;
+  }
+
+  spsc_ring& ring = *shards_[target]->inbound_[current.index_];
+  if (!ring.try_push(task)) {
+    return false;
+  }
+  if (!ring.drainScheduled_.exchange(true, std::memory_order_acq_rel)) {
+    start_drain(ring);
+  }
+  return true;
+}
+
+void sharded_runtime::start_drain(spsc_ring& ring) noexcept {
+  ring.drainOp_.construct_with([&]() noexcept {
+    return unifex::connect(
+        unifex::schedule(ring.consumer_.get_scheduler()),
+        drain_receiver{this, &ring});
+  });
+  unifex::start(ring.drainOp_.get());
+}
+
+void sharded_runtime::drain(spsc_ring& ring) noexcept {
+  ring.drainOp_.destruct();
+  ring.drainScheduled_.exchange(false, std::memory_order_acq_rel);
+
+  // Run at most one ring's worth of tasks before letting the shard get on
+  // with its I/O, rescheduling the drain if more have arrived since.
+  for (std::size_t i = 0; i < ring.capacity(); ++i) {
+    task_base* task = ring.front();
+    if (task == nullptr) {
+      return;
+    }
+    task->execute_(task);
+    ring.pop();
+  }
+  if (ring.front() != nullptr &&
+      !ring.drainScheduled_.exchange(true, std::memory_order_acq_rel)) {
+    start_drain(ring);
+  }
+}
+
+void sharded_runtime::shutdown() noexcept {
+  if (shutDown_) {
+    return;
+  }
+  shutDown_ = true;
+  UNIFEX_ASSERT(currentShard.runtime_ != this);
+
+  // Scheduled work can schedule more work, so wait until two consecutive
+  // passes find every ring idle and no fallback operation in flight, with
+  // nothing scheduled in between. A ring isn't empty while one of its tasks
+  // is running, so any task that was running during the first pass either
+  // shows up as busy or scheduled nothing.
+  bool wasIdle = false;
+  std::size_t lastPushed = 0;
+  while (true) {
+    const std::size_t finished =
+        fallbackFinished_.load(std::memory_order_acquire);
+    const std::size_t started =
+        fallbackStarted_.load(std::memory_order_acquire);
+    bool idle = started == finished;
+    std::size_t pushed = started;
+    for (auto& s : shards_) {
+      for (auto& ring : s->inbound_) {
+        idle = idle && ring->idle();
+        pushed += ring->pushed_count();
+      }
+    }
+    if (idle && wasIdle && pushed == lastPushed) {
+      break;
+    }
+    wasIdle = idle;
+    lastPushed = pushed;
+
+    // Let every shard run whatever it has queued.
+    for (auto& s : shards_) {
+      if (s->thread_.joinable()) {
+        sync_wait(unifex::schedule(s->context_.get_scheduler()));
+      }
+    }
+  }
+
+  for (auto& s : shards_) {
+    s->stopSource_.request_stop();
+  }
+  for (auto& s : shards_) {
+    if (s->thread_.joinable()) {
+      s->thread_.join();
+    }
+  }
+}
+
+}  // namespace unifex::linuxos
+
+#endif  // !UNIFEX_NO_LIBURING
@@ -15,10 +15,72 @@
  */
 #include <unifex/manual_event_loop.hpp>
 
+#include <unifex/schedule_batch.hpp>
+#include <unifex/scope_guard.hpp>
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
 namespace unifex {
 namespace _manual_event_loop {
 
+static thread_local const context* currentThreadLoop = nullptr;
+
+struct context::batch : schedule_batch::pending {
+  // Tasks for more distinct loops than this are enqueued straight away.
+  static constexpr std::size_t max_groups = 8;
+
+  struct group {
+    context* loop_;
+    task_base* head_;
+    task_base* tail_;
+  };
+
+  batch() noexcept : pending(&batch::flush) {}
+
+  static batch& current() noexcept {
+    static thread_local batch b;
+    return b;
+  }
+
+  bool try_defer(context* loop, task_base* task) noexcept {
+    task->next_ = nullptr;
+    for (std::size_t i = 0; i < groupCount_; ++i) {
+      group& g = groups_[i];
+      if (g.loop_ == loop) {
+        g.tail_->next_ = task;
+        g.tail_ = task;
+        return true;
+      }
+    }
+    if (groupCount_ == max_groups) {
+      return false;
+    }
+    groups_[groupCount_++] = group{loop, task, task};
+    schedule_batch::defer(*this);
+    return true;
+  }
+
+  static void flush(pending* p) noexcept {
+    auto& self = *static_cast<batch*>(p);
+    const std::size_t groupCount = std::exchange(self.groupCount_, 0);
+    for (std::size_t i = 0; i < groupCount; ++i) {
+      group& g = self.groups_[i];
+      g.loop_->enqueue_list(g.head_, g.tail_);
+    }
+  }
+
+  std::array<group, max_groups> groups_;
+  std::size_t groupCount_ = 0;
+};
+
 void context::run() {
+  auto* oldLoop = std::exchange(currentThreadLoop, this);
+  scope_guard restoreLoop = [&]() noexcept {
+    currentThreadLoop = oldLoop;
+  };
+
   std::unique_lock lock{mutex_};
   while (true) {
     while (head_ == nullptr) {
@@ -37,6 +99,10 @@ void context::run() {
   }
 }
 
+bool context::is_running_on_loop_thread() const noexcept {
+  return currentThreadLoop == this;
+}
+
 void context::stop() {
   std::unique_lock lock{mutex_};
   stop_ = true;
@@ -44,15 +110,22 @@ void context::stop() {
 }
 
 void context::enqueue(task_base* task) {
+  if (schedule_batch::active() && batch::current().try_defer(this, task)) {
+    return;
+  }
+  task->next_ = nullptr;
+  enqueue_list(task, task);
+}
+
+void context::enqueue_list(task_base* head, task_base* tail) {
   std::unique_lock lock{mutex_};
   bool wasEmpty = (head_ == nullptr);
   if (wasEmpty) {
-    head_ = task;
+    head_ = head;
   } else {
-    tail_->next_ = task;
+    tail_->next_ = head;
   }
-  tail_ = task;
-  task->next_ = nullptr;
+  tail_ = tail;
   if (wasEmpty) {
     cv_.notify_one();
   }
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/schedule_batch.hpp>
+
+namespace unifex {
+
+thread_local std::size_t schedule_batch::depth_ = 0;
+thread_local schedule_batch::pending* schedule_batch::head_ = nullptr;
+
+void schedule_batch::defer(pending& p) noexcept {
+  UNIFEX_ASSERT(active());
+  if (!p.queued_) {
+    p.queued_ = true;
+    p.next_ = head_;
+    head_ = &p;
+  }
+}
+
+void schedule_batch::flush() noexcept {
+  while (head_ != nullptr) {
+    pending* p = head_;
+    head_ = p->next_;
+    p->queued_ = false;
+    p->flush_(p);
+  }
+}
+
+}  // namespace unifex
@@ -15,29 +15,299 @@
  */
 #include <unifex/static_thread_pool.hpp>
 
+#include <unifex/schedule_batch.hpp>
+#include <unifex/spin_wait.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#  include <dirent.h>
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
 namespace unifex {
 namespace _static_thread_pool {
-context::context() : context(std::thread::hardware_concurrency()) {
+static thread_local const context* currentThreadPool = nullptr;
+static thread_local std::uint32_t currentThreadNode = context::any_node;
+static thread_local std::uint32_t currentThreadIndex = 0;
+
+namespace {
+#if defined(__linux__)
+// The CPUs that the process is allowed to run on.
+std::vector<int> allowed_cpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+// Parses a sysfs CPU list such as "0-3,8,10-11".
+std::vector<int> parse_cpu_list(const std::string& list) {
+  std::vector<int> cpus;
+  std::size_t pos = 0;
+  while (pos < list.size()) {
+    int first = 0;
+    int last = 0;
+    int length = 0;
+    const char* range = list.c_str() + pos;
+    if (std::sscanf(range, "%d-%d%n", &first, &last, &length) != 2) {
+      if (std::sscanf(range, "%d%n", &first, &length) != 1) {
+        break;
+      }
+      last = first;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+    pos += static_cast<std::size_t>(length);
+    pos = list.find(',', pos);
+    if (pos == std::string::npos) {
+      break;
+    }
+    ++pos;
+  }
+  return cpus;
+}
+
+std::string read_first_line(const std::string& path) {
+  std::string line;
+  if (std::FILE* file = std::fopen(path.c_str(), "r")) {
+    char buffer[4096];
+    if (std::fgets(buffer, sizeof(buffer), file) != nullptr) {
+      line = buffer;
+    }
+    std::fclose(file);
+  }
+  return line;
+}
+
+// The allowed CPUs of each NUMA node that has any, as listed in sysfs.
+std::vector<std::vector<int>> numa_nodes(const std::vector<int>& allowed) {
+  std::vector<std::vector<int>> nodes;
+  const std::string root = "/sys/devices/system/node";
+  DIR* dir = ::opendir(root.c_str());
+  if (dir == nullptr) {
+    return nodes;
+  }
+  std::vector<unsigned> ids;
+  while (const dirent* entry = ::readdir(dir)) {
+    unsigned id;
+    char trailing;
+    if (std::sscanf(entry->d_name, "node%u%c", &id, &trailing) == 1) {
+      ids.push_back(id);
+    }
+  }
+  ::closedir(dir);
+  std::sort(ids.begin(), ids.end());
+
+  for (unsigned id : ids) {
+    std::vector<int> cpus;
+    for (int cpu : parse_cpu_list(read_first_line(
+             root + "/node" + std::to_string(id) + "/cpulist"))) {
+      if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+        cpus.push_back(cpu);
+      }
+    }
+    if (!cpus.empty()) {
+      nodes.push_back(std::move(cpus));
+    }
+  }
+  return nodes;
+}
+
+void pin_current_thread(int cpu) noexcept {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  (void)::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+}
+#else
+std::vector<int> allowed_cpus() {
+  return {};
+}
+
+std::vector<std::vector<int>> numa_nodes(const std::vector<int>&) {
+  return {};
+}
+
+void pin_current_thread(int) noexcept {
+}
+#endif
+
+// Splits threadCount threads between the nodes in proportion to their
+// CPU counts, giving the remainder to the nodes with the largest
+// fractional shares.
+std::vector<std::uint32_t> distribute_threads(
+    std::uint32_t threadCount, const std::vector<std::vector<int>>& nodes) {
+  std::size_t totalCpus = 0;
+  for (auto& cpus : nodes) {
+    totalCpus += cpus.size();
+  }
+  std::vector<std::uint32_t> counts(nodes.size());
+  if (totalCpus == 0) {
+    counts[0] = threadCount;
+    return counts;
+  }
+
+  std::vector<std::pair<std::size_t, std::size_t>> remainders;
+  std::uint32_t assigned = 0;
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    const std::size_t share = std::size_t(threadCount) * nodes[i].size();
+    counts[i] = static_cast<std::uint32_t>(share / totalCpus);
+    assigned += counts[i];
+    remainders.emplace_back(share % totalCpus, i);
+  }
+  std::stable_sort(
+      remainders.begin(), remainders.end(), [](auto& a, auto& b) {
+        return a.first > b.first;
+      });
+  for (std::size_t i = 0; assigned < threadCount; ++i, ++assigned) {
+    ++counts[remainders[i % remainders.size()].second];
+  }
+  return counts;
+}
+}  // namespace
+
+struct context::batch : schedule_batch::pending {
+  // Tasks for more distinct (pool, node, lane) targets than this are
+  // enqueued straight away.
+  static constexpr std::size_t max_groups = 8;
+
+  struct group {
+    context* pool_;
+    std::uint32_t node_;
+    priority lane_;
+    std::size_t count_;
+    task_queue tasks_;
+  };
+
+  batch() noexcept : pending(&batch::flush) {}
+
+  static batch& current() noexcept {
+    static thread_local batch b;
+    return b;
+  }
+
+  bool try_defer(
+      context* pool, task_base* task, std::uint32_t node, priority p) noexcept {
+    for (std::size_t i = 0; i < groupCount_; ++i) {
+      group& g = groups_[i];
+      if (g.pool_ == pool && g.node_ == node && g.lane_ == p) {
+        g.tasks_.push_back(task);
+        ++g.count_;
+        return true;
+      }
+    }
+    if (groupCount_ == max_groups) {
+      return false;
+    }
+    group& g = groups_[groupCount_++];
+    g.pool_ = pool;
+    g.node_ = node;
+    g.lane_ = p;
+    g.count_ = 1;
+    g.tasks_.push_back(task);
+    schedule_batch::defer(*this);
+    return true;
+  }
+
+  static void flush(pending* p) noexcept {
+    auto& self = *static_cast<batch*>(p);
+    const std::size_t groupCount = std::exchange(self.groupCount_, 0);
+    for (std::size_t i = 0; i < groupCount; ++i) {
+      group& g = self.groups_[i];
+      g.pool_->enqueue_list(std::move(g.tasks_), g.count_, g.node_, g.lane_);
+    }
+  }
+
+  std::array<group, max_groups> groups_;
+  std::size_t groupCount_ = 0;
+};
+
+context::context() : context(options{}) {
 }
 
 context::context(std::uint32_t threadCount)
-  : threadCount_(threadCount)
-  , threadStates_(threadCount)
-  , nextThread_(0) {
+  : context(options{threadCount}) {
   UNIFEX_ASSERT(threadCount > 0);
+}
+
+context::context(const options& opts)
+  : options_(opts)
+  , threadCount_(
+        opts.threadCount != 0
+            ? opts.threadCount
+            : std::max(1u, std::thread::hardware_concurrency()))
+  , threadStates_(threadCount_)
+  , nextThread_(0) {
+  for ([[maybe_unused]] std::uint32_t weight : opts.laneWeights) {
+    UNIFEX_ASSERT(weight > 0);
+  }
+
+  const std::vector<int> cpus = allowed_cpus();
+  std::vector<std::vector<int>> topology;
+  if (opts.numaAware) {
+    topology = numa_nodes(cpus);
+  }
+  if (topology.empty()) {
+    topology.push_back(cpus);
+  }
+
+  // Nodes that get no threads are left out.
+  const std::vector<std::uint32_t> counts =
+      distribute_threads(threadCount_, topology);
+  nodeCount_ = static_cast<std::uint32_t>(
+      counts.size() - std::count(counts.begin(), counts.end(), 0u));
+  nodes_ = std::make_unique<node_state[]>(nodeCount_);
+  std::uint32_t firstThread = 0;
+  for (std::size_t i = 0, node = 0; i < topology.size(); ++i) {
+    if (counts[i] != 0) {
+      nodes_[node].cpus_ = std::move(topology[i]);
+      nodes_[node].firstThread_ = firstThread;
+      nodes_[node].threadCount_ = counts[i];
+      firstThread += counts[i];
+      ++node;
+    }
+  }
 
-  threads_.reserve(threadCount);
+  threads_.reserve(threadCount_);
 
   UNIFEX_TRY {
-    for (std::uint32_t i = 0; i < threadCount; ++i) {
-      threads_.emplace_back([this, i] { run(i); });
+    for (std::uint32_t node = 0; node < nodeCount_; ++node) {
+      const node_state& n = nodes_[node];
+      for (std::uint32_t i = 0; i < n.threadCount_; ++i) {
+        const int cpu = opts.pinThreads && !n.cpus_.empty()
+            ? n.cpus_[i % n.cpus_.size()]
+            : -1;
+        threads_.emplace_back([this, index = n.firstThread_ + i, node, cpu] {
+          run(index, node, cpu);
+        });
+      }
     }
   }
   UNIFEX_CATCH(...) {
-    request_stop();
+    {
+      std::lock_guard lk{startupMutex_};
+      startupAborted_ = true;
+    }
+    startupCv_.notify_all();
     join();
     UNIFEX_RETHROW();
   }
+
+  std::unique_lock lk{startupMutex_};
+  startupCv_.wait(lk, [&] { return startedCount_ == threadCount_; });
 }
 
 context::~context() {
@@ -47,25 +317,89 @@ context::~context() {
 
 void context::request_stop() noexcept {
   for (auto& state : threadStates_) {
-    state.request_stop();
+    if (state) {
+      state->request_stop();
+    }
   }
 }
 
-void context::run(std::uint32_t index) noexcept {
+void context::run(std::uint32_t index, std::uint32_t node, int cpu) noexcept {
+  if (cpu >= 0) {
+    pin_current_thread(cpu);
+  }
+  currentThreadPool = this;
+  currentThreadNode = node;
+  currentThreadIndex = index;
+
+  // Other workers' states are needed for stealing, so wait for every
+  // worker to get this far.
+  threadStates_[index] = std::make_unique<thread_state>(options_, searching_);
+  {
+    std::unique_lock lk{startupMutex_};
+    ++startedCount_;
+    startupCv_.notify_all();
+    startupCv_.wait(lk, [&] {
+      return startedCount_ == threadCount_ || startupAborted_;
+    });
+    if (startupAborted_) {
+      return;
+    }
+  }
+
+  // Look for work in this thread's queue, then in the queues of the other
+  // threads on its node, and only then on other nodes.
+  auto tryPopFrom = [&](std::uint32_t n, std::uint32_t start) -> task_base* {
+    const node_state& ns = nodes_[n];
+    for (std::uint32_t i = 0; i < ns.threadCount_; ++i) {
+      const std::uint32_t offset = (start + i) % ns.threadCount_;
+      if (task_base* task =
+              threadStates_[ns.firstThread_ + offset]->try_pop()) {
+        return task;
+      }
+    }
+    return nullptr;
+  };
+
+  const std::uint32_t localIndex = index - nodes_[node].firstThread_;
+  auto findTask = [&]() -> task_base* {
+    task_base* task = threadStates_[index]->try_pop_timer();
+    if (task == nullptr) {
+      task = tryPopFrom(node, localIndex);
+    }
+    for (std::uint32_t i = 1; task == nullptr && i < nodeCount_; ++i) {
+      task = tryPopFrom((node + i) % nodeCount_, localIndex);
+    }
+    return task;
+  };
+
   while (true) {
-    task_base* task = nullptr;
-    for (std::uint32_t i = 0; i < threadCount_; ++i) {
-      auto queueIndex =
-          (index + i) < threadCount_ ? (index + i) : (index + i - threadCount_);
-      auto& state = threadStates_[queueIndex];
-      task = state.try_pop();
-      if (task != nullptr) {
-        break;
+    task_base* task = findTask();
+
+    // Rather than parking as soon as there is no work, keep looking for a
+    // while, so that a burst of work doesn't need a wake-up per task.
+    if (task == nullptr && options_.spinCount != 0 && try_start_searching()) {
+      spin_wait spin;
+      for (std::uint32_t i = 0; task == nullptr && i < options_.spinCount;
+           ++i) {
+        spin.wait();
+        task = findTask();
+      }
+
+      // Producers don't wake parked workers while anyone is searching, so
+      // the last searcher to stop has to make sure that no task is left
+      // behind in a parked worker's lanes. This pairs with the check of
+      // searching_ after a push.
+      if (searching_.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+        if (task != nullptr) {
+          wake_parked_with_work();
+        } else if (any_queued()) {
+          continue;
+        }
       }
     }
 
     if (task == nullptr) {
-      task = threadStates_[index].pop();
+      task = threadStates_[index]->pop();
       if (task == nullptr) {
         // request_stop() was called.
         return;
@@ -76,6 +410,40 @@ void context::run(std::uint32_t index) noexcept {
   }
 }
 
+bool context::is_running_on_pool_thread(std::uint32_t node) const noexcept {
+  return currentThreadPool == this &&
+      (node == any_node || currentThreadNode == node);
+}
+
+bool context::try_start_searching() noexcept {
+  const std::uint32_t maxSearching = std::max(1u, threadCount_ / 2);
+  std::uint32_t searching = searching_.load(std::memory_order_relaxed);
+  while (searching < maxSearching) {
+    if (searching_.compare_exchange_weak(
+            searching, searching + 1, std::memory_order_seq_cst)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool context::any_queued() const noexcept {
+  for (auto& state : threadStates_) {
+    if (state->has_queued()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void context::wake_parked_with_work() noexcept {
+  for (auto& state : threadStates_) {
+    if (state->has_queued()) {
+      state->wake_if_parked_with_work();
+    }
+  }
+}
+
 void context::join() noexcept {
   for (auto& t : threads_) {
     t.join();
@@ -83,70 +451,296 @@ void context::join() noexcept {
   threads_.clear();
 }
 
-void context::enqueue(task_base* task) noexcept {
-  const std::uint32_t threadCount = static_cast<std::uint32_t>(threads_.size());
+void context::enqueue(
+    task_base* task, std::uint32_t node, priority p) noexcept {
+  if (schedule_batch::active() &&
+      batch::current().try_defer(this, task, node, p)) {
+    return;
+  }
+
+  if (options_.lanePolicy == options::lane_policy::aging) {
+    task->enqueueTime = std::chrono::steady_clock::now();
+  }
+
+  std::uint32_t firstThread = 0;
+  std::uint32_t threadCount = threadCount_;
+  std::atomic<std::uint32_t>* nextThread = &nextThread_;
+  if (node != any_node) {
+    firstThread = nodes_[node].firstThread_;
+    threadCount = nodes_[node].threadCount_;
+    nextThread = &nodes_[node].nextThread_;
+  }
   const std::uint32_t startIndex =
-      nextThread_.fetch_add(1, std::memory_order_relaxed) % threadCount;
+      nextThread->fetch_add(1, std::memory_order_relaxed) % threadCount;
 
   // First try to enqueue to one of the threads without blocking.
   for (std::uint32_t i = 0; i < threadCount; ++i) {
     const auto index = (startIndex + i) < threadCount
         ? (startIndex + i)
         : (startIndex + i - threadCount);
-    if (threadStates_[index].try_push(task)) {
+    if (threadStates_[firstThread + index]->try_push(task, p)) {
       return;
     }
   }
 
   // Otherwise, do a blocking enqueue on the selected thread.
-  threadStates_[startIndex].push(task);
+  threadStates_[firstThread + startIndex]->push(task, p);
+}
+
+void context::enqueue_list(
+    task_queue tasks,
+    std::size_t count,
+    std::uint32_t node,
+    priority p) noexcept {
+  if (options_.lanePolicy == options::lane_policy::aging) {
+    const auto now = std::chrono::steady_clock::now();
+    for (task_base* task = tasks.front(); task != nullptr; task = task->next) {
+      task->enqueueTime = now;
+    }
+  }
+
+  std::uint32_t firstThread = 0;
+  std::uint32_t threadCount = threadCount_;
+  std::atomic<std::uint32_t>* nextThread = &nextThread_;
+  if (node != any_node) {
+    firstThread = nodes_[node].firstThread_;
+    threadCount = nodes_[node].threadCount_;
+    nextThread = &nodes_[node].nextThread_;
+  }
+  const auto chunks =
+      static_cast<std::uint32_t>(std::min<std::size_t>(count, threadCount));
+  const std::uint32_t startIndex =
+      nextThread->fetch_add(chunks, std::memory_order_relaxed) % threadCount;
+
+  for (std::uint32_t chunk = 0; chunk < chunks; ++chunk) {
+    const std::size_t size = count / chunks + (chunk < count % chunks);
+    task_queue part;
+    for (std::size_t i = 0; i < size; ++i) {
+      part.push_back(tasks.pop_front());
+    }
+    const std::uint32_t index = (startIndex + chunk) % threadCount;
+    threadStates_[firstThread + index]->push_all(std::move(part), size, p);
+  }
+  UNIFEX_ASSERT(tasks.empty());
+}
+
+std::uint32_t context::select_timer_worker(std::uint32_t node) noexcept {
+  if (is_running_on_pool_thread(node)) {
+    return currentThreadIndex;
+  }
+  if (node == any_node) {
+    return nextThread_.fetch_add(1, std::memory_order_relaxed) %
+        threadCount_;
+  }
+  node_state& n = nodes_[node];
+  return n.firstThread_ +
+      n.nextThread_.fetch_add(1, std::memory_order_relaxed) % n.threadCount_;
+}
+
+void context::add_timer(timer_base* timer) noexcept {
+  threadStates_[timer->worker]->add_timer(timer);
+}
+
+void context::cancel_timer(timer_base* timer) noexcept {
+  threadStates_[timer->worker]->cancel_timer(timer);
 }
 
 task_base* context::thread_state::try_pop() {
+  if (queued_.load(std::memory_order_relaxed) == 0) {
+    return nullptr;
+  }
   std::unique_lock lk{mut_, std::try_to_lock};
-  if (!lk || queue_.empty()) {
+  if (!lk || empty()) {
     return nullptr;
   }
-  return queue_.pop_front();
+  return pop_next();
 }
 
 task_base* context::thread_state::pop() {
   std::unique_lock lk{mut_};
-  while (queue_.empty()) {
+  while (true) {
+    if (!timers_.empty()) {
+      if (timer_base* timer =
+              pop_due_timer(std::chrono::steady_clock::now())) {
+        return timer;
+      }
+    }
+    if (!empty()) {
+      return pop_next();
+    }
     if (stopRequested_) {
       return nullptr;
     }
-    cv_.wait(lk);
+    parked_ = true;
+    if (timers_.empty()) {
+      cv_.wait(lk);
+    } else {
+      cv_.wait_until(lk, timers_.top()->dueTime);
+    }
+    parked_ = false;
+  }
+}
+
+task_base* context::thread_state::try_pop_timer() {
+  const auto nextDue = nextDue_.load(std::memory_order_relaxed);
+  if (nextDue == no_timers) {
+    return nullptr;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  if (now.time_since_epoch().count() < nextDue) {
+    return nullptr;
+  }
+  std::lock_guard lk{mut_};
+  return pop_due_timer(now);
+}
+
+void context::thread_state::add_timer(timer_base* timer) {
+  std::lock_guard lk{mut_};
+  timer->inHeap = true;
+  timers_.insert(timer);
+  if (timers_.top() == timer) {
+    // The worker may be parked until a later due time.
+    update_next_due();
+    wake_locked(true);
+  }
+}
+
+void context::thread_state::cancel_timer(timer_base* timer) {
+  std::lock_guard lk{mut_};
+  const auto now = std::chrono::steady_clock::now();
+  if (timer->dueTime <= now) {
+    // It is about to run anyway.
+    return;
+  }
+  // If the timer hasn't been added yet, this makes it due as soon as it
+  // is.
+  timer->dueTime = now;
+  if (timer->inHeap) {
+    timers_.remove(timer);
+    timer->inHeap = false;
+    update_next_due();
+    push_locked(timer, timer->lane);
   }
-  return queue_.pop_front();
 }
 
-bool context::thread_state::try_push(task_base* task) {
+timer_base* context::thread_state::pop_due_timer(
+    std::chrono::steady_clock::time_point now) noexcept {
+  if (timers_.empty() || now < timers_.top()->dueTime) {
+    return nullptr;
+  }
+  timer_base* timer = timers_.pop();
+  timer->inHeap = false;
+  update_next_due();
+  return timer;
+}
+
+void context::thread_state::update_next_due() noexcept {
+  nextDue_.store(
+      timers_.empty() ? no_timers
+                      : timers_.top()->dueTime.time_since_epoch().count(),
+      std::memory_order_relaxed);
+}
+
+bool context::thread_state::try_push(task_base* task, priority p) {
   std::unique_lock lk{mut_, std::try_to_lock};
   if (!lk) {
     return false;
   }
-  const bool wasEmpty = queue_.empty();
-  queue_.push_back(task);
-  if (wasEmpty) {
-    cv_.notify_one();
-  }
+  push_locked(task, p);
   return true;
 }
 
-void context::thread_state::push(task_base* task) {
+void context::thread_state::push(task_base* task, priority p) {
+  std::lock_guard lk{mut_};
+  push_locked(task, p);
+}
+
+void context::thread_state::push_all(
+    task_queue tasks, std::size_t count, priority p) {
   std::lock_guard lk{mut_};
-  const bool wasEmpty = queue_.empty();
-  queue_.push_back(task);
-  if (wasEmpty) {
+  lanes_[static_cast<std::size_t>(p)].append(std::move(tasks));
+  queued_.fetch_add(count, std::memory_order_seq_cst);
+  wake_locked(false);
+}
+
+void context::thread_state::push_locked(task_base* task, priority p) noexcept {
+  lanes_[static_cast<std::size_t>(p)].push_back(task);
+  queued_.fetch_add(1, std::memory_order_seq_cst);
+  wake_locked(false);
+}
+
+void context::thread_state::wake_if_parked_with_work() {
+  std::lock_guard lk{mut_};
+  if (!empty()) {
+    wake_locked(true);
+  }
+}
+
+void context::thread_state::wake_locked(bool evenIfSearching) noexcept {
+  // A searching worker will find the work, or wake us when it gives up.
+  if (parked_ &&
+      (evenIfSearching || searching_.load(std::memory_order_seq_cst) == 0)) {
+    parked_ = false;
     cv_.notify_one();
   }
 }
 
+bool context::thread_state::empty() const noexcept {
+  for (auto& lane : lanes_) {
+    if (!lane.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+task_base* context::thread_state::pop_next() noexcept {
+  std::size_t selected = priority_count;
+  if (options_.lanePolicy == options::lane_policy::aging) {
+    // Strict priority order, unless a lower lane's oldest task is overdue.
+    std::chrono::steady_clock::time_point now{};
+    for (std::size_t lane = priority_count; lane-- > 0;) {
+      task_base* front = lanes_[lane].front();
+      if (front == nullptr) {
+        continue;
+      }
+      if (selected == priority_count) {
+        selected = lane;
+        continue;
+      }
+      if (now == std::chrono::steady_clock::time_point{}) {
+        now = std::chrono::steady_clock::now();
+      }
+      if (now - front->enqueueTime >= options_.agingThreshold) {
+        selected = lane;
+      }
+    }
+  } else {
+    // Smooth weighted round robin between the lanes that have work: each
+    // earns its weight in credit, and the richest pays for the pick.
+    std::int64_t totalWeight = 0;
+    for (std::size_t lane = priority_count; lane-- > 0;) {
+      if (lanes_[lane].empty()) {
+        continue;
+      }
+      credits_[lane] += options_.laneWeights[lane];
+      totalWeight += options_.laneWeights[lane];
+      if (selected == priority_count ||
+          credits_[lane] > credits_[selected]) {
+        selected = lane;
+      }
+    }
+    credits_[selected] -= totalWeight;
+  }
+  UNIFEX_ASSERT(selected < priority_count);
+  queued_.fetch_sub(1, std::memory_order_relaxed);
+  return lanes_[selected].pop_front();
+}
+
 void context::thread_state::request_stop() {
   std::lock_guard lk{mut_};
   stopRequested_ = true;
-  cv_.notify_one();
+  wake_locked(true);
 }
 
 }  // namespace _static_thread_pool
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/coroutine.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/async_generator.hpp>
+
+#  include <unifex/for_each.hpp>
+#  include <unifex/just.hpp>
+#  include <unifex/just_done.hpp>
+#  include <unifex/let_done.hpp>
+#  include <unifex/reduce_stream.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/static_thread_pool.hpp>
+#  include <unifex/stop_when.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/timed_single_thread_context.hpp>
+#  include <unifex/transform_stream.hpp>
+
+#  include <gtest/gtest.h>
+
+#  include <chrono>
+#  include <cstddef>
+#  include <memory>
+#  include <stdexcept>
+#  include <string>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+async_generator<int> iota(int count) {
+  for (int i = 0; i < count; ++i) {
+    co_yield i;
+  }
+}
+
+int sum(async_generator<int> gen) {
+  return sync_wait(reduce_stream(
+                       std::move(gen),
+                       0,
+                       [](int state, int val) { return state + val; }))
+      .value();
+}
+
+struct counting_resource {
+  std::size_t allocated = 0;
+  std::size_t deallocated = 0;
+};
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(counting_resource& r) noexcept : resource(&r) {}
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+    : resource(other.resource) {}
+
+  T* allocate(std::size_t n) {
+    resource->allocated += n * sizeof(T);
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* p, std::size_t n) noexcept {
+    resource->deallocated += n * sizeof(T);
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  counting_resource* resource;
+};
+}  // namespace
+
+TEST(async_generator, YieldsValues) {
+  EXPECT_EQ(4950, sum(iota(100)));
+}
+
+TEST(async_generator, ManyElements) {
+  EXPECT_EQ(499500, sum(iota(1000)));
+}
+
+TEST(async_generator, AwaitsInBody) {
+  static_thread_pool pool{2};
+  auto gen = [&]() -> async_generator<int> {
+    for (int i = 0; i < 10; ++i) {
+      co_await schedule(pool.get_scheduler());
+      int doubled = co_await just(i * 2);
+      co_yield std::move(doubled);
+    }
+  };
+
+  EXPECT_EQ(90, sum(gen()));
+}
+
+TEST(async_generator, PlugsIntoAdapters) {
+  std::string out;
+  sync_wait(for_each(
+      transform_stream(iota(3), [](int val) { return val + 1; }),
+      [&](int val) { out += std::to_string(val); }));
+  EXPECT_EQ("123", out);
+}
+
+TEST(async_generator, CopiesConstLvalues) {
+  auto gen = []() -> async_generator<std::string> {
+    const std::string value = "abc";
+    co_yield value;
+    co_yield value;
+  };
+  auto g = gen();
+  EXPECT_EQ("abc", sync_wait(next(g)));
+  EXPECT_EQ("abc", sync_wait(next(g)));
+  EXPECT_FALSE(sync_wait(next(g)));
+  sync_wait(cleanup(g));
+}
+
+TEST(async_generator, DoneEndsStream) {
+  auto gen = []() -> async_generator<int> {
+    co_yield 1;
+    co_await just_done();
+    co_yield 2;
+  };
+  EXPECT_EQ(1, sum(gen()));
+}
+
+TEST(async_generator, CleanupDestroysFrame) {
+  auto alive = std::make_shared<int>(0);
+  std::weak_ptr<int> weak = alive;
+  auto gen = [](std::shared_ptr<int> p) -> async_generator<int> {
+    while (true) {
+      co_yield (*p)++;
+    }
+  };
+
+  auto g = gen(std::move(alive));
+  EXPECT_EQ(0, sync_wait(next(g)));
+  EXPECT_EQ(1, sync_wait(next(g)));
+  EXPECT_FALSE(weak.expired());
+  sync_wait(cleanup(g));
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(async_generator, StopRequestReachesAwait) {
+  timed_single_thread_context ctx;
+  auto gen = [&]() -> async_generator<int> {
+    co_yield 1;
+    co_await schedule_after(ctx.get_scheduler(), 1h);
+    co_yield 2;
+  };
+
+  auto g = gen();
+  EXPECT_EQ(1, sync_wait(next(g)));
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(sync_wait(stop_when(next(g), just())));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+  sync_wait(cleanup(g));
+}
+
+// GCC flags the frame's deallocation when the promise's operator new is a
+// template, see GCC bug 109224.
+#  if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#  endif
+TEST(async_generator, UsesAllocator) {
+  counting_resource resource;
+  {
+    auto gen = [](std::allocator_arg_t,
+                  counting_allocator<std::byte>,
+                  int count) -> async_generator<int> {
+      for (int i = 0; i < count; ++i) {
+        co_yield i;
+      }
+    };
+    EXPECT_EQ(45, sum(gen(
+                      std::allocator_arg,
+                      counting_allocator<std::byte>{resource},
+                      10)));
+  }
+  EXPECT_GT(resource.allocated, 0u);
+  EXPECT_EQ(resource.allocated, resource.deallocated);
+}
+#  if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC diagnostic pop
+#  endif
+
+#  if !UNIFEX_NO_EXCEPTIONS
+TEST(async_generator, PropagatesExceptions) {
+  auto gen = []() -> async_generator<int> {
+    co_yield 1;
+    throw std::runtime_error{"boom"};
+  };
+
+  auto g = gen();
+  EXPECT_EQ(1, sync_wait(next(g)));
+  EXPECT_THROW(sync_wait(next(g)), std::runtime_error);
+  EXPECT_FALSE(sync_wait(next(g)));
+  sync_wait(cleanup(g));
+}
+#  endif
+
+#endif  // !UNIFEX_NO_COROUTINES
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/batch_stream.hpp>
+
+#include <unifex/just.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/transform_stream.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+using ctx_scheduler =
+    decltype(UNIFEX_DECLVAL(timed_single_thread_context&).get_scheduler());
+
+// Produces 0, 1, 2, ... one element every interval.
+struct ticking_stream {
+  auto next() {
+    return schedule_after(scheduler_, interval_) |
+        then([this] { return i_++; });
+  }
+
+  auto cleanup() { return just(); }
+
+  ctx_scheduler scheduler_;
+  std::chrono::milliseconds interval_;
+  int i_ = 0;
+};
+}  // namespace
+
+TEST(batch_stream, FlushesFullBatches) {
+  timed_single_thread_context ctx;
+  auto res = range_stream{0, 10} |
+      batch_stream(4, 1h, ctx.get_scheduler()) |
+      reduce_stream(
+          std::vector<std::vector<int>>{},
+          [](auto batches, std::vector<int> batch) {
+            EXPECT_GE(batch.capacity(), 4u);
+            batches.push_back(std::move(batch));
+            return batches;
+          }) |
+      sync_wait();
+
+  ASSERT_TRUE(res);
+  std::vector<std::vector<int>> expected{{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9}};
+  EXPECT_EQ(expected, *res);
+}
+
+TEST(batch_stream, FlushesAfterMaxDelay) {
+  timed_single_thread_context ctx;
+  auto stream = batch_stream(
+      ticking_stream{ctx.get_scheduler(), 1ms},
+      1000,
+      20ms,
+      ctx.get_scheduler());
+
+  int expected = 0;
+  for (int i = 0; i < 3; ++i) {
+    auto batch = sync_wait(next(stream));
+    ASSERT_TRUE(batch);
+    ASSERT_FALSE(batch->empty());
+    EXPECT_LT(batch->size(), 1000u);
+    for (int val : *batch) {
+      EXPECT_EQ(expected++, val);
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  sync_wait(cleanup(stream));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+}
+
+TEST(batch_stream, CleanupCancelsTimer) {
+  timed_single_thread_context ctx;
+  auto stream = batch_stream(
+      ticking_stream{ctx.get_scheduler(), 1ms}, 2, 1h, ctx.get_scheduler());
+
+  auto batch = sync_wait(next(stream));
+  ASSERT_TRUE(batch);
+  EXPECT_EQ((std::vector<int>{0, 1}), *batch);
+
+  // The element pulled after the first batch starts another timer.
+  auto start = std::chrono::steady_clock::now();
+  sync_wait(cleanup(stream));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+}
+
+#if !UNIFEX_NO_EXCEPTIONS
+TEST(batch_stream, EmitsBatchBeforeError) {
+  timed_single_thread_context ctx;
+  auto stream = range_stream{0, 10} | transform_stream([](int val) {
+                  if (val == 5) {
+                    throw std::runtime_error{"boom"};
+                  }
+                  return val;
+                }) |
+      batch_stream(4, 1h, ctx.get_scheduler());
+
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3}), sync_wait(next(stream)));
+  EXPECT_EQ((std::vector<int>{4}), sync_wait(next(stream)));
+  EXPECT_THROW(sync_wait(next(stream)), std::runtime_error);
+  sync_wait(cleanup(stream));
+}
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/buffer_stream.hpp>
+
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform_stream.hpp>
+#include <unifex/via_stream.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+using namespace unifex;
+
+TEST(buffer_stream, PassesThroughValues) {
+  auto res = range_stream{0, 100} | buffer_stream(8) |
+      reduce_stream(0, [](int state, int val) { return state + val; }) |
+      sync_wait();
+
+  ASSERT_TRUE(res);
+  EXPECT_EQ(4950, *res);
+}
+
+TEST(buffer_stream, ReadsAhead) {
+  int pulled = 0;
+  auto stream = buffer_stream(
+      transform_stream(
+          range_stream{0, 100},
+          [&](int val) {
+            ++pulled;
+            return val;
+          }),
+      4);
+
+  EXPECT_EQ(0, pulled);
+
+  auto first = sync_wait(next(stream));
+  ASSERT_TRUE(first);
+  EXPECT_EQ(0, *first);
+  EXPECT_EQ(5, pulled);
+
+  auto second = sync_wait(next(stream));
+  ASSERT_TRUE(second);
+  EXPECT_EQ(1, *second);
+  EXPECT_EQ(6, pulled);
+
+  sync_wait(cleanup(stream));
+  EXPECT_EQ(6, pulled);
+}
+
+TEST(buffer_stream, OverlapsWithProducer) {
+  static_thread_pool pool{1};
+  std::atomic<int> produced{0};
+  auto res = via_stream(
+                 pool.get_scheduler(),
+                 transform_stream(
+                     range_stream{0, 1000},
+                     [&](int val) {
+                       ++produced;
+                       return val;
+                     })) |
+      buffer_stream(16) |
+      reduce_stream(0, [&](int state, int val) {
+        EXPECT_LE(produced.load(), val + 17);
+        return state + val;
+      }) |
+      sync_wait();
+
+  ASSERT_TRUE(res);
+  EXPECT_EQ(499500, *res);
+}
+
+#if !UNIFEX_NO_EXCEPTIONS
+TEST(buffer_stream, DeliversBufferedValuesBeforeError) {
+  auto stream = range_stream{0, 10} | transform_stream([](int val) {
+                  if (val == 3) {
+                    throw std::runtime_error{"boom"};
+                  }
+                  return val;
+                }) |
+      buffer_stream(8);
+
+  for (int i = 0; i < 3; ++i) {
+    auto res = sync_wait(next(stream));
+    ASSERT_TRUE(res);
+    EXPECT_EQ(i, *res);
+  }
+  EXPECT_THROW(sync_wait(next(stream)), std::runtime_error);
+  EXPECT_FALSE(sync_wait(next(stream)));
+  sync_wait(cleanup(stream));
+}
+#endif
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/bulk_reduce.hpp>
+
+#include <unifex/bulk_join.hpp>
+#include <unifex/bulk_schedule.hpp>
+#include <unifex/bulk_transform.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+TEST(bulk_reduce, SerialSum) {
+  single_thread_context ctx;
+  auto result = bulk_schedule(ctx.get_scheduler(), std::size_t(1000)) |
+      bulk_reduce(std::size_t(5), std::plus<>{}) | sync_wait();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(5u + 999u * 1000u / 2, *result);
+}
+
+TEST(bulk_reduce, EmptyRangeGivesInit) {
+  single_thread_context ctx;
+  auto result = bulk_schedule(ctx.get_scheduler(), 0) |
+      bulk_reduce(42, std::plus<>{}) | sync_wait();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(42, *result);
+}
+
+TEST(bulk_reduce, ParallelTransformReduceOnThreadPool) {
+  static_thread_pool pool{4};
+  std::vector<std::int64_t> data(100000);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<std::int64_t>(i % 1000);
+  }
+
+  auto result = bulk_schedule(pool.get_scheduler(), data.size()) |
+      bulk_transform_reduce(
+                    std::int64_t(7),
+                    std::plus<>{},
+                    [&](std::size_t i) noexcept { return data[i]; }) |
+      sync_wait();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(7 + 100 * (999 * 1000 / 2), *result);
+}
+
+TEST(bulk_reduce, ForwardsExceptions) {
+  static_thread_pool pool{2};
+  EXPECT_THROW(
+      bulk_schedule(pool.get_scheduler(), 1000) |
+          bulk_transform_reduce(
+              0,
+              std::plus<>{},
+              [](int i) {
+                if (i == 500) {
+                  throw std::runtime_error("500");
+                }
+                return i;
+              }) |
+          sync_wait(),
+      std::runtime_error);
+}
@@ -19,10 +19,39 @@
 #include <unifex/bulk_transform.hpp>
 #include <unifex/let_value_with_stop_source.hpp>
 #include <unifex/single_thread_context.hpp>
+#include <unifex/span.hpp>
 #include <unifex/sync_wait.hpp>
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
+namespace {
+// Wraps another scheduler, with a different bulk chunk size.
+template <typename Scheduler>
+struct chunk_size_scheduler {
+  Scheduler inner;
+  std::size_t chunkSize;
+
+  auto schedule() const { return unifex::schedule(inner); }
+
+  friend bool
+  operator==(const chunk_size_scheduler& a, const chunk_size_scheduler& b) {
+    return a.inner == b.inner && a.chunkSize == b.chunkSize;
+  }
+  friend bool
+  operator!=(const chunk_size_scheduler& a, const chunk_size_scheduler& b) {
+    return !(a == b);
+  }
+
+  friend std::size_t tag_invoke(
+      unifex::tag_t<unifex::get_bulk_chunk_size>,
+      const chunk_size_scheduler& s) noexcept {
+    return s.chunkSize;
+  }
+};
+}  // namespace
+
 TEST(bulk, bulk_transform) {
   unifex::single_thread_context ctx;
   auto sched = ctx.get_scheduler();
@@ -114,3 +143,119 @@ TEST(bulk, Pipeable) {
     EXPECT_EQ(i, output[i]);
   }
 }
+
+TEST(bulk, ChunkedTransformGetsIndexRanges) {
+  unifex::single_thread_context ctx;
+  const std::size_t count = 1000;
+
+  std::vector<int> output(count);
+  std::vector<std::size_t> chunkSizes;
+  unifex::bulk_schedule_chunked(ctx.get_scheduler(), count) |
+      unifex::bulk_transform(
+          [&](unifex::index_range<std::size_t> range) noexcept {
+            chunkSizes.push_back(range.size());
+            for (std::size_t i : range) {
+              output[i] = static_cast<int>(i);
+            }
+          },
+          unifex::seq) |
+      unifex::bulk_join() | unifex::sync_wait();
+
+  for (std::size_t i = 0; i < count; ++i) {
+    EXPECT_EQ(i, output[i]);
+  }
+  const std::size_t chunkSize = unifex::bulk_cancellation_chunk_size;
+  ASSERT_EQ((count + chunkSize - 1) / chunkSize, chunkSizes.size());
+  EXPECT_EQ(chunkSize, chunkSizes.front());
+  EXPECT_EQ(count % chunkSize, chunkSizes.back());
+}
+
+TEST(bulk, ChunkedSenderAdaptsPerIndexFunctions) {
+  unifex::single_thread_context ctx;
+  const std::size_t count = 1000;
+
+  std::vector<int> output(count);
+  unifex::bulk_schedule_chunked(ctx.get_scheduler(), count) |
+      unifex::bulk_transform(
+          [](std::size_t index) noexcept { return count - 1 - index; },
+          unifex::par_unseq) |
+      unifex::bulk_transform(
+          [&](std::size_t index) noexcept {
+            output[index] = static_cast<int>(index);
+          },
+          unifex::par_unseq) |
+      unifex::bulk_join() | unifex::sync_wait();
+
+  for (std::size_t i = 0; i < count; ++i) {
+    EXPECT_EQ(i, output[i]);
+  }
+}
+
+TEST(bulk, ChunkedSenderCallsSetNextPerIndexForVoidFunctions) {
+  unifex::single_thread_context ctx;
+  const std::size_t count = 1000;
+
+  std::size_t calls = 0;
+  std::size_t nexts = 0;
+  unifex::bulk_schedule_chunked(ctx.get_scheduler(), count) |
+      unifex::bulk_transform(
+          [&](std::size_t) noexcept { ++calls; }, unifex::seq) |
+      unifex::bulk_transform([&]() noexcept { ++nexts; }, unifex::seq) |
+      unifex::bulk_join() | unifex::sync_wait();
+
+  EXPECT_EQ(count, calls);
+  EXPECT_EQ(count, nexts);
+}
+
+TEST(bulk, ChunkedTransformCanReturnASpanPerChunk) {
+  unifex::single_thread_context ctx;
+  const std::size_t count = 1000;
+
+  std::vector<int> squares(count);
+  std::vector<int> output(count);
+  std::size_t chunks = 0;
+  unifex::bulk_schedule_chunked(ctx.get_scheduler(), count) |
+      unifex::bulk_transform(
+          [&](unifex::index_range<std::size_t> range) noexcept {
+            for (std::size_t i : range) {
+              squares[i] = static_cast<int>(i * i);
+            }
+            return unifex::span<const int>{
+                squares.data() + range.first, range.size()};
+          },
+          unifex::seq) |
+      unifex::bulk_transform(
+          [&](unifex::span<const int> results) noexcept {
+            ++chunks;
+            const auto first =
+                static_cast<std::size_t>(results.data() - squares.data());
+            for (std::size_t i = 0; i < results.size(); ++i) {
+              output[first + i] = results[i];
+            }
+          },
+          unifex::seq) |
+      unifex::bulk_join() | unifex::sync_wait();
+
+  for (std::size_t i = 0; i < count; ++i) {
+    EXPECT_EQ(static_cast<int>(i * i), output[i]);
+  }
+  const std::size_t chunkSize = unifex::bulk_cancellation_chunk_size;
+  EXPECT_EQ((count + chunkSize - 1) / chunkSize, chunks);
+}
+
+TEST(bulk, ChunkSizeIsPerScheduler) {
+  unifex::single_thread_context ctx;
+  chunk_size_scheduler<decltype(ctx.get_scheduler())> sched{
+      ctx.get_scheduler(), 100};
+
+  std::vector<std::size_t> chunkSizes;
+  unifex::bulk_schedule_chunked(sched, 1000) |
+      unifex::bulk_transform(
+          [&](unifex::index_range<int> range) noexcept {
+            chunkSizes.push_back(static_cast<std::size_t>(range.size()));
+          },
+          unifex::seq) |
+      unifex::bulk_join() | unifex::sync_wait();
+
+  EXPECT_EQ(std::vector<std::size_t>(10, 100), chunkSizes);
+}
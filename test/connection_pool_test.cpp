@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/connection_pool.hpp>
+
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/just_done.hpp>
+#include <unifex/just_from.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/socket_concepts.hpp>
+#include <unifex/stop_when.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/with_query_value.hpp>
+
+#if !UNIFEX_NO_EPOLL
+#  include <unifex/linux/io_epoll_context.hpp>
+#endif
+#if !UNIFEX_NO_LIBURING
+#  include <unifex/linux/io_uring_context.hpp>
+#endif
+#if !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
+#  include <unifex/linux/socket_address.hpp>
+#  include <unifex/scope_guard.hpp>
+
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct fake_connection {
+  int id;
+};
+
+// Wraps a timed_single_thread_context scheduler and "connects" by
+// handing out connections with increasing ids.
+struct fake_scheduler {
+  timed_single_thread_context* context_;
+  std::atomic<int>* connectCount_;
+
+  auto schedule() const noexcept {
+    return unifex::schedule(context_->get_scheduler());
+  }
+
+  auto now() const noexcept { return std::chrono::steady_clock::now(); }
+
+  auto schedule_at(std::chrono::steady_clock::time_point tp) const noexcept {
+    return unifex::schedule_at(context_->get_scheduler(), tp);
+  }
+
+  friend auto
+  tag_invoke(tag_t<async_connect>, const fake_scheduler& s, const int&) {
+    return just_from([count = s.connectCount_]() {
+      return fake_connection{++*count};
+    });
+  }
+
+  friend bool operator==(fake_scheduler a, fake_scheduler b) noexcept {
+    return a.context_ == b.context_;
+  }
+  friend bool operator!=(fake_scheduler a, fake_scheduler b) noexcept {
+    return a.context_ != b.context_;
+  }
+};
+
+using fake_pool = connection_pool<fake_scheduler, int>;
+
+// A scheduler whose schedule() always completes with done, as a scheduler
+// that is shutting down might.
+struct done_scheduler : fake_scheduler {
+  auto schedule() const noexcept { return just_done(); }
+};
+
+using done_pool = connection_pool<done_scheduler, int>;
+
+// Records that an acquire() completed with done, with a stop token from a
+// stop source that outlives the operation.
+struct done_receiver {
+  bool* done_;
+  inplace_stop_token stopToken_;
+
+  void set_value(done_pool::lease&&) noexcept { std::terminate(); }
+  void set_error(std::exception_ptr) noexcept { std::terminate(); }
+  void set_done() noexcept { *done_ = true; }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const done_receiver& r) noexcept {
+    return r.stopToken_;
+  }
+};
+
+// Starts an acquire() and records its outcome.
+struct pending_acquire {
+  struct receiver {
+    pending_acquire& state_;
+
+    void set_value(fake_pool::lease&& l) noexcept {
+      state_.lease_.emplace(std::move(l));
+      state_.completed_ = true;
+    }
+    void set_error(std::exception_ptr) noexcept { std::terminate(); }
+    void set_done() noexcept {
+      state_.done_ = true;
+      state_.completed_ = true;
+    }
+
+    friend inplace_stop_token
+    tag_invoke(tag_t<get_stop_token>, const receiver& r) noexcept {
+      return r.state_.stopSource_.get_token();
+    }
+  };
+
+  explicit pending_acquire(fake_pool& pool)
+    : op_(unifex::connect(pool.acquire(), receiver{*this})) {
+    start(op_);
+  }
+
+  void wait() {
+    while (!completed_.load()) {
+      std::this_thread::yield();
+    }
+  }
+
+  inplace_stop_source stopSource_;
+  std::optional<fake_pool::lease> lease_;
+  std::atomic<bool> completed_{false};
+  bool done_{false};
+  connect_result_t<fake_pool::acquire_sender, receiver> op_;
+};
+
+struct ConnectionPoolTest : testing::Test {
+  timed_single_thread_context context_;
+  std::atomic<int> connectCount_{0};
+  fake_scheduler scheduler_{&context_, &connectCount_};
+};
+
+}  // namespace
+
+TEST_F(ConnectionPoolTest, ReusesReleasedConnection) {
+  fake_pool pool{scheduler_, 0};
+  {
+    auto l = sync_wait(pool.acquire());
+    ASSERT_TRUE(l.has_value());
+    EXPECT_EQ(1, (*l)->id);
+    EXPECT_EQ(0u, pool.idle_count());
+  }
+  EXPECT_EQ(1u, pool.idle_count());
+
+  auto l = sync_wait(pool.acquire());
+  ASSERT_TRUE(l.has_value());
+  EXPECT_EQ(1, (*l)->id);
+  EXPECT_EQ(1, connectCount_.load());
+  EXPECT_EQ(1u, pool.open_count());
+}
+
+TEST_F(ConnectionPoolTest, WaitsForReleaseAtCapacity) {
+  fake_pool pool{scheduler_, 0, {1}};
+  auto first = sync_wait(pool.acquire());
+  ASSERT_TRUE(first.has_value());
+
+  pending_acquire second{pool};
+  EXPECT_FALSE(second.completed_.load());
+
+  first.reset();
+  second.wait();
+  ASSERT_TRUE(second.lease_.has_value());
+  EXPECT_EQ(1, (*second.lease_)->id);
+  EXPECT_EQ(1, connectCount_.load());
+}
+
+TEST_F(ConnectionPoolTest, DiscardOpensNewConnectionForWaiter) {
+  fake_pool pool{scheduler_, 0, {1}};
+  auto first = sync_wait(pool.acquire());
+  ASSERT_TRUE(first.has_value());
+
+  pending_acquire second{pool};
+  first->discard();
+  second.wait();
+  ASSERT_TRUE(second.lease_.has_value());
+  EXPECT_EQ(2, (*second.lease_)->id);
+  EXPECT_EQ(1u, pool.open_count());
+}
+
+TEST_F(ConnectionPoolTest, CancelledWaiterDoesNotLeakConnections) {
+  fake_pool pool{scheduler_, 0, {1}};
+  auto first = sync_wait(pool.acquire());
+  ASSERT_TRUE(first.has_value());
+
+  pending_acquire second{pool};
+  second.stopSource_.request_stop();
+  second.wait();
+  EXPECT_TRUE(second.done_);
+  EXPECT_FALSE(second.lease_.has_value());
+
+  first.reset();
+  EXPECT_EQ(1u, pool.idle_count());
+  EXPECT_EQ(1u, pool.open_count());
+}
+
+TEST_F(ConnectionPoolTest, SchedulerDoneCompletesWaiterWithDone) {
+  done_pool pool{done_scheduler{scheduler_}, 0, {1}};
+  auto first = sync_wait(pool.acquire());
+  ASSERT_TRUE(first.has_value());
+
+  inplace_stop_source stopSource;
+  bool done = false;
+  {
+    auto op = unifex::connect(
+        pool.acquire(), done_receiver{&done, stopSource.get_token()});
+    unifex::start(op);
+    EXPECT_FALSE(done);
+
+    // Resuming the waiter schedules onto the pool's scheduler, which
+    // completes with done.
+    first.reset();
+    EXPECT_TRUE(done);
+  }
+  // The waiter's stop callback must have been deregistered along with its
+  // operation.
+  stopSource.request_stop();
+
+  EXPECT_EQ(1u, pool.idle_count());
+  EXPECT_EQ(1u, pool.open_count());
+}
+
+TEST_F(ConnectionPoolTest, ReapsExpiredIdleConnections) {
+  connection_pool_options options;
+  options.idleTimeout = 0ms;
+  options.reapInterval = 1ms;
+  fake_pool pool{scheduler_, 0, options};
+  {
+    auto a = sync_wait(pool.acquire());
+    auto b = sync_wait(pool.acquire());
+  }
+  EXPECT_EQ(2u, pool.idle_count());
+
+  inplace_stop_source stopSource;
+  std::thread stopper{[&] {
+    while (pool.idle_count() != 0) {
+      std::this_thread::yield();
+    }
+    stopSource.request_stop();
+  }};
+  sync_wait(with_query_value(
+      pool.reap_idle(), get_stop_token, stopSource.get_token()));
+  stopper.join();
+
+  EXPECT_EQ(0u, pool.open_count());
+}
+
+#if !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
+namespace {
+// A loopback listener whose backlog completes connection handshakes.
+struct loopback_listener {
+  explicit loopback_listener(int backlog = 128) {
+    fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t size = sizeof(addr);
+    EXPECT_EQ(0, ::bind(fd_, (const sockaddr*)&addr, size));
+    EXPECT_EQ(0, ::listen(fd_, backlog));
+    EXPECT_EQ(0, ::getsockname(fd_, (sockaddr*)&addr, &size));
+    port_ = ntohs(addr.sin_port);
+  }
+
+  ~loopback_listener() { ::close(fd_); }
+
+  linuxos::socket_address address() const {
+    return linuxos::socket_address::ipv4_loopback(port_);
+  }
+
+  // Connects a socket that is never accepted, which fills the accept
+  // queue of a listener with no backlog. Further connections then wait
+  // for room in the queue, retrying until the TCP connect timeout.
+  int fill() const {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port_);
+    EXPECT_EQ(0, ::connect(fd, (const sockaddr*)&addr, sizeof(addr)));
+    return fd;
+  }
+
+  int fd_;
+  port_t port_;
+};
+
+template <typename Context, typename Func>
+void with_running(Context& ctx, Func func) {
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+  };
+  func(ctx.get_scheduler());
+}
+}  // namespace
+#endif
+
+#if !UNIFEX_NO_LIBURING
+TEST(AsyncConnect, IoUringLoopback) {
+  loopback_listener listener;
+  linuxos::io_uring_context ctx;
+  with_running(ctx, [&](auto scheduler) {
+    auto socket = sync_wait(async_connect(scheduler, listener.address()));
+    EXPECT_TRUE(socket.has_value());
+
+    connection_pool pool{scheduler, listener.address(), {2}};
+    auto l = sync_wait(pool.acquire());
+    EXPECT_TRUE(l.has_value());
+    EXPECT_EQ(1u, pool.open_count());
+  });
+}
+
+TEST(AsyncConnect, IoUringConnectionRefused) {
+  port_t port;
+  {
+    // Find a port that nothing listens on.
+    loopback_listener listener;
+    port = listener.port_;
+  }
+  linuxos::io_uring_context ctx;
+  with_running(ctx, [&](auto scheduler) {
+    EXPECT_THROW(
+        sync_wait(async_connect(
+            scheduler, linuxos::socket_address::ipv4_loopback(port))),
+        std::system_error);
+  });
+}
+
+TEST(AsyncConnect, IoUringStopRequestedBeforeStart) {
+  loopback_listener listener{0};
+  const int filler = listener.fill();
+  scope_guard closeFiller = [&]() noexcept { ::close(filler); };
+  linuxos::io_uring_context ctx;
+  with_running(ctx, [&](auto scheduler) {
+    inplace_stop_source stopSource;
+    stopSource.request_stop();
+    const auto start = std::chrono::steady_clock::now();
+    auto socket = sync_wait(with_query_value(
+        async_connect(scheduler, listener.address()),
+        get_stop_token,
+        stopSource.get_token()));
+    EXPECT_FALSE(socket.has_value());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+  });
+}
+
+TEST(AsyncConnect, IoUringStopRequestCancelsPendingConnect) {
+  loopback_listener listener{0};
+  const int filler = listener.fill();
+  scope_guard closeFiller = [&]() noexcept { ::close(filler); };
+  timed_single_thread_context timer;
+  linuxos::io_uring_context ctx;
+  with_running(ctx, [&](auto scheduler) {
+    const auto start = std::chrono::steady_clock::now();
+    auto socket = sync_wait(stop_when(
+        async_connect(scheduler, listener.address()),
+        schedule_after(timer.get_scheduler(), 50ms)));
+    EXPECT_FALSE(socket.has_value());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+  });
+}
+#endif
+
+#if !UNIFEX_NO_EPOLL
+TEST(AsyncConnect, EpollLoopback) {
+  loopback_listener listener;
+  linuxos::io_epoll_context ctx;
+  with_running(ctx, [&](auto scheduler) {
+    auto socket = sync_wait(async_connect(scheduler, listener.address()));
+    EXPECT_TRUE(socket.has_value());
+  });
+}
+#endif
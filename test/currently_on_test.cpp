@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/scheduler_concepts.hpp>
+
+#include <unifex/inline_scheduler.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/just.hpp>
+#include <unifex/manual_event_loop.hpp>
+#include <unifex/on.hpp>
+#include <unifex/repeat_effect_until.hpp>
+#include <unifex/schedule_if_needed.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/via.hpp>
+#include <unifex/with_query_value.hpp>
+
+#if !UNIFEX_NO_EPOLL
+#  include <unifex/linux/io_epoll_context.hpp>
+#endif
+#if !UNIFEX_NO_LIBURING
+#  include <unifex/linux/io_uring_context.hpp>
+#endif
+#if !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
+#  include <unifex/scope_guard.hpp>
+#endif
+
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+
+// Forwards to another scheduler, counting calls to schedule().
+template <typename Scheduler>
+struct counting_scheduler {
+  Scheduler inner_;
+  std::atomic<int>* count_;
+
+  auto schedule() const noexcept {
+    ++*count_;
+    return unifex::schedule(inner_);
+  }
+
+  friend bool
+  tag_invoke(tag_t<currently_on>, const counting_scheduler& s) noexcept {
+    return currently_on(s.inner_);
+  }
+
+  friend bool
+  operator==(const counting_scheduler& a, const counting_scheduler& b) {
+    return a.inner_ == b.inner_;
+  }
+  friend bool
+  operator!=(const counting_scheduler& a, const counting_scheduler& b) {
+    return a.inner_ != b.inner_;
+  }
+};
+
+template <typename Scheduler>
+std::optional<bool> check_on(Scheduler s) {
+  return sync_wait(
+      then(schedule(s), [s]() noexcept { return currently_on(s); }));
+}
+
+}  // namespace
+
+TEST(CurrentlyOn, DefaultsToFalse) {
+  EXPECT_FALSE(currently_on(inline_scheduler{}));
+}
+
+TEST(CurrentlyOn, SingleThreadContext) {
+  single_thread_context ctx;
+  auto s = ctx.get_scheduler();
+  EXPECT_FALSE(currently_on(s));
+  EXPECT_EQ(std::optional<bool>(true), check_on(s));
+
+  single_thread_context other;
+  auto onOther = sync_wait(then(
+      schedule(other.get_scheduler()),
+      [s]() noexcept { return currently_on(s); }));
+  EXPECT_EQ(std::optional<bool>(false), onOther);
+}
+
+TEST(CurrentlyOn, ManualEventLoop) {
+  manual_event_loop loop;
+  std::thread t{[&] {
+    loop.run();
+  }};
+  EXPECT_FALSE(currently_on(loop.get_scheduler()));
+  EXPECT_EQ(std::optional<bool>(true), check_on(loop.get_scheduler()));
+  loop.stop();
+  t.join();
+}
+
+TEST(CurrentlyOn, StaticThreadPool) {
+  static_thread_pool pool{2};
+  EXPECT_FALSE(currently_on(pool.get_scheduler()));
+  EXPECT_EQ(std::optional<bool>(true), check_on(pool.get_scheduler()));
+
+  static_thread_pool other{1};
+  auto onOther = sync_wait(then(
+      schedule(other.get_scheduler()),
+      [s = pool.get_scheduler()]() noexcept { return currently_on(s); }));
+  EXPECT_EQ(std::optional<bool>(false), onOther);
+}
+
+TEST(CurrentlyOn, TimedSingleThreadContext) {
+  timed_single_thread_context ctx;
+  EXPECT_FALSE(currently_on(ctx.get_scheduler()));
+  EXPECT_EQ(std::optional<bool>(true), check_on(ctx.get_scheduler()));
+}
+
+#if !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
+namespace {
+template <typename Context>
+void check_io_context() {
+  Context ctx;
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+  };
+  EXPECT_FALSE(currently_on(ctx.get_scheduler()));
+  EXPECT_EQ(std::optional<bool>(true), check_on(ctx.get_scheduler()));
+}
+}  // namespace
+#endif
+
+#if !UNIFEX_NO_LIBURING
+TEST(CurrentlyOn, IoUringContext) {
+  check_io_context<linuxos::io_uring_context>();
+}
+#endif
+
+#if !UNIFEX_NO_EPOLL
+TEST(CurrentlyOn, IoEpollContext) {
+  check_io_context<linuxos::io_epoll_context>();
+}
+#endif
+
+TEST(ScheduleIfNeeded, SkipsRescheduleWhenAlreadyOnScheduler) {
+  single_thread_context ctx;
+  std::atomic<int> count{0};
+  counting_scheduler<decltype(ctx.get_scheduler())> s{
+      ctx.get_scheduler(), &count};
+
+  // The first hop has to reschedule; the via() back onto the same context
+  // completes inline.
+  auto result = sync_wait(then(
+      via(on(s, just(42)), s),
+      [&](int x) noexcept {
+        EXPECT_EQ(ctx.get_thread_id(), std::this_thread::get_id());
+        return x;
+      }));
+  EXPECT_EQ(std::optional<int>(42), result);
+  EXPECT_EQ(1, count.load());
+
+  // From a different thread it reschedules.
+  EXPECT_TRUE(sync_wait(schedule_if_needed(s)).has_value());
+  EXPECT_EQ(2, count.load());
+}
+
+TEST(ScheduleIfNeeded, BoundsInlineRecursion) {
+  single_thread_context ctx;
+  auto s = ctx.get_scheduler();
+  int iterations = 0;
+
+  // Each iteration would complete inline; without a depth bound this
+  // recurses once per iteration.
+  sync_wait(on(
+      s,
+      repeat_effect_until(
+          schedule_if_needed(s) | then([&]() noexcept { ++iterations; }),
+          [&]() noexcept { return iterations == 100000; })));
+  EXPECT_EQ(100000, iterations);
+}
+
+TEST(ScheduleIfNeeded, CompletesWithDoneInlineWhenStopRequested) {
+  single_thread_context ctx;
+  auto s = ctx.get_scheduler();
+  inplace_stop_source stopSource;
+  stopSource.request_stop();
+
+  // Already on the context, so via() and on() complete inline, but with
+  // done as schedule() would.
+  auto viaResult = sync_wait(on(
+      s,
+      with_query_value(
+          via(just(42), s), get_stop_token, stopSource.get_token())));
+  EXPECT_FALSE(viaResult.has_value());
+
+  bool started = false;
+  auto onResult = sync_wait(on(
+      s,
+      with_query_value(
+          on(s, then(just(), [&]() noexcept { started = true; })),
+          get_stop_token,
+          stopSource.get_token())));
+  EXPECT_FALSE(onResult.has_value());
+  EXPECT_FALSE(started);
+}
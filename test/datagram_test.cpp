@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/socket_concepts.hpp>
+#  include <unifex/stop_when.hpp>
+#  include <unifex/stream_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+
+#  include <unifex/linux/datagram.hpp>
+#  if !UNIFEX_NO_EPOLL
+#    include <unifex/linux/io_epoll_context.hpp>
+#  endif
+#  if !UNIFEX_NO_LIBURING
+#    include <unifex/linux/io_uring_context.hpp>
+#  endif
+
+#  include <array>
+#  include <chrono>
+#  include <string>
+#  include <thread>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+
+namespace {
+
+template <typename Context>
+struct DatagramTest : testing::Test {
+  ~DatagramTest() {
+    stopSource_.request_stop();
+    thread_.join();
+  }
+
+  auto scheduler() { return context_.get_scheduler(); }
+
+  auto open_loopback() {
+    return open_datagram_socket(
+        scheduler(), socket_address::ipv4_loopback(0));
+  }
+
+  template <typename Socket>
+  static socket_address address_of(const Socket& socket) {
+    return socket_address::local_address_of(socket.native_handle());
+  }
+
+  Context context_;
+  inplace_stop_source stopSource_;
+  std::thread thread_{[this] {
+    context_.run(stopSource_.get_token());
+  }};
+};
+
+struct slots {
+  static constexpr std::size_t count = 8;
+
+  slots() {
+    for (std::size_t i = 0; i < count; ++i) {
+      datagrams[i].buffer = as_writable_bytes(span{storage[i]});
+    }
+  }
+
+  span<datagram> all() { return span{datagrams}; }
+
+  std::string payload(std::size_t i) const {
+    return std::string(storage[i].data(), datagrams[i].size);
+  }
+
+  std::array<std::array<char, 2048>, count> storage;
+  std::array<datagram, count> datagrams;
+};
+
+// Fills 'out' with 'count' datagrams addressed to 'to', the i'th of which
+// contains "message i".
+void prepare_messages(slots& out, std::size_t count, socket_address to) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto text = "message " + std::to_string(i);
+    text.copy(out.storage[i].data(), text.size());
+    out.datagrams[i].size = text.size();
+    out.datagrams[i].peer = to;
+  }
+}
+
+using contexts = testing::Types<
+#  if !UNIFEX_NO_LIBURING
+    io_uring_context
+#    if !UNIFEX_NO_EPOLL
+    ,
+#    endif
+#  endif
+#  if !UNIFEX_NO_EPOLL
+    io_epoll_context
+#  endif
+    >;
+}  // namespace
+
+TYPED_TEST_SUITE(DatagramTest, contexts, );
+
+TYPED_TEST(DatagramTest, SendsAndReceivesBatches) {
+  auto sender = this->open_loopback();
+  auto receiver = this->open_loopback();
+
+  slots out;
+  prepare_messages(out, 5, this->address_of(receiver));
+  auto sent = sync_wait(async_send_batch(sender, out.all().first(5)));
+  ASSERT_TRUE(sent.has_value());
+  EXPECT_EQ(5u, *sent);
+
+  slots in;
+  std::size_t received = 0;
+  while (received < 5) {
+    auto count = sync_wait(
+        async_recv_batch(receiver, in.all().after(received)));
+    ASSERT_TRUE(count.has_value());
+    received += *count;
+  }
+  for (std::size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ("message " + std::to_string(i), in.payload(i));
+    EXPECT_EQ(this->address_of(sender).port(), in.datagrams[i].peer.port());
+    EXPECT_EQ(0, in.datagrams[i].segment_size);
+  }
+}
+
+TYPED_TEST(DatagramTest, ReceiveWaitsForData) {
+  auto sender = this->open_loopback();
+  auto receiver = this->open_loopback();
+
+  std::thread late{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    slots out;
+    prepare_messages(out, 1, this->address_of(receiver));
+    sync_wait(async_send_batch(sender, out.all().first(1)));
+  }};
+  slots in;
+  auto count = sync_wait(async_recv_batch(receiver, in.all()));
+  late.join();
+  ASSERT_TRUE(count.has_value());
+  EXPECT_EQ(1u, *count);
+  EXPECT_EQ("message 0", in.payload(0));
+}
+
+TYPED_TEST(DatagramTest, ReceiveCancelsWhileWaiting) {
+  auto receiver = this->open_loopback();
+  auto scheduler = this->scheduler();
+
+  slots in;
+  auto count = sync_wait(stop_when(
+      async_recv_batch(receiver, in.all()),
+      schedule_at(scheduler, now(scheduler) + std::chrono::milliseconds(10))));
+  EXPECT_FALSE(count.has_value());
+}
+
+TYPED_TEST(DatagramTest, StreamYieldsFilledSlots) {
+  auto sender = this->open_loopback();
+  auto receiver = this->open_loopback();
+
+  slots out;
+  prepare_messages(out, 3, this->address_of(receiver));
+  sync_wait(async_send_batch(sender, out.all().first(3)));
+
+  slots in;
+  auto stream = datagram_stream(receiver, in.all());
+  std::size_t received = 0;
+  while (received < 3) {
+    auto batch = sync_wait(next(stream));
+    ASSERT_TRUE(batch.has_value());
+    for (const datagram& d : *batch) {
+      EXPECT_EQ(
+          "message " + std::to_string(received++),
+          std::string(reinterpret_cast<const char*>(d.buffer.data()), d.size));
+    }
+  }
+  sync_wait(cleanup(stream));
+}
+
+#  ifdef UDP_SEGMENT
+TYPED_TEST(DatagramTest, SegmentationOffloadSplitsPayload) {
+  auto sender = this->open_loopback();
+  auto receiver = this->open_loopback();
+
+  slots out;
+  std::string payload(300, 'x');
+  payload.copy(out.storage[0].data(), payload.size());
+  out.datagrams[0].size = payload.size();
+  out.datagrams[0].peer = this->address_of(receiver);
+  out.datagrams[0].segment_size = 100;
+  auto sent = sync_wait(async_send_batch(sender, out.all().first(1)));
+  ASSERT_TRUE(sent.has_value());
+  EXPECT_EQ(1u, *sent);
+
+  // Without UDP_GRO on the receiver the kernel delivers the segments as
+  // separate datagrams.
+  slots in;
+  std::size_t received = 0;
+  while (received < 3) {
+    auto count = sync_wait(
+        async_recv_batch(receiver, in.all().after(received)));
+    ASSERT_TRUE(count.has_value());
+    received += *count;
+  }
+  for (std::size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(100u, in.datagrams[i].size);
+  }
+}
+#  endif
+
+#endif  // !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
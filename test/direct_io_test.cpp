@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING
+
+#  include <unifex/file_concepts.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/io_concepts.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+
+#  include <unifex/linux/aligned_buffer_pool.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+
+#  include <algorithm>
+#  include <chrono>
+#  include <cstdint>
+#  include <optional>
+#  include <string>
+#  include <system_error>
+#  include <thread>
+#  include <vector>
+
+#  include <unistd.h>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t file_size = 64 * 1024;
+
+struct DirectIoTest : testing::Test {
+  DirectIoTest() {
+    char path[] = "/var/tmp/unifex_direct_io_test_XXXXXX";
+    safe_file_descriptor fd{::mkstemp(path)};
+    EXPECT_TRUE(fd.valid());
+    path_ = path;
+    contents_.resize(file_size);
+    for (std::size_t i = 0; i < file_size; ++i) {
+      contents_[i] = char('a' + i % 26);
+    }
+    EXPECT_EQ(
+        ssize_t(file_size), ::write(fd.get(), contents_.data(), file_size));
+  }
+
+  ~DirectIoTest() {
+    ::unlink(path_.c_str());
+    stop();
+  }
+
+  void run(const io_uring_context::options& options = {}) {
+    context_.emplace(options);
+    thread_.emplace([this] {
+      context_->run(stopSource_.get_token());
+    });
+  }
+
+  void stop() {
+    if (thread_) {
+      stopSource_.request_stop();
+      thread_->join();
+      thread_.reset();
+    }
+  }
+
+  // Opens the test file with direct_io, or returns nullopt if the
+  // filesystem doesn't support it.
+  std::optional<io_uring_context::async_read_only_file> open_direct() {
+    try {
+      return open_file_read_only(
+          context_->get_scheduler(), path_, direct_io);
+    } catch (const std::system_error& e) {
+      if (e.code().value() == EINVAL) {
+        return std::nullopt;
+      }
+      throw;
+    }
+  }
+
+  std::string path_;
+  std::string contents_;
+  std::optional<io_uring_context> context_;
+  inplace_stop_source stopSource_;
+  std::optional<std::thread> thread_;
+};
+
+}  // namespace
+
+TEST(AlignedBufferPool, BuffersAreAlignedAndRecycled) {
+  aligned_buffer_pool pool{1000, 3, 512};
+  EXPECT_EQ(1024u, pool.buffer_size());
+  EXPECT_EQ(3u, pool.available());
+
+  std::vector<aligned_buffer_pool::buffer> leases;
+  for (int i = 0; i < 3; ++i) {
+    auto b = pool.try_acquire();
+    ASSERT_TRUE(b);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(b.data().data()) % 512);
+    EXPECT_EQ(1024u, b.size());
+    leases.push_back(std::move(b));
+  }
+  EXPECT_FALSE(pool.try_acquire());
+  EXPECT_EQ(0u, pool.available());
+
+  auto* reused = leases.back().data().data();
+  leases.pop_back();
+  EXPECT_EQ(1u, pool.available());
+  EXPECT_EQ(reused, pool.try_acquire().data().data());
+}
+
+TEST(AlignedBufferPool, OverAlignedBuffers) {
+  aligned_buffer_pool pool{4096, 2, 64 * 1024};
+  auto a = pool.try_acquire();
+  auto b = pool.try_acquire();
+  EXPECT_EQ(
+      0u, reinterpret_cast<std::uintptr_t>(a.data().data()) % (64 * 1024));
+  EXPECT_EQ(
+      0u, reinterpret_cast<std::uintptr_t>(b.data().data()) % (64 * 1024));
+  EXPECT_NE(a.data().data(), b.data().data());
+}
+
+TEST_F(DirectIoTest, AlignedReadSucceeds) {
+  run();
+  auto file = open_direct();
+  if (!file) {
+    GTEST_SKIP() << "O_DIRECT not supported on /var/tmp";
+  }
+  const auto alignment = file->direct_io_alignment();
+  ASSERT_NE(0u, alignment);
+
+  aligned_buffer_pool pool{alignment, 1, alignment};
+  auto buffer = pool.try_acquire();
+  auto result = sync_wait(
+      async_read_some_at(*file, alignment, buffer.data()));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(ssize_t(alignment), *result);
+  EXPECT_TRUE(std::equal(
+      buffer.data().begin(),
+      buffer.data().end(),
+      reinterpret_cast<const std::byte*>(contents_.data()) + alignment));
+}
+
+TEST_F(DirectIoTest, MisalignedReadFailsUpFront) {
+  run();
+  auto file = open_direct();
+  if (!file) {
+    GTEST_SKIP() << "O_DIRECT not supported on /var/tmp";
+  }
+  const auto alignment = file->direct_io_alignment();
+  aligned_buffer_pool pool{2 * alignment, 1, alignment};
+  auto buffer = pool.try_acquire();
+
+  auto expectEinval = [](auto&& sender) {
+    try {
+      sync_wait(static_cast<decltype(sender)>(sender));
+      ADD_FAILURE() << "expected EINVAL";
+    } catch (const std::system_error& e) {
+      EXPECT_EQ(EINVAL, e.code().value());
+    }
+  };
+  // Misaligned offset, length and buffer address.
+  expectEinval(async_read_some_at(*file, 1, buffer.data().first(alignment)));
+  expectEinval(
+      async_read_some_at(*file, 0, buffer.data().first(alignment - 1)));
+  expectEinval(
+      async_read_some_at(*file, 0, buffer.data().after(1).first(alignment)));
+}
+
+TEST_F(DirectIoTest, BufferedFileIsNotValidated) {
+  run();
+  auto file = open_file_read_only(context_->get_scheduler(), path_);
+  EXPECT_EQ(0u, file.direct_io_alignment());
+
+  char buffer[3];
+  auto result = sync_wait(
+      async_read_some_at(file, 1, as_writable_bytes(span{buffer})));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(3, *result);
+  EXPECT_EQ("bcd", std::string(buffer, 3));
+}
+
+TEST_F(DirectIoTest, PolledContextRunsSchedulesAndTimers) {
+  try {
+    run(io_uring_context::options{64, true});
+  } catch (const std::system_error& e) {
+    GTEST_SKIP() << "IORING_SETUP_IOPOLL not available: " << e.what();
+  }
+  EXPECT_TRUE(context_->polled_io());
+
+  auto scheduler = context_->get_scheduler();
+  EXPECT_TRUE(sync_wait(schedule(scheduler)).has_value());
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(
+      sync_wait(schedule_at(scheduler, now(scheduler) + 10ms)).has_value());
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 10ms);
+
+  auto file = open_direct();
+  if (!file) {
+    return;
+  }
+  const auto alignment = file->direct_io_alignment();
+  aligned_buffer_pool pool{alignment, 1, alignment};
+  auto buffer = pool.try_acquire();
+  try {
+    auto result = sync_wait(async_read_some_at(*file, 0, buffer.data()));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(ssize_t(alignment), *result);
+    EXPECT_EQ(
+        contents_.substr(0, alignment),
+        std::string(
+            reinterpret_cast<const char*>(buffer.data().data()), alignment));
+  } catch (const std::system_error& e) {
+    // The device may not have polled queues configured.
+    EXPECT_EQ(EOPNOTSUPP, e.code().value());
+  }
+}
+
+#endif  // !UNIFEX_NO_LIBURING
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/elastic_thread_pool.hpp>
+
+#include <unifex/async_scope.hpp>
+#include <unifex/offload.hpp>
+#include <unifex/on.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+// Runs 'count' tasks on the pool that each stay busy until 'concurrency'
+// of them have been seen running at once, or 'patience' has passed.
+// Returns the highest number seen running at once.
+int run_blocking_tasks(
+    elastic_thread_pool& pool,
+    int count,
+    int concurrency,
+    std::chrono::milliseconds patience = std::chrono::seconds(1)) {
+  std::atomic<int> running{0};
+  std::atomic<int> highest{0};
+  async_scope scope;
+  for (int i = 0; i < count; ++i) {
+    scope.detached_spawn(then(schedule(pool.get_scheduler()), [&] {
+      int now = ++running;
+      int seen = highest.load();
+      while (now > seen && !highest.compare_exchange_weak(seen, now)) {
+      }
+      auto deadline = std::chrono::steady_clock::now() + patience;
+      while (highest.load() < concurrency &&
+             std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+      }
+      --running;
+    }));
+  }
+  sync_wait(scope.complete());
+  return highest.load();
+}
+}  // namespace
+
+TEST(ElasticThreadPool, RunsOnPoolThread) {
+  elastic_thread_pool pool;
+  auto s = pool.get_scheduler();
+  auto onPool = sync_wait(
+      then(schedule(s), [s]() noexcept { return currently_on(s); }));
+  EXPECT_TRUE(onPool.value_or(false));
+  EXPECT_FALSE(currently_on(s));
+}
+
+TEST(ElasticThreadPool, GrowsUnderBlockingLoad) {
+  elastic_thread_pool pool;
+  EXPECT_EQ(0u, pool.thread_count());
+  EXPECT_EQ(4, run_blocking_tasks(pool, 4, 4));
+  EXPECT_GE(pool.thread_count(), 4u);
+}
+
+TEST(ElasticThreadPool, StopsGrowingAtTheCap) {
+  elastic_thread_pool::options options;
+  options.maxThreads = 2;
+  elastic_thread_pool pool{options};
+  EXPECT_EQ(
+      2, run_blocking_tasks(pool, 6, 3, std::chrono::milliseconds(20)));
+  EXPECT_EQ(2u, pool.thread_count());
+}
+
+TEST(ElasticThreadPool, ShrinksWhenIdle) {
+  elastic_thread_pool::options options;
+  options.idleTimeout = std::chrono::milliseconds(10);
+  elastic_thread_pool pool{options};
+  run_blocking_tasks(pool, 3, 3);
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (pool.thread_count() != 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(0u, pool.thread_count());
+
+  // And grows again.
+  EXPECT_EQ(2, run_blocking_tasks(pool, 2, 2));
+}
+
+TEST(Offload, ResumesOnCallersScheduler) {
+  elastic_thread_pool pool;
+  single_thread_context caller;
+  auto callerScheduler = caller.get_scheduler();
+  auto poolScheduler = pool.get_scheduler();
+
+  auto result = sync_wait(on(
+      callerScheduler,
+      then(
+          offload(
+              poolScheduler,
+              [&] {
+                EXPECT_TRUE(currently_on(poolScheduler));
+                return 42;
+              }),
+          [&](int value) {
+            EXPECT_TRUE(currently_on(callerScheduler));
+            return value;
+          })));
+  EXPECT_EQ(42, result.value_or(0));
+}
+
+#if !UNIFEX_NO_EXCEPTIONS
+TEST(Offload, ForwardsExceptions) {
+  elastic_thread_pool pool;
+  EXPECT_THROW(
+      sync_wait(offload(pool.get_scheduler(), []() -> int {
+        throw std::runtime_error("blocked");
+      })),
+      std::runtime_error);
+}
+#endif  // !UNIFEX_NO_EXCEPTIONS
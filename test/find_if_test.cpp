@@ -65,7 +65,9 @@ TEST(find_if, find_if_parallel) {
   for (int i = 2; i < 128; ++i) {
     input.push_back(i);
   }
-  static_thread_pool ctx;
+  // A single worker runs the chunks in order, which makes the number of
+  // comparisons deterministic.
+  static_thread_pool ctx{1};
   std::optional<std::vector<int>::iterator> result = sync_wait(unifex::on(
       ctx.get_scheduler(),
       then(
@@ -84,21 +86,37 @@ TEST(find_if, find_if_parallel) {
           })));
 
   EXPECT_EQ(**result, checkValue);
-  // Expect 62 iterations to run to validate cancellation
-  // This is based on some implementation details:
-  //  * bulk_schedule's bulk_cancellation_chunk_size
-  //  * find_if's max_num_chunks and min_chunk_size
-  // find_if tries to launch 32 chunks of 4 elements each.
-  // bulk_schedule then chunks those into 16 element cancellation chunks.
-  // bulk_schedule launches a whole 16 element chunk.
-  // Most of them run to completion without finding the element.
-  // The second finds element 7 half way through and terminates early in
-  // the find_if algorithm.
-  // It ends up running the comparison operator 62 times.
-  // In general cancellation is best effort.
-  // Note though that the current implementation launches tasks in-order, so it
-  // cannot cancel earlier tasks, which makes find_if's find-fist rule safe.
-  EXPECT_EQ(countOfTasksRun, 62);
+  // find_if splits the input into 32 chunks of 4 elements. The first chunk
+  // compares all of its 4 elements and the second finds element 7 on its
+  // second comparison. Every later chunk sees the match before comparing
+  // anything, so the comparison runs 6 times.
+  EXPECT_EQ(countOfTasksRun, 6);
+}
+
+TEST(find_if, find_if_parallel_finds_first_match) {
+  using namespace unifex;
+
+  std::vector<int> input;
+  for (int i = 0; i < 512; ++i) {
+    input.push_back(i % 100);
+  }
+
+  // Chunks run concurrently and in any order on several workers, so later
+  // chunks, which also contain matches, may find theirs first.
+  static_thread_pool ctx{4};
+  for (int repeat = 0; repeat < 20; ++repeat) {
+    std::optional<std::vector<int>::iterator> result = sync_wait(unifex::on(
+        ctx.get_scheduler(),
+        then(
+            find_if(
+                just(begin(input), end(input)),
+                [&](const int& v) noexcept { return v == 90; },
+                unifex::par),
+            [](std::vector<int>::iterator v) noexcept { return v; })));
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(90, *result - begin(input));
+  }
 }
 #endif
 
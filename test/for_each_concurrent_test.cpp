@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/for_each_concurrent.hpp>
+
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/just.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/when_all_range.hpp>
+#include <unifex/with_query_value.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(std::size_t& allocated) noexcept
+    : allocated_(&allocated) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+    : allocated_(other.allocated_) {}
+
+  T* allocate(std::size_t n) {
+    *allocated_ += n * sizeof(T);
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool
+  operator==(const counting_allocator& a, const counting_allocator& b) {
+    return a.allocated_ == b.allocated_;
+  }
+  friend bool
+  operator!=(const counting_allocator& a, const counting_allocator& b) {
+    return !(a == b);
+  }
+
+  std::size_t* allocated_;
+};
+}  // namespace
+
+TEST(for_each_concurrent, RunsAtMostMaxConcurrencyAtATime) {
+  static_thread_pool pool{4};
+  std::atomic<int> running{0};
+  std::atomic<int> maxRunning{0};
+
+  std::vector<int> inputs(200);
+  std::iota(inputs.begin(), inputs.end(), 0);
+  auto makeWork = [&](int i) {
+    return then(schedule(pool.get_scheduler()), [&, i] {
+      int now = ++running;
+      int max = maxRunning.load();
+      while (now > max && !maxRunning.compare_exchange_weak(max, now)) {
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+      --running;
+      return i;
+    });
+  };
+  std::vector<decltype(makeWork(0))> works;
+  for (int i : inputs) {
+    works.push_back(makeWork(i));
+  }
+
+  auto result = sync_wait(when_all_range(works.begin(), works.end(), 5));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(inputs, std::vector<int>(result->begin(), result->end()));
+  EXPECT_LE(maxRunning.load(), 5);
+  EXPECT_GE(maxRunning.load(), 1);
+}
+
+TEST(for_each_concurrent, CopiesSendersUnlessMoveIterators) {
+  const std::string text(64, 'x');
+  std::vector<decltype(just(text))> works(10, just(text));
+  const std::vector<std::string> expected(10, text);
+
+  // The senders are copied, so the same range can be run again.
+  for (int run = 0; run < 2; ++run) {
+    auto result = sync_wait(when_all_range(works.begin(), works.end(), 3));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(
+        expected, std::vector<std::string>(result->begin(), result->end()));
+  }
+
+  auto result = sync_wait(when_all_range(
+      std::make_move_iterator(works.begin()),
+      std::make_move_iterator(works.end()),
+      3));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(
+      expected, std::vector<std::string>(result->begin(), result->end()));
+}
+
+TEST(for_each_concurrent, InlineCompletionsDontRecurse) {
+  std::vector<decltype(just(0))> works;
+  for (int i = 0; i < 100000; ++i) {
+    works.push_back(just(i));
+  }
+  long sum = 0;
+  auto result = sync_wait(for_each_concurrent(
+      works.begin(), works.end(), 3, [&](int i) { sum += i; }));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(100000L * 99999 / 2, sum);
+}
+
+TEST(for_each_concurrent, CallsFuncInCompletionOrder) {
+  static_thread_pool pool{4};
+  auto makeWork = [&](int i) {
+    return then(schedule(pool.get_scheduler()), [i] {
+      // Later senders finish first.
+      std::this_thread::sleep_for(std::chrono::milliseconds(10 * (4 - i)));
+      return i;
+    });
+  };
+  std::vector<decltype(makeWork(0))> works;
+  for (int i = 0; i < 4; ++i) {
+    works.push_back(makeWork(i));
+  }
+  std::vector<int> seen;
+  sync_wait(for_each_concurrent(works.begin(), works.end(), 4, [&](int i) {
+    seen.push_back(i);
+  }));
+  EXPECT_EQ((std::vector<int>{3, 2, 1, 0}), seen);
+}
+
+TEST(for_each_concurrent, ErrorStopsStartingChildren) {
+  int started = 0;
+  auto makeWork = [&](int i) {
+    return then(just(i), [&](int i) {
+      ++started;
+      if (i == 10) {
+        throw std::runtime_error("10");
+      }
+      return i;
+    });
+  };
+  std::vector<decltype(makeWork(0))> works;
+  for (int i = 0; i < 100; ++i) {
+    works.push_back(makeWork(i));
+  }
+  EXPECT_THROW(
+      sync_wait(when_all_range(works.begin(), works.end(), 2)),
+      std::runtime_error);
+  EXPECT_EQ(11, started);
+}
+
+TEST(for_each_concurrent, StopRequestedBeforeStartCompletesWithDone) {
+  std::vector<decltype(just(0))> works(10, just(0));
+  inplace_stop_source stopSource;
+  stopSource.request_stop();
+  int calls = 0;
+  auto result = sync_wait(with_query_value(
+      for_each_concurrent(
+          works.begin(), works.end(), 2, [&](int) { ++calls; }),
+      get_stop_token,
+      stopSource.get_token()));
+  EXPECT_FALSE(result.has_value());
+  EXPECT_EQ(0, calls);
+}
+
+TEST(for_each_concurrent, AllocatesOnlyMaxConcurrencySlots) {
+  std::vector<decltype(just(0))> works(1000, just(1));
+  std::size_t smallAllocated = 0;
+  std::size_t largeAllocated = 0;
+  sync_wait(for_each_concurrent(
+      works.begin(),
+      works.end(),
+      4,
+      [](int) {},
+      counting_allocator<std::byte>{smallAllocated}));
+  sync_wait(for_each_concurrent(
+      works.begin(),
+      works.end(),
+      8,
+      [](int) {},
+      counting_allocator<std::byte>{largeAllocated}));
+  EXPECT_GT(smallAllocated, 0u);
+  EXPECT_EQ(2 * smallAllocated, largeAllocated);
+}
@@ -15,14 +15,24 @@
  */
 #include <unifex/indexed_for.hpp>
 
+#include <unifex/execution_policy.hpp>
 #include <unifex/just.hpp>
 #include <unifex/let_value.hpp>
+#include <unifex/on.hpp>
 #include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
 #include <unifex/sync_wait.hpp>
 #include <unifex/then.hpp>
 
+#include <atomic>
 #include <chrono>
 #include <iostream>
+#include <list>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -91,3 +101,75 @@ TEST(indexed_for, Pipeable) {
   // 42 + 0 + 1 + 2 + 3 + 4 + 5 + 6 + 7 + 8 +  9, which is 42 + 45 = 87.
   EXPECT_EQ(87, *result);
 }
+
+TEST(indexed_for, ParallelOnGivenScheduler) {
+  static_thread_pool pool{4};
+  std::vector<std::atomic<int>> hits(10000);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+
+  sync_wait(
+      just() |
+      indexed_for(
+          pool.get_scheduler(),
+          unifex::par,
+          ranges::iota_view{10000},
+          [&](int idx) {
+            ++hits[idx];
+            std::lock_guard lk{mutex};
+            threads.insert(std::this_thread::get_id());
+          }));
+
+  for (auto& h : hits) {
+    EXPECT_EQ(1, h.load());
+  }
+  threads.erase(std::this_thread::get_id());
+  EXPECT_FALSE(threads.empty());
+}
+
+TEST(indexed_for, ParallelOnReceiversScheduler) {
+  static_thread_pool pool{4};
+  auto result = sync_wait(on(
+      pool.get_scheduler(),
+      just(std::vector<int>(1000)) |
+          indexed_for(
+              unifex::par_unseq,
+              ranges::iota_view{1000},
+              [](int idx, std::vector<int>& v) { v[idx] = 2 * idx; })));
+
+  ASSERT_TRUE(result.has_value());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(2 * i, (*result)[i]);
+  }
+}
+
+TEST(indexed_for, ForwardRangeRunsSequentially) {
+  static_thread_pool pool{4};
+  std::list<int> range{1, 2, 3, 4, 5};
+  std::vector<int> seen;
+  const auto caller = std::this_thread::get_id();
+  sync_wait(
+      just() |
+      indexed_for(pool.get_scheduler(), unifex::par, range, [&](int idx) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        seen.push_back(idx);
+      }));
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), seen);
+}
+
+TEST(indexed_for, ParallelLoopForwardsExceptions) {
+  static_thread_pool pool{4};
+  EXPECT_THROW(
+      sync_wait(
+          just() |
+          indexed_for(
+              pool.get_scheduler(),
+              unifex::par,
+              ranges::iota_view{1000},
+              [](int idx) {
+                if (idx == 500) {
+                  throw std::runtime_error("500");
+                }
+              })),
+      std::runtime_error);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/let_value.hpp>
+#  include <unifex/on.hpp>
+#  include <unifex/repeat_effect_until.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+
+#  include <unifex/linux/io_uring_context.hpp>
+
+#  include <chrono>
+#  include <optional>
+#  include <thread>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct running_context {
+  explicit running_context(const io_uring_context::options& options)
+    : context_(options) {}
+
+  ~running_context() {
+    stopSource_.request_stop();
+    thread_.join();
+  }
+
+  io_uring_context context_;
+  inplace_stop_source stopSource_;
+  std::thread thread_{[this] {
+    context_.run(stopSource_.get_token());
+  }};
+};
+
+struct MsgRingTest : testing::TestWithParam<bool> {
+  io_uring_context::options options() const {
+    io_uring_context::options options;
+    options.msgRingWakeups = GetParam();
+    return options;
+  }
+
+  running_context a_{options()};
+  running_context b_{options()};
+};
+
+}  // namespace
+
+TEST_P(MsgRingTest, PingPong) {
+  auto a = a_.context_.get_scheduler();
+  auto b = b_.context_.get_scheduler();
+  constexpr int roundTrips = 1000;
+  int count = 0;
+  bool wrongThread = false;
+
+  sync_wait(on(
+      a,
+      repeat_effect_until(
+          let_value(
+              schedule(b),
+              [&] {
+                wrongThread |=
+                    std::this_thread::get_id() != b_.thread_.get_id();
+                return schedule(a);
+              }) |
+              then([&] {
+                wrongThread |=
+                    std::this_thread::get_id() != a_.thread_.get_id();
+                ++count;
+              }),
+          [&] { return count == roundTrips; })));
+
+  EXPECT_EQ(roundTrips, count);
+  EXPECT_FALSE(wrongThread);
+}
+
+TEST_P(MsgRingTest, NonRingThreadCanWakeAfterRingWakeup) {
+  auto a = a_.context_.get_scheduler();
+  auto b = b_.context_.get_scheduler();
+  for (int i = 0; i < 10; ++i) {
+    // Let b go idle, then wake it from a's ring.
+    std::this_thread::sleep_for(1ms);
+    EXPECT_TRUE(sync_wait(on(a, schedule(b))).has_value());
+
+    // Let b go idle again, then wake it from this thread.
+    std::this_thread::sleep_for(1ms);
+    EXPECT_TRUE(sync_wait(schedule(b)).has_value());
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    IoUring,
+    MsgRingTest,
+    testing::Bool(),
+    [](const testing::TestParamInfo<bool>& info) {
+      return info.param ? "MsgRing" : "EventFd";
+    });
+
+#endif  // !UNIFEX_NO_LIBURING
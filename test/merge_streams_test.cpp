@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/merge_streams.hpp>
+
+#include <unifex/just_done.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/transform_stream.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+using ctx_scheduler =
+    decltype(UNIFEX_DECLVAL(timed_single_thread_context&).get_scheduler());
+
+// Produces first, first + 1, ... one element every interval.
+struct ticking_stream {
+  auto next() {
+    return schedule_after(scheduler_, interval_) |
+        then([this] { return i_++; });
+  }
+
+  auto cleanup() { return just_done(); }
+
+  ctx_scheduler scheduler_;
+  std::chrono::milliseconds interval_;
+  int i_ = 0;
+};
+
+template <typename Stream>
+std::vector<int> collect(Stream&& stream) {
+  auto res = reduce_stream(
+                 (Stream &&) stream,
+                 std::vector<int>{},
+                 [](std::vector<int> acc, int val) {
+                   acc.push_back(val);
+                   return acc;
+                 }) |
+      sync_wait();
+  return res ? std::move(*res) : std::vector<int>{};
+}
+}  // namespace
+
+TEST(merge_streams, MergesAllValues) {
+  auto results = collect(
+      merge_streams(range_stream{0, 10}, range_stream{10, 15}));
+
+  std::sort(results.begin(), results.end());
+  std::vector<int> expected;
+  for (int i = 0; i < 15; ++i) {
+    expected.push_back(i);
+  }
+  EXPECT_EQ(expected, results);
+}
+
+TEST(merge_streams, MergesRangeOfStreams) {
+  std::vector<range_stream> streams;
+  for (int i = 0; i < 4; ++i) {
+    streams.push_back(range_stream{i * 100, i * 100 + 50});
+  }
+
+  auto results = collect(merge_streams(std::move(streams)));
+
+  ASSERT_EQ(200u, results.size());
+  // Each source's values keep their relative order.
+  for (int i = 0; i < 4; ++i) {
+    std::vector<int> fromSource;
+    std::copy_if(
+        results.begin(),
+        results.end(),
+        std::back_inserter(fromSource),
+        [&](int val) { return val / 100 == i; });
+    ASSERT_EQ(50u, fromSource.size());
+    EXPECT_TRUE(std::is_sorted(fromSource.begin(), fromSource.end()));
+  }
+}
+
+TEST(merge_streams, YieldsWhicheverCompletesFirst) {
+  timed_single_thread_context ctx;
+  auto stream = merge_streams(
+      ticking_stream{ctx.get_scheduler(), 1h, 0},
+      ticking_stream{ctx.get_scheduler(), 1ms, 100});
+
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(100 + i, sync_wait(next(stream)));
+  }
+
+  // Cleanup cancels the outstanding next() on the slow stream.
+  auto start = std::chrono::steady_clock::now();
+  sync_wait(cleanup(stream));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+}
+
+#if !UNIFEX_NO_EXCEPTIONS
+TEST(merge_streams, PropagatesErrors) {
+  auto throwing = range_stream{0, 10} | transform_stream([](int val) {
+                    if (val == 3) {
+                      throw std::runtime_error{"boom"};
+                    }
+                    return val;
+                  });
+
+  EXPECT_THROW(
+      collect(merge_streams(range_stream{0, 10}, std::move(throwing))),
+      std::runtime_error);
+}
+#endif
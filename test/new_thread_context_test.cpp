@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/new_thread_context.hpp>
+
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/when_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+// Completes once `count` operations are running at the same time, or
+// reports false after a generous timeout.
+auto wait_for_all(
+    new_thread_context& ctx, std::atomic<int>& running, int count) {
+  return then(schedule(ctx.get_scheduler()), [&running, count] {
+    ++running;
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (running.load() < count) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  });
+}
+}  // namespace
+
+TEST(NewThreadContext, ReusesParkedThreads) {
+  new_thread_context ctx;
+  std::set<std::thread::id> ids;
+  for (int i = 0; i < 20; ++i) {
+    ids.insert(*sync_wait(then(schedule(ctx.get_scheduler()), [] {
+      return std::this_thread::get_id();
+    })));
+  }
+  EXPECT_LT(ids.size(), 20u);
+}
+
+TEST(NewThreadContext, EachOperationGetsItsOwnThread) {
+  // A single cached thread can't be shared between operations that are
+  // started at the same time.
+  new_thread_context ctx{1};
+  for (int round = 0; round < 3; ++round) {
+    std::atomic<int> running{0};
+    auto result = sync_wait(when_all(
+        wait_for_all(ctx, running, 4),
+        wait_for_all(ctx, running, 4),
+        wait_for_all(ctx, running, 4),
+        wait_for_all(ctx, running, 4)));
+    ASSERT_TRUE(result.has_value());
+    auto& [a, b, c, d] = *result;
+    EXPECT_TRUE(std::get<0>(std::get<0>(a)));
+    EXPECT_TRUE(std::get<0>(std::get<0>(b)));
+    EXPECT_TRUE(std::get<0>(std::get<0>(c)));
+    EXPECT_TRUE(std::get<0>(std::get<0>(d)));
+  }
+}
+
+TEST(NewThreadContext, WithoutCachingEveryOperationGetsANewThread) {
+  new_thread_context ctx{0};
+  for (int i = 0; i < 10; ++i) {
+    auto tasksOnThisThread = sync_wait(then(schedule(ctx.get_scheduler()), [] {
+      thread_local int count = 0;
+      return ++count;
+    }));
+    EXPECT_EQ(1, *tasksOnThisThread);
+  }
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/parallel_algorithms.hpp>
+
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/with_query_value.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+// Large enough to be split into several chunks.
+constexpr std::size_t input_size = 100000;
+
+std::vector<int> random_input(std::size_t size = input_size) {
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<int> dist{-1000, 1000};
+  std::vector<int> input(size);
+  for (auto& v : input) {
+    v = dist(rng);
+  }
+  return input;
+}
+}  // namespace
+
+TEST(parallel_algorithms, ForEachN) {
+  static_thread_pool pool;
+  std::vector<int> input(input_size, 1);
+  auto result = sync_wait(parallel::for_each_n(
+      pool.get_scheduler(), par, input.begin(), 1000, [](int& v) { v = 2; }));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(input.begin() + 1000, *result);
+  EXPECT_EQ(2000 + (input_size - 1000), std::size_t(std::accumulate(
+                                            input.begin(), input.end(), 0)));
+}
+
+TEST(parallel_algorithms, Transform) {
+  static_thread_pool pool;
+  auto input = random_input();
+  std::vector<long> output(input.size());
+  auto result = sync_wait(parallel::transform(
+      pool.get_scheduler(),
+      par,
+      input.begin(),
+      input.end(),
+      output.begin(),
+      [](int v) { return long(v) * 3; }));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(output.end(), *result);
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    ASSERT_EQ(long(input[i]) * 3, output[i]);
+  }
+}
+
+TEST(parallel_algorithms, CountIfAndMinElement) {
+  static_thread_pool pool;
+  auto input = random_input();
+  input[70000] = -5000;
+  input[90000] = -5000;
+
+  auto count = sync_wait(parallel::count_if(
+      pool.get_scheduler(), par, input.begin(), input.end(), [](int v) {
+        return v > 0;
+      }));
+  ASSERT_TRUE(count.has_value());
+  EXPECT_EQ(
+      std::count_if(input.begin(), input.end(), [](int v) { return v > 0; }),
+      *count);
+
+  auto min = sync_wait(parallel::min_element(
+      pool.get_scheduler(), par, input.begin(), input.end()));
+  ASSERT_TRUE(min.has_value());
+  EXPECT_EQ(input.begin() + 70000, *min);
+
+  std::vector<int> empty;
+  auto emptyMin = sync_wait(parallel::min_element(
+      pool.get_scheduler(), par, empty.begin(), empty.end()));
+  EXPECT_EQ(empty.end(), *emptyMin);
+}
+
+TEST(parallel_algorithms, Scans) {
+  static_thread_pool pool;
+  auto input = random_input();
+
+  std::vector<long> expected(input.size());
+  std::vector<long> output(input.size());
+  std::inclusive_scan(input.begin(), input.end(), expected.begin());
+  sync_wait(parallel::inclusive_scan(
+      pool.get_scheduler(), par, input.begin(), input.end(), output.begin()));
+  EXPECT_EQ(expected, output);
+
+  std::inclusive_scan(
+      input.begin(), input.end(), expected.begin(), std::plus<>{}, 10L);
+  sync_wait(parallel::inclusive_scan(
+      pool.get_scheduler(),
+      par,
+      input.begin(),
+      input.end(),
+      output.begin(),
+      std::plus<>{},
+      10L));
+  EXPECT_EQ(expected, output);
+
+  std::exclusive_scan(input.begin(), input.end(), expected.begin(), 10L);
+  sync_wait(parallel::exclusive_scan(
+      pool.get_scheduler(),
+      par,
+      input.begin(),
+      input.end(),
+      output.begin(),
+      10L));
+  EXPECT_EQ(expected, output);
+
+  // In place, and on a sequenced scheduler.
+  single_thread_context ctx;
+  auto inPlace = input;
+  std::inclusive_scan(input.begin(), input.end(), input.begin());
+  sync_wait(parallel::inclusive_scan(
+      ctx.get_scheduler(),
+      seq,
+      inPlace.begin(),
+      inPlace.end(),
+      inPlace.begin()));
+  EXPECT_EQ(input, inPlace);
+}
+
+TEST(parallel_algorithms, PartitionIsStable) {
+  static_thread_pool pool;
+  auto input = random_input();
+  auto expected = input;
+  auto isEven = [](int v) { return v % 2 == 0; };
+  auto expectedMid =
+      std::stable_partition(expected.begin(), expected.end(), isEven);
+
+  auto mid = sync_wait(parallel::partition(
+      pool.get_scheduler(), par, input.begin(), input.end(), isEven));
+  ASSERT_TRUE(mid.has_value());
+  EXPECT_EQ(expectedMid - expected.begin(), *mid - input.begin());
+  EXPECT_EQ(expected, input);
+}
+
+TEST(parallel_algorithms, Sort) {
+  static_thread_pool pool;
+  for (std::size_t size : {0, 1, 1000, 3500, 5000, 100000}) {
+    auto input = random_input(size);
+    auto expected = input;
+    std::sort(expected.begin(), expected.end(), std::greater<>{});
+    sync_wait(parallel::sort(
+        pool.get_scheduler(),
+        par,
+        input.begin(),
+        input.end(),
+        std::greater<>{}));
+    EXPECT_EQ(expected, input);
+  }
+}
+
+TEST(parallel_algorithms, StopSkipsRemainingChunks) {
+  static_thread_pool pool;
+  std::vector<int> input(input_size);
+  inplace_stop_source stopSource;
+  std::atomic<std::size_t> visited{0};
+  auto result = sync_wait(with_query_value(
+      parallel::for_each_n(
+          pool.get_scheduler(),
+          par,
+          input.begin(),
+          input.size(),
+          [&](int&) {
+            ++visited;
+            stopSource.request_stop();
+          }),
+      get_stop_token,
+      stopSource.get_token()));
+  EXPECT_FALSE(result.has_value());
+  EXPECT_GT(visited.load(), 0u);
+
+  // Already stopped: no chunks run at all.
+  visited = 0;
+  result = sync_wait(with_query_value(
+      parallel::for_each_n(
+          pool.get_scheduler(),
+          par,
+          input.begin(),
+          input.size(),
+          [&](int&) { ++visited; }),
+      get_stop_token,
+      stopSource.get_token()));
+  EXPECT_FALSE(result.has_value());
+  EXPECT_EQ(0u, visited.load());
+}
+
+TEST(parallel_algorithms, ForwardsExceptions) {
+  static_thread_pool pool;
+  auto input = random_input();
+  EXPECT_THROW(
+      sync_wait(parallel::for_each_n(
+          pool.get_scheduler(),
+          par,
+          input.begin(),
+          input.size(),
+          [](int v) {
+            if (v == 1000) {
+              throw std::runtime_error("1000");
+            }
+          })),
+      std::runtime_error);
+}
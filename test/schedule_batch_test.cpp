@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/schedule_batch.hpp>
+
+#include <unifex/manual_event_loop.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/when_all.hpp>
+#include <unifex/when_all_range.hpp>
+
+#if !UNIFEX_NO_LIBURING
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+#  include <unifex/scope_guard.hpp>
+#endif
+
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+
+struct recording_receiver {
+  std::vector<int>* order_;
+  int id_;
+
+  void set_value() noexcept { order_->push_back(id_); }
+  void set_error(std::exception_ptr) noexcept { std::terminate(); }
+  void set_done() noexcept { std::terminate(); }
+};
+
+}  // namespace
+
+TEST(ScheduleBatch, HoldsWorkUntilOutermostBatchEnds) {
+  manual_event_loop loop;
+  loop.stop();  // run() returns once the queue is empty.
+  std::vector<int> order;
+
+  auto s = loop.get_scheduler();
+  auto a = unifex::connect(schedule(s), recording_receiver{&order, 0});
+  auto b = unifex::connect(schedule(s), recording_receiver{&order, 1});
+  {
+    schedule_batch outer;
+    EXPECT_TRUE(schedule_batch::active());
+    unifex::start(a);
+    {
+      schedule_batch inner;
+      unifex::start(b);
+    }
+    loop.run();
+    EXPECT_TRUE(order.empty());
+  }
+  EXPECT_FALSE(schedule_batch::active());
+  loop.run();
+  EXPECT_EQ((std::vector<int>{0, 1}), order);
+}
+
+TEST(ScheduleBatch, HeldBackWorkKeepsItsPlaceBehindEarlierWork) {
+  manual_event_loop loop;
+  loop.stop();
+  std::vector<int> order;
+
+  auto s = loop.get_scheduler();
+  auto a = unifex::connect(schedule(s), recording_receiver{&order, 0});
+  auto b = unifex::connect(schedule(s), recording_receiver{&order, 1});
+  auto c = unifex::connect(schedule(s), recording_receiver{&order, 2});
+  unifex::start(a);
+  {
+    schedule_batch batch;
+    unifex::start(b);
+    unifex::start(c);
+  }
+  loop.run();
+  EXPECT_EQ((std::vector<int>{0, 1, 2}), order);
+}
+
+TEST(ScheduleBatch, WhenAllOnThreadPool) {
+  static_thread_pool pool{4};
+  auto s = pool.get_scheduler();
+  std::atomic<int> count{0};
+  auto tick = [&] {
+    ++count;
+  };
+
+  sync_wait(when_all(
+      then(schedule(s), tick),
+      then(schedule(s), tick),
+      then(schedule(s), tick),
+      then(schedule(s), tick),
+      then(schedule(s), tick),
+      then(schedule(s), tick)));
+  EXPECT_EQ(6, count.load());
+}
+
+TEST(ScheduleBatch, WhenAllRangeOnThreadPool) {
+  static_thread_pool pool{4};
+  auto s = pool.get_scheduler();
+
+  auto make = [s](int i) {
+    return then(schedule(s), [i] { return i; });
+  };
+  std::vector<decltype(make(0))> senders;
+  for (int i = 0; i < 100; ++i) {
+    senders.push_back(make(i));
+  }
+  auto result = sync_wait(when_all_range(std::move(senders)));
+  ASSERT_TRUE(result.has_value());
+  ASSERT_EQ(100u, result->size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, (*result)[i]);
+  }
+}
+
+#if !UNIFEX_NO_LIBURING
+TEST(ScheduleBatch, WhenAllOnIoUringContextFromAnotherThread) {
+  linuxos::io_uring_context ctx;
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+  };
+
+  auto s = ctx.get_scheduler();
+  std::atomic<int> count{0};
+  auto tick = [&] {
+    ++count;
+  };
+  for (int i = 0; i < 10; ++i) {
+    sync_wait(when_all(
+        then(schedule(s), tick),
+        then(schedule(s), tick),
+        then(schedule(s), tick),
+        then(schedule(s), tick)));
+  }
+  EXPECT_EQ(40, count.load());
+}
+#endif
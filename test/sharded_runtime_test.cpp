@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING
+
+#  include <unifex/async_scope.hpp>
+#  include <unifex/defer.hpp>
+#  include <unifex/repeat_effect_until.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+
+#  include <unifex/linux/sharded_runtime.hpp>
+
+#  include <atomic>
+#  include <memory>
+#  include <vector>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+
+namespace {
+sharded_runtime::options test_options(std::size_t ringCapacity = 1024) {
+  sharded_runtime::options options;
+  options.shardCount = 3;
+  options.ringCapacity = ringCapacity;
+  options.ioOptions.entries = 64;
+  return options;
+}
+
+// Hops from shard to shard `hops` times, checking that each hop lands on
+// the shard it was scheduled onto.
+auto hop_around(
+    sharded_runtime& runtime,
+    std::size_t first,
+    int hops,
+    std::atomic<int>& completed,
+    std::atomic<int>& misplaced) {
+  struct state {
+    std::size_t next;
+    int remaining;
+  };
+  auto s = std::make_shared<state>(state{first, hops});
+  return repeat_effect_until(
+      defer([&runtime, &misplaced, s] {
+        auto target = s->next;
+        s->next = (s->next + 1) % runtime.shard_count();
+        --s->remaining;
+        return then(
+            schedule(runtime.shard_scheduler(target)),
+            [&runtime, &misplaced, target] {
+              if (runtime.this_shard() != target) {
+                ++misplaced;
+              }
+            });
+      }),
+      [&completed, s] {
+        if (s->remaining > 0) {
+          return false;
+        }
+        ++completed;
+        return true;
+      });
+}
+}  // namespace
+
+TEST(ShardedRuntime, SchedulesOntoEachShard) {
+  sharded_runtime runtime{test_options()};
+  ASSERT_EQ(3u, runtime.shard_count());
+  EXPECT_EQ(sharded_runtime::no_shard, runtime.this_shard());
+
+  for (std::size_t i = 0; i < runtime.shard_count(); ++i) {
+    auto scheduler = runtime.shard_scheduler(i);
+    EXPECT_FALSE(currently_on(scheduler));
+    auto result = sync_wait(then(schedule(scheduler), [&] {
+      return std::make_pair(runtime.this_shard(), currently_on(scheduler));
+    }));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(i, result->first);
+    EXPECT_TRUE(result->second);
+  }
+}
+
+TEST(ShardedRuntime, CrossShardHops) {
+  sharded_runtime runtime{test_options()};
+  std::atomic<int> completed{0};
+  std::atomic<int> misplaced{0};
+  sync_wait(hop_around(runtime, 0, 3000, completed, misplaced));
+  EXPECT_EQ(1, completed.load());
+  EXPECT_EQ(0, misplaced.load());
+}
+
+TEST(ShardedRuntime, FullRingFallsBackToContextQueue) {
+  sharded_runtime runtime{test_options(2)};
+  std::atomic<int> completed{0};
+  async_scope scope;
+  // All of these are scheduled from shard 0 before shard 1 gets a chance
+  // to drain its ring from shard 0.
+  sync_wait(then(schedule(runtime.shard_scheduler(0)), [&] {
+    for (int i = 0; i < 100; ++i) {
+      scope.detached_spawn(
+          then(schedule(runtime.shard_scheduler(1)), [&] {
+            if (runtime.this_shard() == 1) {
+              ++completed;
+            }
+          }));
+    }
+  }));
+  sync_wait(scope.complete());
+  EXPECT_EQ(100, completed.load());
+}
+
+TEST(ShardedRuntime, ShutdownDrainsCrossShardWork) {
+  sharded_runtime runtime{test_options(8)};
+  constexpr int chains = 20;
+  std::vector<std::atomic<int>> completed(chains);
+  std::atomic<int> misplaced{0};
+  async_scope scope;
+  sync_wait(then(schedule(runtime.shard_scheduler(0)), [&] {
+    for (int i = 0; i < chains; ++i) {
+      scope.detached_spawn(
+          hop_around(runtime, i % 3, 200, completed[i], misplaced));
+    }
+  }));
+  runtime.shutdown();
+  for (auto& c : completed) {
+    EXPECT_EQ(1, c.load());
+  }
+  EXPECT_EQ(0, misplaced.load());
+  sync_wait(scope.complete());
+}
+
+#  if !UNIFEX_NO_MEMORY_RESOURCE
+TEST(ShardedRuntime, ShardMemoryResource) {
+  sharded_runtime runtime{test_options()};
+  EXPECT_EQ(
+      pmr::get_default_resource(),
+      &sharded_runtime::this_shard_memory_resource());
+  for (std::size_t i = 0; i < runtime.shard_count(); ++i) {
+    auto resource = sync_wait(then(schedule(runtime.shard_scheduler(i)), [] {
+      auto& r = sharded_runtime::this_shard_memory_resource();
+      pmr::vector<int> v{&r};
+      v.resize(1000);
+      return &r;
+    }));
+    ASSERT_TRUE(resource.has_value());
+    EXPECT_EQ(&runtime.shard_memory_resource(i), *resource);
+  }
+}
+#  endif
+
+#endif  // !UNIFEX_NO_LIBURING
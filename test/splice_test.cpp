@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/pipe_concepts.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/stop_when.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/when_all.hpp>
+
+#  include <unifex/linux/async_transfer.hpp>
+#  if !UNIFEX_NO_EPOLL
+#    include <unifex/linux/io_epoll_context.hpp>
+#  endif
+#  if !UNIFEX_NO_LIBURING
+#    include <unifex/linux/io_uring_context.hpp>
+#  endif
+
+#  include <chrono>
+#  include <cstdlib>
+#  include <string>
+#  include <thread>
+
+#  include <fcntl.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+
+namespace {
+
+template <typename Context>
+struct SpliceTest : testing::Test {
+  ~SpliceTest() {
+    stopSource_.request_stop();
+    thread_.join();
+  }
+
+  auto scheduler() { return context_.get_scheduler(); }
+
+  static safe_file_descriptor temp_file(const std::string& contents) {
+    char path[] = "/tmp/unifex_splice_test_XXXXXX";
+    safe_file_descriptor fd{::mkstemp(path)};
+    EXPECT_TRUE(fd.valid());
+    ::unlink(path);
+    EXPECT_EQ(
+        ssize_t(contents.size()),
+        ::write(fd.get(), contents.data(), contents.size()));
+    return fd;
+  }
+
+  static std::string read_all(int fd, std::size_t size, off_t offset = 0) {
+    std::string result(size, '\0');
+    EXPECT_EQ(ssize_t(size), ::pread(fd, result.data(), size, offset));
+    return result;
+  }
+
+  Context context_;
+  inplace_stop_source stopSource_;
+  std::thread thread_{[this] {
+    context_.run(stopSource_.get_token());
+  }};
+};
+
+using contexts = testing::Types<
+#  if !UNIFEX_NO_LIBURING
+    io_uring_context
+#    if !UNIFEX_NO_EPOLL
+    ,
+#    endif
+#  endif
+#  if !UNIFEX_NO_EPOLL
+    io_epoll_context
+#  endif
+    >;
+}  // namespace
+
+TYPED_TEST_SUITE(SpliceTest, contexts, );
+
+TYPED_TEST(SpliceTest, SpliceFileThroughPipe) {
+  const std::string contents = "spliced without a user-space copy";
+  auto in = this->temp_file(contents);
+  auto out = this->temp_file("");
+  int p[2];
+  ASSERT_EQ(0, ::pipe(p));
+  safe_file_descriptor pipeRead{p[0]}, pipeWrite{p[1]};
+
+  auto filled = sync_wait(async_splice(
+      this->scheduler(),
+      in.get(),
+      0,
+      pipeWrite.get(),
+      splice_no_offset,
+      contents.size()));
+  ASSERT_TRUE(filled.has_value());
+  EXPECT_EQ(ssize_t(contents.size()), *filled);
+
+  auto drained = sync_wait(async_splice(
+      this->scheduler(),
+      pipeRead.get(),
+      splice_no_offset,
+      out.get(),
+      0,
+      contents.size()));
+  ASSERT_TRUE(drained.has_value());
+  EXPECT_EQ(ssize_t(contents.size()), *drained);
+  EXPECT_EQ(contents, this->read_all(out.get(), contents.size()));
+}
+
+TYPED_TEST(SpliceTest, TeeLeavesSourcePipeIntact) {
+  int a[2], b[2];
+  ASSERT_EQ(0, ::pipe2(a, O_NONBLOCK));
+  ASSERT_EQ(0, ::pipe2(b, O_NONBLOCK));
+  safe_file_descriptor aRead{a[0]}, aWrite{a[1]}, bRead{b[0]}, bWrite{b[1]};
+  ASSERT_EQ(5, ::write(aWrite.get(), "hello", 5));
+
+  auto teed =
+      sync_wait(async_tee(this->scheduler(), aRead.get(), bWrite.get(), 5));
+  ASSERT_TRUE(teed.has_value());
+  EXPECT_EQ(5, *teed);
+
+  char buffer[5];
+  ASSERT_EQ(5, ::read(aRead.get(), buffer, 5));
+  EXPECT_EQ("hello", std::string(buffer, 5));
+  ASSERT_EQ(5, ::read(bRead.get(), buffer, 5));
+  EXPECT_EQ("hello", std::string(buffer, 5));
+}
+
+TYPED_TEST(SpliceTest, CopyFileRange) {
+  const std::string contents = "copied inside the kernel";
+  auto in = this->temp_file(contents);
+  auto out = this->temp_file("");
+
+  auto copied = sync_wait(async_copy_file_range(
+      this->scheduler(), in.get(), 7, out.get(), 0, contents.size() - 7));
+  ASSERT_TRUE(copied.has_value());
+  EXPECT_EQ(ssize_t(contents.size() - 7), *copied);
+  EXPECT_EQ(contents.substr(7), this->read_all(out.get(), *copied));
+}
+
+TYPED_TEST(SpliceTest, SpliceWaitsForSocketData) {
+  int s[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, s));
+  safe_file_descriptor local{s[0]}, remote{s[1]};
+  int p[2];
+  ASSERT_EQ(0, ::pipe(p));
+  safe_file_descriptor pipeRead{p[0]}, pipeWrite{p[1]};
+
+  // Nothing has been written yet, so the splice has to wait for the socket.
+  std::thread writer{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(4, ::write(remote.get(), "ping", 4));
+  }};
+  auto spliced = sync_wait(async_splice(
+      this->scheduler(),
+      local.get(),
+      splice_no_offset,
+      pipeWrite.get(),
+      splice_no_offset,
+      4));
+  writer.join();
+  ASSERT_TRUE(spliced.has_value());
+  EXPECT_EQ(4, *spliced);
+}
+
+TYPED_TEST(SpliceTest, SpliceCancelsWhileWaiting) {
+  int s[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, s));
+  safe_file_descriptor local{s[0]}, remote{s[1]};
+  int p[2];
+  ASSERT_EQ(0, ::pipe(p));
+  safe_file_descriptor pipeRead{p[0]}, pipeWrite{p[1]};
+
+  auto scheduler = this->scheduler();
+  auto spliced = sync_wait(stop_when(
+      async_splice(
+          scheduler,
+          local.get(),
+          splice_no_offset,
+          pipeWrite.get(),
+          splice_no_offset,
+          4),
+      schedule_at(scheduler, now(scheduler) + std::chrono::milliseconds(10))));
+  EXPECT_FALSE(spliced.has_value());
+}
+
+TYPED_TEST(SpliceTest, TransferProxiesBetweenSockets) {
+  int upstream[2], downstream[2];
+  ASSERT_EQ(
+      0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, upstream));
+  ASSERT_EQ(
+      0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, downstream));
+  safe_file_descriptor upLocal{upstream[0]}, upRemote{upstream[1]};
+  safe_file_descriptor downLocal{downstream[0]}, downRemote{downstream[1]};
+
+  // More than a chunk, so that the pipe is refilled several times.
+  const std::size_t size = 40000;
+  std::string sent(size, '\0');
+  for (std::size_t i = 0; i < size; ++i) {
+    sent[i] = char('a' + i % 26);
+  }
+  std::string received;
+  std::thread peer{[&] {
+    std::size_t written = 0;
+    char buffer[4096];
+    while (received.size() < size) {
+      if (written < size) {
+        auto n = ::write(upRemote.get(), sent.data() + written, size - written);
+        if (n > 0) {
+          written += n;
+        }
+      }
+      auto n = ::read(downRemote.get(), buffer, sizeof(buffer));
+      if (n > 0) {
+        received.append(buffer, n);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }};
+
+  auto transferred = sync_wait(async_transfer(
+      this->scheduler(), upLocal.get(), downLocal.get(), size, 4096));
+  peer.join();
+  ASSERT_TRUE(transferred.has_value());
+  EXPECT_EQ(size, *transferred);
+  EXPECT_EQ(sent, received);
+}
+
+TYPED_TEST(SpliceTest, TransferStopsAtEndOfFile) {
+  const std::string contents = "short file";
+  auto in = this->temp_file(contents);
+  ASSERT_EQ(0, ::lseek(in.get(), 0, SEEK_SET));
+  auto out = this->temp_file("");
+
+  auto transferred = sync_wait(
+      async_transfer(this->scheduler(), in.get(), out.get(), 1024));
+  ASSERT_TRUE(transferred.has_value());
+  EXPECT_EQ(contents.size(), *transferred);
+  EXPECT_EQ(contents, this->read_all(out.get(), contents.size()));
+}
+
+#endif  // !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
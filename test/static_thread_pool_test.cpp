@@ -15,14 +15,27 @@
  */
 #include <unifex/static_thread_pool.hpp>
 
+#include <unifex/async_scope.hpp>
+#include <unifex/bulk_join.hpp>
+#include <unifex/bulk_schedule.hpp>
+#include <unifex/bulk_transform.hpp>
+#include <unifex/get_priority.hpp>
+#include <unifex/inplace_stop_token.hpp>
 #include <unifex/just.hpp>
 #include <unifex/on.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sync_wait.hpp>
 #include <unifex/then.hpp>
 #include <unifex/when_all.hpp>
+#include <unifex/with_query_value.hpp>
 
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -33,6 +46,70 @@ template <typename Scheduler, typename F>
 auto run_on(Scheduler&& s, F&& func) {
   return then(schedule((Scheduler &&) s), (F &&) func);
 }
+
+// Queues tasks on a single-threaded pool while its worker is blocked, then
+// records the order in which they run.
+struct lane_order {
+  explicit lane_order(const static_thread_pool::options& options)
+    : pool_(options) {
+    scope_.detached_spawn(run_on(pool_.get_scheduler(), [this] {
+      started_ = true;
+      while (!released_) {
+        std::this_thread::yield();
+      }
+    }));
+    while (!started_) {
+      std::this_thread::yield();
+    }
+  }
+
+  template <typename Sender>
+  void add(char tag, Sender&& sender) {
+    scope_.detached_spawn(then((Sender &&) sender, [this, tag] {
+      std::lock_guard lk{mutex_};
+      order_ += tag;
+    }));
+  }
+
+  std::string run() {
+    released_ = true;
+    sync_wait(scope_.complete());
+    return order_;
+  }
+
+  static_thread_pool pool_;
+  async_scope scope_;
+  std::atomic<bool> started_{false};
+  std::atomic<bool> released_{false};
+  std::mutex mutex_;
+  std::string order_;
+};
+
+// Two bulk tasks that each wait for the other to arrive, which only
+// happens if they run at the same time.
+struct overlap_check {
+  void arrive() {
+    ++arrived_;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (arrived_.load() < 2) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        overlapped_ = false;
+        return;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  std::atomic<int> arrived_{0};
+  std::atomic<bool> overlapped_{true};
+};
+
+static_thread_pool::options single_thread_options() {
+  static_thread_pool::options options;
+  options.threadCount = 1;
+  return options;
+}
 }  // anonymous namespace
 
 TEST(StaticThreadPool, Smoke) {
@@ -62,3 +139,274 @@ TEST(StaticThreadPool, Smoke) {
 
   EXPECT_EQ(x, 3);
 }
+
+TEST(StaticThreadPool, NodeSchedulers) {
+  static_thread_pool::options options;
+  options.threadCount = 4;
+  options.pinThreads = true;
+  options.numaAware = true;
+  static_thread_pool tpContext{options};
+  ASSERT_GE(tpContext.node_count(), 1u);
+
+  auto any = tpContext.get_scheduler();
+  for (std::uint32_t node = 0; node < tpContext.node_count(); ++node) {
+    auto tp = tpContext.get_scheduler(node);
+    EXPECT_NE(any, tp);
+    EXPECT_FALSE(currently_on(tp));
+
+    auto onNode = sync_wait(run_on(tp, [&] {
+      return currently_on(tp) && currently_on(any);
+    }));
+    ASSERT_TRUE(onNode.has_value());
+    EXPECT_TRUE(*onNode);
+  }
+}
+
+TEST(StaticThreadPool, NodeSchedulerOnlyOnItsNode) {
+  static_thread_pool::options options;
+  options.threadCount = 2;
+  static_thread_pool tpContext{options};
+  // Without numaAware the pool has a single node.
+  ASSERT_EQ(1u, tpContext.node_count());
+  EXPECT_EQ(tpContext.get_scheduler(0), tpContext.get_scheduler(0));
+
+  std::atomic<int> x = 0;
+  sync_wait(when_all(
+      run_on(tpContext.get_scheduler(0), [&] { ++x; }),
+      run_on(tpContext.get_scheduler(0), [&] { ++x; }),
+      run_on(tpContext.get_scheduler(), [&] { ++x; })));
+  EXPECT_EQ(x, 3);
+}
+
+TEST(StaticThreadPool, WeightedPriorityLanes) {
+  lane_order lanes{single_thread_options()};
+  auto low = lanes.pool_.get_scheduler(priority::low);
+  auto high = lanes.pool_.get_scheduler(priority::high);
+  EXPECT_EQ(priority::low, get_priority(low));
+  EXPECT_EQ(priority::high, get_priority(high));
+  EXPECT_NE(low, high);
+
+  for (int i = 0; i < 10; ++i) {
+    lanes.add('l', schedule(low));
+  }
+  for (int i = 0; i < 10; ++i) {
+    lanes.add('h', schedule(high));
+  }
+  // With the default weights of 1 and 16, the low lane gets one slot in
+  // 17 while both lanes have work.
+  EXPECT_EQ("hhhhhhhhlhhlllllllll", lanes.run());
+}
+
+TEST(StaticThreadPool, StrictPriorityLanesWithAging) {
+  auto options = single_thread_options();
+  options.lanePolicy = static_thread_pool::options::lane_policy::aging;
+  options.agingThreshold = std::chrono::hours(1);
+  lane_order lanes{options};
+  for (int i = 0; i < 3; ++i) {
+    lanes.add('l', schedule(lanes.pool_.get_scheduler(priority::low)));
+    lanes.add('n', schedule(lanes.pool_.get_scheduler(priority::normal)));
+    lanes.add('h', schedule(lanes.pool_.get_scheduler(priority::high)));
+  }
+  EXPECT_EQ("hhhnnnlll", lanes.run());
+}
+
+TEST(StaticThreadPool, AgedTasksRunFirst) {
+  auto options = single_thread_options();
+  options.lanePolicy = static_thread_pool::options::lane_policy::aging;
+  options.agingThreshold = std::chrono::seconds(0);
+  lane_order lanes{options};
+  for (int i = 0; i < 3; ++i) {
+    lanes.add('l', schedule(lanes.pool_.get_scheduler(priority::low)));
+    lanes.add('h', schedule(lanes.pool_.get_scheduler(priority::high)));
+  }
+  // Every task is overdue, so the lowest lane with work goes first.
+  EXPECT_EQ("lllhhh", lanes.run());
+}
+
+TEST(StaticThreadPool, DefaultSchedulerInheritsPriority) {
+  auto options = single_thread_options();
+  options.lanePolicy = static_thread_pool::options::lane_policy::aging;
+  options.agingThreshold = std::chrono::hours(1);
+  lane_order lanes{options};
+  auto tp = lanes.pool_.get_scheduler();
+  lanes.add('n', schedule(tp));
+  lanes.add('h', with_query_value(schedule(tp), get_priority, priority::high));
+  lanes.add('l', with_query_value(schedule(tp), get_priority, priority::low));
+  EXPECT_EQ("hnl", lanes.run());
+}
+
+TEST(StaticThreadPool, ScheduleAfter) {
+  static_thread_pool pool{2};
+  auto tp = pool.get_scheduler();
+  const auto start = tp.now();
+  auto onPool = sync_wait(then(
+      schedule_after(tp, std::chrono::milliseconds(20)),
+      [tp]() noexcept { return currently_on(tp); }));
+  EXPECT_TRUE(onPool.value_or(false));
+  EXPECT_GE(tp.now() - start, std::chrono::milliseconds(20));
+}
+
+TEST(StaticThreadPool, TimersRunInDueOrder) {
+  lane_order timers{single_thread_options()};
+  auto tp = timers.pool_.get_scheduler();
+  const auto now = tp.now();
+  timers.add('c', schedule_at(tp, now + std::chrono::milliseconds(30)));
+  timers.add('a', schedule_at(tp, now + std::chrono::milliseconds(10)));
+  timers.add('b', schedule_at(tp, now + std::chrono::milliseconds(20)));
+  EXPECT_EQ("abc", timers.run());
+}
+
+TEST(StaticThreadPool, CancelledTimerCompletesEarly) {
+  static_thread_pool pool{2};
+  auto tp = pool.get_scheduler();
+  inplace_stop_source stopSource;
+  const auto start = tp.now();
+  std::thread canceller{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stopSource.request_stop();
+  }};
+  auto result = sync_wait(with_query_value(
+      schedule_after(tp, std::chrono::seconds(10)),
+      get_stop_token,
+      stopSource.get_token()));
+  canceller.join();
+  EXPECT_FALSE(result.has_value());
+  EXPECT_LT(tp.now() - start, std::chrono::seconds(5));
+}
+
+TEST(StaticThreadPool, CancelManyTimers) {
+  static_thread_pool pool{2};
+  auto tp = pool.get_scheduler();
+  async_scope scope;
+  std::atomic<int> fired{0};
+  for (int i = 0; i < 50; ++i) {
+    scope.detached_spawn(then(
+        schedule_after(tp, std::chrono::seconds(10 + i % 7)),
+        [&] { ++fired; }));
+  }
+  const auto start = tp.now();
+  sync_wait(scope.cleanup());
+  EXPECT_EQ(0, fired.load());
+  EXPECT_LT(tp.now() - start, std::chrono::seconds(5));
+}
+
+TEST(StaticThreadPool, BurstsCompleteWithOrWithoutSpinning) {
+  for (std::uint32_t spinCount : {0u, 4u, 32u}) {
+    static_thread_pool::options options;
+    options.threadCount = 4;
+    options.spinCount = spinCount;
+    static_thread_pool pool{options};
+    auto tp = pool.get_scheduler();
+
+    for (int burst = 1; burst <= 64; burst *= 2) {
+      async_scope scope;
+      std::atomic<int> ran{0};
+      for (int i = 0; i < burst; ++i) {
+        scope.detached_spawn(then(schedule(tp), [&] { ++ran; }));
+      }
+      sync_wait(scope.complete());
+      EXPECT_EQ(burst, ran.load());
+
+      // Let the workers park again.
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+TEST(StaticThreadPool, ParallelBulkScheduleRunsChunksConcurrently) {
+  static_thread_pool pool{2};
+  const std::size_t count = 1000;
+  auto runs = std::make_unique<std::atomic<int>[]>(count);
+
+  // The first and last indices are in different chunks.
+  overlap_check check;
+
+  sync_wait(
+      bulk_schedule(pool.get_scheduler(), count) |
+      bulk_transform(
+          [&](std::size_t i) {
+            ++runs[i];
+            if (i == 0 || i == count - 1) {
+              check.arrive();
+            }
+          },
+          par) |
+      bulk_join());
+
+  for (std::size_t i = 0; i < count; ++i) {
+    EXPECT_EQ(1, runs[i].load()) << "index " << i;
+  }
+  EXPECT_TRUE(check.overlapped_.load());
+}
+
+TEST(StaticThreadPool, ParallelBulkScheduleChunkedRunsChunksConcurrently) {
+  static_thread_pool pool{2};
+  const std::size_t count = 1000;
+  const std::size_t chunkSize = get_bulk_chunk_size(pool.get_scheduler());
+  auto runs = std::make_unique<std::atomic<int>[]>(count);
+  std::atomic<std::size_t> shortChunks{0};
+  overlap_check check;
+
+  sync_wait(
+      bulk_schedule_chunked(pool.get_scheduler(), count) |
+      bulk_transform(
+          [&](index_range<std::size_t> range) {
+            if (range.size() != chunkSize) {
+              ++shortChunks;
+            }
+            for (std::size_t i : range) {
+              ++runs[i];
+            }
+            if (range.first == 0 || range.last == count) {
+              check.arrive();
+            }
+          },
+          par) |
+      bulk_join());
+
+  for (std::size_t i = 0; i < count; ++i) {
+    EXPECT_EQ(1, runs[i].load()) << "index " << i;
+  }
+  // Only the last chunk may be short.
+  EXPECT_EQ(count % chunkSize != 0 ? 1u : 0u, shortChunks.load());
+  EXPECT_TRUE(check.overlapped_.load());
+}
+
+TEST(StaticThreadPool, ParallelBulkSchedulePropagatesErrors) {
+  static_thread_pool pool{4};
+  EXPECT_THROW(
+      sync_wait(
+          bulk_schedule(pool.get_scheduler(), 10000) |
+          bulk_transform(
+              [](int i) {
+                if (i == 5000) {
+                  throw std::runtime_error("bulk");
+                }
+              },
+              par) |
+          bulk_join()),
+      std::runtime_error);
+}
+
+TEST(StaticThreadPool, ParallelBulkScheduleStopsOnStopRequest) {
+  static_thread_pool pool{4};
+  const int count = 100000;
+  inplace_stop_source stopSource;
+  std::atomic<int> ran{0};
+
+  auto result = sync_wait(with_query_value(
+      bulk_schedule(pool.get_scheduler(), count) |
+          bulk_transform(
+              [&](int) {
+                if (++ran == 100) {
+                  stopSource.request_stop();
+                }
+              },
+              par) |
+          bulk_join(),
+      get_stop_token,
+      stopSource.get_token()));
+
+  EXPECT_FALSE(result.has_value());
+  EXPECT_LT(ran.load(), count);
+}
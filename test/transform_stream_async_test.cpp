@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/transform_stream_async.hpp>
+
+#include <unifex/just.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+template <typename Stream>
+std::vector<int> collect(Stream&& stream) {
+  auto res = reduce_stream(
+                 (Stream &&) stream,
+                 std::vector<int>{},
+                 [](std::vector<int> acc, int val) {
+                   acc.push_back(val);
+                   return acc;
+                 }) |
+      sync_wait();
+  return res ? std::move(*res) : std::vector<int>{};
+}
+
+// Later elements complete sooner, so that completion order differs from
+// input order.
+auto staggered(timed_single_thread_context& ctx) {
+  return [&ctx](int i) {
+    return schedule_after(ctx.get_scheduler(), (4 - i % 4) * 1ms) |
+        then([i] { return i * 10; });
+  };
+}
+}  // namespace
+
+TEST(transform_stream_async, InputOrder) {
+  timed_single_thread_context ctx;
+  auto results =
+      collect(transform_stream_async(range_stream{0, 20}, staggered(ctx), 4));
+
+  std::vector<int> expected;
+  for (int i = 0; i < 20; ++i) {
+    expected.push_back(i * 10);
+  }
+  EXPECT_EQ(expected, results);
+}
+
+TEST(transform_stream_async, CompletionOrder) {
+  timed_single_thread_context ctx;
+  auto results = collect(
+      range_stream{0, 20} |
+      transform_stream_async(
+          staggered(ctx), 4, transform_order::completion));
+
+  ASSERT_EQ(20u, results.size());
+  EXPECT_NE(0, results.front());
+  std::sort(results.begin(), results.end());
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(i * 10, results[i]);
+  }
+}
+
+TEST(transform_stream_async, BoundsWorkInFlight) {
+  static_thread_pool pool{4};
+  std::atomic<int> inFlight{0};
+  std::atomic<int> maxInFlight{0};
+
+  auto results = collect(transform_stream_async(
+      range_stream{0, 100},
+      [&](int i) {
+        return schedule(pool.get_scheduler()) | then([&, i] {
+                 int n = ++inFlight;
+                 int prev = maxInFlight.load();
+                 while (prev < n &&
+                        !maxInFlight.compare_exchange_weak(prev, n)) {
+                 }
+                 std::this_thread::sleep_for(100us);
+                 --inFlight;
+                 return i;
+               });
+      },
+      3));
+
+  ASSERT_EQ(100u, results.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, results[i]);
+  }
+  EXPECT_LE(maxInFlight.load(), 3);
+}
+
+TEST(transform_stream_async, InlineCompletion) {
+  auto results = collect(transform_stream_async(
+      range_stream{0, 1000}, [](int i) { return just(i + 1); }, 8));
+
+  ASSERT_EQ(1000u, results.size());
+  EXPECT_EQ(1, results.front());
+  EXPECT_EQ(1000, results.back());
+}
+
+#if !UNIFEX_NO_EXCEPTIONS
+TEST(transform_stream_async, PropagatesErrors) {
+  static_thread_pool pool{2};
+  auto stream = transform_stream_async(
+      range_stream{0, 20},
+      [&](int i) {
+        return schedule(pool.get_scheduler()) | then([i] {
+                 if (i == 7) {
+                   throw std::runtime_error{"boom"};
+                 }
+                 return i;
+               });
+      },
+      4);
+
+  EXPECT_THROW(collect(std::move(stream)), std::runtime_error);
+}
+#endif
+
+TEST(transform_stream_async, CleanupCancelsWorkInFlight) {
+  timed_single_thread_context ctx;
+  auto stream = transform_stream_async(
+      range_stream{0, 10},
+      [&](int i) {
+        return schedule_after(ctx.get_scheduler(), i == 0 ? 0ms : 1h) |
+            then([i] { return i; });
+      },
+      4,
+      transform_order::completion);
+
+  auto first = sync_wait(next(stream));
+  ASSERT_TRUE(first);
+  EXPECT_EQ(0, *first);
+
+  auto start = std::chrono::steady_clock::now();
+  sync_wait(cleanup(stream));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+}
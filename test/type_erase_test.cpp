@@ -22,6 +22,7 @@
 #include <unifex/never.hpp>
 #include <unifex/on_stream.hpp>
 #include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
 #include <unifex/single_thread_context.hpp>
 #include <unifex/sync_wait.hpp>
 #include <unifex/then.hpp>
@@ -29,7 +30,9 @@
 #include <unifex/via_stream.hpp>
 #include <unifex/when_all.hpp>
 
+#include <cstddef>
 #include <cstdio>
+#include <memory>
 
 #include <gtest/gtest.h>
 
@@ -38,6 +41,38 @@ using namespace unifex;
 namespace {
 single_thread_context context1;
 single_thread_context context2;
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(int& live) noexcept : live_(&live) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+    : live_(other.live_) {}
+
+  T* allocate(std::size_t n) {
+    ++*live_;
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    --*live_;
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool
+  operator==(const counting_allocator& a, const counting_allocator& b) {
+    return a.live_ == b.live_;
+  }
+  friend bool
+  operator!=(const counting_allocator& a, const counting_allocator& b) {
+    return !(a == b);
+  }
+
+  int* live_;
+};
 }  // namespace
 
 TEST(type_erase, UseType) {
@@ -89,3 +124,22 @@ TEST(type_erase, InlineCancel) {
         just_from([&] { stopSource.request_stop(); }));
   }));
 }
+
+TEST(type_erase, AllocatesOnceWithAllocator) {
+  int live = 0;
+  {
+    auto stream =
+        type_erase<int>(range_stream{0, 100}, counting_allocator<int>{live});
+    EXPECT_EQ(1, live);
+
+    // Every next() reuses the storage allocated with the stream.
+    auto sum = sync_wait(reduce_stream(
+        std::move(stream), 0, [&](int state, int value) {
+          EXPECT_EQ(1, live);
+          return state + value;
+        }));
+    ASSERT_TRUE(sum.has_value());
+    EXPECT_EQ(4950, *sum);
+  }
+  EXPECT_EQ(0, live);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/zip_streams.hpp>
+
+#include <unifex/just_done.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/transform_stream.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+using ctx_scheduler =
+    decltype(UNIFEX_DECLVAL(timed_single_thread_context&).get_scheduler());
+
+// Produces 0, 1, 2, ... one element every interval.
+struct ticking_stream {
+  auto next() {
+    return schedule_after(scheduler_, interval_) |
+        then([this] { return i_++; });
+  }
+
+  auto cleanup() { return just_done(); }
+
+  ctx_scheduler scheduler_;
+  std::chrono::milliseconds interval_;
+  int i_ = 0;
+};
+}  // namespace
+
+TEST(zip_streams, PairsValuesUntilShortestEnds) {
+  auto res = zip_streams(range_stream{0, 5}, range_stream{10, 20}) |
+      reduce_stream(
+                 std::vector<std::pair<int, int>>{},
+                 [](auto acc, int a, int b) {
+                   acc.emplace_back(a, b);
+                   return acc;
+                 }) |
+      sync_wait();
+
+  ASSERT_TRUE(res);
+  std::vector<std::pair<int, int>> expected{
+      {0, 10}, {1, 11}, {2, 12}, {3, 13}, {4, 14}};
+  EXPECT_EQ(expected, *res);
+}
+
+TEST(zip_streams, PullsInLockstep) {
+  timed_single_thread_context ctx;
+  int pulled = 0;
+  auto stream = zip_streams(
+      ticking_stream{ctx.get_scheduler(), 1ms},
+      range_stream{0, 100} | transform_stream([&](int val) {
+        ++pulled;
+        return val;
+      }));
+
+  for (int i = 0; i < 3; ++i) {
+    auto res = sync_wait(next(stream));
+    ASSERT_TRUE(res);
+    EXPECT_EQ(i, std::get<0>(*res));
+    EXPECT_EQ(i, std::get<1>(*res));
+    EXPECT_EQ(i + 1, pulled);
+  }
+  sync_wait(cleanup(stream));
+  EXPECT_EQ(3, pulled);
+}
+
+#if !UNIFEX_NO_EXCEPTIONS
+TEST(zip_streams, PropagatesErrors) {
+  timed_single_thread_context ctx;
+  auto stream = zip_streams(
+      ticking_stream{ctx.get_scheduler(), 1h},
+      range_stream{0, 10} |
+          transform_stream([](int) -> int { throw std::runtime_error{""}; }));
+
+  // The error stops the slow stream rather than waiting for it.
+  EXPECT_THROW(sync_wait(next(stream)), std::runtime_error);
+  sync_wait(cleanup(stream));
+}
+#endif